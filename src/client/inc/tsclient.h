@@ -41,10 +41,11 @@ extern "C" {
 struct SSqlInfo;
 struct SLocalMerger;
 
-// data source from sql string or from file
+// data source from sql string, from file or from the parameters bound to a statement
 enum {
-  DATA_FROM_SQL_STRING = 1,
-  DATA_FROM_DATA_FILE  = 2,
+  DATA_FROM_SQL_STRING  = 1,
+  DATA_FROM_DATA_FILE   = 2,
+  DATA_FROM_BOUND_PARAM = 3,
 };
 
 typedef void (*__async_cb_func_t)(void *param, TAOS_RES *tres, int32_t numOfRows);
@@ -428,6 +429,12 @@ void tscResetSqlCmd(SSqlCmd *pCmd, bool removeMeta);
  */
 void tscFreeSqlResult(SSqlObj *pSql);
 
+/**
+ * free the sub sql objects of a completed query or multi-vnode insertion
+ * @param pSql
+ */
+void tscFreeSubobj(SSqlObj* pSql);
+
 /**
  * free sql object, release allocated resource
  * @param pObj
@@ -98,9 +98,11 @@ static void tscInitSqlContext(SSqlCmd *pCmd, SLocalMerger *pReducer, tOrderDescr
       pCtx->param[2].i64 = pQueryInfo->order.order;
       pCtx->param[2].nType  = TSDB_DATA_TYPE_BIGINT;
       pCtx->param[1].i64 = pQueryInfo->order.orderColId;
-    } else if (functionId == TSDB_FUNC_APERCT) {
+    } else if (functionId == TSDB_FUNC_APERCT || functionId == TSDB_FUNC_HLL) {
       pCtx->param[0].i64 = pExpr->param[0].i64;
       pCtx->param[0].nType  = pExpr->param[0].nType;
+      pCtx->param[1].i64 = pExpr->param[1].i64;
+      pCtx->param[1].nType  = pExpr->param[1].nType;
     }
 
     pCtx->interBufBytes = pExpr->interBytes;
@@ -553,6 +555,14 @@ static int32_t createOrderDescriptor(tOrderDescriptor **pOrderDesc, SSqlCmd *pCm
     numOfGroupByCols++;
   }
 
+  // order by a normal column, with the primary timestamp to break the ties
+  bool orderByCol = pQueryInfo->interval.interval == 0 && pQueryInfo->groupbyExpr.numOfGroupCols == 0 &&
+                    tscOrderedProjectionQueryOnSTable(pQueryInfo, 0) &&
+                    pQueryInfo->order.orderColId != PRIMARYKEY_TIMESTAMP_COL_INDEX;
+  if (orderByCol) {
+    numOfGroupByCols++;
+  }
+
   int32_t *orderColIndexList = (int32_t *)calloc(numOfGroupByCols, sizeof(int32_t));
   if (orderColIndexList == NULL) {
     return TSDB_CODE_TSC_OUT_OF_MEMORY;
@@ -584,13 +594,17 @@ static int32_t createOrderDescriptor(tOrderDescriptor **pOrderDesc, SSqlCmd *pCm
         size_t size = tscSqlExprNumOfExprs(pQueryInfo);
         for (int32_t i = 0; i < size; ++i) {
           SSqlExpr *pExpr = tscSqlExprGet(pQueryInfo, i);
-          if (pExpr->functionId == TSDB_FUNC_PRJ && pExpr->colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+          if (pExpr->functionId != TSDB_FUNC_PRJ) {
+            continue;
+          }
+
+          if (pExpr->colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+            orderColIndexList[numOfGroupByCols - 1] = i;
+          } else if (orderByCol && pExpr->colInfo.colId == pQueryInfo->order.orderColId) {
             orderColIndexList[0] = i;
           }
         }
       }
-
-      assert(pQueryInfo->order.orderColId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
     }
   }
 
@@ -416,6 +416,29 @@ static int32_t tsCheckTimestamp(STableDataBlocks *pDataBlocks, const char *start
   return TSDB_CODE_SUCCESS;
 }
 
+static int32_t tsSetUnassignedColumnsNull(char *payload, SSchema schema[], SParsedDataColInfo *spd) {
+  char *ptr = payload;
+
+  for (int32_t i = 0; i < spd->numOfCols; ++i) {
+    
+    if (!spd->hasVal[i]) {  // current column do not have any value to insert, set it to null
+      if (schema[i].type == TSDB_DATA_TYPE_BINARY) {
+        varDataSetLen(ptr, sizeof(int8_t));
+        *(uint8_t*) varDataVal(ptr) = TSDB_DATA_BINARY_NULL;
+      } else if (schema[i].type == TSDB_DATA_TYPE_NCHAR) {
+        varDataSetLen(ptr, sizeof(int32_t));
+        *(uint32_t*) varDataVal(ptr) = TSDB_DATA_NCHAR_NULL;
+      } else {
+        setNull(ptr, schema[i].type, schema[i].bytes);
+      }
+    }
+    
+    ptr += schema[i].bytes;
+  }
+
+  return (int32_t)(ptr - payload);
+}
+
 int tsParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[], SParsedDataColInfo *spd, SSqlCmd* pCmd,
                       int16_t timePrec, int32_t *code, char *tmpTokenBuf) {
   int32_t index = 0;
@@ -499,26 +522,7 @@ int tsParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[
 
   // 2. set the null value for the columns that do not assign values
   if (spd->numOfAssignedCols < spd->numOfCols) {
-    char *ptr = payload;
-
-    for (int32_t i = 0; i < spd->numOfCols; ++i) {
-      
-      if (!spd->hasVal[i]) {  // current column do not have any value to insert, set it to null
-        if (schema[i].type == TSDB_DATA_TYPE_BINARY) {
-          varDataSetLen(ptr, sizeof(int8_t));
-          *(uint8_t*) varDataVal(ptr) = TSDB_DATA_BINARY_NULL;
-        } else if (schema[i].type == TSDB_DATA_TYPE_NCHAR) {
-          varDataSetLen(ptr, sizeof(int32_t));
-          *(uint32_t*) varDataVal(ptr) = TSDB_DATA_NCHAR_NULL;
-        } else {
-          setNull(ptr, schema[i].type, schema[i].bytes);
-        }
-      }
-      
-      ptr += schema[i].bytes;
-    }
-
-    rowSize = (int32_t)(ptr - payload);
+    rowSize = tsSetUnassignedColumnsNull(payload, schema, spd);
   }
 
   return rowSize;
@@ -535,6 +539,409 @@ static int32_t rowDataCompar(const void *lhs, const void *rhs) {
   }
 }
 
+/*
+ * Fast path for the rows that consist of plain literals only, e.g. (1577808000000, 10, 2.5, 'abc'), which is the
+ * usual shape of bulk insertion. Values are scanned in place without the generic tokenizer. Anything not recognized
+ * here (now, time expressions, escaped strings, hex numbers, '?', invalid or overflow data, ...) makes the whole row
+ * fall back to tsParseOneRowData, which also reports the error.
+ */
+#define FAST_PARSE_MAX_INT_DIGITS   18   // never overflows int64_t
+#define FAST_PARSE_MAX_FLT_DIGITS   15   // mantissa is exact in a double
+#define FAST_PARSE_MAX_FLT_EXP      22   // power of ten is exact in a double
+#define FAST_PARSE_TS_MINUTE_LEN    16   // "YYYY-MM-DD HH:MM"
+#define FAST_PARSE_TS_SECOND_LEN    19   // "YYYY-MM-DD HH:MM:SS"
+
+#define IS_FAST_PARSE_SPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r' || (c) == '\f')
+#define IS_FAST_PARSE_DIGIT(c) ((c) >= '0' && (c) <= '9')
+
+// timestamp of the minute that the last timestamp string belongs to, rows in one sql are usually close in time
+typedef struct STsMinuteCache {
+  bool    valid;
+  char    minute[FAST_PARSE_TS_MINUTE_LEN];
+  int64_t base;
+} STsMinuteCache;
+
+static const long double exactPow10[] = {
+  1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,  1e10L, 1e11L,
+  1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L,
+};
+
+static char *tsFastParseInteger(char *p, int64_t *value) {
+  bool neg = (*p == '-');
+  if (neg) {
+    p++;
+  }
+
+  char   *start = p;
+  int64_t v = 0;
+  while (IS_FAST_PARSE_DIGIT(*p) && (p - start) < FAST_PARSE_MAX_INT_DIGITS) {
+    v = v * 10 + (*p - '0');
+    p++;
+  }
+
+  if (p == start || IS_FAST_PARSE_DIGIT(*p)) {
+    return NULL;
+  }
+
+  *value = neg ? -v : v;
+  return p;
+}
+
+/*
+ * A decimal number with at most 15 significant digits and a small exponent is m * 10^e where both m and 10^e are
+ * exact, so one multiplication or division in long double gives the same correctly rounded result as strtold.
+ */
+static char *tsFastParseDouble(char *p, double *value) {
+  char    *start = p;
+  bool     neg = (*p == '-');
+  uint64_t mantissa = 0;
+  int32_t  digits = 0;
+  int32_t  exp = 0;
+  bool     exact = true;
+  bool     hasDigit = false;
+
+  if (neg) {
+    p++;
+  }
+
+  for (bool frac = false; ; p++) {
+    if (IS_FAST_PARSE_DIGIT(*p)) {
+      hasDigit = true;
+      if (mantissa == 0 && *p == '0') {
+        exp -= frac;
+        continue;
+      }
+
+      if (++digits > FAST_PARSE_MAX_FLT_DIGITS) {
+        exact = false;
+        continue;
+      }
+
+      mantissa = mantissa * 10 + (*p - '0');
+      exp -= frac;
+    } else if (*p == '.' && !frac) {
+      frac = true;
+    } else {
+      break;
+    }
+  }
+
+  if (!hasDigit) {
+    return NULL;
+  }
+
+  if (*p == 'e' || *p == 'E') {
+    char   *e = p + 1;
+    int32_t sign = 1;
+    if (*e == '-' || *e == '+') {
+      sign = (*e == '-') ? -1 : 1;
+      e++;
+    }
+
+    int32_t v = 0;
+    char   *eStart = e;
+    while (IS_FAST_PARSE_DIGIT(*e) && (e - eStart) < 4) {
+      v = v * 10 + (*e - '0');
+      e++;
+    }
+
+    if (e == eStart || IS_FAST_PARSE_DIGIT(*e)) {
+      return NULL;
+    }
+
+    exp += sign * v;
+    p = e;
+  }
+
+  if (exact && exp >= -FAST_PARSE_MAX_FLT_EXP && exp <= FAST_PARSE_MAX_FLT_EXP) {
+    long double v = (exp >= 0) ? (long double)mantissa * exactPow10[exp] : (long double)mantissa / exactPow10[-exp];
+    *value = (double)(neg ? -v : v);
+    return p;
+  }
+
+  char *endPtr = NULL;
+  *value = strtold(start, &endPtr);
+  return (endPtr == p) ? p : NULL;
+}
+
+// a quoted string without any escape characters
+static char *tsFastParseString(char *p, char **z, int32_t *n) {
+  char  delim = *p;
+  char *end = strchr(p + 1, delim);
+  if (end == NULL || end[1] == delim || memchr(p + 1, '\\', end - p - 1) != NULL) {
+    return NULL;
+  }
+
+  *z = p + 1;
+  *n = (int32_t)(end - p - 1);
+  return end + 1;
+}
+
+static bool tsIsCanonicalTimeStr(const char *z, int32_t n) {
+  static const char pattern[] = "dddd-dd-dd dd:dd:dd";
+
+  if (n < FAST_PARSE_TS_SECOND_LEN || (n > FAST_PARSE_TS_SECOND_LEN && (n == FAST_PARSE_TS_SECOND_LEN + 1 ||
+                                                                        z[FAST_PARSE_TS_SECOND_LEN] != '.'))) {
+    return false;
+  }
+
+  for (int32_t i = 0; i < FAST_PARSE_TS_SECOND_LEN; ++i) {
+    if ((pattern[i] == 'd') ? !IS_FAST_PARSE_DIGIT(z[i]) : (z[i] != pattern[i])) {
+      return false;
+    }
+  }
+
+  for (int32_t i = FAST_PARSE_TS_SECOND_LEN + 1; i < n; ++i) {
+    if (!IS_FAST_PARSE_DIGIT(z[i])) {
+      return false;
+    }
+  }
+
+  // leap seconds are left to taosParseTime
+  return (z[17] - '0') * 10 + (z[18] - '0') <= 59;
+}
+
+static bool tsFastParseTimeStr(char *z, int32_t n, int64_t *time, int16_t timePrec, STsMinuteCache *pCache) {
+  char buf[64];
+
+  if (!tsIsCanonicalTimeStr(z, n)) {
+    if (n >= tListLen(buf)) {
+      return false;
+    }
+
+    memcpy(buf, z, n);
+    buf[n] = 0;
+    return taosParseTime(buf, time, n, timePrec, tsDaylight) == TSDB_CODE_SUCCESS;
+  }
+
+  // the local time of one minute is resolved by taosParseTime only once, the seconds are added on it
+  if (!pCache->valid || memcmp(pCache->minute, z, FAST_PARSE_TS_MINUTE_LEN) != 0) {
+    memcpy(buf, z, FAST_PARSE_TS_MINUTE_LEN);
+    memcpy(buf + FAST_PARSE_TS_MINUTE_LEN, ":00", 4);
+    if (taosParseTime(buf, &pCache->base, FAST_PARSE_TS_SECOND_LEN, timePrec, tsDaylight) != TSDB_CODE_SUCCESS) {
+      pCache->valid = false;
+      return false;
+    }
+
+    memcpy(pCache->minute, z, FAST_PARSE_TS_MINUTE_LEN);
+    pCache->valid = true;
+  }
+
+  int64_t factor = (timePrec == TSDB_TIME_PRECISION_MILLI) ? 1000 : 1000000;
+  int32_t fracLen = (timePrec == TSDB_TIME_PRECISION_MILLI) ? 3 : 6;
+  int64_t fraction = 0;
+
+  // the same as parseFraction: the extra digits are ignored, and the short ones are scaled
+  char *f = z + FAST_PARSE_TS_SECOND_LEN + 1;
+  for (int32_t i = 0; i < fracLen; ++i) {
+    fraction = fraction * 10 + ((f + i < z + n) ? (f[i] - '0') : 0);
+  }
+
+  *time = pCache->base + ((z[17] - '0') * 10 + (z[18] - '0')) * factor + fraction;
+  return true;
+}
+
+static char *tsFastParseColumnData(SSchema *pSchema, char *p, char *payload, int16_t timePrec,
+                                   STsMinuteCache *pCache) {
+  int64_t iv = 0;
+  double  dv = 0;
+  char   *z = NULL;
+  int32_t n = 0;
+
+  switch (pSchema->type) {
+    case TSDB_DATA_TYPE_BOOL:
+      if (strncmp(p, "true", 4) == 0) {
+        *(uint8_t *)payload = TSDB_TRUE;
+        return p + 4;
+      } else if (strncmp(p, "false", 5) == 0) {
+        *(uint8_t *)payload = TSDB_FALSE;
+        return p + 5;
+      } else if ((p = tsFastParseInteger(p, &iv)) == NULL) {
+        return NULL;
+      }
+
+      *(uint8_t *)payload = (int8_t)((iv == 0) ? TSDB_FALSE : TSDB_TRUE);
+      return p;
+
+    case TSDB_DATA_TYPE_TINYINT:
+      if ((p = tsFastParseInteger(p, &iv)) == NULL || !IS_VALID_TINYINT(iv)) {
+        return NULL;
+      }
+
+      *((uint8_t *)payload) = (uint8_t)iv;
+      return p;
+
+    case TSDB_DATA_TYPE_UTINYINT:
+      if (*p == '-' || (p = tsFastParseInteger(p, &iv)) == NULL || !IS_VALID_UTINYINT(iv)) {
+        return NULL;
+      }
+
+      *((uint8_t *)payload) = (uint8_t)iv;
+      return p;
+
+    case TSDB_DATA_TYPE_SMALLINT:
+      if ((p = tsFastParseInteger(p, &iv)) == NULL || !IS_VALID_SMALLINT(iv)) {
+        return NULL;
+      }
+
+      *((int16_t *)payload) = (int16_t)iv;
+      return p;
+
+    case TSDB_DATA_TYPE_USMALLINT:
+      if (*p == '-' || (p = tsFastParseInteger(p, &iv)) == NULL || !IS_VALID_USMALLINT(iv)) {
+        return NULL;
+      }
+
+      *((uint16_t *)payload) = (uint16_t)iv;
+      return p;
+
+    case TSDB_DATA_TYPE_INT:
+      if ((p = tsFastParseInteger(p, &iv)) == NULL || !IS_VALID_INT(iv)) {
+        return NULL;
+      }
+
+      *((int32_t *)payload) = (int32_t)iv;
+      return p;
+
+    case TSDB_DATA_TYPE_UINT:
+      if (*p == '-' || (p = tsFastParseInteger(p, &iv)) == NULL || !IS_VALID_UINT(iv)) {
+        return NULL;
+      }
+
+      *((uint32_t *)payload) = (uint32_t)iv;
+      return p;
+
+    case TSDB_DATA_TYPE_BIGINT:
+      if ((p = tsFastParseInteger(p, &iv)) == NULL) {
+        return NULL;
+      }
+
+      *((int64_t *)payload) = iv;
+      return p;
+
+    case TSDB_DATA_TYPE_UBIGINT:
+      if (*p == '-' || (p = tsFastParseInteger(p, &iv)) == NULL) {
+        return NULL;
+      }
+
+      *((uint64_t *)payload) = (uint64_t)iv;
+      return p;
+
+    case TSDB_DATA_TYPE_FLOAT:
+      if ((p = tsFastParseDouble(p, &dv)) == NULL || dv > FLT_MAX || dv < -FLT_MAX || isinf(dv) || isnan(dv)) {
+        return NULL;
+      }
+
+      *((float *)payload) = (float)dv;
+      return p;
+
+    case TSDB_DATA_TYPE_DOUBLE:
+      if ((p = tsFastParseDouble(p, &dv)) == NULL || isinf(dv) || isnan(dv)) {
+        return NULL;
+      }
+
+      *((double *)payload) = dv;
+      return p;
+
+    case TSDB_DATA_TYPE_BINARY:
+      if ((*p != '\'' && *p != '"') || (p = tsFastParseString(p, &z, &n)) == NULL ||
+          n + VARSTR_HEADER_SIZE > pSchema->bytes) {
+        return NULL;
+      }
+
+      STR_WITH_SIZE_TO_VARSTR(payload, z, n);
+      return p;
+
+    case TSDB_DATA_TYPE_NCHAR: {
+      int32_t output = 0;
+      if ((*p != '\'' && *p != '"') || (p = tsFastParseString(p, &z, &n)) == NULL ||
+          !taosMbsToUcs4(z, n, varDataVal(payload), pSchema->bytes - VARSTR_HEADER_SIZE, &output)) {
+        return NULL;
+      }
+
+      varDataSetLen(payload, output);
+      return p;
+    }
+
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      if (*p == '\'' || *p == '"') {
+        if ((p = tsFastParseString(p, &z, &n)) == NULL || !tsFastParseTimeStr(z, n, &iv, timePrec, pCache)) {
+          return NULL;
+        }
+      } else if (*p == '-' || (p = tsFastParseInteger(p, &iv)) == NULL) {
+        return NULL;
+      }
+
+      *((int64_t *)payload) = iv;
+      return p;
+
+    default:
+      return NULL;
+  }
+}
+
+/*
+ * return the row size and move *str after the closing parenthesis, or 0 if the row should be parsed by
+ * tsParseOneRowData from the same position.
+ */
+static int32_t tsFastParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[],
+                                     SParsedDataColInfo *spd, int16_t timePrec, STsMinuteCache *pCache) {
+  char *p = *str;
+  char *payload = pDataBlocks->pData + pDataBlocks->size;
+  char *pKey = NULL;
+
+  int32_t rowSize = 0;
+  for (int32_t i = 0; i < spd->numOfAssignedCols; ++i) {
+    char    *start = payload + spd->elems[i].offset;
+    int16_t  colIndex = spd->elems[i].colIndex;
+    SSchema *pSchema = schema + colIndex;
+    rowSize += pSchema->bytes;
+
+    if (colIndex == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+      pKey = start;
+    }
+
+    while (IS_FAST_PARSE_SPACE(*p)) {
+      p++;
+    }
+
+    if (strncmp(p, "null", 4) == 0) {
+      if (pSchema->type == TSDB_DATA_TYPE_BINARY || pSchema->type == TSDB_DATA_TYPE_NCHAR) {
+        setVardataNull(start, pSchema->type);
+      } else if (colIndex == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+        *((int64_t *)start) = 0;
+      } else {
+        setNull(start, pSchema->type, pSchema->bytes);
+      }
+
+      p += 4;
+    } else if ((p = tsFastParseColumnData(pSchema, p, start, timePrec, pCache)) == NULL) {
+      return 0;
+    }
+
+    while (IS_FAST_PARSE_SPACE(*p)) {
+      p++;
+    }
+
+    if (*p != ((i == spd->numOfAssignedCols - 1) ? ')' : ',')) {
+      return 0;
+    }
+
+    p++;
+  }
+
+  if (pKey == NULL || tsCheckTimestamp(pDataBlocks, pKey) != TSDB_CODE_SUCCESS) {
+    return 0;
+  }
+
+  if (spd->numOfAssignedCols < spd->numOfCols) {
+    rowSize = tsSetUnassignedColumnsNull(payload, schema, spd);
+  }
+
+  *str = p;
+  return rowSize;
+}
+
 int tsParseValues(char **str, STableDataBlocks *pDataBlock, STableMeta *pTableMeta, int maxRows,
                   SParsedDataColInfo *spd, SSqlCmd* pCmd, int32_t *code, char *tmpTokenBuf) {
   int32_t   index = 0;
@@ -552,12 +959,25 @@ int tsParseValues(char **str, STableDataBlocks *pDataBlock, STableMeta *pTableMe
     return -1;
   }
 
+  STsMinuteCache tsCache = {0};
+
   while (1) {
-    index = 0;
-    sToken = tStrGetToken(*str, &index, false, 0, NULL);
-    if (sToken.n == 0 || sToken.type != TK_LP) break;
+    char *p = *str;
+    while (IS_FAST_PARSE_SPACE(*p)) {
+      p++;
+    }
 
-    *str += index;
+    if (*p != '(') {
+      index = 0;
+      sToken = tStrGetToken(*str, &index, false, 0, NULL);
+      if (sToken.n == 0 || sToken.type != TK_LP) break;
+
+      p = *str + index;
+    } else {
+      p++;
+    }
+
+    *str = p;
     if (numOfRows >= maxRows || pDataBlock->size + tinfo.rowSize >= pDataBlock->nAllocSize) {
       int32_t tSize;
       *code = tscAllocateMemIfNeed(pDataBlock, tinfo.rowSize, &tSize);
@@ -570,7 +990,14 @@ int tsParseValues(char **str, STableDataBlocks *pDataBlock, STableMeta *pTableMe
       maxRows = tSize;
     }
 
-    int32_t len = tsParseOneRowData(str, pDataBlock, pSchema, spd, pCmd, precision, code, tmpTokenBuf);
+    int32_t len = tsFastParseOneRowData(str, pDataBlock, pSchema, spd, precision, &tsCache);
+    if (len > 0) {
+      pDataBlock->size += len;
+      numOfRows++;
+      continue;
+    }
+
+    len = tsParseOneRowData(str, pDataBlock, pSchema, spd, pCmd, precision, code, tmpTokenBuf);
     if (len <= 0) {  // error message has been set in tsParseOneRowData
       return -1;
     }
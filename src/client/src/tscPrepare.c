@@ -22,6 +22,7 @@
 #include "tstrbuild.h"
 #include "tscLog.h"
 #include "tscSubquery.h"
+#include "tschemautil.h"
 
 int tsParseInsertSql(SSqlObj *pSql);
 
@@ -43,11 +44,17 @@ typedef struct SNormalStmt {
   tVariant*        params;
 } SNormalStmt;
 
+typedef struct SMultiTbStmt {
+  int64_t   currentUid;   // uid of the table that parameters are bound to
+  SHashObj* pTableUids;   // table name set by taos_stmt_set_tbname -> uid of its data block
+} SMultiTbStmt;
+
 typedef struct STscStmt {
   bool isInsert;
   STscObj* taos;
   SSqlObj* pSql;
   SNormalStmt normal;
+  SMultiTbStmt mtb;
 } STscStmt;
 
 static int normalStmtAddPart(SNormalStmt* stmt, bool isParam, char* str, uint32_t len) {
@@ -693,26 +700,31 @@ static int doBindParam(char* data, SParamInfo* param, TAOS_BIND* bind) {
   return TSDB_CODE_SUCCESS;
 }
 
-static int insertStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
-  SSqlCmd* pCmd = &stmt->pSql->cmd;
-
-  STableMetaInfo* pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, 0, 0);
+// the bound rows of a table are counted in the header of its data block until the statement is executed
+static void insertStmtResetDataBlock(STableDataBlocks* pBlock) {
+  SSubmitBlk* pBlk = (SSubmitBlk*)pBlock->pData;
+  pBlk->numOfRows = 0;
 
-  STableMeta* pTableMeta = pTableMetaInfo->pTableMeta;
-  if (pCmd->pTableBlockHashList == NULL) {
-    pCmd->pTableBlockHashList = taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, false);
-  }
+  pBlock->size = sizeof(SSubmitBlk);
+  pBlock->ordered = true;
+  pBlock->prevTS = INT64_MIN;
+}
 
-  STableDataBlocks* pBlock = NULL;
+static int insertStmtGetDataBlock(STscStmt* stmt, STableDataBlocks** pBlock) {
+  SSqlCmd* pCmd = &stmt->pSql->cmd;
 
-  int32_t ret =
-      tscGetDataBlockFromList(pCmd->pTableBlockHashList, pTableMeta->id.uid, TSDB_PAYLOAD_SIZE, sizeof(SSubmitBlk),
-                              pTableMeta->tableInfo.rowSize, &pTableMetaInfo->name, pTableMeta, &pBlock, NULL);
-  if (ret != 0) {
-    // todo handle error
+  STableDataBlocks** t = taosHashGet(pCmd->pTableBlockHashList, (const char*)&stmt->mtb.currentUid, sizeof(int64_t));
+  if (t == NULL) {
+    tscError("%p data block of table uid:%" PRId64 " not found", stmt->pSql, stmt->mtb.currentUid);
+    return TSDB_CODE_TSC_APP_ERROR;
   }
 
-  uint32_t totalDataSize = sizeof(SSubmitBlk) + pCmd->batchSize * pBlock->rowSize;
+  *pBlock = *t;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int insertStmtEnsureCapacity(STableDataBlocks* pBlock, int32_t numOfRows) {
+  uint32_t totalDataSize = sizeof(SSubmitBlk) + numOfRows * pBlock->rowSize;
   if (totalDataSize > pBlock->nAllocSize) {
     const double factor = 1.5;
 
@@ -725,11 +737,61 @@ static int insertStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
     pBlock->nAllocSize = (uint32_t)(totalDataSize * factor);
   }
 
-  char* data = pBlock->pData + sizeof(SSubmitBlk) + pBlock->rowSize * pCmd->batchSize;
+  return TSDB_CODE_SUCCESS;
+}
+
+// the columns left out of the column list of the statement are null in every bound row
+static void insertStmtSetRowsNull(STableDataBlocks* pBlock, int32_t start, int32_t numOfRows) {
+  STableComInfo tinfo = tscGetTableInfo(pBlock->pTableMeta);
+  if (pBlock->numOfParams >= (uint32_t)tinfo.numOfColumns) {
+    return;
+  }
+
+  SSchema* pSchema = tscGetTableSchema(pBlock->pTableMeta);
+  char*    row = pBlock->pData + sizeof(SSubmitBlk) + pBlock->rowSize * start;
+  for (int32_t i = 0; i < numOfRows; ++i, row += pBlock->rowSize) {
+    char* data = row;
+    for (int32_t j = 0; j < tinfo.numOfColumns; ++j) {
+      setNull(data, pSchema[j].type, pSchema[j].bytes);
+      data += pSchema[j].bytes;
+    }
+  }
+}
+
+// rows out of timestamp order are sorted when the data blocks are merged
+static void insertStmtCheckOrder(STableDataBlocks* pBlock, int32_t start, int32_t numOfRows) {
+  char* row = pBlock->pData + sizeof(SSubmitBlk) + pBlock->rowSize * start;
+  for (int32_t i = 0; i < numOfRows && pBlock->ordered; ++i, row += pBlock->rowSize) {
+    TSKEY k = *(TSKEY*)row;
+    if (k <= pBlock->prevTS) {
+      pBlock->ordered = false;
+    }
+    pBlock->prevTS = k;
+  }
+}
+
+static int insertStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
+  STableDataBlocks* pBlock = NULL;
+
+  int32_t code = insertStmtGetDataBlock(stmt, &pBlock);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  SSubmitBlk* pBlk = (SSubmitBlk*)pBlock->pData;
+  code = insertStmtEnsureCapacity(pBlock, pBlk->numOfRows + 1);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  pBlk = (SSubmitBlk*)pBlock->pData;
+  insertStmtSetRowsNull(pBlock, pBlk->numOfRows, 1);
+
+  char* data = pBlock->pData + sizeof(SSubmitBlk) + pBlock->rowSize * pBlk->numOfRows;
   for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
     SParamInfo* param = &pBlock->params[j];
 
-    int code = doBindParam(data, param, &bind[param->idx]);
+    code = doBindParam(data, param, &bind[param->idx]);
     if (code != TSDB_CODE_SUCCESS) {
       tscDebug("param %d: type mismatch or invalid", param->idx);
       return code;
@@ -739,73 +801,301 @@ static int insertStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
   return TSDB_CODE_SUCCESS;
 }
 
-static int insertStmtAddBatch(STscStmt* stmt) {
-  SSqlCmd* pCmd = &stmt->pSql->cmd;
-  ++pCmd->batchSize;
+/*
+ * The values of a column are copied into the row-wise data block with a stride of the row size. The type is
+ * resolved once per column, and only the values of a different type go through doBindParam one by one.
+ */
+static int doBindBatchParam(STableDataBlocks* pBlock, SParamInfo* param, TAOS_MULTI_BIND* bind, int32_t start) {
+  char* data = pBlock->pData + sizeof(SSubmitBlk) + pBlock->rowSize * start + param->offset;
+
+  if (bind->buffer_type == param->type && !IS_VAR_DATA_TYPE(param->type)) {
+    int32_t bytes = param->bytes;
+    char*   src = bind->buffer;
+    for (int32_t i = 0; i < bind->num; ++i, data += pBlock->rowSize, src += bytes) {
+      if (bind->is_null != NULL && bind->is_null[i]) {
+        setNull(data, param->type, param->bytes);
+      } else {
+        memcpy(data, src, bytes);
+      }
+    }
+
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (bind->buffer_type == param->type && param->type == TSDB_DATA_TYPE_BINARY) {
+    char* src = bind->buffer;
+    for (int32_t i = 0; i < bind->num; ++i, data += pBlock->rowSize, src += bind->buffer_length) {
+      if (bind->is_null != NULL && bind->is_null[i]) {
+        setNull(data, param->type, param->bytes);
+        continue;
+      }
+
+      if (bind->length[i] < 0 || bind->length[i] > param->bytes - VARSTR_HEADER_SIZE) {
+        return TSDB_CODE_TSC_INVALID_VALUE;
+      }
+      STR_WITH_SIZE_TO_VARSTR(data, src, bind->length[i]);
+    }
+
+    return TSDB_CODE_SUCCESS;
+  }
+
+  // type conversion, nchar, or the values that need to be checked one by one
+  int32_t bytes = tDataTypes[bind->buffer_type].bytes;
+  if (IS_VAR_DATA_TYPE(bind->buffer_type)) {
+    bytes = (int32_t)bind->buffer_length;
+  }
+
+  char* src = bind->buffer;
+  for (int32_t i = 0; i < bind->num; ++i, data += pBlock->rowSize, src += bytes) {
+    uintptr_t length = (bind->length != NULL) ? (uintptr_t)bind->length[i] : 0;
+    int       isNull = (bind->is_null != NULL) ? bind->is_null[i] : 0;
+
+    TAOS_BIND b = {.buffer_type = bind->buffer_type, .buffer = src, .length = &length, .is_null = &isNull};
+    int       code = doBindParam(data - param->offset, param, &b);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
   return TSDB_CODE_SUCCESS;
 }
 
-static int insertStmtReset(STscStmt* pStmt) {
-  SSqlCmd* pCmd = &pStmt->pSql->cmd;
-  if (pCmd->batchSize > 2) {
-    int32_t alloced = (pCmd->batchSize + 1) / 2;
+static int insertStmtBindParamBatch(STscStmt* stmt, TAOS_MULTI_BIND* bind) {
+  SSqlCmd*          pCmd = &stmt->pSql->cmd;
+  STableDataBlocks* pBlock = NULL;
 
-    size_t size = taosArrayGetSize(pCmd->pDataBlocks);
-    for (int32_t i = 0; i < size; ++i) {
-      STableDataBlocks* pBlock = taosArrayGetP(pCmd->pDataBlocks, i);
+  int32_t code = insertStmtGetDataBlock(stmt, &pBlock);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
 
-      uint32_t totalDataSize = pBlock->size - sizeof(SSubmitBlk);
-      pBlock->size = sizeof(SSubmitBlk) + totalDataSize / alloced;
+  if (pBlock->numOfParams == 0) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  int32_t numOfRows = bind[pBlock->params[0].idx].num;
+  for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
+    TAOS_MULTI_BIND* b = &bind[pBlock->params[j].idx];
+    if (b->num != numOfRows || b->buffer == NULL || !isValidDataType(b->buffer_type)) {
+      tscDebug("param %d: invalid column array, rows:%d, expected rows:%d", pBlock->params[j].idx, b->num, numOfRows);
+      return TSDB_CODE_TSC_INVALID_VALUE;
+    }
 
-      SSubmitBlk* pSubmit = (SSubmitBlk*)pBlock->pData;
-      pSubmit->numOfRows = pSubmit->numOfRows / alloced;
+    if (IS_VAR_DATA_TYPE(b->buffer_type) && b->length == NULL) {
+      tscDebug("param %d: length array is required for binary and nchar", pBlock->params[j].idx);
+      return TSDB_CODE_TSC_INVALID_VALUE;
     }
   }
-  pCmd->batchSize = 0;
 
-  STableMetaInfo* pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, pCmd->clauseIndex, 0);
-  pTableMetaInfo->vgroupIndex = 0;
+  SSubmitBlk* pBlk = (SSubmitBlk*)pBlock->pData;
+  if (numOfRows <= 0 || pBlk->numOfRows + numOfRows >= INT16_MAX) {
+    tscDebug("%p invalid number of rows:%d in batch, bound rows:%d", stmt->pSql, numOfRows, pBlk->numOfRows);
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  code = insertStmtEnsureCapacity(pBlock, pBlk->numOfRows + numOfRows);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  // the rows are added to the batch only if all columns are bound successfully
+  pBlk = (SSubmitBlk*)pBlock->pData;
+  insertStmtSetRowsNull(pBlock, pBlk->numOfRows, numOfRows);
+
+  for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
+    SParamInfo* param = &pBlock->params[j];
+
+    code = doBindBatchParam(pBlock, param, &bind[param->idx], pBlk->numOfRows);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscDebug("param %d: type mismatch or invalid", param->idx);
+      return code;
+    }
+  }
+
+  insertStmtCheckOrder(pBlock, pBlk->numOfRows, numOfRows);
+  pBlk->numOfRows += numOfRows;
+  pCmd->batchSize += numOfRows;
   return TSDB_CODE_SUCCESS;
 }
 
-static int insertStmtExecute(STscStmt* stmt) {
-  SSqlCmd* pCmd = &stmt->pSql->cmd;
-  if (pCmd->batchSize == 0) {
+static int insertStmtAddBatch(STscStmt* stmt) {
+  SSqlCmd*          pCmd = &stmt->pSql->cmd;
+  STableDataBlocks* pBlock = NULL;
+
+  int32_t code = insertStmtGetDataBlock(stmt, &pBlock);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  SSubmitBlk* pBlk = (SSubmitBlk*)pBlock->pData;
+  if (pBlk->numOfRows + 1 >= INT16_MAX) {
     return TSDB_CODE_TSC_INVALID_VALUE;
   }
 
-  assert(pCmd->numOfClause == 1);
-  if (taosHashGetSize(pCmd->pTableBlockHashList) == 0) {
+  insertStmtCheckOrder(pBlock, pBlk->numOfRows, 1);
+  ++pBlk->numOfRows;
+  ++pCmd->batchSize;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * The table is resolved by preparing the same statement against it, and its data block is moved into this
+ * statement. The tables share the parameters, so they must have the same row layout.
+ */
+static int insertStmtSetTbname(STscStmt* stmt, const char* name) {
+  SSqlObj* pSql = stmt->pSql;
+  SSqlCmd* pCmd = &pSql->cmd;
+
+  if (stmt->mtb.pTableUids == NULL) {
+    stmt->mtb.pTableUids = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, false);
+    if (stmt->mtb.pTableUids == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+  }
+
+  size_t   nameLen = strlen(name);
+  int64_t* pUid = taosHashGet(stmt->mtb.pTableUids, name, nameLen);
+  if (pUid != NULL) {
+    stmt->mtb.currentUid = *pUid;
     return TSDB_CODE_SUCCESS;
   }
 
-  STableMetaInfo* pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, 0, 0);
+  STableDataBlocks* pCurrent = NULL;
+  int32_t           code = insertStmtGetDataBlock(stmt, &pCurrent);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
 
-  STableMeta* pTableMeta = pTableMetaInfo->pTableMeta;
-  if (pCmd->pTableBlockHashList == NULL) {
-    pCmd->pTableBlockHashList = taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, false);
+  // replace the table name of "insert into [db.]tb ..." with the given name
+  char*     sql = pSql->sqlstr;
+  int32_t   index = 0;
+  SStrToken sToken = tStrGetToken(sql, &index, false, 0, NULL);
+  if (sToken.type != TK_INSERT && sToken.type != TK_IMPORT) {
+    return TSDB_CODE_TSC_INVALID_SQL;
   }
 
-  STableDataBlocks* pBlock = NULL;
+  sToken = tStrGetToken(sql, &index, false, 0, NULL);
+  if (sToken.type != TK_INTO) {
+    return TSDB_CODE_TSC_INVALID_SQL;
+  }
 
-  int32_t ret =
-      tscGetDataBlockFromList(pCmd->pTableBlockHashList, pTableMeta->id.uid, TSDB_PAYLOAD_SIZE, sizeof(SSubmitBlk),
-                              pTableMeta->tableInfo.rowSize, &pTableMetaInfo->name, pTableMeta, &pBlock, NULL);
-  assert(ret == 0);
-  pBlock->size = sizeof(SSubmitBlk) + pCmd->batchSize * pBlock->rowSize;
-  SSubmitBlk* pBlk = (SSubmitBlk*) pBlock->pData;
-  pBlk->numOfRows = pCmd->batchSize;
-  pBlk->dataLen = 0;
-  pBlk->uid = pTableMeta->id.uid;
-  pBlk->tid = pTableMeta->id.tid;
+  // the token of a qualified name is "db.tb" as a whole
+  sToken = tStrGetToken(sql, &index, false, 0, NULL);
+  if (sToken.n == 0 || (sToken.type != TK_ID && sToken.type != TK_STRING) ||
+      taosHashGetSize(pCmd->pTableBlockHashList) == 0) {
+    return TSDB_CODE_TSC_INVALID_SQL;
+  }
 
-  int code = tscMergeTableDataBlocks(stmt->pSql, false);
+  // a name without the database is in the same database as the prepared table
+  int32_t dbLen = 0;
+  if (strchr(name, TS_PATH_DELIMITER[0]) == NULL) {
+    char* dot = memchr(sToken.z, TS_PATH_DELIMITER[0], sToken.n);
+    if (dot != NULL) {
+      dbLen = (int32_t)(dot - sToken.z) + 1;
+    }
+  }
+
+  int32_t headLen = (int32_t)(sToken.z - sql);
+  char*   tail = sToken.z + sToken.n;
+  size_t  len = headLen + dbLen + nameLen + strlen(tail) + 2;
+  char*   newSql = malloc(len);
+  if (newSql == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+  snprintf(newSql, len, "%.*s%.*s%s %s", headLen, sql, dbLen, sToken.z, name, tail);
+
+  STscStmt* pNew = taos_stmt_init(stmt->taos);
+  if (pNew == NULL) {
+    free(newSql);
+    return terrno;
+  }
+
+  code = taos_stmt_prepare(pNew, newSql, 0);
+  free(newSql);
   if (code != TSDB_CODE_SUCCESS) {
+    tscError("%p failed to prepare statement for table %s, code:%s", pSql, name, tstrerror(code));
+    taos_stmt_close(pNew);
     return code;
   }
 
-  STableDataBlocks* pDataBlock = taosArrayGetP(pCmd->pDataBlocks, 0);
-  code = tscCopyDataBlockToPayload(stmt->pSql, pDataBlock);
+  SHashObj* pNewBlocks = pNew->pSql->cmd.pTableBlockHashList;
+  STableDataBlocks** p = taosHashGet(pNewBlocks, (const char*)&pNew->mtb.currentUid, sizeof(int64_t));
+  assert(p != NULL);
+
+  STableDataBlocks* pBlock = *p;
+  bool sameLayout = (pBlock->rowSize == pCurrent->rowSize && pBlock->numOfParams == pCurrent->numOfParams);
+  for (uint32_t j = 0; sameLayout && j < pBlock->numOfParams; ++j) {
+    SParamInfo* p1 = pBlock->params + j;
+    SParamInfo* p2 = pCurrent->params + j;
+    sameLayout = (p1->idx == p2->idx && p1->type == p2->type && p1->bytes == p2->bytes && p1->offset == p2->offset);
+  }
+
+  if (!sameLayout) {
+    tscError("%p table %s does not have the same schema as the prepared table", pSql, name);
+    taos_stmt_close(pNew);
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  int64_t uid = pNew->mtb.currentUid;
+  if (taosHashGet(pCmd->pTableBlockHashList, (const char*)&uid, sizeof(int64_t)) == NULL) {
+    taosHashRemove(pNewBlocks, (const char*)&uid, sizeof(int64_t));
+    taosHashPut(pCmd->pTableBlockHashList, (const char*)&uid, sizeof(int64_t), &pBlock, POINTER_BYTES);
+  }
+  taos_stmt_close(pNew);
+
+  taosHashPut(stmt->mtb.pTableUids, name, nameLen, &uid, sizeof(int64_t));
+  stmt->mtb.currentUid = uid;
+
+  tscDebug("%p bind parameters to table %s, uid:%" PRId64, pSql, name, uid);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int insertStmtReset(STscStmt* pStmt) {
+  SSqlCmd* pCmd = &pStmt->pSql->cmd;
+
+  STableDataBlocks** p = taosHashIterate(pCmd->pTableBlockHashList, NULL);
+  while (p) {
+    insertStmtResetDataBlock(*p);
+    p = taosHashIterate(pCmd->pTableBlockHashList, p);
+  }
+  pCmd->batchSize = 0;
+
+  STableMetaInfo* pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, pCmd->clauseIndex, 0);
+  pTableMetaInfo->vgroupIndex = 0;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int insertStmtSubmit(STscStmt* stmt) {
+  SSqlCmd* pCmd = &stmt->pSql->cmd;
+
+  // only the tables with bound rows are merged, all data blocks are kept for the next batch
+  SHashObj* pAllBlocks = pCmd->pTableBlockHashList;
+  SHashObj* pBoundBlocks = taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, false);
+  if (pBoundBlocks == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  STableDataBlocks** p = taosHashIterate(pAllBlocks, NULL);
+  while (p) {
+    STableDataBlocks* pBlock = *p;
+    SSubmitBlk*       pBlk = (SSubmitBlk*)pBlock->pData;
+    if (pBlk->numOfRows > 0) {
+      STableMeta* pTableMeta = pBlock->pTableMeta;
+      pBlock->size = sizeof(SSubmitBlk) + pBlk->numOfRows * pBlock->rowSize;
+      pBlk->dataLen = 0;
+      pBlk->uid = pTableMeta->id.uid;
+      pBlk->tid = pTableMeta->id.tid;
+      pBlk->sversion = pTableMeta->sversion;
+      taosHashPut(pBoundBlocks, (const char*)&pTableMeta->id.uid, sizeof(int64_t), p, POINTER_BYTES);
+    }
+    p = taosHashIterate(pAllBlocks, p);
+  }
+
+  pCmd->pTableBlockHashList = pBoundBlocks;
+  int code = tscMergeTableDataBlocks(stmt->pSql, false);
+  pCmd->pTableBlockHashList = pAllBlocks;
+  taosHashCleanup(pBoundBlocks);
+
   if (code != TSDB_CODE_SUCCESS) {
     return code;
   }
@@ -815,13 +1105,29 @@ static int insertStmtExecute(STscStmt* stmt) {
   pRes->numOfRows  = 0;
   pRes->numOfTotal = 0;
 
-  tscProcessSql(pSql);
+  if (taosArrayGetSize(pCmd->pDataBlocks) == 1) {
+    STableDataBlocks* pDataBlock = taosArrayGetP(pCmd->pDataBlocks, 0);
+    code = tscCopyDataBlockToPayload(pSql, pDataBlock);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
 
-  // wait for the callback function to post the semaphore
-  tsem_wait(&pSql->rspSem);
+    tscProcessSql(pSql);
+
+    // wait for the callback function to post the semaphore
+    tsem_wait(&pSql->rspSem);
+  } else {
+    code = tscHandleMultivnodeInsert(pSql);
+    if (code == TSDB_CODE_SUCCESS) {
+      tsem_wait(&pSql->rspSem);
+    } else {
+      pRes->code = code;
+    }
+
+    tscFreeSubobj(pSql);
+    tfree(pSql->pSubs);
+  }
 
-  // data block reset
-  pCmd->batchSize = 0;
   for(int32_t i = 0; i < pCmd->numOfTables; ++i) {
     if (pCmd->pTableNameList && pCmd->pTableNameList[i]) {
       tfree(pCmd->pTableNameList[i]);
@@ -832,7 +1138,46 @@ static int insertStmtExecute(STscStmt* stmt) {
   tfree(pCmd->pTableNameList);
   pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
 
-  return pSql->res.code;
+  return pRes->code;
+}
+
+static int insertStmtExecute(STscStmt* stmt) {
+  SSqlCmd* pCmd = &stmt->pSql->cmd;
+  if (pCmd->batchSize == 0) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  assert(pCmd->numOfClause == 1);
+  if (taosHashGetSize(pCmd->pTableBlockHashList) == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int code = insertStmtSubmit(stmt);
+
+  // the bound rows can not be parsed again from the sql string, they are submitted again along with the table
+  // schema when the vnode does not have the latest schema of a table yet
+  if (code == TSDB_CODE_TDB_TABLE_RECONFIGURE && pCmd->submitSchema) {
+    tscDebug("%p submit the bound rows again with the table schema", stmt->pSql);
+
+    STableDataBlocks** p = taosHashIterate(pCmd->pTableBlockHashList, NULL);
+    while (p) {
+      SSubmitBlk* pBlk = (SSubmitBlk*)(*p)->pData;
+      pBlk->numOfRows = htons(pBlk->numOfRows);  // restore the byte order changed by merging the blocks
+      p = taosHashIterate(pCmd->pTableBlockHashList, p);
+    }
+
+    code = insertStmtSubmit(stmt);
+  }
+
+  // data block reset
+  pCmd->batchSize = 0;
+  STableDataBlocks** p = taosHashIterate(pCmd->pTableBlockHashList, NULL);
+  while (p) {
+    insertStmtResetDataBlock(*p);
+    p = taosHashIterate(pCmd->pTableBlockHashList, p);
+  }
+
+  return code;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -921,10 +1266,27 @@ int taos_stmt_prepare(TAOS_STMT* stmt, const char* sql, unsigned long length) {
     if (code == TSDB_CODE_TSC_ACTION_IN_PROGRESS) {
       // wait for the callback function to post the semaphore
       tsem_wait(&pSql->rspSem);
-      return pSql->res.code;
+      code = pSql->res.code;
     }
 
-    return code;
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+
+    // the data blocks are filled by the bound parameters from now on
+    pCmd->dataSourceType = DATA_FROM_BOUND_PARAM;
+
+    // parameters are bound to the first table of the statement until taos_stmt_set_tbname is called
+    STableMetaInfo* pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, 0, 0);
+    pStmt->mtb.currentUid = pTableMetaInfo->pTableMeta->id.uid;
+
+    STableDataBlocks** p = taosHashIterate(pCmd->pTableBlockHashList, NULL);
+    while (p) {
+      insertStmtResetDataBlock(*p);
+      p = taosHashIterate(pCmd->pTableBlockHashList, p);
+    }
+
+    return TSDB_CODE_SUCCESS;
   }
 
   pStmt->isInsert = false;
@@ -945,6 +1307,7 @@ int taos_stmt_close(TAOS_STMT* stmt) {
     free(normal->sql);
   }
 
+  taosHashCleanup(pStmt->mtb.pTableUids);
   taos_free_result(pStmt->pSql);
   free(pStmt);
   return TSDB_CODE_SUCCESS;
@@ -959,6 +1322,36 @@ int taos_stmt_bind_param(TAOS_STMT* stmt, TAOS_BIND* bind) {
   }
 }
 
+int taos_stmt_set_tbname(TAOS_STMT* stmt, const char* name) {
+  STscStmt* pStmt = (STscStmt*)stmt;
+  if (stmt == NULL || pStmt->taos == NULL || pStmt->pSql == NULL) {
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    return TSDB_CODE_TSC_DISCONNECTED;
+  }
+
+  if (name == NULL || name[0] == 0) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  if (pStmt->isInsert) {
+    return insertStmtSetTbname(pStmt, name);
+  }
+  return TSDB_CODE_COM_OPS_NOT_SUPPORT;
+}
+
+int taos_stmt_bind_param_batch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind) {
+  STscStmt* pStmt = (STscStmt*)stmt;
+  if (stmt == NULL || pStmt->taos == NULL || pStmt->pSql == NULL) {
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    return TSDB_CODE_TSC_DISCONNECTED;
+  }
+
+  if (pStmt->isInsert) {
+    return insertStmtBindParamBatch(pStmt, bind);
+  }
+  return TSDB_CODE_COM_OPS_NOT_SUPPORT;
+}
+
 int taos_stmt_add_batch(TAOS_STMT* stmt) {
   STscStmt* pStmt = (STscStmt*)stmt;
   if (pStmt->isInsert) {
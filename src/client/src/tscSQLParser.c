@@ -21,6 +21,7 @@
 #endif // __APPLE__
 
 #include "os.h"
+#include "qHyperLogLog.h"
 #include "ttype.h"
 #include "texpr.h"
 #include "taos.h"
@@ -1488,23 +1489,22 @@ static void addProjectQueryCol(SQueryInfo* pQueryInfo, int32_t startPos, SColumn
   insertResultField(pQueryInfo, startPos, &ids, pExpr->resBytes, (int8_t)pExpr->resType, pExpr->aliasName, pExpr);
 }
 
-static void addPrimaryTsColIntoResult(SQueryInfo* pQueryInfo) {
-  // primary timestamp column has been added already
+static void addPrjColIntoResult(SQueryInfo* pQueryInfo, int16_t columnIndex) {
+  // set the constant column value always attached to first table.
+  STableMetaInfo* pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
+  SSchema* pSchema = tscGetTableColumnSchema(pTableMetaInfo->pTableMeta, columnIndex);
+
+  // the column has been added already
   size_t size = tscSqlExprNumOfExprs(pQueryInfo);
   for (int32_t i = 0; i < size; ++i) {
     SSqlExpr* pExpr = tscSqlExprGet(pQueryInfo, i);
-    if (pExpr->functionId == TSDB_FUNC_PRJ && pExpr->colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+    if (pExpr->functionId == TSDB_FUNC_PRJ && pExpr->colInfo.colId == pSchema->colId) {
       return;
     }
   }
 
-
-  // set the constant column value always attached to first table.
-  STableMetaInfo* pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
-  SSchema* pSchema = tscGetTableColumnSchema(pTableMetaInfo->pTableMeta, PRIMARYKEY_TIMESTAMP_COL_INDEX);
-
-  // add the timestamp column into the output columns
-  SColumnIndex index = {0};  // primary timestamp column info
+  // add the column into the output columns as an invisible one
+  SColumnIndex index = {0, columnIndex};
   int32_t numOfCols = (int32_t)tscSqlExprNumOfExprs(pQueryInfo);
   tscAddSpecialColumnForSelect(pQueryInfo, numOfCols, TSDB_FUNC_PRJ, &index, pSchema, TSDB_COL_NORMAL);
 
@@ -1514,6 +1514,10 @@ static void addPrimaryTsColIntoResult(SQueryInfo* pQueryInfo) {
   pQueryInfo->type |= TSDB_QUERY_TYPE_PROJECTION_QUERY;
 }
 
+static void addPrimaryTsColIntoResult(SQueryInfo* pQueryInfo) {
+  addPrjColIntoResult(pQueryInfo, PRIMARYKEY_TIMESTAMP_COL_INDEX);
+}
+
 bool isValidDistinctSql(SQueryInfo* pQueryInfo) {
   if (pQueryInfo == NULL) {
     return false;
@@ -1560,7 +1564,8 @@ int32_t parseSelectClause(SSqlCmd* pCmd, int32_t clauseIndex, tSQLExprList* pSel
       if (addProjectionExprAndResultField(pCmd, pQueryInfo, pItem) != TSDB_CODE_SUCCESS) {
         return TSDB_CODE_TSC_INVALID_SQL;
       }
-    } else if (pItem->pNode->nSQLOptr >= TK_COUNT && pItem->pNode->nSQLOptr <= TK_TBID) {
+    } else if ((pItem->pNode->nSQLOptr >= TK_COUNT && pItem->pNode->nSQLOptr <= TK_TBID) ||
+               pItem->pNode->nSQLOptr == TK_HYPERLOGLOG) {
       // sql function in selection clause, append sql function info in pSqlCmd structure sequentially
       if (addExprAndResultField(pCmd, pQueryInfo, outputIndex, pItem, true) != TSDB_CODE_SUCCESS) {
         return TSDB_CODE_TSC_INVALID_SQL;
@@ -1874,6 +1879,8 @@ int32_t addExprAndResultField(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, int32_t col
   const char* msg7 = "normal table can not apply this function";
   const char* msg8 = "multi-columns selection does not support alias column name";
   const char* msg9 = "invalid function";
+  const char* msg10 = "precision is out of range [4, 14]";
+  const char* msg11 = "invalid algorithm, only 'default' and 't-digest' are supported";
 
   switch (optr) {
     case TK_COUNT: {
@@ -2218,8 +2225,9 @@ int32_t addExprAndResultField(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, int32_t col
     case TK_BOTTOM:
     case TK_PERCENTILE:
     case TK_APERCENTILE: {
-      // 1. valid the number of parameters
-      if (pItem->pNode->pParam == NULL || pItem->pNode->pParam->nExpr != 2) {
+      // 1. valid the number of parameters, apercentile accepts an optional algorithm name as the third one
+      if (pItem->pNode->pParam == NULL ||
+          (pItem->pNode->pParam->nExpr != 2 && (optr != TK_APERCENTILE || pItem->pNode->pParam->nExpr != 3))) {
         /* no parameters or more than one parameter for function */
         return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg2);
       }
@@ -2288,8 +2296,26 @@ int32_t addExprAndResultField(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, int32_t col
         tscInsertPrimaryTSSourceColumn(pQueryInfo, &index);
         colIndex += 1;  // the first column is ts
 
+        int64_t algo = TSDB_APERCT_ALGO_DEFAULT;
+        if (pItem->pNode->pParam->nExpr == 3) {
+          tVariant* pAlgo = &pParamElem[2].pNode->val;
+          if (pParamElem[2].pNode->nSQLOptr != TK_STRING || pAlgo->nType != TSDB_DATA_TYPE_BINARY) {
+            return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg2);
+          }
+
+          if (pAlgo->nLen == strlen("t-digest") && strncasecmp(pAlgo->pz, "t-digest", pAlgo->nLen) == 0) {
+            algo = TSDB_APERCT_ALGO_TDIGEST;
+          } else if (pAlgo->nLen != strlen("default") || strncasecmp(pAlgo->pz, "default", pAlgo->nLen) != 0) {
+            return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg11);
+          }
+        }
+
         pExpr = tscSqlExprAppend(pQueryInfo, functionId, &index, resultType, resultSize, getNewResColId(pQueryInfo), resultSize, false);
         addExprParams(pExpr, val, TSDB_DATA_TYPE_DOUBLE, sizeof(double));
+
+        if (algo != TSDB_APERCT_ALGO_DEFAULT) {
+          addExprParams(pExpr, (char*)&algo, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t));
+        }
       } else {
         tVariantDump(pVariant, val, TSDB_DATA_TYPE_BIGINT, true);
 
@@ -2335,7 +2361,84 @@ int32_t addExprAndResultField(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, int32_t col
 
       return TSDB_CODE_SUCCESS;
     };
-    
+
+    case TK_HYPERLOGLOG: {
+      // 1. valid the number of parameters, the second optional parameter is the precision of the sketch
+      if (pItem->pNode->pParam == NULL || pItem->pNode->pParam->nExpr < 1 || pItem->pNode->pParam->nExpr > 2) {
+        return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg2);
+      }
+
+      tSqlExprItem* pParamElem = &(pItem->pNode->pParam->a[0]);
+      if (pParamElem->pNode->nSQLOptr != TK_ID) {
+        return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg2);
+      }
+
+      SColumnIndex index = COLUMN_INDEX_INITIALIZER;
+      if (getColumnIndexByName(pCmd, &pParamElem->pNode->colInfo, pQueryInfo, &index) != TSDB_CODE_SUCCESS) {
+        return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg3);
+      }
+
+      if (index.columnIndex == TSDB_TBNAME_COLUMN_INDEX) {
+        return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg6);
+      }
+
+      pTableMetaInfo = tscGetMetaInfo(pQueryInfo, index.tableIndex);
+      SSchema* pSchema = tscGetTableSchema(pTableMetaInfo->pTableMeta);
+
+      // functions can not be applied to tags
+      if (index.columnIndex >= tscGetNumOfColumns(pTableMetaInfo->pTableMeta)) {
+        return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg6);
+      }
+
+      // 2. valid the precision
+      int64_t precision = HLL_DEFAULT_PRECISION;
+      if (pItem->pNode->pParam->nExpr == 2) {
+        tVariant* pVariant = &pParamElem[1].pNode->val;
+        if (pParamElem[1].pNode->nSQLOptr != TK_INTEGER || tVariantDump(pVariant, (char*)&precision,
+                                                                        TSDB_DATA_TYPE_BIGINT, true) < 0) {
+          return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg2);
+        }
+
+        if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION) {
+          return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg10);
+        }
+      }
+
+      int16_t functionId = 0;
+      if (convertFunctionId(optr, &functionId) != TSDB_CODE_SUCCESS) {
+        return TSDB_CODE_TSC_INVALID_SQL;
+      }
+
+      int16_t resultType = 0;
+      int16_t resultSize = 0;
+      int32_t intermediateResSize = 0;
+      if (getResultDataInfo(pSchema[index.columnIndex].type, pSchema[index.columnIndex].bytes, functionId,
+                            (int32_t)precision, &resultType, &resultSize, &intermediateResSize, 0,
+                            false) != TSDB_CODE_SUCCESS) {
+        return TSDB_CODE_TSC_INVALID_SQL;
+      }
+
+      SSqlExpr* pExpr = tscSqlExprAppend(pQueryInfo, functionId, &index, resultType, resultSize,
+                                         getNewResColId(pQueryInfo), intermediateResSize, false);
+      addExprParams(pExpr, (char*)&precision, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t));
+
+      memset(pExpr->aliasName, 0, tListLen(pExpr->aliasName));
+      getColumnName(pItem, pExpr->aliasName, sizeof(pExpr->aliasName) - 1);
+
+      SColumnList ids = getColumnList(1, 0, index.columnIndex);
+      if (finalResult) {
+        int32_t numOfOutput = tscNumOfFields(pQueryInfo);
+        insertResultField(pQueryInfo, numOfOutput, &ids, resultSize, resultType, pExpr->aliasName, pExpr);
+      } else {
+        for (int32_t i = 0; i < ids.num; ++i) {
+          tscColumnListInsert(pQueryInfo->colList, &(ids.ids[i]));
+        }
+      }
+
+      tscInsertPrimaryTSSourceColumn(pQueryInfo, &index);
+      return TSDB_CODE_SUCCESS;
+    }
+
     case TK_TBID: {
       pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
       if (UTIL_TABLE_IS_NORMAL_TABLE(pTableMetaInfo)) {
@@ -2638,6 +2741,9 @@ int32_t convertFunctionId(int32_t optr, int16_t* functionId) {
     case TK_TWA:
       *functionId = TSDB_FUNC_TWA;
       break;
+    case TK_HYPERLOGLOG:
+      *functionId = TSDB_FUNC_HLL;
+      break;
     case TK_INTERP:
       *functionId = TSDB_FUNC_INTERP;
       break;
@@ -2801,7 +2907,7 @@ int32_t tscTansformSQLFuncForSTableQuery(SQueryInfo* pQueryInfo) {
     
     if ((functionId >= TSDB_FUNC_SUM && functionId <= TSDB_FUNC_TWA) ||
         (functionId >= TSDB_FUNC_FIRST_DST && functionId <= TSDB_FUNC_LAST_DST) ||
-        (functionId >= TSDB_FUNC_RATE && functionId <= TSDB_FUNC_AVG_IRATE)) {
+        (functionId >= TSDB_FUNC_RATE && functionId <= TSDB_FUNC_AVG_IRATE) || functionId == TSDB_FUNC_HLL) {
       if (getResultDataInfo(pSrcSchema->type, pSrcSchema->bytes, functionId, (int32_t)pExpr->param[0].i64, &type, &bytes,
                             &interBytes, 0, true) != TSDB_CODE_SUCCESS) {
         return TSDB_CODE_TSC_INVALID_SQL;
@@ -4759,11 +4865,30 @@ static void setDefaultOrderInfo(SQueryInfo* pQueryInfo) {
   }
 }
 
+/*
+ * The order column and the primary timestamp are both kept in the output of a super table projection query, so that
+ * the vnode can keep the top rows of each vgroup and the client can merge them by (column, ts).
+ */
+static void setOrderByNormalColumn(SQueryInfo* pQueryInfo, int16_t columnIndex, int32_t order) {
+  STableMetaInfo* pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
+  SSchema* pSchema = tscGetTableColumnSchema(pTableMetaInfo->pTableMeta, columnIndex);
+
+  pQueryInfo->order.order = order;
+  pQueryInfo->order.orderColId = pSchema->colId;
+
+  // the merge of results from vnodes compares the non-timestamp order columns in this direction
+  pQueryInfo->groupbyExpr.orderType = order;
+
+  addPrjColIntoResult(pQueryInfo, columnIndex);
+  addPrimaryTsColIntoResult(pQueryInfo);
+}
+
 int32_t parseOrderbyClause(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SQuerySQL* pQuerySql, SSchema* pSchema) {
   const char* msg0 = "only support order by primary timestamp";
   const char* msg1 = "invalid column name";
   const char* msg2 = "only support order by primary timestamp or first tag in groupby clause allowed";
   const char* msg3 = "invalid column in order by clause, only primary timestamp or first tag in groupby clause allowed";
+  const char* msg4 = "primary timestamp must be sorted in the same direction as the order by column";
 
   setDefaultOrderInfo(pQueryInfo);
   STableMetaInfo* pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
@@ -4815,6 +4940,7 @@ int32_t parseOrderbyClause(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SQuerySQL* pQu
 
     bool orderByTags = false;
     bool orderByTS = false;
+    bool orderByCol = false;
 
     if (index.columnIndex >= tscGetNumOfColumns(pTableMetaInfo->pTableMeta)) {
       int32_t relTagIndex = index.columnIndex - tscGetNumOfColumns(pTableMetaInfo->pTableMeta);
@@ -4833,9 +4959,14 @@ int32_t parseOrderbyClause(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SQuerySQL* pQu
 
     if (PRIMARYKEY_TIMESTAMP_COL_INDEX == index.columnIndex) {
       orderByTS = true;
+    } else if (index.columnIndex > PRIMARYKEY_TIMESTAMP_COL_INDEX &&
+               index.columnIndex < tscGetNumOfColumns(pTableMetaInfo->pTableMeta) &&
+               tscIsProjectionQueryOnSTable(pQueryInfo, 0)) {
+      // projection query on super table ordered by a normal column, e.g. select * from st order by c1 desc limit 10
+      orderByCol = true;
     }
 
-    if (!(orderByTags || orderByTS) && !isTopBottomQuery(pQueryInfo)) {
+    if (!(orderByTags || orderByTS || orderByCol) && !isTopBottomQuery(pQueryInfo)) {
       return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg3);
     } else {  // order by top/bottom result value column is not supported in case of interval query.
       assert(!(orderByTags && orderByTS));
@@ -4862,6 +4993,9 @@ int32_t parseOrderbyClause(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SQuerySQL* pQu
         pQueryInfo->order.order = p1->sortOrder;
         pQueryInfo->order.orderColId = pSchema[index.columnIndex].colId;
         return TSDB_CODE_SUCCESS;
+      } else if (orderByCol) {
+        tVariantListItem* p1 = taosArrayGet(pQuerySql->pSortOrder, 0);
+        setOrderByNormalColumn(pQueryInfo, index.columnIndex, p1->sortOrder);
       } else {
         tVariantListItem* p1 = taosArrayGet(pQuerySql->pSortOrder, 0);
 
@@ -4880,6 +5014,8 @@ int32_t parseOrderbyClause(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SQuerySQL* pQu
       if (orderByTags) {
         pQueryInfo->groupbyExpr.orderIndex = index.columnIndex - tscGetNumOfColumns(pTableMetaInfo->pTableMeta);
         pQueryInfo->groupbyExpr.orderType = pItem->sortOrder;
+      } else if (orderByCol) {
+        setOrderByNormalColumn(pQueryInfo, index.columnIndex, pItem->sortOrder);
       } else {
         pQueryInfo->order.order = pItem->sortOrder;
         pQueryInfo->order.orderColId = PRIMARYKEY_TIMESTAMP_COL_INDEX;
@@ -4894,6 +5030,12 @@ int32_t parseOrderbyClause(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SQuerySQL* pQu
 
       if (index.columnIndex != PRIMARYKEY_TIMESTAMP_COL_INDEX) {
         return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg2);
+      } else if (orderByCol) {
+        // the timestamp only breaks the ties of the order column, both of them share one direction
+        tVariantListItem* p1 = taosArrayGet(pSortorder, 1);
+        if (p1->sortOrder != pQueryInfo->order.order) {
+          return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg4);
+        }
       } else {
         tVariantListItem* p1 = taosArrayGet(pSortorder, 1);
         pQueryInfo->order.order = p1->sortOrder;
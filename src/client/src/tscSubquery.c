@@ -2378,6 +2378,12 @@ static bool needRetryInsert(SSqlObj* pParentObj, int32_t numOfSub) {
     return false;
   }
 
+  // the submit blocks are rebuilt by parsing the sql string, which does not carry the bound parameters
+  if (pParentObj->cmd.dataSourceType == DATA_FROM_BOUND_PARAM) {
+    tscError("%p the bound parameters can not be submitted again, abort the retry effort", pParentObj);
+    return false;
+  }
+
   for (int32_t i = 0; i < numOfSub; ++i) {
     int32_t code = pParentObj->pSubs[i]->res.code;
     if (code == TSDB_CODE_SUCCESS) {
@@ -0,0 +1,192 @@
+#include "os.h"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+
+#include "taos.h"
+#include "tsclient.h"
+#include "tscUtil.h"
+#include "tstoken.h"
+#include "ttokendef.h"
+
+extern "C" {
+int tsParseValues(char **str, STableDataBlocks *pDataBlock, STableMeta *pTableMeta, int maxRows,
+                  SParsedDataColInfo *spd, SSqlCmd *pCmd, int32_t *code, char *tmpTokenBuf);
+int tsParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[], SParsedDataColInfo *spd,
+                      SSqlCmd *pCmd, int16_t timePrec, int32_t *code, char *tmpTokenBuf);
+}
+
+namespace {
+// ts timestamp, c1 int, c2 bigint, c3 float, c4 double, c5 binary(16), c6 smallint, c7 bool, c8 nchar(8), c9 tinyint
+const SSchema schema[] = {
+    {TSDB_DATA_TYPE_TIMESTAMP, "ts", 1, 8}, {TSDB_DATA_TYPE_INT, "c1", 2, 4},
+    {TSDB_DATA_TYPE_BIGINT, "c2", 3, 8},    {TSDB_DATA_TYPE_FLOAT, "c3", 4, 4},
+    {TSDB_DATA_TYPE_DOUBLE, "c4", 5, 8},    {TSDB_DATA_TYPE_BINARY, "c5", 6, 16 + VARSTR_HEADER_SIZE},
+    {TSDB_DATA_TYPE_SMALLINT, "c6", 7, 2},  {TSDB_DATA_TYPE_BOOL, "c7", 8, 1},
+    {TSDB_DATA_TYPE_NCHAR, "c8", 9, 8 * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE},
+    {TSDB_DATA_TYPE_TINYINT, "c9", 10, 1},
+};
+
+const int32_t numOfCols = sizeof(schema) / sizeof(schema[0]);
+
+struct SParseCtx {
+  STableMeta*        pMeta;
+  STableDataBlocks   block;
+  SParsedDataColInfo spd;
+  SSqlCmd            cmd;
+  char               msg[1024];
+  char               tokenBuf[1024];
+
+  explicit SParseCtx(int32_t maxRows) {
+    pMeta = (STableMeta*)calloc(1, sizeof(STableMeta) + sizeof(schema));
+    memcpy(pMeta->schema, schema, sizeof(schema));
+    pMeta->tableInfo.numOfColumns = numOfCols;
+    pMeta->tableInfo.precision = TSDB_TIME_PRECISION_MILLI;
+    for (int32_t i = 0; i < numOfCols; ++i) {
+      pMeta->tableInfo.rowSize += schema[i].bytes;
+    }
+
+    memset(&block, 0, sizeof(block));
+    block.tsSource = -1;
+    block.ordered = true;
+    block.prevTS = INT64_MIN;
+    block.nAllocSize = (uint32_t)(pMeta->tableInfo.rowSize * (maxRows + 1));
+    block.pData = (char*)calloc(1, block.nAllocSize);
+
+    memset(&spd, 0, sizeof(spd));
+    spd.numOfCols = numOfCols;
+    spd.numOfAssignedCols = numOfCols;
+    for (int32_t i = 0; i < numOfCols; ++i) {
+      spd.hasVal[i] = true;
+      spd.elems[i].colIndex = i;
+      spd.elems[i].offset = (i == 0) ? 0 : spd.elems[i - 1].offset + schema[i - 1].bytes;
+    }
+
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.payload = msg;
+  }
+
+  ~SParseCtx() {
+    free(block.pData);
+    free(pMeta);
+  }
+
+  // the parse loop of tsParseValues before the fast path was added
+  int32_t parseByGeneralPath(char* str) {
+    int32_t code = 0;
+    int32_t numOfRows = 0;
+
+    while (1) {
+      int32_t   index = 0;
+      SStrToken sToken = tStrGetToken(str, &index, false, 0, NULL);
+      if (sToken.n == 0 || sToken.type != TK_LP) break;
+      str += index;
+
+      int32_t len = tsParseOneRowData(&str, &block, pMeta->schema, &spd, &cmd, TSDB_TIME_PRECISION_MILLI, &code,
+                                      tokenBuf);
+      if (len <= 0) {
+        return -1;
+      }
+
+      block.size += len;
+
+      index = 0;
+      sToken = tStrGetToken(str, &index, false, 0, NULL);
+      str += index;
+      if (sToken.n == 0 || sToken.type != TK_RP) {
+        return -1;
+      }
+
+      numOfRows++;
+    }
+
+    return numOfRows;
+  }
+
+  int32_t parseByValues(char* str, int32_t maxRows) {
+    int32_t code = 0;
+    return tsParseValues(&str, &block, pMeta, maxRows, &spd, &cmd, &code, tokenBuf);
+  }
+};
+
+std::string buildRows(int32_t numOfRows) {
+  std::string sql;
+  char        row[512];
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    snprintf(row, sizeof(row), "(%" PRId64 ", %d, %" PRId64 ", %d.%02d, %.6f, 'bin_%d', %d, %s, 'nc%d', %d) ",
+             (int64_t)1577808000000 + i, i * 7 - 100000, (int64_t)i * 1000003, i % 1000, i % 100, i * 0.001234,
+             i % 1000, i % 30000, (i % 2) ? "true" : "false", i % 100, i % 127);
+    sql += row;
+  }
+
+  return sql;
+}
+
+void expectSameResult(const char* sql, int32_t expectRows) {
+  SParseCtx general(64);
+  SParseCtx fast(64);
+
+  std::string s1(sql);
+  std::string s2(sql);
+  int32_t     n1 = general.parseByGeneralPath(&s1[0]);
+  int32_t     n2 = fast.parseByValues(&s2[0], 64);
+
+  ASSERT_EQ(n1, expectRows);
+  ASSERT_EQ(n2, expectRows);
+  ASSERT_EQ(general.block.size, fast.block.size);
+  EXPECT_EQ(memcmp(general.block.pData, fast.block.pData, general.block.size), 0);
+  EXPECT_EQ(general.block.ordered, fast.block.ordered);
+}
+}  // namespace
+
+TEST(testCase, insert_parse_fast_path) {
+  // plain literals
+  expectSameResult("(1577808000000, 1, 2, 3.5, 4.25, 'abc', 6, true, 'xy', 9)", 1);
+  expectSameResult("( 1577808000001 ,-1,-9223372036854775807, -0.0001, 1e300, \"\", -32767, false, '', -127 )", 1);
+
+  // timestamp strings, with and without the fraction
+  expectSameResult("('2020-01-01 00:00:00', 1, 2, 3, 4, 'a', 6, 1, 'b', 9) "
+                   "('2020-01-01 00:00:59.5', 1, 2, 3, 4, 'a', 6, 0, 'b', 9) "
+                   "('2020-01-01 00:01:00.123456', 1, 2, 3, 4, 'a', 6, 0, 'b', 9) "
+                   "('2020-1-2 3:4:5.06', 1, 2, 3, 4, 'a', 6, 0, 'b', 9)", 4);
+
+  // nulls, escaped strings and the literals that fall back to the general path
+  expectSameResult("(1577808000000, null, null, null, null, null, null, null, null, null) "
+                   "(1577808000001, 0x10, 1.5e3, 123456789012345678901.5, 0.1234567890123456789, 'it''s', 1, "
+                   "'true', 'a\\'b', 'null') "
+                   "(1577808000000, 1, 2, 3, 4, 'a', 6, 1, 'b', 9)", 3);
+
+  // invalid rows are rejected by both paths
+  SParseCtx   ctx(64);
+  std::string overflow("(1577808000000, 1, 2, 3, 4, 'a', 6, 1, 'b', 200)");
+  EXPECT_EQ(ctx.parseByValues(&overflow[0], 64), -1);
+
+  std::string tooLong("(1577808000000, 1, 2, 3, 4, 'abcdefghijklmnopq', 6, 1, 'b', 9)");
+  EXPECT_EQ(ctx.parseByValues(&tooLong[0], 64), -1);
+}
+
+TEST(testCase, insert_parse_benchmark) {
+  const int32_t numOfRows = 100000;
+  std::string   sql = buildRows(numOfRows);
+
+  SParseCtx   general(numOfRows);
+  SParseCtx   fast(numOfRows);
+  std::string s1(sql);
+  std::string s2(sql);
+
+  int64_t st = taosGetTimestampUs();
+  ASSERT_EQ(general.parseByGeneralPath(&s1[0]), numOfRows);
+  int64_t generalUs = taosGetTimestampUs() - st;
+
+  st = taosGetTimestampUs();
+  ASSERT_EQ(fast.parseByValues(&s2[0], numOfRows + 1), numOfRows);
+  int64_t fastUs = taosGetTimestampUs() - st;
+
+  ASSERT_EQ(general.block.size, fast.block.size);
+  EXPECT_EQ(memcmp(general.block.pData, fast.block.pData, general.block.size), 0);
+
+  std::cout << numOfRows << " rows, " << sql.length() << " bytes, general path: " << generalUs
+            << " us, fast path: " << fastUs << " us, "
+            << (double)sql.length() / (fastUs > 0 ? fastUs : 1) << " MB/s" << std::endl;
+}
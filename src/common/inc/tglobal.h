@@ -47,7 +47,9 @@ extern int32_t  tsShellActivityTimer;
 extern uint32_t tsMaxTmrCtrl;
 extern float    tsNumOfThreadsPerCore;
 extern int32_t  tsNumOfCommitThreads;
+extern int32_t  tsNumOfCommitWorkers;
 extern float    tsRatioOfQueryCores;
+extern int32_t  tsNumOfScanWorkers;
 extern int8_t   tsDaylight;
 extern char     tsTimezone[];
 extern char     tsLocale[];
@@ -96,6 +98,20 @@ extern int32_t tsReplications;
 extern int32_t tsQuorum;
 extern int8_t  tsUpdate;
 extern int8_t  tsCacheLastRow;
+extern int8_t  tsColumnarCache;
+extern int32_t tsReadCacheSize;
+extern int32_t tsTagIndexColumns;
+
+// compaction
+extern int8_t  tsEnableCompact;
+extern float   tsCompactSubBlockRatio;
+extern float   tsCompactTombRatio;
+extern int32_t tsCompactMBPerSec;
+extern int32_t tsColdCompDays;
+extern int32_t tsColdCompLevel;
+
+// rollup
+extern int32_t tsRollupInterval;
 
 // balance
 extern int8_t  tsEnableBalance;
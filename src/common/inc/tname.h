@@ -28,7 +28,7 @@ typedef struct SDataStatis {
   int64_t min;
   int16_t maxIndex;
   int16_t minIndex;
-  int16_t numOfNull;
+  int32_t numOfNull;
 } SDataStatis;
 
 typedef struct SColumnInfoData {
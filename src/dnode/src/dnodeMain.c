@@ -20,6 +20,7 @@
 #include "ttimer.h"
 #include "tconfig.h"
 #include "tfile.h"
+#include "tscompression.h"
 #include "twal.h"
 // #include "tfs.h"
 #include "tsync.h"
@@ -116,6 +117,7 @@ int32_t dnodeInitSystem() {
   taosIgnSIGPIPE();
   taosBlockSIGPIPE();
   taosResolveCRC();
+  taosResolveCompression();
   taosInitGlobalCfg();
   taosReadGlobalLogCfg();
   taosSetCoreDump();
@@ -99,12 +99,23 @@ typedef struct TAOS_BIND {
   unsigned int     allocated;
 } TAOS_BIND;
 
+typedef struct TAOS_MULTI_BIND {
+  int            buffer_type;
+  void *         buffer;         // column array of num values
+  uintptr_t      buffer_length;  // bytes of each value in buffer, only required for binary and nchar
+  int32_t *      length;         // actual bytes of each binary or nchar value
+  char *         is_null;        // null flag of each value, NULL if none is null
+  int            num;            // number of rows
+} TAOS_MULTI_BIND;
+
 TAOS_STMT *taos_stmt_init(TAOS *taos);
 int        taos_stmt_prepare(TAOS_STMT *stmt, const char *sql, unsigned long length);
 int        taos_stmt_is_insert(TAOS_STMT *stmt, int *insert);
 int        taos_stmt_num_params(TAOS_STMT *stmt, int *nums);
 int        taos_stmt_get_param(TAOS_STMT *stmt, int idx, int *type, int *bytes);
 int        taos_stmt_bind_param(TAOS_STMT *stmt, TAOS_BIND *bind);
+int        taos_stmt_set_tbname(TAOS_STMT *stmt, const char *name);
+int        taos_stmt_bind_param_batch(TAOS_STMT *stmt, TAOS_MULTI_BIND *bind);
 int        taos_stmt_add_batch(TAOS_STMT *stmt);
 int        taos_stmt_execute(TAOS_STMT *stmt);
 TAOS_RES * taos_stmt_use_result(TAOS_STMT *stmt);
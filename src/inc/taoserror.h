@@ -242,6 +242,7 @@ TAOS_DEFINE_ERROR(TSDB_CODE_TDB_NO_TABLE_DATA_IN_MEM,     0, 0x060F, "No table d
 TAOS_DEFINE_ERROR(TSDB_CODE_TDB_FILE_ALREADY_EXISTS,      0, 0x0610, "File already exists")
 TAOS_DEFINE_ERROR(TSDB_CODE_TDB_TABLE_RECONFIGURE,        0, 0x0611, "Need to reconfigure table")
 TAOS_DEFINE_ERROR(TSDB_CODE_TDB_IVD_CREATE_TABLE_INFO,    0, 0x0612, "Invalid information to create table")
+TAOS_DEFINE_ERROR(TSDB_CODE_TDB_COMPACT_CANCELLED,        0, 0x0613, "Compaction is cancelled")
 
 // query
 TAOS_DEFINE_ERROR(TSDB_CODE_QRY_INVALID_QHANDLE,          0, 0x0700, "Invalid handle")
@@ -290,6 +291,7 @@ TAOS_DEFINE_ERROR(TSDB_CODE_SYN_INVALID_MSGTYPE,          0, 0x090A, "Invalid ms
 TAOS_DEFINE_ERROR(TSDB_CODE_WAL_APP_ERROR,                0, 0x1000, "Unexpected generic error in wal")
 TAOS_DEFINE_ERROR(TSDB_CODE_WAL_FILE_CORRUPTED,           0, 0x1001, "WAL file is corrupted")
 TAOS_DEFINE_ERROR(TSDB_CODE_WAL_SIZE_LIMIT,               0, 0x1002, "WAL size exceeds limit")
+TAOS_DEFINE_ERROR(TSDB_CODE_WAL_OUT_OF_MEMORY,            0, 0x1003, "WAL out of memory")
 
 // http
 TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_SERVER_OFFLINE,          0, 0x1100, "http server is not onlin")
@@ -390,6 +392,16 @@ TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_OP_TAG_VALUE_NULL,       0, 0x11A3, "tag value
 TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_OP_TAG_VALUE_TOO_LONG,   0, 0x11A4, "tag value can not more than 64")
 TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_OP_VALUE_NULL,           0, 0x11A5, "value not find")
 TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_OP_VALUE_TYPE,           0, 0x11A6, "value type should be boolean, number or string")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_DB_NOT_INPUT,         0, 0x11B0, "database name can not be null")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_DB_INVALID,           0, 0x11B1, "invalid database name")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_PRECISION_INVALID,    0, 0x11B2, "invalid timestamp precision")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_INVALID_LINE,         0, 0x11B3, "invalid line protocol format")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_NAME_INVALID,         0, 0x11B4, "measurement, tag or field name invalid")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_VALUE_INVALID,        0, 0x11B5, "tag or field value invalid")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_TIMESTAMP_INVALID,    0, 0x11B6, "timestamp invalid")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_FIELD_TYPE_CONFLICT,  0, 0x11B7, "field type conflict")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_COLUMNS_SIZE,         0, 0x11B8, "too many tags or fields")
+TAOS_DEFINE_ERROR(TSDB_CODE_HTTP_IF_TIMESTAMP_COLLIDED,   0, 0x11B9, "points of a series with the same timestamp")
 
 // odbc
 TAOS_DEFINE_ERROR(TSDB_CODE_ODBC_OOM,                     0, 0x2100, "out of memory")
@@ -87,6 +87,7 @@ TSDB_REPO_T *tsdbOpenRepo(char *rootDir, STsdbAppH *pAppH);
 int          tsdbCloseRepo(TSDB_REPO_T *repo, int toCommit);
 int32_t      tsdbConfigRepo(TSDB_REPO_T *repo, STsdbCfg *pCfg);
 int          tsdbGetState(TSDB_REPO_T *repo);
+int64_t      tsdbGetRollupInterval(TSDB_REPO_T *repo);
 
 // --------- TSDB TABLE DEFINITION
 typedef struct {
@@ -165,6 +166,7 @@ typedef struct STsdbQueryCond {
   int32_t      numOfCols;
   SColumnInfo *colList;
   bool         loadExternalRows;  // load external rows or not
+  bool         rollup;            // the file groups can be read as the rollups of the time buckets
 } STsdbQueryCond;
 
 typedef struct SMemRef {
@@ -216,6 +218,18 @@ TsdbQueryHandleT *tsdbQueryTables(TSDB_REPO_T *tsdb, STsdbQueryCond *pCond, STab
  */
 TsdbQueryHandleT tsdbQueryLastRow(TSDB_REPO_T *tsdb, STsdbQueryCond *pCond, STableGroupInfo *tableInfo, void *qinfo, SMemRef* pRef);
 
+/**
+ * Get the data blocks for the last value of each column of the tables. If the last non-null value of each column is
+ * cached by the repository, one data block built from the cache is returned for each table, otherwise the data blocks
+ * are the same as the ones of tsdbQueryTables.
+ *
+ * @param tsdb   tsdb handle
+ * @param pCond  query condition, including time window, result set order, and basic required columns for each block
+ * @param tableInfo  table list.
+ * @return
+ */
+TsdbQueryHandleT tsdbQueryCacheLast(TSDB_REPO_T *tsdb, STsdbQueryCond *pCond, STableGroupInfo *tableInfo, void *qinfo, SMemRef* pRef);
+
 /**
  * get the queried table object list
  * @param pHandle
@@ -328,6 +342,13 @@ int32_t tsdbGetOneTableGroup(TSDB_REPO_T *tsdb, uint64_t uid, TSKEY startKey, ST
  */
 int32_t tsdbGetTableGroupFromIdList(TSDB_REPO_T* tsdb, SArray* pTableIdList, STableGroupInfo* pGroupInfo);
 
+/**
+ * get the number of file blocks skipped by the column filters of the query without being loaded
+ * @param queryHandle
+ * @return
+ */
+int32_t tsdbGetNumOfSkippedBlocks(TsdbQueryHandleT queryHandle);
+
 /**
  * clean up the query handle
  * @param queryHandle
@@ -236,6 +236,7 @@
 #define TK_BIN                            305   // bin format data 0b111
 #define TK_FILE                           306
 #define TK_QUESTION                       307   // denoting the placeholder of "?",when invoking statement bind query
+#define TK_HYPERLOGLOG                    308   // function keyword passed to the grammar as ID
 
 #endif
 
@@ -48,6 +48,18 @@ typedef struct {
   EWalKeep keep;         // keep the wal file when closed
 } SWalCfg;
 
+#define WAL_STAT_BUCKETS 20
+
+// group commit statistics, bucket i of the histograms counts the values in [2^i, 2^(i+1)), the last one counts
+// all the larger values
+typedef struct {
+  int64_t numOfBatches;                   // write calls into the wal file
+  int64_t numOfRecords;
+  int64_t numOfFsyncs;
+  int64_t batchSize[WAL_STAT_BUCKETS];    // records per write
+  int64_t latency[WAL_STAT_BUCKETS];      // microseconds from the first record buffered to the batch persisted
+} SWalStat;
+
 typedef void *  twalh;  // WAL HANDLE
 typedef int32_t FWalWrite(void *ahandle, void *pHead, int32_t qtype, void *pMsg);
 
@@ -61,10 +73,11 @@ int32_t  walRenew(twalh);
 void     walRemoveOneOldFile(twalh);
 void     walRemoveAllOldFiles(twalh);
 int32_t  walWrite(twalh, SWalHead *);
-void     walFsync(twalh, bool forceFsync);
+int32_t  walFsync(twalh, bool forceFsync);
 int32_t  walRestore(twalh, void *pVnode, FWalWrite writeFp);
 int32_t  walGetWalFile(twalh, char *fileName, int64_t *fileId);
 uint64_t walGetVersion(twalh);
+void     walGetStat(twalh, SWalStat *pStat);
 
 #ifdef __cplusplus
 }
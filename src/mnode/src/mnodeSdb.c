@@ -1111,12 +1111,17 @@ static void *sdbWorkerFp(void *pWorker) {
       sdbTrace("vgId:1, msg:%p is processed in sdb queue, code:%x", pRow->pMsg, pRow->code);
     }
 
-    walFsync(tsSdbMgmt.wal, true);
+    // the wal records of all rows are written and synced together, a row is not confirmed if they are lost
+    int32_t code = walFsync(tsSdbMgmt.wal, true);
+    if (code != TSDB_CODE_SUCCESS) {
+      sdbError("vgId:1, failed to fsync wal of %d rows since %s", numOfMsgs, tstrerror(code));
+    }
 
     // browse all items, and process them one by one
     taosResetQitems(tsSdbWQall);
     for (int32_t i = 0; i < numOfMsgs; ++i) {
       taosGetQitem(tsSdbWQall, &qtype, (void **)&pRow);
+      if (pRow->code == 0) pRow->code = code;
 
       if (qtype == TAOS_QTYPE_RPC) {
         sdbConfirmForward(1, pRow, pRow->code);
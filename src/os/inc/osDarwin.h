@@ -78,6 +78,7 @@ extern "C" {
   typedef struct tsem_s *tsem_t;
   int tsem_init(tsem_t *sem, int pshared, unsigned int value);
   int tsem_wait(tsem_t *sem);
+  int tsem_trywait(tsem_t *sem);
   int tsem_post(tsem_t *sem);
   int tsem_destroy(tsem_t *sem);
 
@@ -24,6 +24,7 @@ extern "C" {
   #define tsem_t sem_t
   #define tsem_init sem_init
   int tsem_wait(tsem_t* sem);
+  #define tsem_trywait sem_trywait
   #define tsem_post sem_post
   #define tsem_destroy sem_destroy
 #endif
@@ -51,17 +51,21 @@ int taosMkDir(const char *path, mode_t mode) {
   return code;
 }
 
-void taosRename(char* oldName, char *newName) {
+int32_t taosRename(char* oldName, char *newName) {
   // if newName in not empty, rename return fail. 
   // the newName must be empty or does not exist
 #ifdef WINDOWS
   remove(newName);
 #endif
   if (rename(oldName, newName)) {
+    int32_t code = errno;
     uError("failed to rename file %s to %s, reason:%s", oldName, newName, strerror(errno));
-  } else {
-    uInfo("successfully to rename file %s to %s", oldName, newName);
+    errno = code;
+    return -1;
   }
+
+  uInfo("successfully to rename file %s to %s", oldName, newName);
+  return 0;
 }
 
 void taosRemoveOldLogFiles(char *rootDir, int32_t keepDays) {
@@ -48,7 +48,8 @@ typedef enum HttpReqType {
   HTTP_REQTYPE_LOGIN = 1,
   HTTP_REQTYPE_HEARTBEAT = 2,
   HTTP_REQTYPE_SINGLE_SQL = 3,
-  HTTP_REQTYPE_MULTI_SQL = 4
+  HTTP_REQTYPE_MULTI_SQL = 4,
+  HTTP_REQTYPE_NATIVE = 5
 } HttpReqType;
 
 typedef enum {
@@ -121,6 +122,7 @@ typedef struct {
 typedef struct {
   char *module;
   bool (*fpDecode)(struct HttpContext *pContext);
+  void (*fpExecute)(struct HttpContext *pContext);  // runs a request of HTTP_REQTYPE_NATIVE
 } HttpDecodeMethod;
 
 typedef struct {
@@ -27,6 +27,7 @@ enum _httpRespTempl {
   HTTP_RESPONSE_CHUNKED_COMPRESS,
   HTTP_RESPONSE_OPTIONS,
   HTTP_RESPONSE_GRAFANA,
+  HTTP_RESPONSE_NO_CONTENT,
   HTTP_RESP_END
 };
 
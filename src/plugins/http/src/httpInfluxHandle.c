@@ -0,0 +1,1354 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "hash.h"
+#include "tmd5.h"
+#include "tstoken.h"
+#include "tglobal.h"
+#include "tstrbuild.h"
+#include "taosdef.h"
+#include "taosmsg.h"
+#include "taos.h"
+#include "httpInt.h"
+#include "httpContext.h"
+#include "httpQueue.h"
+#include "httpInfluxHandle.h"
+#include "httpInfluxJson.h"
+
+/*
+ * InfluxDB line protocol, one point per line:
+ *   measurement[,tag_key=tag_value...] field_key=field_value[,field_key=field_value...] [timestamp]
+ *
+ * request url formats like
+ *   /influx/write?db=<db>[&precision=n|u|ms|s|m|h][&u=<user>&p=<password>]
+ *
+ * Each measurement maps to a super table, and each tag set to a child table named <stable>_<md5 of the
+ * series key>. Fields become columns prefixed by "f_", tags become binary tags prefixed by "t_". Float
+ * fields are stored as double, integer fields as bigint, strings as binary. Timestamps are parsed into nanoseconds
+ * and converted to the precision of the database, which is looked up once and cached with the schemas. A database
+ * created here takes the default precision of the server. Points of a series that fall on the same timestamp after
+ * the conversion are rejected with the request, since only one of them could be stored.
+ *
+ * The points are not formatted into sql text. The missing database, super tables, columns and child tables are
+ * created first, then the points of each super table are bound as column arrays to a prepared insert, which
+ * merges the rows into one submit block per vgroup. The statement API is synchronous, so the request is run by
+ * a worker of the http result queue.
+ */
+
+#define INFLUX_MAX_STABLE_LEN 128
+#define INFLUX_BINARY_BYTES   256
+#define INFLUX_BINARY_TYPE    "binary(256)"
+#define INFLUX_TAG_BYTES      128
+#define INFLUX_EMPTY_TAG      "t_"  // tag keys are never empty, so the name can not clash
+#define INFLUX_MAX_BIND_ROWS  4096
+#define INFLUX_SUBMIT_BYTES   (1024 * 1024)  // rows bound before the statement is executed
+#define INFLUX_ESCAPE_CHARS   ",= \"\\"
+
+typedef struct {
+  char   name[TSDB_COL_NAME_LEN];
+  int8_t type;
+} SInfluxColumn;
+
+typedef struct {
+  SInfluxColumn *cols;
+  int32_t        num;
+  int32_t        cap;
+  int32_t        known;  // leading columns that already exist in the database
+} SInfluxColumns;
+
+typedef struct {
+  SInfluxColumns fields;
+  SInfluxColumns tags;
+} SInfluxSchema;
+
+typedef struct {
+  char *  key;
+  char *  str;
+  int32_t len;
+  int32_t col;
+  int8_t  type;
+  union {
+    int64_t i;
+    double  d;
+  } v;
+} SInfluxPair;
+
+typedef struct {
+  int64_t timestamp;
+  int32_t next;  // next point of the same series
+  int32_t fieldStart;
+  int32_t numOfFields;
+} SInfluxPoint;
+
+typedef struct {
+  char    name[TSDB_TABLE_NAME_LEN];
+  int32_t stable;
+  int32_t tagStart;
+  int32_t numOfTags;
+  int32_t firstPoint;
+  int32_t lastPoint;
+  int32_t next;  // next series of the same stable
+} SInfluxSeries;
+
+typedef struct {
+  char          name[TSDB_TABLE_NAME_LEN];
+  bool          cached;
+  int32_t       firstSeries;
+  int32_t       lastSeries;
+  SInfluxSchema schema;
+} SInfluxStable;
+
+typedef struct {
+  int32_t          numOfCols;  // bound fields, the timestamp is not counted
+  int32_t          maxRows;
+  int32_t          rowBytes;
+  int32_t *        cols;       // field of each bound column
+  int32_t *        binds;      // bound column of each field, -1 if the field is not bound
+  TAOS_MULTI_BIND *params;
+} SInfluxBind;
+
+typedef struct {
+  HttpContext *  pContext;
+  TAOS *         taos;
+  char *         db;
+  int64_t        tsMul;  // nanoseconds per unit of the request precision
+  int32_t        line;
+  SInfluxPair *  pairs;
+  int32_t        numOfPairs;
+  int32_t        pairCap;
+  SInfluxPoint * points;
+  int32_t        numOfPoints;
+  int32_t        pointCap;
+  SInfluxSeries *series;
+  int32_t        numOfSeries;
+  int32_t        seriesCap;
+  SInfluxStable *stables;
+  int32_t        numOfStables;
+  int32_t        stableCap;
+  SHashObj *     seriesHash;
+  SHashObj *     stableHash;
+} SInfluxReq;
+
+static HttpDecodeMethod influxDecodeMethod = {"influx", influxProcessRequest, influxExecuteRequest};
+
+// super table schemas known to exist, keyed by db.stable, child tables known to exist, keyed by db.table, and the
+// precision of the databases, keyed by db
+static SHashObj *       influxSchemas = NULL;
+static SHashObj *       influxTables = NULL;
+static SHashObj *       influxPrecisions = NULL;
+static pthread_mutex_t  influxMutex;
+
+static bool influxReserve(void **p, int32_t *cap, int32_t num, size_t size) {
+  if (num < *cap) return true;
+
+  int32_t newCap = (*cap == 0) ? 64 : (*cap * 2);
+  void *  np = realloc(*p, (size_t)newCap * size);
+  if (np == NULL) return false;
+
+  *p = np;
+  *cap = newCap;
+  return true;
+}
+
+static void influxFreeSchema(SInfluxSchema *schema) {
+  tfree(schema->fields.cols);
+  tfree(schema->tags.cols);
+  memset(schema, 0, sizeof(SInfluxSchema));
+}
+
+static bool influxCopyColumns(SInfluxColumns *dst, const SInfluxColumns *src) {
+  if (dst->cap < src->num) {
+    void *np = realloc(dst->cols, (size_t)src->num * sizeof(SInfluxColumn));
+    if (np == NULL) return false;
+    dst->cols = np;
+    dst->cap = src->num;
+  }
+
+  if (src->num > 0) memcpy(dst->cols, src->cols, (size_t)src->num * sizeof(SInfluxColumn));
+  dst->num = src->num;
+  dst->known = src->num;
+  return true;
+}
+
+void influxClearSchemas() {
+  if (influxSchemas == NULL) return;
+
+  pthread_mutex_lock(&influxMutex);
+  SInfluxSchema *schema = taosHashIterate(influxSchemas, NULL);
+  while (schema != NULL) {
+    influxFreeSchema(schema);
+    schema = taosHashIterate(influxSchemas, schema);
+  }
+  taosHashEmpty(influxSchemas);
+  taosHashEmpty(influxTables);
+  taosHashEmpty(influxPrecisions);
+  pthread_mutex_unlock(&influxMutex);
+}
+
+void influxInitHandle(HttpServer *pServer) {
+  pthread_mutex_init(&influxMutex, NULL);
+  influxSchemas = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  influxTables = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  influxPrecisions = taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  httpAddMethod(pServer, &influxDecodeMethod);
+}
+
+void influxCleanupHandle() {
+  if (influxSchemas == NULL) return;
+
+  influxClearSchemas();
+  taosHashCleanup(influxSchemas);
+  taosHashCleanup(influxTables);
+  taosHashCleanup(influxPrecisions);
+  influxSchemas = NULL;
+  influxTables = NULL;
+  influxPrecisions = NULL;
+  pthread_mutex_destroy(&influxMutex);
+}
+
+static void influxLoadSchema(SInfluxReq *pReq, SInfluxStable *pStable) {
+  char    key[TSDB_DB_NAME_LEN + TSDB_TABLE_NAME_LEN];
+  int32_t keyLen = snprintf(key, sizeof(key), "%s.%s", pReq->db, pStable->name);
+
+  pthread_mutex_lock(&influxMutex);
+  SInfluxSchema *schema = taosHashGet(influxSchemas, key, keyLen);
+  if (schema != NULL && influxCopyColumns(&pStable->schema.fields, &schema->fields) &&
+      influxCopyColumns(&pStable->schema.tags, &schema->tags)) {
+    pStable->cached = true;
+  } else {
+    pStable->schema.fields.num = pStable->schema.fields.known = 0;
+    pStable->schema.tags.num = pStable->schema.tags.known = 0;
+  }
+  pthread_mutex_unlock(&influxMutex);
+}
+
+static void influxSaveSchema(SInfluxReq *pReq, SInfluxStable *pStable) {
+  char    key[TSDB_DB_NAME_LEN + TSDB_TABLE_NAME_LEN];
+  int32_t keyLen = snprintf(key, sizeof(key), "%s.%s", pReq->db, pStable->name);
+
+  SInfluxSchema schema = {{0}};
+  if (!influxCopyColumns(&schema.fields, &pStable->schema.fields) ||
+      !influxCopyColumns(&schema.tags, &pStable->schema.tags)) {
+    influxFreeSchema(&schema);
+    return;
+  }
+
+  pthread_mutex_lock(&influxMutex);
+  SInfluxSchema *old = taosHashGet(influxSchemas, key, keyLen);
+  if (old != NULL) {
+    influxFreeSchema(old);
+    *old = schema;
+  } else if (taosHashPut(influxSchemas, key, keyLen, &schema, sizeof(SInfluxSchema)) != 0) {
+    influxFreeSchema(&schema);
+  }
+  pthread_mutex_unlock(&influxMutex);
+}
+
+static void influxFreeReq(SInfluxReq *pReq) {
+  for (int32_t s = 0; s < pReq->numOfStables; ++s) {
+    influxFreeSchema(&pReq->stables[s].schema);
+  }
+  tfree(pReq->pairs);
+  tfree(pReq->points);
+  tfree(pReq->series);
+  tfree(pReq->stables);
+  taosHashCleanup(pReq->seriesHash);
+  taosHashCleanup(pReq->stableHash);
+}
+
+/*
+ * lower-cased, every character other than [a-z0-9_] replaced by '_'
+ */
+static bool influxNormalizeName(char *dst, int32_t size, const char *prefix, const char *src) {
+  int32_t len = (int32_t)strlen(prefix);
+  if (*src == 0 || len + (int32_t)strlen(src) >= size) return false;
+
+  memcpy(dst, prefix, (size_t)len);
+  for (; *src != 0; ++src) {
+    char c = *src;
+    if (c >= 'A' && c <= 'Z') {
+      c = (char)(c - 'A' + 'a');
+    } else if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_')) {
+      c = '_';
+    }
+    dst[len++] = c;
+  }
+  dst[len] = 0;
+  return true;
+}
+
+/*
+ * scan a name up to an unescaped stop character and remove the escapes in place,
+ * return the stop character
+ */
+static char influxScanName(char **pp, const char *stops) {
+  char *src = *pp;
+  char *dst = *pp;
+
+  while (*src != 0 && strchr(stops, *src) == NULL) {
+    if (*src == '\\' && src[1] != 0 && strchr(INFLUX_ESCAPE_CHARS, src[1]) != NULL) src++;
+    *dst++ = *src++;
+  }
+
+  char stop = *src;
+  *dst = 0;
+  *pp = (stop == 0) ? src : src + 1;
+  return stop;
+}
+
+static bool influxIsBool(const char *s, bool *val) {
+  if (strcmp(s, "t") == 0 || strcmp(s, "T") == 0 || strcmp(s, "true") == 0 || strcmp(s, "True") == 0 ||
+      strcmp(s, "TRUE") == 0) {
+    *val = true;
+    return true;
+  }
+  if (strcmp(s, "f") == 0 || strcmp(s, "F") == 0 || strcmp(s, "false") == 0 || strcmp(s, "False") == 0 ||
+      strcmp(s, "FALSE") == 0) {
+    *val = false;
+    return true;
+  }
+  return false;
+}
+
+/*
+ * tag values are sent in the sql text creating the table, and the client parser treats a backslash as an escape,
+ * so one before a quote or at the end can not be sent
+ */
+static bool influxCheckString(const char *s, int32_t len, int32_t bytes) {
+  if (len > bytes) return false;
+  for (int32_t i = 0; i < len; ++i) {
+    if (s[i] == '\\' && (i == len - 1 || s[i + 1] == '\'')) return false;
+  }
+  return true;
+}
+
+static int32_t influxParseFieldValue(char **pp, SInfluxPair *pair, char *stop) {
+  char *p = *pp;
+
+  if (*p == '"') {
+    char *dst = ++p;
+    pair->str = p;
+    while (*p != '"') {
+      if (*p == 0) return TSDB_CODE_HTTP_IF_VALUE_INVALID;
+      if (*p == '\\' && (p[1] == '"' || p[1] == '\\')) p++;
+      *dst++ = *p++;
+    }
+    *dst = 0;
+    pair->len = (int32_t)(dst - pair->str);
+    pair->type = TSDB_DATA_TYPE_BINARY;
+    if (pair->len > INFLUX_BINARY_BYTES) return TSDB_CODE_HTTP_IF_VALUE_INVALID;
+
+    *stop = *(++p);
+    if (*stop != 0 && strchr(", \r\n", *stop) == NULL) return TSDB_CODE_HTTP_IF_INVALID_LINE;
+    *pp = (*stop == 0) ? p : p + 1;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  char *start = p;
+  while (*p != 0 && strchr(", \r\n", *p) == NULL) p++;
+  *stop = *p;
+  *p = 0;
+  *pp = (*stop == 0) ? p : p + 1;
+
+  int32_t len = (int32_t)(p - start);
+  if (len == 0) return TSDB_CODE_HTTP_IF_VALUE_INVALID;
+
+  bool  bval = false;
+  char *end = NULL;
+  errno = 0;
+  if (start[len - 1] == 'i' || start[len - 1] == 'u') {
+    bool isUnsigned = (start[len - 1] == 'u');
+    start[len - 1] = 0;
+    pair->v.i = strtoll(start, &end, 10);
+    if (end == start || *end != 0 || errno != 0 || (isUnsigned && (pair->v.i < 0 || *start == '-'))) {
+      return TSDB_CODE_HTTP_IF_VALUE_INVALID;
+    }
+    pair->type = TSDB_DATA_TYPE_BIGINT;
+  } else if (influxIsBool(start, &bval)) {
+    pair->v.i = bval ? 1 : 0;
+    pair->type = TSDB_DATA_TYPE_BOOL;
+  } else {
+    pair->v.d = strtod(start, &end);
+    if (end == start || *end != 0 || errno == ERANGE || !isfinite(pair->v.d) || strpbrk(start, "xX") != NULL) {
+      return TSDB_CODE_HTTP_IF_VALUE_INVALID;
+    }
+    pair->type = TSDB_DATA_TYPE_DOUBLE;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t influxMapColumn(SInfluxColumns *pCols, const char *prefix, const char *key, int8_t type, int32_t hint,
+                               int32_t maxNum, int32_t *col) {
+  char name[TSDB_COL_NAME_LEN];
+  if (!influxNormalizeName(name, sizeof(name), prefix, key)) return TSDB_CODE_HTTP_IF_NAME_INVALID;
+
+  // fields of one measurement usually arrive in the same order
+  int32_t i = hint;
+  if (i >= pCols->num || strcmp(pCols->cols[i].name, name) != 0) {
+    i = 0;
+    while (i < pCols->num && strcmp(pCols->cols[i].name, name) != 0) i++;
+  }
+
+  if (i < pCols->num) {
+    if (pCols->cols[i].type != type) return TSDB_CODE_HTTP_IF_FIELD_TYPE_CONFLICT;
+    *col = i;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (pCols->num >= maxNum) return TSDB_CODE_HTTP_IF_COLUMNS_SIZE;
+  if (!influxReserve((void **)&pCols->cols, &pCols->cap, pCols->num, sizeof(SInfluxColumn))) {
+    return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+  }
+
+  SInfluxColumn *pCol = pCols->cols + pCols->num;
+  tstrncpy(pCol->name, name, sizeof(pCol->name));
+  pCol->type = type;
+  *col = pCols->num++;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t influxGetStable(SInfluxReq *pReq, const char *measurement, int32_t *stable) {
+  char name[TSDB_TABLE_NAME_LEN];
+  if (!influxNormalizeName(name, INFLUX_MAX_STABLE_LEN, "", measurement)) return TSDB_CODE_HTTP_IF_NAME_INVALID;
+  if (!(name[0] >= 'a' && name[0] <= 'z') || isKeyWord(name, (int32_t)strlen(name))) {
+    if (!influxNormalizeName(name, INFLUX_MAX_STABLE_LEN, "m_", measurement)) return TSDB_CODE_HTTP_IF_NAME_INVALID;
+  }
+
+  int32_t  nameLen = (int32_t)strlen(name);
+  int32_t *idx = taosHashGet(pReq->stableHash, name, nameLen);
+  if (idx != NULL) {
+    *stable = *idx;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (!influxReserve((void **)&pReq->stables, &pReq->stableCap, pReq->numOfStables, sizeof(SInfluxStable))) {
+    return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+  }
+
+  SInfluxStable *pStable = pReq->stables + pReq->numOfStables;
+  memset(pStable, 0, sizeof(SInfluxStable));
+  tstrncpy(pStable->name, name, sizeof(pStable->name));
+  pStable->firstSeries = -1;
+  pStable->lastSeries = -1;
+  influxLoadSchema(pReq, pStable);
+
+  *stable = pReq->numOfStables++;
+  taosHashPut(pReq->stableHash, name, nameLen, stable, sizeof(int32_t));
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t influxComparePair(const void *a, const void *b) {
+  return strcmp(((const SInfluxPair *)a)->key, ((const SInfluxPair *)b)->key);
+}
+
+static int32_t influxGetSeries(SInfluxReq *pReq, const char *measurement, int32_t tagStart, int32_t numOfTags,
+                               int32_t *series) {
+  SInfluxPair *tags = pReq->pairs + tagStart;
+  qsort(tags, (size_t)numOfTags, sizeof(SInfluxPair), influxComparePair);
+
+  MD5_CTX context;
+  MD5Init(&context);
+  MD5Update(&context, (uint8_t *)measurement, (unsigned int)strlen(measurement));
+  for (int32_t t = 0; t < numOfTags; ++t) {
+    if (t > 0 && strcmp(tags[t].key, tags[t - 1].key) == 0) return TSDB_CODE_HTTP_IF_INVALID_LINE;
+    MD5Update(&context, (uint8_t *)",", 1);
+    MD5Update(&context, (uint8_t *)tags[t].key, (unsigned int)strlen(tags[t].key));
+    MD5Update(&context, (uint8_t *)"=", 1);
+    MD5Update(&context, (uint8_t *)tags[t].str, (unsigned int)tags[t].len);
+  }
+  MD5Final(&context);
+
+  int32_t *idx = taosHashGet(pReq->seriesHash, context.digest, sizeof(context.digest));
+  if (idx != NULL) {
+    *series = *idx;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t stable = 0;
+  int32_t code = influxGetStable(pReq, measurement, &stable);
+  if (code != TSDB_CODE_SUCCESS) return code;
+
+  SInfluxColumns *pTags = &pReq->stables[stable].schema.tags;
+  for (int32_t t = 0; t < numOfTags; ++t) {
+    if (!influxCheckString(tags[t].str, tags[t].len, INFLUX_TAG_BYTES)) return TSDB_CODE_HTTP_IF_VALUE_INVALID;
+    code = influxMapColumn(pTags, "t_", tags[t].key, TSDB_DATA_TYPE_BINARY, t, TSDB_MAX_TAGS, &tags[t].col);
+    if (code != TSDB_CODE_SUCCESS) return code;
+  }
+
+  if (!influxReserve((void **)&pReq->series, &pReq->seriesCap, pReq->numOfSeries, sizeof(SInfluxSeries))) {
+    return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+  }
+
+  SInfluxSeries *pSeries = pReq->series + pReq->numOfSeries;
+  int32_t        len = snprintf(pSeries->name, sizeof(pSeries->name), "%s_", pReq->stables[stable].name);
+  for (int32_t i = 0; i < (int32_t)sizeof(context.digest); ++i) {
+    len += snprintf(pSeries->name + len, sizeof(pSeries->name) - len, "%02x", context.digest[i]);
+  }
+  pSeries->stable = stable;
+  pSeries->tagStart = tagStart;
+  pSeries->numOfTags = numOfTags;
+  pSeries->firstPoint = -1;
+  pSeries->lastPoint = -1;
+  pSeries->next = -1;
+
+  *series = pReq->numOfSeries++;
+
+  SInfluxStable *pStable = pReq->stables + stable;
+  if (pStable->lastSeries < 0) {
+    pStable->firstSeries = *series;
+  } else {
+    pReq->series[pStable->lastSeries].next = *series;
+  }
+  pStable->lastSeries = *series;
+
+  taosHashPut(pReq->seriesHash, context.digest, sizeof(context.digest), series, sizeof(int32_t));
+  return TSDB_CODE_SUCCESS;
+}
+
+static SInfluxPair *influxNewPair(SInfluxReq *pReq) {
+  if (!influxReserve((void **)&pReq->pairs, &pReq->pairCap, pReq->numOfPairs, sizeof(SInfluxPair))) return NULL;
+
+  SInfluxPair *pair = pReq->pairs + pReq->numOfPairs++;
+  memset(pair, 0, sizeof(SInfluxPair));
+  return pair;
+}
+
+static int32_t influxParseLine(SInfluxReq *pReq, char **pp) {
+  char *p = *pp;
+
+  // measurement and tag set
+  char *measurement = p;
+  char  stop = influxScanName(&p, ", \n");
+  if (*measurement == 0) return TSDB_CODE_HTTP_IF_NAME_INVALID;
+
+  int32_t tagStart = pReq->numOfPairs;
+  while (stop == ',') {
+    SInfluxPair *pair = influxNewPair(pReq);
+    if (pair == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+
+    pair->key = p;
+    if (influxScanName(&p, ",= \n") != '=' || *pair->key == 0) return TSDB_CODE_HTTP_IF_INVALID_LINE;
+    pair->str = p;
+    stop = influxScanName(&p, ", \n");
+    pair->len = (int32_t)strlen(pair->str);
+    pair->type = TSDB_DATA_TYPE_BINARY;
+    if (pair->len == 0) return TSDB_CODE_HTTP_IF_VALUE_INVALID;
+  }
+  int32_t numOfTags = pReq->numOfPairs - tagStart;
+  if (stop != ' ') return TSDB_CODE_HTTP_IF_INVALID_LINE;
+
+  // field set
+  while (*p == ' ') p++;
+  int32_t fieldStart = pReq->numOfPairs;
+  do {
+    SInfluxPair *pair = influxNewPair(pReq);
+    if (pair == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+
+    pair->key = p;
+    if (influxScanName(&p, ",= \n") != '=' || *pair->key == 0) return TSDB_CODE_HTTP_IF_INVALID_LINE;
+    int32_t code = influxParseFieldValue(&p, pair, &stop);
+    if (code != TSDB_CODE_SUCCESS) return code;
+  } while (stop == ',');
+  int32_t numOfFields = pReq->numOfPairs - fieldStart;
+
+  // timestamp, in nanoseconds until the precision of the database is known
+  int64_t timestamp = taosGetTimestampUs() * 1000;
+  if (stop == ' ') {
+    while (*p == ' ') p++;
+    if (*p != 0 && *p != '\r' && *p != '\n') {
+      char *end = NULL;
+      errno = 0;
+      int64_t ts = strtoll(p, &end, 10);
+      if (end == p || errno != 0) return TSDB_CODE_HTTP_IF_TIMESTAMP_INVALID;
+      if (ts > INT64_MAX / pReq->tsMul || ts < INT64_MIN / pReq->tsMul) return TSDB_CODE_HTTP_IF_TIMESTAMP_INVALID;
+      timestamp = ts * pReq->tsMul;
+      p = end;
+      while (*p == ' ') p++;
+    }
+    stop = *p;
+    if (stop != 0) p++;
+  }
+  if (stop == '\r') {
+    stop = *p;
+    if (stop != 0) p++;
+  }
+  if (stop != 0 && stop != '\n') return TSDB_CODE_HTTP_IF_INVALID_LINE;
+  *pp = p;
+
+  int32_t series = 0;
+  int32_t code = influxGetSeries(pReq, measurement, tagStart, numOfTags, &series);
+  if (code != TSDB_CODE_SUCCESS) return code;
+
+  SInfluxSeries * pSeries = pReq->series + series;
+  SInfluxColumns *pFields = &pReq->stables[pSeries->stable].schema.fields;
+  for (int32_t f = 0; f < numOfFields; ++f) {
+    SInfluxPair *pair = pReq->pairs + fieldStart + f;
+    code = influxMapColumn(pFields, "f_", pair->key, pair->type, f, TSDB_MAX_COLUMNS - 1, &pair->col);
+    if (code != TSDB_CODE_SUCCESS) return code;
+  }
+
+  if (!influxReserve((void **)&pReq->points, &pReq->pointCap, pReq->numOfPoints, sizeof(SInfluxPoint))) {
+    return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+  }
+
+  int32_t       point = pReq->numOfPoints++;
+  SInfluxPoint *pPoint = pReq->points + point;
+  pPoint->timestamp = timestamp;
+  pPoint->next = -1;
+  pPoint->fieldStart = fieldStart;
+  pPoint->numOfFields = numOfFields;
+
+  if (pSeries->lastPoint < 0) {
+    pSeries->firstPoint = point;
+  } else {
+    pReq->points[pSeries->lastPoint].next = point;
+  }
+  pSeries->lastPoint = point;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t influxParseBody(SInfluxReq *pReq, char *body) {
+  char *p = body;
+  while (*p != 0) {
+    pReq->line++;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '\n' || *p == '\r' || *p == '#') {
+      while (*p != 0 && *p != '\n') p++;
+      if (*p == '\n') p++;
+      continue;
+    }
+    if (*p == 0) break;
+
+    int32_t code = influxParseLine(pReq, &p);
+    if (code != TSDB_CODE_SUCCESS) return code;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static const char *influxTypeName(int8_t type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL:
+      return "bool";
+    case TSDB_DATA_TYPE_BIGINT:
+      return "bigint";
+    case TSDB_DATA_TYPE_BINARY:
+      return INFLUX_BINARY_TYPE;
+    default:
+      return "double";
+  }
+}
+
+static int32_t influxTypeBytes(int8_t type) {
+  return (type == TSDB_DATA_TYPE_BINARY) ? INFLUX_BINARY_BYTES : tDataTypes[type].bytes;
+}
+
+static void influxAppendString(SStringBuilder *sb, const char *str, int32_t len) {
+  taosStringBuilderAppendChar(sb, '\'');
+  for (int32_t i = 0; i < len; ++i) {
+    if (str[i] == '\'') taosStringBuilderAppendChar(sb, '\'');
+    taosStringBuilderAppendChar(sb, str[i]);
+  }
+  taosStringBuilderAppendChar(sb, '\'');
+}
+
+static int32_t influxExecSql(SInfluxReq *pReq, const char *sql) {
+  if (sql == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+
+  TAOS_RES *result = taos_query(pReq->taos, sql);
+  int32_t   code = taos_errno(result);
+  taos_free_result(result);
+
+  httpDebug("context:%p, fd:%d, code:%s, sql:%s", pReq->pContext, pReq->pContext->fd, tstrerror(code), sql);
+  return code;
+}
+
+/*
+ * the precision of a database missing yet is the one it is created with, the default of the server
+ */
+static int32_t influxGetPrecision(SInfluxReq *pReq, int8_t *precision) {
+  int32_t keyLen = (int32_t)strlen(pReq->db);
+
+  pthread_mutex_lock(&influxMutex);
+  int8_t *cached = taosHashGet(influxPrecisions, pReq->db, keyLen);
+  if (cached != NULL) *precision = *cached;
+  pthread_mutex_unlock(&influxMutex);
+  if (cached != NULL) return TSDB_CODE_SUCCESS;
+
+  TAOS_RES *result = taos_query(pReq->taos, "show databases");
+  int32_t   code = taos_errno(result);
+  if (code != TSDB_CODE_SUCCESS) {
+    taos_free_result(result);
+    return code;
+  }
+
+  int32_t     numOfFields = taos_num_fields(result);
+  TAOS_FIELD *fields = taos_fetch_fields(result);
+  int32_t     col = -1;
+  for (int32_t i = 0; i < numOfFields; ++i) {
+    if (strcasecmp(fields[i].name, "precision") == 0) col = i;
+  }
+
+  bool     found = false;
+  TAOS_ROW row = NULL;
+  *precision = (int8_t)tsTimePrecision;
+  while (col >= 0 && !found && (row = taos_fetch_row(result)) != NULL) {
+    int32_t *lengths = taos_fetch_lengths(result);
+    if (lengths[0] != keyLen || strncasecmp(row[0], pReq->db, (size_t)keyLen) != 0) continue;
+
+    found = true;
+    if (lengths[col] == 2 && strncmp(row[col], TSDB_TIME_PRECISION_MICRO_STR, 2) == 0) {
+      *precision = TSDB_TIME_PRECISION_MICRO;
+    } else if (lengths[col] == 2 && strncmp(row[col], TSDB_TIME_PRECISION_NANO_STR, 2) == 0) {
+      *precision = TSDB_TIME_PRECISION_NANO;
+    } else {
+      *precision = TSDB_TIME_PRECISION_MILLI;
+    }
+  }
+  taos_free_result(result);
+
+  if (found) {
+    pthread_mutex_lock(&influxMutex);
+    taosHashPut(influxPrecisions, pReq->db, keyLen, precision, sizeof(int8_t));
+    pthread_mutex_unlock(&influxMutex);
+  }
+
+  httpDebug("context:%p, fd:%d, db:%s, precision:%d, found:%d", pReq->pContext, pReq->pContext->fd, pReq->db,
+            *precision, found);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t influxCompareTimestamp(const void *a, const void *b) {
+  int64_t x = *(const int64_t *)a;
+  int64_t y = *(const int64_t *)b;
+  return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/*
+ * The nanoseconds of the points are truncated to the precision of the database. A series can hold one row per
+ * timestamp, so points that fall on the same one would silently lose all but one of them, the request is rejected.
+ */
+static int32_t influxConvertTimestamps(SInfluxReq *pReq, int8_t precision) {
+  int64_t div = 1000000;
+  if (precision == TSDB_TIME_PRECISION_MICRO) div = 1000;
+  if (precision == TSDB_TIME_PRECISION_NANO) div = 1;
+
+  for (int32_t p = 0; p < pReq->numOfPoints; ++p) {
+    pReq->points[p].timestamp /= div;
+  }
+
+  int64_t *keys = malloc((size_t)pReq->numOfPoints * sizeof(int64_t));
+  if (keys == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  for (int32_t s = 0; s < pReq->numOfSeries && code == TSDB_CODE_SUCCESS; ++s) {
+    SInfluxSeries *pSeries = pReq->series + s;
+    int32_t        num = 0;
+    for (int32_t p = pSeries->firstPoint; p >= 0; p = pReq->points[p].next) {
+      keys[num++] = pReq->points[p].timestamp;
+    }
+    if (num < 2) continue;
+
+    qsort(keys, (size_t)num, sizeof(int64_t), influxCompareTimestamp);
+    for (int32_t k = 1; k < num; ++k) {
+      if (keys[k] != keys[k - 1]) continue;
+
+      httpError("context:%p, fd:%d, points of table %s.%s collide at timestamp %" PRId64 ", precision:%d",
+                pReq->pContext, pReq->pContext->fd, pReq->db, pSeries->name, keys[k], precision);
+      code = TSDB_CODE_HTTP_IF_TIMESTAMP_COLLIDED;
+      break;
+    }
+  }
+
+  free(keys);
+  return code;
+}
+
+static char *influxBuildCreateSql(SInfluxReq *pReq, SInfluxStable *pStable) {
+  SStringBuilder sb;
+  memset(&sb, 0, sizeof(sb));
+
+  if (taosStringBuilderSetJmp(&sb) != 0) {
+    taosStringBuilderDestroy(&sb);
+    return NULL;
+  }
+
+  SInfluxColumns *pFields = &pStable->schema.fields;
+  SInfluxColumns *pTags = &pStable->schema.tags;
+
+  taosStringBuilderAppendString(&sb, "create table ");
+  taosStringBuilderAppendString(&sb, pReq->db);
+  taosStringBuilderAppendChar(&sb, '.');
+  taosStringBuilderAppendString(&sb, pStable->name);
+  taosStringBuilderAppendString(&sb, " (ts timestamp");
+  for (int32_t f = 0; f < pFields->num; ++f) {
+    taosStringBuilderAppendChar(&sb, ',');
+    taosStringBuilderAppendString(&sb, pFields->cols[f].name);
+    taosStringBuilderAppendChar(&sb, ' ');
+    taosStringBuilderAppendString(&sb, influxTypeName(pFields->cols[f].type));
+  }
+  for (int32_t t = 0; t < pTags->num; ++t) {
+    taosStringBuilderAppendString(&sb, (t == 0) ? ") tags (" : ",");
+    taosStringBuilderAppendString(&sb, pTags->cols[t].name);
+    taosStringBuilderAppendString(&sb, " binary(");
+    taosStringBuilderAppendInteger(&sb, INFLUX_TAG_BYTES);
+    taosStringBuilderAppendChar(&sb, ')');
+  }
+  taosStringBuilderAppendChar(&sb, ')');
+
+  return taosStringBuilderGetResult(&sb, NULL);
+}
+
+/*
+ * A stable not in the cache is created with the full schema. If it already exists, the alter commands add
+ * whatever columns are missing, the ones that exist already are skipped.
+ */
+static int32_t influxCreateStable(SInfluxReq *pReq, SInfluxStable *pStable) {
+  SInfluxColumns *pFields = &pStable->schema.fields;
+  SInfluxColumns *pTags = &pStable->schema.tags;
+  char            sql[TSDB_DB_NAME_LEN + TSDB_TABLE_NAME_LEN + TSDB_COL_NAME_LEN + 64];
+
+  if (pTags->num == 0) {
+    int32_t col = 0;
+    int32_t code = influxMapColumn(pTags, "", INFLUX_EMPTY_TAG, TSDB_DATA_TYPE_BINARY, 0, TSDB_MAX_TAGS, &col);
+    if (code != TSDB_CODE_SUCCESS) return code;
+  }
+
+  if (pFields->num == pFields->known && pTags->num == pTags->known && pStable->cached) return TSDB_CODE_SUCCESS;
+
+  if (!pStable->cached) {
+    char *  createSql = influxBuildCreateSql(pReq, pStable);
+    int32_t code = influxExecSql(pReq, createSql);
+    tfree(createSql);
+
+    if (code == TSDB_CODE_SUCCESS) {
+      influxSaveSchema(pReq, pStable);
+      return code;
+    }
+    if (code != TSDB_CODE_MND_TABLE_ALREADY_EXIST) return code;
+  }
+
+  for (int32_t f = pFields->known; f < pFields->num; ++f) {
+    SInfluxColumn *pCol = pFields->cols + f;
+    snprintf(sql, sizeof(sql), "alter table %s.%s add column %s %s", pReq->db, pStable->name, pCol->name,
+             influxTypeName(pCol->type));
+    int32_t code = influxExecSql(pReq, sql);
+    if (code != TSDB_CODE_SUCCESS && code != TSDB_CODE_MND_FIELD_ALREAY_EXIST) return code;
+  }
+
+  for (int32_t t = pTags->known; t < pTags->num; ++t) {
+    snprintf(sql, sizeof(sql), "alter table %s.%s add tag %s binary(%d)", pReq->db, pStable->name,
+             pTags->cols[t].name, INFLUX_TAG_BYTES);
+    int32_t code = influxExecSql(pReq, sql);
+    if (code != TSDB_CODE_SUCCESS && code != TSDB_CODE_MND_TAG_ALREAY_EXIST) return code;
+  }
+
+  influxSaveSchema(pReq, pStable);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t influxCreateStables(SInfluxReq *pReq) {
+  for (int32_t s = 0; s < pReq->numOfStables; ++s) {
+    int32_t code = influxCreateStable(pReq, pReq->stables + s);
+    if (code != TSDB_CODE_SUCCESS) return code;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * insert into db.table [using db.stable (tags) tags (values)] (ts, columns) values (?, ...)
+ */
+static char *influxBuildInsertSql(SInfluxReq *pReq, SInfluxSeries *pSeries, SInfluxBind *pBind, bool create) {
+  SStringBuilder sb;
+  memset(&sb, 0, sizeof(sb));
+
+  if (taosStringBuilderSetJmp(&sb) != 0) {
+    taosStringBuilderDestroy(&sb);
+    return NULL;
+  }
+
+  SInfluxStable * pStable = pReq->stables + pSeries->stable;
+  SInfluxColumns *pFields = &pStable->schema.fields;
+  SInfluxColumns *pTags = &pStable->schema.tags;
+
+  taosStringBuilderAppendString(&sb, "insert into ");
+  taosStringBuilderAppendString(&sb, pReq->db);
+  taosStringBuilderAppendChar(&sb, '.');
+  taosStringBuilderAppendString(&sb, pSeries->name);
+
+  if (create) {
+    taosStringBuilderAppendString(&sb, " using ");
+    taosStringBuilderAppendString(&sb, pReq->db);
+    taosStringBuilderAppendChar(&sb, '.');
+    taosStringBuilderAppendString(&sb, pStable->name);
+
+    // a series without tags sets the first tag to NULL
+    SInfluxPair *tags = pReq->pairs + pSeries->tagStart;
+    taosStringBuilderAppendString(&sb, " (");
+    if (pSeries->numOfTags == 0) taosStringBuilderAppendString(&sb, pTags->cols[0].name);
+    for (int32_t t = 0; t < pSeries->numOfTags; ++t) {
+      if (t > 0) taosStringBuilderAppendChar(&sb, ',');
+      taosStringBuilderAppendString(&sb, pTags->cols[tags[t].col].name);
+    }
+    taosStringBuilderAppendString(&sb, ") tags (");
+    if (pSeries->numOfTags == 0) taosStringBuilderAppendNull(&sb);
+    for (int32_t t = 0; t < pSeries->numOfTags; ++t) {
+      if (t > 0) taosStringBuilderAppendChar(&sb, ',');
+      influxAppendString(&sb, tags[t].str, tags[t].len);
+    }
+    taosStringBuilderAppendChar(&sb, ')');
+  }
+
+  taosStringBuilderAppendString(&sb, " (ts");
+  for (int32_t c = 0; c < pBind->numOfCols; ++c) {
+    taosStringBuilderAppendChar(&sb, ',');
+    taosStringBuilderAppendString(&sb, pFields->cols[pBind->cols[c]].name);
+  }
+  taosStringBuilderAppendString(&sb, ") values (?");
+  for (int32_t c = 0; c < pBind->numOfCols; ++c) {
+    taosStringBuilderAppendString(&sb, ",?");
+  }
+  taosStringBuilderAppendChar(&sb, ')');
+
+  return taosStringBuilderGetResult(&sb, NULL);
+}
+
+static void influxFreeBind(SInfluxBind *pBind) {
+  if (pBind->params != NULL) {
+    for (int32_t c = 0; c <= pBind->numOfCols; ++c) {
+      tfree(pBind->params[c].buffer);
+      tfree(pBind->params[c].length);
+      tfree(pBind->params[c].is_null);
+    }
+  }
+  tfree(pBind->params);
+  tfree(pBind->cols);
+  tfree(pBind->binds);
+  memset(pBind, 0, sizeof(SInfluxBind));
+}
+
+/*
+ * Only the fields carried by the points of the stable are bound, the others are null. The column arrays hold
+ * at most INFLUX_SUBMIT_BYTES of rows.
+ */
+static int32_t influxInitBind(SInfluxReq *pReq, SInfluxStable *pStable, SInfluxBind *pBind) {
+  SInfluxColumns *pFields = &pStable->schema.fields;
+
+  pBind->binds = malloc((size_t)MAX(pFields->num, 1) * sizeof(int32_t));
+  pBind->cols = malloc((size_t)MAX(pFields->num, 1) * sizeof(int32_t));
+  if (pBind->binds == NULL || pBind->cols == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+
+  for (int32_t f = 0; f < pFields->num; ++f) pBind->binds[f] = -1;
+  for (int32_t s = pStable->firstSeries; s >= 0; s = pReq->series[s].next) {
+    for (int32_t p = pReq->series[s].firstPoint; p >= 0; p = pReq->points[p].next) {
+      SInfluxPoint *pPoint = pReq->points + p;
+      for (int32_t f = 0; f < pPoint->numOfFields; ++f) pBind->binds[pReq->pairs[pPoint->fieldStart + f].col] = 0;
+    }
+  }
+
+  pBind->rowBytes = TSDB_KEYSIZE;
+  for (int32_t f = 0; f < pFields->num; ++f) {
+    if (pBind->binds[f] < 0) continue;
+    pBind->binds[f] = pBind->numOfCols;
+    pBind->cols[pBind->numOfCols++] = f;
+    pBind->rowBytes += influxTypeBytes(pFields->cols[f].type);
+  }
+  pBind->maxRows = MAX(1, MIN(INFLUX_MAX_BIND_ROWS, INFLUX_SUBMIT_BYTES / pBind->rowBytes));
+
+  pBind->params = calloc((size_t)pBind->numOfCols + 1, sizeof(TAOS_MULTI_BIND));
+  if (pBind->params == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+
+  pBind->params[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  pBind->params[0].buffer = malloc((size_t)pBind->maxRows * TSDB_KEYSIZE);
+  if (pBind->params[0].buffer == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+
+  for (int32_t c = 0; c < pBind->numOfCols; ++c) {
+    TAOS_MULTI_BIND *b = pBind->params + c + 1;
+    int8_t           type = pFields->cols[pBind->cols[c]].type;
+
+    b->buffer_type = type;
+    b->buffer_length = (uintptr_t)influxTypeBytes(type);
+    b->buffer = malloc((size_t)pBind->maxRows * b->buffer_length);
+    b->is_null = malloc((size_t)pBind->maxRows);
+    if (b->buffer == NULL || b->is_null == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+
+    if (type == TSDB_DATA_TYPE_BINARY) {
+      b->length = malloc((size_t)pBind->maxRows * sizeof(int32_t));
+      if (b->length == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * fill the column arrays with the points from *point on, return the number of rows
+ */
+static int32_t influxFillBind(SInfluxReq *pReq, SInfluxBind *pBind, int32_t *point) {
+  int64_t *ts = pBind->params[0].buffer;
+  int32_t  rows = 0;
+
+  for (int32_t c = 0; c < pBind->numOfCols; ++c) {
+    memset(pBind->params[c + 1].is_null, 1, (size_t)pBind->maxRows);
+  }
+
+  int32_t p = *point;
+  for (; p >= 0 && rows < pBind->maxRows; p = pReq->points[p].next, ++rows) {
+    SInfluxPoint *pPoint = pReq->points + p;
+    ts[rows] = pPoint->timestamp;
+
+    for (int32_t f = 0; f < pPoint->numOfFields; ++f) {
+      SInfluxPair *    pair = pReq->pairs + pPoint->fieldStart + f;
+      TAOS_MULTI_BIND *b = pBind->params + pBind->binds[pair->col] + 1;
+      b->is_null[rows] = 0;
+
+      switch (pair->type) {
+        case TSDB_DATA_TYPE_BINARY:
+          memcpy((char *)b->buffer + rows * b->buffer_length, pair->str, (size_t)pair->len);
+          b->length[rows] = pair->len;
+          break;
+        case TSDB_DATA_TYPE_BIGINT:
+          ((int64_t *)b->buffer)[rows] = pair->v.i;
+          break;
+        case TSDB_DATA_TYPE_BOOL:
+          ((int8_t *)b->buffer)[rows] = (int8_t)pair->v.i;
+          break;
+        default:
+          ((double *)b->buffer)[rows] = pair->v.d;
+          break;
+      }
+    }
+  }
+
+  for (int32_t c = 0; c <= pBind->numOfCols; ++c) {
+    pBind->params[c].num = rows;
+  }
+
+  *point = p;
+  return rows;
+}
+
+static bool influxIsTableKnown(SInfluxReq *pReq, SInfluxSeries *pSeries) {
+  char    key[TSDB_DB_NAME_LEN + TSDB_TABLE_NAME_LEN];
+  int32_t keyLen = snprintf(key, sizeof(key), "%s.%s", pReq->db, pSeries->name);
+
+  pthread_mutex_lock(&influxMutex);
+  bool known = (taosHashGet(influxTables, key, keyLen) != NULL);
+  pthread_mutex_unlock(&influxMutex);
+  return known;
+}
+
+static void influxSaveTable(SInfluxReq *pReq, SInfluxSeries *pSeries) {
+  char    key[TSDB_DB_NAME_LEN + TSDB_TABLE_NAME_LEN];
+  int32_t keyLen = snprintf(key, sizeof(key), "%s.%s", pReq->db, pSeries->name);
+  int8_t  known = 1;
+
+  pthread_mutex_lock(&influxMutex);
+  taosHashPut(influxTables, key, keyLen, &known, sizeof(int8_t));
+  pthread_mutex_unlock(&influxMutex);
+}
+
+/*
+ * The child table is created by preparing an insert with its tags, which lists the tags by name, so they do not
+ * depend on the order of the tags in the stable.
+ */
+static int32_t influxCreateTable(SInfluxReq *pReq, SInfluxSeries *pSeries, SInfluxBind *pBind) {
+  TAOS_STMT *stmt = taos_stmt_init(pReq->taos);
+  if (stmt == NULL) return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+
+  char *  sql = influxBuildInsertSql(pReq, pSeries, pBind, true);
+  int32_t code = (sql == NULL) ? TSDB_CODE_HTTP_NO_ENOUGH_MEMORY : taos_stmt_prepare(stmt, sql, 0);
+  httpDebug("context:%p, fd:%d, code:%s, create table by sql:%s", pReq->pContext, pReq->pContext->fd,
+            tstrerror(code), sql);
+
+  tfree(sql);
+  taos_stmt_close(stmt);
+  return code;
+}
+
+static int32_t influxSetTable(SInfluxReq *pReq, TAOS_STMT *stmt, bool prepared, SInfluxSeries *pSeries,
+                              SInfluxBind *pBind) {
+  if (!influxIsTableKnown(pReq, pSeries)) {
+    int32_t code = influxCreateTable(pReq, pSeries, pBind);
+    if (code != TSDB_CODE_SUCCESS) return code;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (prepared) {
+    char name[TSDB_DB_NAME_LEN + TSDB_TABLE_NAME_LEN];
+    snprintf(name, sizeof(name), "%s.%s", pReq->db, pSeries->name);
+    code = taos_stmt_set_tbname(stmt, name);
+  } else {
+    char *sql = influxBuildInsertSql(pReq, pSeries, pBind, false);
+    code = (sql == NULL) ? TSDB_CODE_HTTP_NO_ENOUGH_MEMORY : taos_stmt_prepare(stmt, sql, 0);
+    tfree(sql);
+  }
+
+  if (code == TSDB_CODE_SUCCESS) influxSaveTable(pReq, pSeries);
+  return code;
+}
+
+/*
+ * The tables of a stable share one prepared statement, so the rows of all of them are merged into one submit
+ * block per vgroup. The statement is executed whenever INFLUX_SUBMIT_BYTES of rows are bound, or a table is about
+ * to exceed the rows of a data block.
+ */
+static int32_t influxInsertStable(SInfluxReq *pReq, SInfluxStable *pStable) {
+  SInfluxBind bind = {0};
+  int32_t     code = influxInitBind(pReq, pStable, &bind);
+  if (code != TSDB_CODE_SUCCESS) {
+    influxFreeBind(&bind);
+    return code;
+  }
+
+  TAOS_STMT *stmt = taos_stmt_init(pReq->taos);
+  if (stmt == NULL) {
+    influxFreeBind(&bind);
+    return TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+  }
+
+  bool    prepared = false;
+  int32_t boundRows = 0;
+  for (int32_t s = pStable->firstSeries; s >= 0 && code == TSDB_CODE_SUCCESS; s = pReq->series[s].next) {
+    SInfluxSeries *pSeries = pReq->series + s;
+    code = influxSetTable(pReq, stmt, prepared, pSeries, &bind);
+    if (code != TSDB_CODE_SUCCESS) {
+      httpError("context:%p, fd:%d, failed to set table %s.%s, reason:%s", pReq->pContext, pReq->pContext->fd,
+                pReq->db, pSeries->name, tstrerror(code));
+      break;
+    }
+    prepared = true;
+
+    int32_t tableRows = 0;
+    for (int32_t p = pSeries->firstPoint; p >= 0 && code == TSDB_CODE_SUCCESS;) {
+      int32_t rows = influxFillBind(pReq, &bind, &p);
+
+      bool full = (boundRows + rows) * (int64_t)bind.rowBytes > INFLUX_SUBMIT_BYTES || tableRows + rows >= INT16_MAX;
+      if (full && boundRows > 0) {
+        code = taos_stmt_execute(stmt);
+        boundRows = tableRows = 0;
+        if (code != TSDB_CODE_SUCCESS) break;
+      }
+
+      code = taos_stmt_bind_param_batch(stmt, bind.params);
+      boundRows += rows;
+      tableRows += rows;
+    }
+  }
+
+  if (code == TSDB_CODE_SUCCESS && boundRows > 0) {
+    code = taos_stmt_execute(stmt);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    httpError("context:%p, fd:%d, failed to insert into stable %s.%s, reason:%s", pReq->pContext, pReq->pContext->fd,
+              pReq->db, pStable->name, tstrerror(code));
+  }
+
+  taos_stmt_close(stmt);
+  influxFreeBind(&bind);
+  return code;
+}
+
+static int32_t influxWrite(SInfluxReq *pReq) {
+  int32_t code = influxCreateStables(pReq);
+
+  // the database is only created when a stable is found missing in it
+  if (code == TSDB_CODE_MND_DB_NOT_SELECTED || code == TSDB_CODE_MND_INVALID_DB) {
+    char sql[TSDB_DB_NAME_LEN + 64];
+    snprintf(sql, sizeof(sql), "create database if not exists %s", pReq->db);
+    code = influxExecSql(pReq, sql);
+    if (code == TSDB_CODE_SUCCESS) code = influxCreateStables(pReq);
+  }
+
+  for (int32_t s = 0; s < pReq->numOfStables && code == TSDB_CODE_SUCCESS; ++s) {
+    code = influxInsertStable(pReq, pReq->stables + s);
+  }
+
+  return code;
+}
+
+static int32_t influxDecodeParam(char *dst, int32_t size, const char *src, int32_t len) {
+  int32_t n = 0;
+  for (int32_t i = 0; i < len; ++i) {
+    if (n >= size - 1) return -1;
+
+    char c = src[i];
+    if (c == '%' && i + 2 < len && isxdigit((uint8_t)src[i + 1]) && isxdigit((uint8_t)src[i + 2])) {
+      char hex[3] = {src[i + 1], src[i + 2], 0};
+      c = (char)strtol(hex, NULL, 16);
+      i += 2;
+    } else if (c == '+') {
+      c = ' ';
+    }
+    dst[n++] = c;
+  }
+  dst[n] = 0;
+  return n;
+}
+
+static int32_t influxParseUrl(SInfluxReq *pReq, char *db) {
+  HttpContext *pContext = pReq->pContext;
+  HttpParser * pParser = pContext->parser;
+  if (pParser->path[INFLUX_WRITE_URL_POS].pos <= 0) return TSDB_CODE_HTTP_UNSUPPORT_URL;
+
+  char * target = pParser->path[INFLUX_WRITE_URL_POS].str;
+  char * query = strchr(target, '?');
+  size_t len = (query == NULL) ? strlen(target) : (size_t)(query - target);
+  if (len != strlen("write") || strncmp(target, "write", len) != 0) return TSDB_CODE_HTTP_UNSUPPORT_URL;
+
+  pReq->tsMul = 1;
+
+  for (char *p = (query == NULL) ? NULL : query + 1; p != NULL && *p != 0;) {
+    char *  next = strchr(p, '&');
+    int32_t paramLen = (next == NULL) ? (int32_t)strlen(p) : (int32_t)(next - p);
+    char *  eq = memchr(p, '=', (size_t)paramLen);
+    char    val[HTTP_PASSWORD_LEN + TSDB_DB_NAME_LEN];
+
+    if (eq != NULL) {
+      int32_t keyLen = (int32_t)(eq - p);
+      int32_t valLen = influxDecodeParam(val, sizeof(val), eq + 1, paramLen - keyLen - 1);
+
+      if (keyLen == 2 && strncmp(p, "db", 2) == 0) {
+        if (valLen < 0 || valLen >= TSDB_DB_NAME_LEN) return TSDB_CODE_HTTP_IF_DB_INVALID;
+        tstrncpy(db, val, TSDB_DB_NAME_LEN);
+      } else if (keyLen == 9 && strncmp(p, "precision", 9) == 0) {
+        if (strcmp(val, "n") == 0 || strcmp(val, "ns") == 0) {
+          pReq->tsMul = 1;
+        } else if (strcmp(val, "u") == 0 || strcmp(val, "us") == 0) {
+          pReq->tsMul = 1000;
+        } else if (strcmp(val, "ms") == 0) {
+          pReq->tsMul = 1000000;
+        } else if (strcmp(val, "s") == 0) {
+          pReq->tsMul = 1000000000LL;
+        } else if (strcmp(val, "m") == 0) {
+          pReq->tsMul = 60 * 1000000000LL;
+        } else if (strcmp(val, "h") == 0) {
+          pReq->tsMul = 3600 * 1000000000LL;
+        } else {
+          return TSDB_CODE_HTTP_IF_PRECISION_INVALID;
+        }
+      } else if (keyLen == 1 && *p == 'u') {
+        if (valLen <= 0 || valLen >= TSDB_USER_LEN) return TSDB_CODE_HTTP_INVALID_BASIC_AUTH;
+        tstrncpy(pContext->user, val, sizeof(pContext->user));
+      } else if (keyLen == 1 && *p == 'p') {
+        if (valLen <= 0 || valLen >= HTTP_PASSWORD_LEN) return TSDB_CODE_HTTP_INVALID_BASIC_AUTH;
+        tstrncpy(pContext->pass, val, sizeof(pContext->pass));
+      } else {
+      }
+    }
+
+    p = (next == NULL) ? NULL : next + 1;
+  }
+
+  if (db[0] == 0) return TSDB_CODE_HTTP_IF_DB_NOT_INPUT;
+  for (char *c = db; *c != 0; ++c) {
+    if (!isalnum((uint8_t)*c) && *c != '_') return TSDB_CODE_HTTP_IF_DB_INVALID;
+  }
+  pReq->db = db;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static void influxProcessWriteRequest(void *param, void *result, int32_t code, int32_t rows) {
+  HttpContext *pContext = param;
+  char         db[TSDB_DB_NAME_LEN] = {0};
+  SInfluxReq   req = {0};
+  req.pContext = pContext;
+  req.taos = pContext->session->taos;
+
+  code = influxParseUrl(&req, db);
+  if (code == TSDB_CODE_SUCCESS) {
+    req.seriesHash = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+    req.stableHash = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+    if (req.seriesHash == NULL || req.stableHash == NULL) code = TSDB_CODE_HTTP_NO_ENOUGH_MEMORY;
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    code = influxParseBody(&req, pContext->parser->body.str);
+    if (code != TSDB_CODE_SUCCESS) {
+      httpError("context:%p, fd:%d, failed to parse line:%d, reason:%s", pContext, pContext->fd, req.line,
+                tstrerror(code));
+    }
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    influxFreeReq(&req);
+    httpSendErrorResp(pContext, code);
+    return;
+  }
+
+  httpDebug("context:%p, fd:%d, db:%s, points:%d, tables:%d, stables:%d", pContext, pContext->fd, req.db,
+            req.numOfPoints, req.numOfSeries, req.numOfStables);
+
+  if (req.numOfPoints > 0) {
+    int8_t precision = TSDB_TIME_PRECISION_MILLI;
+    code = influxGetPrecision(&req, &precision);
+    if (code == TSDB_CODE_SUCCESS) {
+      code = influxConvertTimestamps(&req, precision);
+      if (code == TSDB_CODE_HTTP_IF_TIMESTAMP_COLLIDED) {
+        influxFreeReq(&req);
+        httpSendErrorResp(pContext, code);
+        return;
+      }
+    }
+    if (code == TSDB_CODE_SUCCESS) code = influxWrite(&req);
+    if (code != TSDB_CODE_SUCCESS) {
+      // the cached schemas or tables may be stale, they are reloaded by the next request
+      httpError("context:%p, fd:%d, failed to write db:%s, reason:%s", pContext, pContext->fd, req.db,
+                tstrerror(code));
+      influxClearSchemas();
+    }
+  }
+
+  influxFreeReq(&req);
+  influxSendResp(pContext, code);
+  httpCloseContextByApp(pContext);
+}
+
+void influxExecuteRequest(struct HttpContext *pContext) {
+  httpDispatchToResultQueue(pContext, NULL, TSDB_CODE_SUCCESS, 0, influxProcessWriteRequest);
+}
+
+bool influxProcessRequest(struct HttpContext *pContext) {
+  char       db[TSDB_DB_NAME_LEN] = {0};
+  SInfluxReq req = {0};
+  req.pContext = pContext;
+
+  int32_t code = influxParseUrl(&req, db);
+  if (code != TSDB_CODE_SUCCESS) {
+    httpSendErrorResp(pContext, code);
+    return false;
+  }
+
+  if (strlen(pContext->user) == 0 || strlen(pContext->pass) == 0) {
+    httpSendErrorResp(pContext, TSDB_CODE_HTTP_NO_AUTH_INFO);
+    return false;
+  }
+
+  if (pContext->parser->body.str == NULL) {
+    httpSendErrorResp(pContext, TSDB_CODE_HTTP_NO_MSG_INPUT);
+    return false;
+  }
+
+  // the points are parsed and written by a worker of the result queue once the session is ready
+  pContext->reqType = HTTP_REQTYPE_NATIVE;
+  return true;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taosmsg.h"
+#include "httpLog.h"
+#include "httpJson.h"
+#include "httpResp.h"
+#include "httpInfluxHandle.h"
+#include "httpInfluxJson.h"
+
+/*
+ * influxdb clients take 204 as success and retry on 5xx, the context is closed by the caller
+ */
+void influxSendResp(HttpContext *pContext, int32_t code) {
+  char    head[512] = {0};
+  char    body[512] = {0};
+  int32_t headLen = 0;
+  int32_t bodyLen = 0;
+
+  int8_t httpVersion = pContext->parser->httpVersion;
+  int8_t keepAlive = pContext->parser->keepAlive;
+
+  if (code == TSDB_CODE_SUCCESS) {
+    headLen = sprintf(head, httpRespTemplate[HTTP_RESPONSE_NO_CONTENT], httpVersionStr[httpVersion],
+                      httpKeepAliveStr[keepAlive]);
+  } else {
+    bodyLen = sprintf(body, httpRespTemplate[HTTP_RESPONSE_JSON_ERROR], code & 0XFFFF, tstrerror(code));
+    headLen = sprintf(head, httpRespTemplate[HTTP_RESPONSE_ERROR], httpVersionStr[httpVersion], 500,
+                      httpGetStatusDesc(500), httpKeepAliveStr[keepAlive], bodyLen);
+  }
+
+  httpWriteBuf(pContext, head, headLen);
+  if (bodyLen > 0) httpWriteBuf(pContext, body, bodyLen);
+}
@@ -355,6 +355,16 @@ void httpProcessHeartBeatCmd(HttpContext *pContext) {
   httpCloseContextByApp(pContext);
 }
 
+void httpProcessNativeCmd(HttpContext *pContext) {
+  HttpDecodeMethod *decode = pContext->decodeMethod;
+  if (decode->fpExecute == NULL) {
+    httpSendErrorResp(pContext, TSDB_CODE_HTTP_UNSUPPORT_URL);
+    return;
+  }
+
+  (*decode->fpExecute)(pContext);
+}
+
 void httpExecCmd(HttpContext *pContext) {
   switch (pContext->reqType) {
     case HTTP_REQTYPE_LOGIN:
@@ -369,6 +379,9 @@ void httpExecCmd(HttpContext *pContext) {
     case HTTP_REQTYPE_HEARTBEAT:
       httpProcessHeartBeatCmd(pContext);
       break;
+    case HTTP_REQTYPE_NATIVE:
+      httpProcessNativeCmd(pContext);
+      break;
     case HTTP_REQTYPE_OTHERS:
       httpCloseContextByApp(pContext);
       break;
@@ -30,6 +30,7 @@
 #include "httpGcHandle.h"
 #include "httpRestHandle.h"
 #include "httpTgHandle.h"
+#include "httpInfluxHandle.h"
 
 #ifndef _ADMIN
 void adminInitHandle(HttpServer* pServer) {}
@@ -51,6 +52,7 @@ int32_t httpInitSystem() {
   adminInitHandle(&tsHttpServer);
   gcInitHandle(&tsHttpServer);
   tgInitHandle(&tsHttpServer);
+  influxInitHandle(&tsHttpServer);
   opInitHandle(&tsHttpServer);
 
   return 0;
@@ -96,6 +98,7 @@ void httpStopSystem() {
   shutdown(tsHttpServer.fd, SHUT_RD);
 #endif
   tgCleanupHandle();
+  influxCleanupHandle();
 }
 
 void httpCleanUpSystem() {
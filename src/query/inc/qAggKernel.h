@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QAGGKERNEL_H
+#define TDENGINE_QAGGKERNEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/*
+ * Aggregate kernels on the data of one column block. The null values are skipped, and so are the rows that are not
+ * selected when the row selection sel is not NULL. The return value is the number of values that are aggregated.
+ */
+
+// pSum is int64_t for signed integers, uint64_t for unsigned integers and double for float/double
+int32_t aggSumBlock(const char *pData, int16_t type, int32_t numOfRows, bool hasNull, const int8_t *sel, void *pSum);
+
+// the same as aggSumBlock, but the sum is accumulated in double
+int32_t aggSumDoubleBlock(const char *pData, int16_t type, int32_t numOfRows, bool hasNull, const int8_t *sel,
+                          double *pSum);
+
+// pVal is the minimum/maximum value of the block in the column type. pIndex, if not NULL, is set to the position of
+// the first maximum value or the last minimum value.
+int32_t aggMinMaxBlock(const char *pData, int16_t type, int32_t numOfRows, bool hasNull, const int8_t *sel, bool isMin,
+                       void *pVal, int32_t *pIndex);
+
+// sum of (x - avg)^2
+int32_t aggSquareDiffBlock(const char *pData, int16_t type, int32_t numOfRows, bool hasNull, const int8_t *sel,
+                           double avg, double *pRes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QAGGKERNEL_H
@@ -94,6 +94,10 @@ extern "C" {
 #define TSDB_FUNCTIONS_NAME_MAX_LENGTH 16
 #define TSDB_AVG_FUNCTION_INTER_BUFFER_SIZE 50
 
+// the algorithm of apercentile, denoted by the optional third parameter
+#define TSDB_APERCT_ALGO_DEFAULT  0  // streaming histogram
+#define TSDB_APERCT_ALGO_TDIGEST  1
+
 #define DATA_SET_FLAG ','  // to denote the output area has data, not null value
 #define DATA_SET_FLAG_SIZE sizeof(DATA_SET_FLAG)
 
@@ -181,6 +185,7 @@ typedef struct SQLFunctionCtx {
   bool         stableQuery;
   int16_t      functionId;   // function id
   void *       aInputElemBuf;
+  int8_t *     pFilterRes;            // row selection of the input block, NULL if all rows are selected
   char *       aOutputBuf;            // final result output buffer, point to sdata->data
   uint8_t      currentStage;          // record current running step, default: 0
   int64_t      nStartQueryTimestamp;  // timestamp range of current query when function is executed on a specific data block
@@ -252,6 +257,15 @@ extern int32_t functionCompatList[]; // compatible check array list
 
 bool topbot_datablock_filter(SQLFunctionCtx *pCtx, int32_t functionId, const char *minval, const char *maxval);
 
+/**
+ * merge the intermediate result that is generated by another scan of the same group, or by another pane of the same
+ * time window, into the output buffer of pCtx, only available for the functions that isIntermediateMergeable returns
+ * true. The result cell of the input is required, since the intermediate result of normal table query may be kept in
+ * its interBuf.
+ */
+bool isIntermediateMergeable(int32_t functionId);
+void mergeIntermediateResult(SQLFunctionCtx *pCtx, const char *pInput, const SResultRowCellInfo *pInputInfo);
+
 /**
  * the numOfRes should be kept, since it may be used later
  * and allow the ResultInfo to be re initialized
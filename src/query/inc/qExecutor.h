@@ -31,6 +31,8 @@
 
 struct SColumnFilterElem;
 typedef bool (*__filter_func_t)(struct SColumnFilterElem* pFilter, const char* val1, const char* val2, int16_t type);
+typedef void (*__filter_block_func_t)(struct SColumnFilterElem* pFilter, const char* pData, int32_t numOfRows,
+                                      int16_t type, int8_t* p);
 typedef int32_t (*__block_search_fn_t)(char* data, int32_t num, int64_t key, int32_t order);
 
 typedef struct SResultRowPool {
@@ -92,9 +94,10 @@ typedef struct SResultRowInfo {
 } SResultRowInfo;
 
 typedef struct SColumnFilterElem {
-  int16_t           bytes;  // column length
-  __filter_func_t   fp;
-  SColumnFilterInfo filterInfo;
+  int16_t               bytes;    // column length
+  __filter_func_t       fp;
+  __filter_block_func_t blockFp;  // evaluate the filter on all rows of a data block
+  SColumnFilterInfo     filterInfo;
 } SColumnFilterElem;
 
 typedef struct SSingleColumnFilterInfo {
@@ -130,6 +133,7 @@ typedef struct SQueryCostInfo {
   uint32_t loadBlocks;
   uint32_t loadBlockStatis;
   uint32_t discardBlocks;
+  uint32_t skipBlocks;      // blocks skipped by the column filters on their statistics without being loaded
   uint64_t elapsedTime;
   uint64_t firstStageMergeTime;
   uint64_t winInfoSize;
@@ -153,6 +157,7 @@ typedef struct SQuery {
   int16_t          numOfOutput;
   int16_t          fillType;
   int16_t          checkResultBuf;  // check if the buffer is full during scan each block
+  bool             rollup;          // the file groups may be read as the rollups of the time buckets of tsdb
   SLimitVal        limit;
   int32_t          rowSize;
   SSqlGroupbyExpr* pGroupbyExpr;
@@ -208,6 +213,9 @@ typedef struct SQueryRuntimeEnv {
   char**               nextRow;
 
   SArithmeticSupport  *sasArray;
+
+  int8_t*              pFilterRes;       // row selection of the current data block, 1 for the qualified row
+  int32_t              filterResCap;     // capacity of the row selection buffer
 } SQueryRuntimeEnv;
 
 enum {
@@ -242,6 +250,7 @@ typedef struct SQInfo {
   void*            rspContext;  // response context
   int64_t          startExecTs; // start to exec timestamp
   char*            sql;         // query sql string
+  struct SQInfo*   pParent;     // the query that a parallel scan worker belongs to
 } SQInfo;
 
 #endif  // TDENGINE_QUERYEXECUTOR_H
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_HYPERLOGLOG_H
+#define TDENGINE_HYPERLOGLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HLL_MIN_PRECISION     4
+#define HLL_MAX_PRECISION     13   // the sketch of a super table query is carried in a row of at most 16KB
+#define HLL_DEFAULT_PRECISION 12   // 4096 registers, the standard error is about 1.6%
+
+/*
+ * The sketch is kept in a flat buffer of sizeof(SHLLInfo) + (1 << precision) bytes, so it can be transferred as the
+ * intermediate result of super table query, and the sketches of the same precision are merged by the register max.
+ */
+typedef struct SHLLInfo {
+  int8_t  precision;
+  int8_t  hasResult;
+  uint8_t registers[];
+} SHLLInfo;
+
+int32_t tHllSketchSize(int32_t precision);
+void    tHllInit(SHLLInfo* pInfo, int32_t precision);
+
+void     tHllAdd(SHLLInfo* pInfo, const void* pData, int32_t len);
+void     tHllMerge(SHLLInfo* pDst, const SHLLInfo* pSrc);
+uint64_t tHllEstimate(const SHLLInfo* pInfo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_HYPERLOGLOG_H
@@ -29,7 +29,7 @@ extern "C" {
 typedef struct SArray* SIDList;
 
 typedef struct SPageDiskInfo {
-  int32_t offset;
+  int64_t offset;
   int32_t length;
 } SPageDiskInfo;
 
@@ -39,19 +39,23 @@ typedef struct SPageInfo {
   SPageDiskInfo info;
   void*         pData;
   bool          used;     // set current page is in used
+  bool          compressed;  // the page content on disk is compressed
 } SPageInfo;
 
 typedef struct SFreeListItem {
-  int32_t offset;
-  int32_t len;
+  int64_t offset;
+  int64_t len;
 } SFreeListItem;
 
 typedef struct SResultBufStatis {
-  int32_t flushBytes;
-  int32_t loadBytes;
+  int64_t flushBytes;     // bytes written to disk
+  int64_t rawFlushBytes;  // bytes of the flushed pages before compression
+  int64_t loadBytes;
   int32_t getPages;
   int32_t releasePages;
   int32_t flushPages;
+  int32_t compPages;      // flushed pages that are stored compressed
+  int32_t loadPages;
 } SResultBufStatis;
 
 typedef struct SDiskbasedResultBuf {
@@ -69,9 +73,9 @@ typedef struct SDiskbasedResultBuf {
   SList*    lruList;
   void*     emptyDummyIdList;    // dummy id list
   void*     assistBuf;           // assistant buffer for compress/decompress data
-  SArray*   pFree;               // free area in file
+  SArray*   pFree;               // SFreeListItem of the free areas in file, ordered by offset
   bool      comp;                // compressed before flushed to disk
-  int32_t   nextPos;             // next page flush position
+  int64_t   nextPos;             // end of the used area in file
 
   const void*      handle;       // for debug purpose
   SResultBufStatis statis;
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TDIGEST_H
+#define TDENGINE_TDIGEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TDIGEST_COMPRESSION   250
+#define TDIGEST_MAX_CENTROIDS TDIGEST_COMPRESSION
+#define TDIGEST_BUFFER_SIZE   TDIGEST_COMPRESSION
+
+typedef struct SCentroid {
+  double  mean;
+  int64_t weight;
+} SCentroid;
+
+/*
+ * merging t-digest, which is kept in one flat buffer without any pointers, so it can be transferred as the
+ * intermediate result directly. The newly added points are collected in the buffer, and merged into the
+ * centroids when the buffer is full, or before the quantile is calculated.
+ */
+typedef struct STDigest {
+  int64_t   totalWeight;
+  double    min;
+  double    max;
+  int32_t   numOfCentroids;
+  int32_t   numOfBuffered;
+  SCentroid centroids[TDIGEST_MAX_CENTROIDS];
+  SCentroid buffered[TDIGEST_BUFFER_SIZE];
+} STDigest;
+
+void tDigestInit(STDigest* pDigest);
+
+void tDigestAdd(STDigest* pDigest, double val, int64_t weight);
+void tDigestCompress(STDigest* pDigest);
+void tDigestMerge(STDigest* pDst, const STDigest* pSrc);
+
+double tDigestQuantile(STDigest* pDigest, double q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TDIGEST_H
@@ -15,6 +15,10 @@
 #ifndef TDENGINE_QUERYUTIL_H
 #define TDENGINE_QUERYUTIL_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define SET_RES_WINDOW_KEY(_k, _ori, _len, _uid)     \
   do {                                               \
     assert(sizeof(_uid) == sizeof(uint64_t));        \
@@ -64,6 +68,11 @@ bool isNullOperator(SColumnFilterElem *pFilter, const char* minval, const char*
 bool notNullOperator(SColumnFilterElem *pFilter, const char* minval, const char* maxval, int16_t type);
 
 __filter_func_t getFilterOperator(int32_t lowerOptr, int32_t upperOptr);
+__filter_block_func_t getBlockFilterOperator(int32_t lowerOptr, int32_t upperOptr);
+
+void    filterBitmapAnd(int8_t *dst, const int8_t *src, int32_t numOfRows);
+void    filterBitmapOr(int8_t *dst, const int8_t *src, int32_t numOfRows);
+int32_t doFilterDataBlock(SSingleColumnFilterInfo *pFilterInfo, int32_t numOfFilterCols, int32_t numOfRows, int8_t *p);
 
 SResultRowPool* initResultRowPool(size_t size);
 SResultRow* getNewResultRow(SResultRowPool* p);
@@ -74,5 +83,8 @@ int32_t getNumOfUsedResultRows(SResultRowPool* p);
 
 bool isPointInterpoQuery(SQuery *pQuery);
 
+#ifdef __cplusplus
+}
+#endif
 
 #endif  // TDENGINE_QUERYUTIL_H
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "qAggKernel.h"
+#include "taosdef.h"
+#include "ttype.h"
+
+/*
+ * The kernels keep AGG_LANES independent accumulators and select the value with the null/selection mask instead of
+ * branching on it, so the compiler turns each loop into SIMD instructions, including the float/double sums that are
+ * not reassociated otherwise. On x86_64 linux every kernel is also compiled for AVX2 and picked at load time.
+ */
+#if defined(__x86_64__) && defined(_TD_LINUX_64)
+#define AGG_KERNEL static __attribute__((target_clones("avx2", "default")))
+#else
+#define AGG_KERNEL static
+#endif
+
+#define AGG_LANES 8
+
+#define AGG_NO_MASK(k)           1
+#define AGG_NULL_MASK(k)         (u[k] != nullVal)
+#define AGG_SEL_NULL_MASK(k)     ((sel[k] != 0) & (u[k] != nullVal))
+
+#define AGG_SUM_LOOP(_R, _MASK, _EXPR, _sum, _num)          \
+  do {                                                     \
+    _R      _acc[AGG_LANES] = {0};                         \
+    int32_t _cnt[AGG_LANES] = {0};                         \
+    int32_t _i = 0;                                        \
+    for (; _i + AGG_LANES <= numOfRows; _i += AGG_LANES) { \
+      for (int32_t _j = 0; _j < AGG_LANES; ++_j) {         \
+        int32_t _m = _MASK(_i + _j);                       \
+        _acc[_j] += _m ? (_EXPR(_i + _j)) : 0;             \
+        _cnt[_j] += _m;                                    \
+      }                                                    \
+    }                                                      \
+    for (; _i < numOfRows; ++_i) {                         \
+      int32_t _m = _MASK(_i);                              \
+      _acc[0] += _m ? (_EXPR(_i)) : 0;                     \
+      _cnt[0] += _m;                                       \
+    }                                                      \
+    for (int32_t _j = 0; _j < AGG_LANES; ++_j) {           \
+      (_sum) += _acc[_j];                                  \
+      (_num) += _cnt[_j];                                  \
+    }                                                      \
+  } while (0)
+
+#define AGG_MINMAX_LOOP(_T, _MASK, _OP, _init, _best, _num) \
+  do {                                                     \
+    _T      _acc[AGG_LANES];                               \
+    int32_t _cnt[AGG_LANES] = {0};                         \
+    for (int32_t _j = 0; _j < AGG_LANES; ++_j) {           \
+      _acc[_j] = (_init);                                  \
+    }                                                      \
+    int32_t _i = 0;                                        \
+    for (; _i + AGG_LANES <= numOfRows; _i += AGG_LANES) { \
+      for (int32_t _j = 0; _j < AGG_LANES; ++_j) {         \
+        int32_t _m = _MASK(_i + _j);                       \
+        _T      _v = _m ? p[_i + _j] : (_init);            \
+        _acc[_j] = (_v _OP _acc[_j]) ? _v : _acc[_j];      \
+        _cnt[_j] += _m;                                    \
+      }                                                    \
+    }                                                      \
+    for (; _i < numOfRows; ++_i) {                         \
+      int32_t _m = _MASK(_i);                              \
+      _T      _v = _m ? p[_i] : (_init);                   \
+      _acc[0] = (_v _OP _acc[0]) ? _v : _acc[0];           \
+      _cnt[0] += _m;                                       \
+    }                                                      \
+    for (int32_t _j = 0; _j < AGG_LANES; ++_j) {           \
+      (_best) = (_acc[_j] _OP (_best)) ? _acc[_j] : (_best); \
+      (_num) += _cnt[_j];                                  \
+    }                                                      \
+  } while (0)
+
+#define AGG_VALUE(k)       (p[k])
+#define AGG_SQUARE_DIFF(k) ((p[k] - avg) * (p[k] - avg))
+
+#define DEFINE_SUM_KERNEL(_name, _T, _U, _NULL, _R)                                                             \
+  AGG_KERNEL int32_t _name(const char *pData, int32_t numOfRows, bool hasNull, const int8_t *sel, _R *pSum) { \
+    const _T *p = (const _T *)pData;                                                                         \
+    const _U *u = (const _U *)pData;                                                                         \
+    const _U  nullVal = (_U)(_NULL);                                                                         \
+    _R        sum = 0;                                                                                       \
+    int32_t   num = 0;                                                                                       \
+    if (sel != NULL) {                                                                                       \
+      AGG_SUM_LOOP(_R, AGG_SEL_NULL_MASK, AGG_VALUE, sum, num);                                              \
+    } else if (hasNull) {                                                                                    \
+      AGG_SUM_LOOP(_R, AGG_NULL_MASK, AGG_VALUE, sum, num);                                                  \
+    } else {                                                                                                 \
+      AGG_SUM_LOOP(_R, AGG_NO_MASK, AGG_VALUE, sum, num);                                                    \
+    }                                                                                                        \
+    *pSum += sum;                                                                                            \
+    return num;                                                                                              \
+  }
+
+#define DEFINE_SQUARE_DIFF_KERNEL(_name, _T, _U, _NULL)                                                       \
+  AGG_KERNEL int32_t _name(const char *pData, int32_t numOfRows, bool hasNull, const int8_t *sel, double avg, \
+                           double *pRes) {                                                                    \
+    const _T *p = (const _T *)pData;                                                                          \
+    const _U *u = (const _U *)pData;                                                                          \
+    const _U  nullVal = (_U)(_NULL);                                                                          \
+    double    res = 0;                                                                                        \
+    int32_t   num = 0;                                                                                        \
+    if (sel != NULL) {                                                                                        \
+      AGG_SUM_LOOP(double, AGG_SEL_NULL_MASK, AGG_SQUARE_DIFF, res, num);                                     \
+    } else if (hasNull) {                                                                                     \
+      AGG_SUM_LOOP(double, AGG_NULL_MASK, AGG_SQUARE_DIFF, res, num);                                         \
+    } else {                                                                                                  \
+      AGG_SUM_LOOP(double, AGG_NO_MASK, AGG_SQUARE_DIFF, res, num);                                           \
+    }                                                                                                         \
+    *pRes += res;                                                                                             \
+    return num;                                                                                               \
+  }
+
+// the first maximum value or the last minimum value, the same one that is kept by the row by row update
+#define AGG_FIND_INDEX(_MASK, _isMin, _best, _index)   \
+  do {                                                 \
+    for (int32_t _i = 0; _i < numOfRows; ++_i) {       \
+      if (_MASK(_i) && p[_i] == (_best)) {             \
+        (_index) = _i;                                 \
+        if (!(_isMin)) break;                          \
+      }                                                \
+    }                                                  \
+  } while (0)
+
+#define DEFINE_MINMAX_KERNEL(_name, _T, _U, _NULL, _OP, _init, _isMin)                                         \
+  AGG_KERNEL int32_t _name(const char *pData, int32_t numOfRows, bool hasNull, const int8_t *sel, _T *pVal,   \
+                           int32_t *pIndex) {                                                                \
+    const _T *p = (const _T *)pData;                                                                         \
+    const _U *u = (const _U *)pData;                                                                         \
+    const _U  nullVal = (_U)(_NULL);                                                                         \
+    _T        best = (_init);                                                                                \
+    int32_t   num = 0;                                                                                       \
+    if (sel != NULL) {                                                                                       \
+      AGG_MINMAX_LOOP(_T, AGG_SEL_NULL_MASK, _OP, _init, best, num);                                         \
+    } else if (hasNull) {                                                                                    \
+      AGG_MINMAX_LOOP(_T, AGG_NULL_MASK, _OP, _init, best, num);                                             \
+    } else {                                                                                                 \
+      AGG_MINMAX_LOOP(_T, AGG_NO_MASK, _OP, _init, best, num);                                               \
+    }                                                                                                        \
+    if (num == 0) {                                                                                          \
+      return 0;                                                                                              \
+    }                                                                                                        \
+    *pVal = best;                                                                                            \
+    if (pIndex != NULL) {                                                                                    \
+      if (sel != NULL) {                                                                                     \
+        AGG_FIND_INDEX(AGG_SEL_NULL_MASK, _isMin, best, *pIndex);                                            \
+      } else {                                                                                               \
+        AGG_FIND_INDEX(AGG_NULL_MASK, _isMin, best, *pIndex);                                                \
+      }                                                                                                      \
+    }                                                                                                        \
+    return num;                                                                                              \
+  }
+
+#define DEFINE_TYPE_KERNELS(_suffix, _T, _U, _NULL, _R, _MIN, _MAX)                      \
+  DEFINE_SUM_KERNEL(sum_##_suffix, _T, _U, _NULL, _R)                                    \
+  DEFINE_SQUARE_DIFF_KERNEL(squareDiff_##_suffix, _T, _U, _NULL)                         \
+  DEFINE_MINMAX_KERNEL(min_##_suffix, _T, _U, _NULL, <, _MAX, true)                      \
+  DEFINE_MINMAX_KERNEL(max_##_suffix, _T, _U, _NULL, >, _MIN, false)
+
+DEFINE_TYPE_KERNELS(i8, int8_t, uint8_t, TSDB_DATA_TINYINT_NULL, int64_t, INT8_MIN, INT8_MAX)
+DEFINE_TYPE_KERNELS(u8, uint8_t, uint8_t, TSDB_DATA_UTINYINT_NULL, uint64_t, 0, UINT8_MAX)
+DEFINE_TYPE_KERNELS(i16, int16_t, uint16_t, TSDB_DATA_SMALLINT_NULL, int64_t, INT16_MIN, INT16_MAX)
+DEFINE_TYPE_KERNELS(u16, uint16_t, uint16_t, TSDB_DATA_USMALLINT_NULL, uint64_t, 0, UINT16_MAX)
+DEFINE_TYPE_KERNELS(i32, int32_t, uint32_t, TSDB_DATA_INT_NULL, int64_t, INT32_MIN, INT32_MAX)
+DEFINE_TYPE_KERNELS(u32, uint32_t, uint32_t, TSDB_DATA_UINT_NULL, uint64_t, 0, UINT32_MAX)
+DEFINE_TYPE_KERNELS(i64, int64_t, uint64_t, TSDB_DATA_BIGINT_NULL, int64_t, INT64_MIN, INT64_MAX)
+DEFINE_TYPE_KERNELS(u64, uint64_t, uint64_t, TSDB_DATA_UBIGINT_NULL, uint64_t, 0, UINT64_MAX)
+DEFINE_TYPE_KERNELS(flt, float, uint32_t, TSDB_DATA_FLOAT_NULL, double, -FLT_MAX, FLT_MAX)
+DEFINE_TYPE_KERNELS(dbl, double, uint64_t, TSDB_DATA_DOUBLE_NULL, double, -DBL_MAX, DBL_MAX)
+
+// 64 bits integers are accumulated in double directly, in case of overflow
+DEFINE_SUM_KERNEL(sumDouble_i64, int64_t, uint64_t, TSDB_DATA_BIGINT_NULL, double)
+DEFINE_SUM_KERNEL(sumDouble_u64, uint64_t, uint64_t, TSDB_DATA_UBIGINT_NULL, double)
+
+int32_t aggSumBlock(const char *pData, int16_t type, int32_t numOfRows, bool hasNull, const int8_t *sel, void *pSum) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT: return sum_i8(pData, numOfRows, hasNull, sel, pSum);
+    case TSDB_DATA_TYPE_UTINYINT: return sum_u8(pData, numOfRows, hasNull, sel, pSum);
+    case TSDB_DATA_TYPE_SMALLINT: return sum_i16(pData, numOfRows, hasNull, sel, pSum);
+    case TSDB_DATA_TYPE_USMALLINT: return sum_u16(pData, numOfRows, hasNull, sel, pSum);
+    case TSDB_DATA_TYPE_INT: return sum_i32(pData, numOfRows, hasNull, sel, pSum);
+    case TSDB_DATA_TYPE_UINT: return sum_u32(pData, numOfRows, hasNull, sel, pSum);
+    case TSDB_DATA_TYPE_BIGINT: return sum_i64(pData, numOfRows, hasNull, sel, pSum);
+    case TSDB_DATA_TYPE_UBIGINT: return sum_u64(pData, numOfRows, hasNull, sel, pSum);
+    case TSDB_DATA_TYPE_FLOAT: return sum_flt(pData, numOfRows, hasNull, sel, pSum);
+    case TSDB_DATA_TYPE_DOUBLE: return sum_dbl(pData, numOfRows, hasNull, sel, pSum);
+    default: return 0;
+  }
+}
+
+int32_t aggSumDoubleBlock(const char *pData, int16_t type, int32_t numOfRows, bool hasNull, const int8_t *sel,
+                          double *pSum) {
+  int32_t num = 0;
+
+  if (IS_SIGNED_NUMERIC_TYPE(type) && type != TSDB_DATA_TYPE_BIGINT) {
+    int64_t sum = 0;
+    num = aggSumBlock(pData, type, numOfRows, hasNull, sel, &sum);
+    *pSum += sum;
+  } else if (IS_UNSIGNED_NUMERIC_TYPE(type) && type != TSDB_DATA_TYPE_UBIGINT) {
+    uint64_t sum = 0;
+    num = aggSumBlock(pData, type, numOfRows, hasNull, sel, &sum);
+    *pSum += sum;
+  } else if (type == TSDB_DATA_TYPE_BIGINT) {
+    num = sumDouble_i64(pData, numOfRows, hasNull, sel, pSum);
+  } else if (type == TSDB_DATA_TYPE_UBIGINT) {
+    num = sumDouble_u64(pData, numOfRows, hasNull, sel, pSum);
+  } else {
+    num = aggSumBlock(pData, type, numOfRows, hasNull, sel, pSum);
+  }
+
+  return num;
+}
+
+#define AGG_MINMAX_CASE(_type, _suffix)                                            \
+  case _type:                                                                      \
+    return isMin ? min_##_suffix(pData, numOfRows, hasNull, sel, pVal, pIndex)     \
+                 : max_##_suffix(pData, numOfRows, hasNull, sel, pVal, pIndex)
+
+int32_t aggMinMaxBlock(const char *pData, int16_t type, int32_t numOfRows, bool hasNull, const int8_t *sel, bool isMin,
+                       void *pVal, int32_t *pIndex) {
+  switch (type) {
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_TINYINT, i8);
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_UTINYINT, u8);
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_SMALLINT, i16);
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_USMALLINT, u16);
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_INT, i32);
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_UINT, u32);
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_BIGINT, i64);
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_UBIGINT, u64);
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_FLOAT, flt);
+    AGG_MINMAX_CASE(TSDB_DATA_TYPE_DOUBLE, dbl);
+    default:
+      return 0;
+  }
+}
+
+int32_t aggSquareDiffBlock(const char *pData, int16_t type, int32_t numOfRows, bool hasNull, const int8_t *sel,
+                           double avg, double *pRes) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT: return squareDiff_i8(pData, numOfRows, hasNull, sel, avg, pRes);
+    case TSDB_DATA_TYPE_UTINYINT: return squareDiff_u8(pData, numOfRows, hasNull, sel, avg, pRes);
+    case TSDB_DATA_TYPE_SMALLINT: return squareDiff_i16(pData, numOfRows, hasNull, sel, avg, pRes);
+    case TSDB_DATA_TYPE_USMALLINT: return squareDiff_u16(pData, numOfRows, hasNull, sel, avg, pRes);
+    case TSDB_DATA_TYPE_INT: return squareDiff_i32(pData, numOfRows, hasNull, sel, avg, pRes);
+    case TSDB_DATA_TYPE_UINT: return squareDiff_u32(pData, numOfRows, hasNull, sel, avg, pRes);
+    case TSDB_DATA_TYPE_BIGINT: return squareDiff_i64(pData, numOfRows, hasNull, sel, avg, pRes);
+    case TSDB_DATA_TYPE_UBIGINT: return squareDiff_u64(pData, numOfRows, hasNull, sel, avg, pRes);
+    case TSDB_DATA_TYPE_FLOAT: return squareDiff_flt(pData, numOfRows, hasNull, sel, avg, pRes);
+    case TSDB_DATA_TYPE_DOUBLE: return squareDiff_dbl(pData, numOfRows, hasNull, sel, avg, pRes);
+    default: return 0;
+  }
+}
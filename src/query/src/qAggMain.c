@@ -19,16 +19,21 @@
 #include "texpr.h"
 #include "ttype.h"
 
+#include "qAggKernel.h"
 #include "qAggMain.h"
 #include "qFill.h"
 #include "qHistogram.h"
+#include "qHyperLogLog.h"
 #include "qPercentile.h"
+#include "qTDigest.h"
 #include "qTsbuf.h"
 #include "queryLog.h"
 
 #define GET_INPUT_DATA_LIST(x) (((char *)((x)->aInputElemBuf)) + ((x)->startOffset) * ((x)->inputBytes))
 #define GET_INPUT_DATA(x, y) (GET_INPUT_DATA_LIST(x) + (y) * (x)->inputBytes)
 
+#define GET_FILTER_RES(x) (((x)->pFilterRes == NULL) ? NULL : ((x)->pFilterRes + (x)->startOffset))
+
 #define GET_TS_LIST(x)    ((TSKEY*)&((x)->ptsList[(x)->startOffset]))
 #define GET_TS_DATA(x, y) (GET_TS_LIST(x)[(y)])
 
@@ -135,10 +140,16 @@ typedef struct SLeastsquaresInfo {
   int64_t num;
 } SLeastsquaresInfo;
 
+// the histogram or the t-digest is kept right after this struct, according to the algorithm
 typedef struct SAPercentileInfo {
   SHistogramInfo *pHisto;
+  STDigest       *pTDigest;
 } SAPercentileInfo;
 
+#define APERCT_INTER_BUFFER_SIZE                                                                         \
+  (sizeof(SAPercentileInfo) + MAX(sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1), \
+                                  sizeof(STDigest)))
+
 typedef struct STSCompInfo {
   STSBuf *pTSBuf;
 } STSCompInfo;
@@ -244,7 +255,7 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
       return TSDB_CODE_SUCCESS;
     } else if (functionId == TSDB_FUNC_APERCT) {
       *type = TSDB_DATA_TYPE_BINARY;
-      *bytes = sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1) + sizeof(SHistogramInfo) + sizeof(SAPercentileInfo);
+      *bytes = APERCT_INTER_BUFFER_SIZE;
       *interBytes = *bytes;
       
       return TSDB_CODE_SUCCESS;
@@ -259,6 +270,11 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
       *bytes = sizeof(STwaInfo);
       *interBytes = *bytes;
       return TSDB_CODE_SUCCESS;
+    } else if (functionId == TSDB_FUNC_HLL) {
+      *type = TSDB_DATA_TYPE_BINARY;
+      *bytes = (int16_t)tHllSketchSize((param == 0) ? HLL_DEFAULT_PRECISION : param);
+      *interBytes = *bytes;
+      return TSDB_CODE_SUCCESS;
     }
   }
   
@@ -277,14 +293,18 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
   } else if (functionId == TSDB_FUNC_APERCT) {
     *type = TSDB_DATA_TYPE_DOUBLE;
     *bytes = sizeof(double);
-    *interBytes =
-        sizeof(SAPercentileInfo) + sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1);
+    *interBytes = APERCT_INTER_BUFFER_SIZE;
     return TSDB_CODE_SUCCESS;
   } else if (functionId == TSDB_FUNC_TWA) {
     *type = TSDB_DATA_TYPE_DOUBLE;
     *bytes = sizeof(double);
     *interBytes = sizeof(STwaInfo);
     return TSDB_CODE_SUCCESS;
+  } else if (functionId == TSDB_FUNC_HLL) {
+    *type = TSDB_DATA_TYPE_BIGINT;
+    *bytes = sizeof(int64_t);
+    *interBytes = tHllSketchSize((param == 0) ? HLL_DEFAULT_PRECISION : param);
+    return TSDB_CODE_SUCCESS;
   }
   
   if (functionId == TSDB_FUNC_AVG) {
@@ -393,6 +413,15 @@ static void count_function(SQLFunctionCtx *pCtx) {
    */
   if (pCtx->preAggVals.isSet) {
     numOfElem = pCtx->size - pCtx->preAggVals.statis.numOfNull;
+  } else if (pCtx->pFilterRes != NULL) {
+    int8_t *sel = GET_FILTER_RES(pCtx);
+    for (int32_t i = 0; i < pCtx->size; ++i) {
+      if (sel[i] == 0 || (pCtx->hasNull && isNull(GET_INPUT_DATA(pCtx, i), pCtx->inputType))) {
+        continue;
+      }
+
+      numOfElem += 1;
+    }
   } else {
     if (pCtx->hasNull) {
       for (int32_t i = 0; i < pCtx->size; ++i) {
@@ -464,18 +493,6 @@ int32_t no_data_info(SQLFunctionCtx *pCtx, TSKEY start, TSKEY end, int32_t colId
   return BLK_DATA_NO_NEEDED;
 }
 
-#define LIST_ADD_N(x, ctx, p, t, numOfElem, tsdbType)              \
-  do {                                                                \
-    t *d = (t *)(p);                                               \
-    for (int32_t i = 0; i < (ctx)->size; ++i) {                    \
-      if (((ctx)->hasNull) && isNull((char *)&(d)[i], tsdbType)) { \
-        continue;                                                  \
-      };                                                           \
-      (x) += (d)[i];                                               \
-      (numOfElem)++;                                               \
-    }                                                              \
-  } while(0)
-
 #define UPDATE_DATA(ctx, left, right, num, sign, k) \
   do {                                              \
     if (((left) < (right)) ^ (sign)) {              \
@@ -494,22 +511,6 @@ int32_t no_data_info(SQLFunctionCtx *pCtx, TSKEY start, TSKEY end, int32_t colId
     }                                                       \
   } while (0)
 
-#define LOOPCHECK_N(val, list, ctx, tsdbType, sign, num)          \
-  for (int32_t i = 0; i < ((ctx)->size); ++i) {                   \
-    if ((ctx)->hasNull && isNull((char *)&(list)[i], tsdbType)) { \
-      continue;                                                   \
-    }                                                             \
-    TSKEY key = GET_TS_DATA(ctx, i);                              \
-    UPDATE_DATA(ctx, val, (list)[i], num, sign, key);             \
-  }
-
-#define TYPED_LOOPCHECK_N(type, data, list, ctx, tsdbType, sign, notNullElems) \
-  do {                                                                         \
-    type *_data = (type *)data;                                                \
-    type *_list = (type *)list;                                                \
-    LOOPCHECK_N(*_data, _list, ctx, tsdbType, sign, notNullElems);             \
-  } while (0)
-
 static void do_sum(SQLFunctionCtx *pCtx) {
   int32_t notNullElems = 0;
   
@@ -530,39 +531,8 @@ static void do_sum(SQLFunctionCtx *pCtx) {
     }
   } else {  // computing based on the true data block
     void *pData = GET_INPUT_DATA_LIST(pCtx);
-    notNullElems = 0;
-
-    if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-      int64_t *retVal = (int64_t *)pCtx->aOutputBuf;
-
-      if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int8_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int16_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int32_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int64_t, notNullElems, pCtx->inputType);
-      }
-    } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-      uint64_t *retVal = (uint64_t *)pCtx->aOutputBuf;
-
-      if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint8_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint16_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint32_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint64_t, notNullElems, pCtx->inputType);
-      }
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-      double *retVal = (double *)pCtx->aOutputBuf;
-      LIST_ADD_N(*retVal, pCtx, pData, double, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
-      double *retVal = (double *)pCtx->aOutputBuf;
-      LIST_ADD_N(*retVal, pCtx, pData, float, notNullElems, pCtx->inputType);
-    }
+    notNullElems =
+        aggSumBlock(pData, pCtx->inputType, pCtx->size, pCtx->hasNull, GET_FILTER_RES(pCtx), pCtx->aOutputBuf);
   }
   
   // data in the check operation are all null, not output
@@ -764,31 +734,10 @@ static void avg_function(SQLFunctionCtx *pCtx) {
     }
   } else {
     void *pData = GET_INPUT_DATA_LIST(pCtx);
-    
-    if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int8_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int16_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int32_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int64_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-      LIST_ADD_N(*pVal, pCtx, pData, double, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
-      LIST_ADD_N(*pVal, pCtx, pData, float, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UTINYINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint8_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_USMALLINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint16_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint32_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UBIGINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint64_t, notNullElems, pCtx->inputType);
-    }
+    notNullElems = aggSumDoubleBlock(pData, pCtx->inputType, pCtx->size, pCtx->hasNull, GET_FILTER_RES(pCtx), pVal);
   }
   
-  if (!pCtx->hasNull) {
+  if (!pCtx->hasNull && pCtx->pFilterRes == NULL) {
     assert(notNullElems == pCtx->size);
   }
   
@@ -1005,54 +954,35 @@ static void minMax_function(SQLFunctionCtx *pCtx, char *pOutput, int32_t isMin,
     return;
   }
   
-  void  *p = GET_INPUT_DATA_LIST(pCtx);
-  TSKEY *tsList = GET_TS_LIST(pCtx);
+  void   *p = GET_INPUT_DATA_LIST(pCtx);
+  int64_t val = 0;
+  int32_t index = -1;
 
-  *notNullElems = 0;
-  
-  if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-    if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-      TYPED_LOOPCHECK_N(int8_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-      TYPED_LOOPCHECK_N(int16_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-      int32_t *pData = p;
-      int32_t *retVal = (int32_t*) pOutput;
-      
-      for (int32_t i = 0; i < pCtx->size; ++i) {
-        if (pCtx->hasNull && isNull((const char*)&pData[i], pCtx->inputType)) {
-          continue;
-        }
-        
-        if ((*retVal < pData[i]) ^ isMin) {
-          *retVal = pData[i];
-          TSKEY k = tsList[i];
-          
-          DO_UPDATE_TAG_COLUMNS(pCtx, k);
-        }
-        
-        *notNullElems += 1;
-      }
-#if defined(_DEBUG_VIEW)
-      qDebug("max value updated:%d", *retVal);
-#endif
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-      TYPED_LOOPCHECK_N(int64_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    }
-  } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-    if (pCtx->inputType == TSDB_DATA_TYPE_UTINYINT) {
-      TYPED_LOOPCHECK_N(uint8_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_USMALLINT) {
-      TYPED_LOOPCHECK_N(uint16_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UINT) {
-      TYPED_LOOPCHECK_N(uint32_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-      TYPED_LOOPCHECK_N(uint64_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    }
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-    TYPED_LOOPCHECK_N(double, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
-    TYPED_LOOPCHECK_N(float, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
+  // the position of min/max value is required only if the tag columns are updated along with it
+  int32_t *pIndex = (pCtx->tagInfo.numOfTagCols > 0 && pCtx->ptsList != NULL) ? &index : NULL;
+
+  *notNullElems =
+      aggMinMaxBlock(p, pCtx->inputType, pCtx->size, pCtx->hasNull, GET_FILTER_RES(pCtx), isMin, &val, pIndex);
+  if (*notNullElems == 0) {
+    return;
+  }
+
+  TSKEY   key = (index >= 0) ? GET_TS_DATA(pCtx, index) : TSKEY_INITIAL_VAL;
+  int32_t num = 0;
+
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT: UPDATE_DATA(pCtx, *(int8_t *)pOutput, *(int8_t *)&val, num, isMin, key); break;
+    case TSDB_DATA_TYPE_UTINYINT: UPDATE_DATA(pCtx, *(uint8_t *)pOutput, *(uint8_t *)&val, num, isMin, key); break;
+    case TSDB_DATA_TYPE_SMALLINT: UPDATE_DATA(pCtx, *(int16_t *)pOutput, *(int16_t *)&val, num, isMin, key); break;
+    case TSDB_DATA_TYPE_USMALLINT: UPDATE_DATA(pCtx, *(uint16_t *)pOutput, *(uint16_t *)&val, num, isMin, key); break;
+    case TSDB_DATA_TYPE_INT: UPDATE_DATA(pCtx, *(int32_t *)pOutput, *(int32_t *)&val, num, isMin, key); break;
+    case TSDB_DATA_TYPE_UINT: UPDATE_DATA(pCtx, *(uint32_t *)pOutput, *(uint32_t *)&val, num, isMin, key); break;
+    case TSDB_DATA_TYPE_BIGINT: UPDATE_DATA(pCtx, *(int64_t *)pOutput, *(int64_t *)&val, num, isMin, key); break;
+    case TSDB_DATA_TYPE_UBIGINT: UPDATE_DATA(pCtx, *(uint64_t *)pOutput, *(uint64_t *)&val, num, isMin, key); break;
+    case TSDB_DATA_TYPE_FLOAT: UPDATE_DATA(pCtx, *(float *)pOutput, *(float *)&val, num, isMin, key); break;
+    case TSDB_DATA_TYPE_DOUBLE: UPDATE_DATA(pCtx, *(double *)pOutput, *(double *)&val, num, isMin, key); break;
+    default:
+      break;
   }
 }
 
@@ -1265,6 +1195,108 @@ static void max_func_merge(SQLFunctionCtx *pCtx) {
   }
 }
 
+#define MERGE_MINMAX_DATA(_type, _output, _input, _isMin)     \
+  do {                                                        \
+    _type v = *(_type *)(_input);                             \
+    if (((*(_type *)(_output)) < v) ^ (_isMin)) {             \
+      *(_type *)(_output) = v;                                \
+    }                                                         \
+  } while (0)
+
+bool isIntermediateMergeable(int32_t functionId) {
+  return functionId == TSDB_FUNC_COUNT || functionId == TSDB_FUNC_SUM || functionId == TSDB_FUNC_AVG ||
+         functionId == TSDB_FUNC_MIN || functionId == TSDB_FUNC_MAX || functionId == TSDB_FUNC_TAG;
+}
+
+void mergeIntermediateResult(SQLFunctionCtx *pCtx, const char *pInput, const SResultRowCellInfo *pInputInfo) {
+  SResultRowCellInfo *pResInfo = GET_RES_INFO(pCtx);
+  assert(isIntermediateMergeable(pCtx->functionId));
+
+  // the sum/min/max of normal table query keep no result flag in the output buffer
+  bool hasInput = pCtx->stableQuery || pInputInfo->hasResult == DATA_SET_FLAG;
+
+  switch (pCtx->functionId) {
+    case TSDB_FUNC_COUNT:
+      *(int64_t *)pCtx->aOutputBuf += *(int64_t *)pInput;
+      break;
+    case TSDB_FUNC_SUM: {
+      if (!pCtx->stableQuery) {
+        if (!hasInput) {
+          break;
+        }
+
+        if (IS_FLOAT_TYPE(pCtx->inputType)) {
+          *(double *)pCtx->aOutputBuf += *(double *)pInput;
+        } else {
+          *(int64_t *)pCtx->aOutputBuf += *(int64_t *)pInput;
+        }
+        break;
+      }
+
+      SSumInfo *pInputSum = (SSumInfo *)pInput;
+      if (pInputSum->hasResult != DATA_SET_FLAG) {
+        break;
+      }
+
+      SSumInfo *pSum = (SSumInfo *)pCtx->aOutputBuf;
+      if (IS_FLOAT_TYPE(pCtx->inputType)) {
+        pSum->dsum += pInputSum->dsum;
+      } else {  // the unsigned sum is kept in the same 64 bits
+        pSum->isum += pInputSum->isum;
+      }
+
+      pSum->hasResult = DATA_SET_FLAG;
+      break;
+    }
+    case TSDB_FUNC_AVG: {
+      SAvgInfo *pAvgInfo = (SAvgInfo *)GET_ROWCELL_INTERBUF(pResInfo);
+      SAvgInfo *pInputAvg = pCtx->stableQuery ? (SAvgInfo *)pInput : (SAvgInfo *)GET_ROWCELL_INTERBUF(pInputInfo);
+      pAvgInfo->sum += pInputAvg->sum;
+      pAvgInfo->num += pInputAvg->num;
+      if (pCtx->stableQuery) {
+        memcpy(pCtx->aOutputBuf, pAvgInfo, sizeof(SAvgInfo));
+      }
+      break;
+    }
+    case TSDB_FUNC_MIN:
+    case TSDB_FUNC_MAX: {
+      if (!hasInput || (pCtx->stableQuery && pInput[pCtx->inputBytes] != DATA_SET_FLAG)) {
+        break;
+      }
+
+      bool isMin = (pCtx->functionId == TSDB_FUNC_MIN);
+      switch (pCtx->inputType) {
+        case TSDB_DATA_TYPE_TINYINT:   MERGE_MINMAX_DATA(int8_t, pCtx->aOutputBuf, pInput, isMin); break;
+        case TSDB_DATA_TYPE_UTINYINT:  MERGE_MINMAX_DATA(uint8_t, pCtx->aOutputBuf, pInput, isMin); break;
+        case TSDB_DATA_TYPE_SMALLINT:  MERGE_MINMAX_DATA(int16_t, pCtx->aOutputBuf, pInput, isMin); break;
+        case TSDB_DATA_TYPE_USMALLINT: MERGE_MINMAX_DATA(uint16_t, pCtx->aOutputBuf, pInput, isMin); break;
+        case TSDB_DATA_TYPE_INT:       MERGE_MINMAX_DATA(int32_t, pCtx->aOutputBuf, pInput, isMin); break;
+        case TSDB_DATA_TYPE_UINT:      MERGE_MINMAX_DATA(uint32_t, pCtx->aOutputBuf, pInput, isMin); break;
+        case TSDB_DATA_TYPE_BIGINT:    MERGE_MINMAX_DATA(int64_t, pCtx->aOutputBuf, pInput, isMin); break;
+        case TSDB_DATA_TYPE_UBIGINT:   MERGE_MINMAX_DATA(uint64_t, pCtx->aOutputBuf, pInput, isMin); break;
+        case TSDB_DATA_TYPE_FLOAT:     MERGE_MINMAX_DATA(float, pCtx->aOutputBuf, pInput, isMin); break;
+        case TSDB_DATA_TYPE_DOUBLE:    MERGE_MINMAX_DATA(double, pCtx->aOutputBuf, pInput, isMin); break;
+        default:
+          qError("illegal data type:%d in min/max query", pCtx->inputType);
+      }
+
+      if (pCtx->stableQuery) {
+        *(pCtx->aOutputBuf + pCtx->inputBytes) = DATA_SET_FLAG;
+      }
+      break;
+    }
+    case TSDB_FUNC_TAG:  // the tag value is identical in one group
+      memcpy(pCtx->aOutputBuf, pInput, pCtx->outputBytes);
+      break;
+  }
+
+  if (pInputInfo->hasResult == DATA_SET_FLAG) {
+    pResInfo->hasResult = DATA_SET_FLAG;
+  }
+
+  pResInfo->numOfRes = MAX(pResInfo->numOfRes, pInputInfo->numOfRes);
+}
+
 static void minMax_function_f(SQLFunctionCtx *pCtx, int32_t index, int32_t isMin) {
   char *pData = GET_INPUT_DATA(pCtx, index);
   TSKEY key   = GET_TS_DATA(pCtx, index);
@@ -1337,14 +1369,6 @@ static void min_function_f(SQLFunctionCtx *pCtx, int32_t index) {
   }
 }
 
-#define LOOP_STDDEV_IMPL(type, r, d, ctx, delta, tsdbType)             \
-  for (int32_t i = 0; i < (ctx)->size; ++i) {                          \
-    if ((ctx)->hasNull && isNull((char *)&((type *)d)[i], tsdbType)) { \
-      continue;                                                        \
-    }                                                                  \
-    (r) += POW2(((type *)d)[i] - (delta));                             \
-  }
-
 static void stddev_function(SQLFunctionCtx *pCtx) {
   SStddevInfo *pStd = GET_ROWCELL_INTERBUF(GET_RES_INFO(pCtx));
   
@@ -1358,40 +1382,7 @@ static void stddev_function(SQLFunctionCtx *pCtx) {
     double  avg = pStd->avg;
     
     void *pData = GET_INPUT_DATA_LIST(pCtx);
-    
-    switch (pCtx->inputType) {
-      case TSDB_DATA_TYPE_INT: {
-        for (int32_t i = 0; i < pCtx->size; ++i) {
-          if (pCtx->hasNull && isNull((const char*) (&((int32_t *)pData)[i]), pCtx->inputType)) {
-            continue;
-          }
-          *retVal += POW2(((int32_t *)pData)[i] - avg);
-        }
-        break;
-      }
-      case TSDB_DATA_TYPE_FLOAT: {
-        LOOP_STDDEV_IMPL(float, *retVal, pData, pCtx, avg, pCtx->inputType);
-        break;
-      }
-      case TSDB_DATA_TYPE_DOUBLE: {
-        LOOP_STDDEV_IMPL(double, *retVal, pData, pCtx, avg, pCtx->inputType);
-        break;
-      }
-      case TSDB_DATA_TYPE_BIGINT: {
-        LOOP_STDDEV_IMPL(int64_t, *retVal, pData, pCtx, avg, pCtx->inputType);
-        break;
-      }
-      case TSDB_DATA_TYPE_SMALLINT: {
-        LOOP_STDDEV_IMPL(int16_t, *retVal, pData, pCtx, avg, pCtx->inputType);
-        break;
-      }
-      case TSDB_DATA_TYPE_TINYINT: {
-        LOOP_STDDEV_IMPL(int8_t, *retVal, pData, pCtx, avg, pCtx->inputType);
-        break;
-      }
-      default:
-        qError("stddev function not support data type:%d", pCtx->inputType);
-    }
+    aggSquareDiffBlock(pData, pCtx->inputType, pCtx->size, pCtx->hasNull, GET_FILTER_RES(pCtx), avg, retVal);
     
     SET_VAL(pCtx, 1, 1);
   }
@@ -2555,11 +2546,19 @@ static void percentile_next_step(SQLFunctionCtx *pCtx) {
 }
 
 //////////////////////////////////////////////////////////////////////////////////
+static bool isTDigestAPerct(SQLFunctionCtx *pCtx) {
+  return pCtx->param[1].nType == TSDB_DATA_TYPE_BIGINT && pCtx->param[1].i64 == TSDB_APERCT_ALGO_TDIGEST;
+}
+
 static void buildHistogramInfo(SAPercentileInfo* pInfo) {
   pInfo->pHisto = (SHistogramInfo*) ((char*) pInfo + sizeof(SAPercentileInfo));
   pInfo->pHisto->elems = (SHistBin*) ((char*)pInfo->pHisto + sizeof(SHistogramInfo));
 }
 
+static void buildTDigestInfo(SAPercentileInfo* pInfo) {
+  pInfo->pTDigest = (STDigest*) ((char*) pInfo + sizeof(SAPercentileInfo));
+}
+
 static SAPercentileInfo *getAPerctInfo(SQLFunctionCtx *pCtx) {
   SResultRowCellInfo *pResInfo = GET_RES_INFO(pCtx);
   SAPercentileInfo* pInfo = NULL;
@@ -2570,7 +2569,12 @@ static SAPercentileInfo *getAPerctInfo(SQLFunctionCtx *pCtx) {
     pInfo = GET_ROWCELL_INTERBUF(pResInfo);
   }
 
-  buildHistogramInfo(pInfo);
+  if (isTDigestAPerct(pCtx)) {
+    buildTDigestInfo(pInfo);
+  } else {
+    buildHistogramInfo(pInfo);
+  }
+
   return pInfo;
 }
 
@@ -2580,7 +2584,12 @@ static bool apercentile_function_setup(SQLFunctionCtx *pCtx) {
   }
   
   SAPercentileInfo *pInfo = getAPerctInfo(pCtx);
-  
+
+  if (isTDigestAPerct(pCtx)) {
+    tDigestInit(pInfo->pTDigest);
+    return true;
+  }
+
   char *tmp = (char *)pInfo + sizeof(SAPercentileInfo);
   pInfo->pHisto = tHistogramCreateFrom(tmp, MAX_HISTOGRAM_BIN);
   return true;
@@ -2591,8 +2600,9 @@ static void apercentile_function(SQLFunctionCtx *pCtx) {
   
   SResultRowCellInfo *     pResInfo = GET_RES_INFO(pCtx);
   SAPercentileInfo *pInfo = getAPerctInfo(pCtx);
+  bool              tdigest = isTDigestAPerct(pCtx);
 
-  assert(pInfo->pHisto->elems != NULL);
+  assert(tdigest || pInfo->pHisto->elems != NULL);
   
   for (int32_t i = 0; i < pCtx->size; ++i) {
     char *data = GET_INPUT_DATA(pCtx, i);
@@ -2604,7 +2614,12 @@ static void apercentile_function(SQLFunctionCtx *pCtx) {
 
     double v = 0;
     GET_TYPED_DATA(v, double, pCtx->inputType, data);
-    tHistogramAdd(&pInfo->pHisto, v);
+
+    if (tdigest) {
+      tDigestAdd(pInfo->pTDigest, v, 1);
+    } else {
+      tHistogramAdd(&pInfo->pHisto, v);
+    }
   }
   
   if (!pCtx->hasNull) {
@@ -2629,14 +2644,39 @@ static void apercentile_function_f(SQLFunctionCtx *pCtx, int32_t index) {
   
   double v = 0;
   GET_TYPED_DATA(v, double, pCtx->inputType, pData);
-  
-  tHistogramAdd(&pInfo->pHisto, v);
-  
+
+  if (isTDigestAPerct(pCtx)) {
+    tDigestAdd(pInfo->pTDigest, v, 1);
+  } else {
+    tHistogramAdd(&pInfo->pHisto, v);
+  }
+
   SET_VAL(pCtx, 1, 1);
   pResInfo->hasResult = DATA_SET_FLAG;
 }
 
+static void tdigest_func_merge(SQLFunctionCtx *pCtx) {
+  SAPercentileInfo *pInput = (SAPercentileInfo *)GET_INPUT_DATA_LIST(pCtx);
+  buildTDigestInfo(pInput);
+
+  if (pInput->pTDigest->numOfCentroids == 0 && pInput->pTDigest->numOfBuffered == 0) {
+    return;
+  }
+
+  SAPercentileInfo *pOutput = getAPerctInfo(pCtx);
+  tDigestMerge(pOutput->pTDigest, pInput->pTDigest);
+
+  SResultRowCellInfo *pResInfo = GET_RES_INFO(pCtx);
+  pResInfo->hasResult = DATA_SET_FLAG;
+  SET_VAL(pCtx, 1, 1);
+}
+
 static void apercentile_func_merge(SQLFunctionCtx *pCtx) {
+  if (isTDigestAPerct(pCtx)) {
+    tdigest_func_merge(pCtx);
+    return;
+  }
+
   SAPercentileInfo *pInput = (SAPercentileInfo *)GET_INPUT_DATA_LIST(pCtx);
   
   pInput->pHisto = (SHistogramInfo*) ((char *)pInput + sizeof(SAPercentileInfo));
@@ -2671,6 +2711,20 @@ static void apercentile_finalizer(SQLFunctionCtx *pCtx) {
   
   SResultRowCellInfo *     pResInfo = GET_RES_INFO(pCtx);
   SAPercentileInfo *pOutput = GET_ROWCELL_INTERBUF(pResInfo);
+
+  if (isTDigestAPerct(pCtx)) {
+    buildTDigestInfo(pOutput);
+
+    STDigest *pDigest = pOutput->pTDigest;
+    if (pResInfo->hasResult != DATA_SET_FLAG || (pDigest->numOfCentroids == 0 && pDigest->numOfBuffered == 0)) {
+      setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
+      return;
+    }
+
+    *(double *)pCtx->aOutputBuf = tDigestQuantile(pDigest, v / 100);
+    doFinalizer(pCtx);
+    return;
+  }
   
   if (pCtx->currentStage == MERGE_STAGE) {
     if (pResInfo->hasResult == DATA_SET_FLAG) {  // check for null
@@ -3532,6 +3586,111 @@ void spread_function_finalizer(SQLFunctionCtx *pCtx) {
   doFinalizer(pCtx);
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+static int32_t getHllPrecision(SQLFunctionCtx *pCtx) {
+  int64_t precision = pCtx->param[0].i64;
+  return (precision == 0) ? HLL_DEFAULT_PRECISION : (int32_t)precision;
+}
+
+static bool hll_function_setup(SQLFunctionCtx *pCtx) {
+  if (!function_setup(pCtx)) {
+    return false;
+  }
+
+  tHllInit(GET_ROWCELL_INTERBUF(GET_RES_INFO(pCtx)), getHllPrecision(pCtx));
+  return true;
+}
+
+static void hll_add_value(SHLLInfo *pInfo, SQLFunctionCtx *pCtx, char *pData) {
+  if (pCtx->inputType == TSDB_DATA_TYPE_BINARY || pCtx->inputType == TSDB_DATA_TYPE_NCHAR) {
+    tHllAdd(pInfo, varDataVal(pData), varDataLen(pData));
+  } else {
+    tHllAdd(pInfo, pData, pCtx->inputBytes);
+  }
+}
+
+static void hll_function(SQLFunctionCtx *pCtx) {
+  SResultRowCellInfo *pResInfo = GET_RES_INFO(pCtx);
+  SHLLInfo *          pInfo = GET_ROWCELL_INTERBUF(pResInfo);
+
+  int8_t *sel = GET_FILTER_RES(pCtx);
+
+  int32_t notNullElems = 0;
+  for (int32_t i = 0; i < pCtx->size; ++i) {
+    char *data = GET_INPUT_DATA(pCtx, i);
+    if ((sel != NULL && sel[i] == 0) || (pCtx->hasNull && isNull(data, pCtx->inputType))) {
+      continue;
+    }
+
+    hll_add_value(pInfo, pCtx, data);
+    notNullElems += 1;
+  }
+
+  SET_VAL(pCtx, notNullElems, 1);
+
+  if (notNullElems > 0) {
+    pResInfo->hasResult = DATA_SET_FLAG;
+    pInfo->hasResult = DATA_SET_FLAG;
+  }
+
+  // keep the sketch in the output buffer for super table query, which is merged at the client side
+  if (pCtx->stableQuery) {
+    memcpy(pCtx->aOutputBuf, pInfo, tHllSketchSize(pInfo->precision));
+  }
+}
+
+static void hll_function_f(SQLFunctionCtx *pCtx, int32_t index) {
+  char *pData = GET_INPUT_DATA(pCtx, index);
+  if (pCtx->hasNull && isNull(pData, pCtx->inputType)) {
+    return;
+  }
+
+  SET_VAL(pCtx, 1, 1);
+
+  SResultRowCellInfo *pResInfo = GET_RES_INFO(pCtx);
+  SHLLInfo *          pInfo = GET_ROWCELL_INTERBUF(pResInfo);
+
+  hll_add_value(pInfo, pCtx, pData);
+
+  pResInfo->hasResult = DATA_SET_FLAG;
+  pInfo->hasResult = DATA_SET_FLAG;
+
+  if (pCtx->stableQuery) {
+    memcpy(pCtx->aOutputBuf, pInfo, tHllSketchSize(pInfo->precision));
+  }
+}
+
+static void hll_func_merge(SQLFunctionCtx *pCtx) {
+  SHLLInfo *pInput = (SHLLInfo *)GET_INPUT_DATA_LIST(pCtx);
+  if (pInput->hasResult != DATA_SET_FLAG) {
+    return;
+  }
+
+  SResultRowCellInfo *pResInfo = GET_RES_INFO(pCtx);
+  SHLLInfo *          pInfo = GET_ROWCELL_INTERBUF(pResInfo);
+
+  tHllMerge(pInfo, pInput);
+
+  pInfo->hasResult = DATA_SET_FLAG;
+  pResInfo->hasResult = DATA_SET_FLAG;
+  SET_VAL(pCtx, 1, 1);
+}
+
+static void hll_function_finalizer(SQLFunctionCtx *pCtx) {
+  SResultRowCellInfo *pResInfo = GET_RES_INFO(pCtx);
+  SHLLInfo *          pInfo = GET_ROWCELL_INTERBUF(pResInfo);
+
+  if (pInfo->hasResult != DATA_SET_FLAG) {
+    setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
+    return;
+  }
+
+  *(int64_t *)pCtx->aOutputBuf = (int64_t)tHllEstimate(pInfo);
+
+  pResInfo->numOfRes = 1;
+  doFinalizer(pCtx);
+}
+
 
 /**
  * param[1]: start time
@@ -4266,8 +4425,8 @@ int32_t functionCompatList[] = {
     4,         -1,       -1,         1,        1,      1,          1,           1,        1,     -1,
     //  tag,    colprj,   tagprj,    arithmetic, diff, first_dist, last_dist,   interp    rate    irate
     1,          1,        1,         1,       -1,      1,          1,           5,        1,      1,
-    // sum_rate, sum_irate, avg_rate, avg_irate
-    1,          1,        1,         1,
+    // sum_rate, sum_irate, avg_rate, avg_irate, tid_tag, histogram, hyperloglog
+    1,          1,        1,         1,         -1,      1,         1,
 };
 
 SQLAggFuncElem aAggs[] = {{
@@ -4763,4 +4922,32 @@ SQLAggFuncElem aAggs[] = {{
                               noop1,
                               noop1,
                               dataBlockRequired,
+                          },
+                          {
+                              // 35, reserved
+                              "histogram",
+                              TSDB_FUNC_HISTOGRAM,
+                              TSDB_FUNC_HISTOGRAM,
+                              TSDB_BASE_FUNC_SO,
+                              function_setup,
+                              noop1,
+                              noop2,
+                              no_next_step,
+                              noop1,
+                              noop1,
+                              dataBlockRequired,
+                          },
+                          {
+                              // 36, distinct count estimation, the sketches are merged at the client side
+                              "hyperloglog",
+                              TSDB_FUNC_HLL,
+                              TSDB_FUNC_HLL,
+                              TSDB_BASE_FUNC_SO,
+                              hll_function_setup,
+                              hll_function,
+                              hll_function_f,
+                              no_next_step,
+                              hll_function_finalizer,
+                              hll_func_merge,
+                              dataBlockRequired,
                           }};
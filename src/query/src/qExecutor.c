@@ -22,6 +22,7 @@
 #include "hash.h"
 #include "texpr.h"
 #include "qExecutor.h"
+#include "qExtbuffer.h"
 #include "qResultbuf.h"
 #include "qUtil.h"
 #include "query.h"
@@ -208,47 +209,6 @@ static void doRowwiseTimeWindowInterpolation(SQueryRuntimeEnv* pRuntimeEnv, SArr
 static STsdbQueryCond createTsdbQueryCond(SQuery* pQuery, STimeWindow* win);
 static STableIdInfo createTableIdInfo(SQuery* pQuery);
 
-bool doFilterData(SQuery *pQuery, int32_t elemPos) {
-  for (int32_t k = 0; k < pQuery->numOfFilterCols; ++k) {
-    SSingleColumnFilterInfo *pFilterInfo = &pQuery->pFilterInfo[k];
-
-    char *pElem = (char*)pFilterInfo->pData + pFilterInfo->info.bytes * elemPos;
-
-    bool qualified = false;
-    for (int32_t j = 0; j < pFilterInfo->numOfFilters; ++j) {
-      SColumnFilterElem *pFilterElem = &pFilterInfo->pFilters[j];
-
-      bool isnull = isNull(pElem, pFilterInfo->info.type);
-      if (isnull) {
-        if (pFilterElem->fp == isNullOperator) {
-          qualified = true;
-          break;
-        } else {
-          continue;
-        }
-      } else {
-        if (pFilterElem->fp == notNullOperator) {
-          qualified = true;
-          break;
-        } else if (pFilterElem->fp == isNullOperator) {
-          continue;
-        }
-      }
-
-      if (pFilterElem->fp(pFilterElem, pElem, pElem, pFilterInfo->info.type)) {
-        qualified = true;
-        break;
-      }
-    }
-
-    if (!qualified) {
-      return false;
-    }
-  }
-
-  return true;
-}
-
 int64_t getNumOfResult(SQueryRuntimeEnv *pRuntimeEnv) {
   SQuery *pQuery = pRuntimeEnv->pQuery;
   bool    hasMainFunction = hasMainOutput(pQuery);
@@ -1530,6 +1490,93 @@ static void setTimeWindowEKeyInterp(SQueryRuntimeEnv* pRuntimeEnv, SArray* pData
   }
 }
 
+/*
+ * Evaluate the filters on all rows of current data block, the row selection is kept in pRuntimeEnv->pFilterRes.
+ */
+static int32_t doFilterBlock(SQueryRuntimeEnv *pRuntimeEnv, SArray *pDataBlock, int32_t numOfRows) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+
+  if (pRuntimeEnv->filterResCap < numOfRows) {
+    int8_t *p = realloc(pRuntimeEnv->pFilterRes, numOfRows);
+    if (p == NULL) {
+      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+    }
+
+    pRuntimeEnv->pFilterRes = p;
+    pRuntimeEnv->filterResCap = numOfRows;
+  }
+
+  // set the input column data
+  for (int32_t k = 0; k < pQuery->numOfFilterCols; ++k) {
+    SSingleColumnFilterInfo *pFilterInfo = &pQuery->pFilterInfo[k];
+    pFilterInfo->pData = getDataBlockImpl(pDataBlock, pFilterInfo->info.colId);
+    assert(pFilterInfo->pData != NULL);
+  }
+
+  return doFilterDataBlock(pQuery->pFilterInfo, pQuery->numOfFilterCols, numOfRows, pRuntimeEnv->pFilterRes);
+}
+
+/*
+ * Aggregate functions that accept the row selection of a block, the remain functions are executed row by row.
+ */
+static bool isBlockwiseFilterQuery(SQueryRuntimeEnv *pRuntimeEnv) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+  if (pQuery->numOfFilterCols == 0 || pRuntimeEnv->pTsBuf != NULL || pRuntimeEnv->groupbyColumn ||
+      QUERY_IS_INTERVAL_QUERY(pQuery)) {
+    return false;
+  }
+
+  for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
+    int32_t functionId = pQuery->pExpr1[i].base.functionId;
+    if (functionId != TSDB_FUNC_COUNT && functionId != TSDB_FUNC_SUM && functionId != TSDB_FUNC_AVG &&
+        functionId != TSDB_FUNC_MIN && functionId != TSDB_FUNC_MAX && functionId != TSDB_FUNC_TAG) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void filteredBlockwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *pStatis,
+                                            SDataBlockInfo *pDataBlockInfo, SArray *pDataBlock) {
+  SQLFunctionCtx *pCtx = pRuntimeEnv->pCtx;
+  SQuery         *pQuery = pRuntimeEnv->pQuery;
+
+  int32_t numOfQualified = doFilterBlock(pRuntimeEnv, pDataBlock, pDataBlockInfo->rows);
+  if (numOfQualified == 0) {
+    return;
+  }
+
+  // all rows are qualified, the pre-aggregation result of this block is still valid
+  int8_t *pFilterRes = (numOfQualified == pDataBlockInfo->rows) ? NULL : pRuntimeEnv->pFilterRes;
+
+  SColumnInfoData *pColInfo = taosArrayGet(pDataBlock, 0);
+  TSKEY           *tsCols = (TSKEY *)(pColInfo->pData);
+
+  SQInfo *pQInfo = GET_QINFO_ADDR(pRuntimeEnv);
+  for (int32_t k = 0; k < pQuery->numOfOutput; ++k) {
+    char *dataBlock = getDataBlock(pRuntimeEnv, &pRuntimeEnv->sasArray[k], k, pDataBlockInfo->rows, pDataBlock);
+    setExecParams(pQuery, &pCtx[k], dataBlock, tsCols, pDataBlockInfo, pStatis, &pRuntimeEnv->sasArray[k], k, pQInfo->vgId);
+
+    pCtx[k].pFilterRes = pFilterRes;
+    if (pFilterRes != NULL) {
+      pCtx[k].preAggVals.isSet = false;
+    }
+  }
+
+  for (int32_t k = 0; k < pQuery->numOfOutput; ++k) {
+    int32_t functionId = pQuery->pExpr1[k].base.functionId;
+    if (functionNeedToExecute(pRuntimeEnv, &pCtx[k], functionId)) {
+      pCtx[k].nStartQueryTimestamp = pQuery->window.skey;
+      aAggs[functionId].xFunction(&pCtx[k]);
+    }
+  }
+
+  for (int32_t k = 0; k < pQuery->numOfOutput; ++k) {
+    pCtx[k].pFilterRes = NULL;
+  }
+}
+
 static void rowwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *pStatis, SDataBlockInfo *pDataBlockInfo,
                                   SResultRowInfo *pWindowResInfo, SArray *pDataBlock) {
   SQLFunctionCtx *pCtx = pRuntimeEnv->pCtx;
@@ -1560,11 +1607,10 @@ static void rowwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *pS
     pCtx[k].size = 1;
   }
 
-  // set the input column data
-  for (int32_t k = 0; k < pQuery->numOfFilterCols; ++k) {
-    SSingleColumnFilterInfo *pFilterInfo = &pQuery->pFilterInfo[k];
-    pFilterInfo->pData = getDataBlockImpl(pDataBlock, pFilterInfo->info.colId);
-    assert(pFilterInfo->pData != NULL);
+  int8_t *pFilterRes = NULL;
+  if (pQuery->numOfFilterCols > 0) {
+    doFilterBlock(pRuntimeEnv, pDataBlock, pDataBlockInfo->rows);
+    pFilterRes = pRuntimeEnv->pFilterRes;
   }
 
   int32_t step = GET_FORWARD_DIRECTION_FACTOR(pQuery->order.order);
@@ -1594,7 +1640,7 @@ static void rowwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *pS
       }
     }
 
-    if (pQuery->numOfFilterCols > 0 && (!doFilterData(pQuery, offset))) {
+    if (pFilterRes != NULL && pFilterRes[offset] == 0) {
       continue;
     }
 
@@ -1725,7 +1771,9 @@ static int32_t tableApplyFunctionsOnBlock(SQueryRuntimeEnv *pRuntimeEnv, SDataBl
   STableQueryInfo* pTableQueryInfo = pQuery->current;
   SResultRowInfo*  pResultRowInfo = &pRuntimeEnv->windowResInfo;
 
-  if (pQuery->numOfFilterCols > 0 || pRuntimeEnv->pTsBuf != NULL || pRuntimeEnv->groupbyColumn) {
+  if (isBlockwiseFilterQuery(pRuntimeEnv)) {
+    filteredBlockwiseApplyFunctions(pRuntimeEnv, pStatis, pDataBlockInfo, pDataBlock);
+  } else if (pQuery->numOfFilterCols > 0 || pRuntimeEnv->pTsBuf != NULL || pRuntimeEnv->groupbyColumn) {
     rowwiseApplyFunctions(pRuntimeEnv, pStatis, pDataBlockInfo, pResultRowInfo, pDataBlock);
   } else {
     blockwiseApplyFunctions(pRuntimeEnv, pStatis, pDataBlockInfo, pResultRowInfo, searchFn, pDataBlock);
@@ -2027,6 +2075,12 @@ _clean:
   return TSDB_CODE_QRY_OUT_OF_MEMORY;
 }
 
+// clean up a query handle that is replaced in the middle of the query, keeping its cost in the query summary
+static void cleanupQueryHandle(SQueryRuntimeEnv* pRuntimeEnv, TsdbQueryHandleT pQueryHandle) {
+  pRuntimeEnv->summary.skipBlocks += tsdbGetNumOfSkippedBlocks(pQueryHandle);
+  tsdbCleanupQueryHandle(pQueryHandle);
+}
+
 static void doFreeQueryHandle(SQInfo* pQInfo) {
   SQueryRuntimeEnv* pRuntimeEnv = &pQInfo->runtimeEnv;
 
@@ -2096,6 +2150,7 @@ static void teardownQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv) {
   tfree(pRuntimeEnv->keyBuf);
   tfree(pRuntimeEnv->rowCellInfoOffset);
   tfree(pRuntimeEnv->prevRow);
+  tfree(pRuntimeEnv->pFilterRes);
 
   taosHashCleanup(pRuntimeEnv->pResultRowHashTable);
   pRuntimeEnv->pResultRowHashTable = NULL;
@@ -2114,6 +2169,10 @@ static bool isQueryKilled(SQInfo *pQInfo) {
     return true;
   }
 
+  if (pQInfo->pParent != NULL) {
+    return isQueryKilled(pQInfo->pParent);
+  }
+
   // query has been executed more than tsShellActivityTimer, and the retrieve has not arrived
   // abort current query execution.
   if (pQInfo->owner != 0 && ((taosGetTimestampSec() - pQInfo->startExecTs) > getMaximumIdleDurationSec()) &&
@@ -2664,11 +2723,13 @@ int32_t loadDataBlockOnDemand(SQueryRuntimeEnv *pRuntimeEnv, SResultRowInfo * pW
     tsdbRetrieveDataBlockStatisInfo(pQueryHandle, pStatis);
 
     if (!needToLoadDataBlock(pRuntimeEnv, *pStatis, pRuntimeEnv->pCtx, pBlockInfo->rows)) {
-      // current block has been discard due to filter applied
+      // current block has been discard due to filter applied, no need to load its data
       pCost->discardBlocks += 1;
+      pCost->skipBlocks += 1;
       qDebug("QInfo:%p data block discard, brange:%"PRId64 "-%"PRId64", rows:%d", GET_QINFO_ADDR(pRuntimeEnv),
           pBlockInfo->window.skey, pBlockInfo->window.ekey, pBlockInfo->rows);
       (*status) = BLK_DATA_DISCARD;
+      return TSDB_CODE_SUCCESS;
     }
 
     pCost->totalCheckedRows += pBlockInfo->rows;
@@ -3579,6 +3640,173 @@ void skipResults(SQueryRuntimeEnv *pRuntimeEnv) {
   }
 }
 
+// the output column of the order column and the primary timestamp that breaks the ties
+static int32_t getTopNOrderColumns(SQuery *pQuery, int32_t *orderCols) {
+  orderCols[0] = -1;
+  orderCols[1] = -1;
+
+  for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
+    SSqlFuncMsg *pFunc = &pQuery->pExpr1[i].base;
+    if (pFunc->functionId != TSDB_FUNC_PRJ) {
+      continue;
+    }
+
+    if (pFunc->colInfo.colId == pQuery->order.orderColId && orderCols[0] < 0) {
+      orderCols[0] = i;
+    } else if (pFunc->colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX && orderCols[1] < 0) {
+      orderCols[1] = i;
+    }
+  }
+
+  if (orderCols[0] < 0) {
+    return 0;
+  }
+
+  return (orderCols[1] < 0) ? 1 : 2;
+}
+
+/*
+ * Super table projection query ordered by a normal column with limit: only the first (limit + offset) rows of each
+ * vgroup can be part of the final result, so they are kept in the output buffer as a bounded heap instead of
+ * returning all qualified rows to the client.
+ */
+static bool isTopNProjectionQuery(SQuery *pQuery) {
+  if (pQuery->prjInfo.vgroupLimit <= 0 || pQuery->order.orderColId == PRIMARYKEY_TIMESTAMP_COL_INDEX ||
+      pQuery->prjInfo.vgroupLimit >= pQuery->rec.threshold) {
+    return false;
+  }
+
+  int32_t orderCols[2] = {0};
+  return getTopNOrderColumns(pQuery, orderCols) > 0;
+}
+
+// less than zero if row r1 is placed ahead of row r2 in the final result
+static int32_t compareOutputRows(SQuery *pQuery, int32_t *orderCols, int32_t numOfCols, int32_t r1, int32_t r2) {
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SExprInfo *pExprInfo = &pQuery->pExpr1[orderCols[i]];
+
+    char *f1 = pQuery->sdata[orderCols[i]]->data + r1 * pExprInfo->bytes;
+    char *f2 = pQuery->sdata[orderCols[i]]->data + r2 * pExprInfo->bytes;
+
+    int32_t ret = 0;
+    if (pExprInfo->type == TSDB_DATA_TYPE_TIMESTAMP) {
+      ret = (*(int64_t *)f1 == *(int64_t *)f2) ? 0 : ((*(int64_t *)f1 < *(int64_t *)f2) ? -1 : 1);
+    } else {
+      ret = columnValueAscendingComparator(f1, f2, pExprInfo->type, pExprInfo->bytes);
+    }
+
+    if (ret != 0) {
+      return QUERY_IS_ASC_QUERY(pQuery) ? ret : -ret;
+    }
+  }
+
+  return 0;
+}
+
+// the heap top is the row that is placed last among the kept rows
+static void topNHeapSiftDown(SQuery *pQuery, int32_t *orderCols, int32_t numOfCols, int32_t *pHeap, int32_t size,
+                             int32_t index) {
+  while (true) {
+    int32_t largest = index;
+    int32_t left = 2 * index + 1;
+    int32_t right = left + 1;
+
+    if (left < size && compareOutputRows(pQuery, orderCols, numOfCols, pHeap[left], pHeap[largest]) > 0) {
+      largest = left;
+    }
+
+    if (right < size && compareOutputRows(pQuery, orderCols, numOfCols, pHeap[right], pHeap[largest]) > 0) {
+      largest = right;
+    }
+
+    if (largest == index) {
+      break;
+    }
+
+    SWAP(pHeap[index], pHeap[largest], int32_t);
+    index = largest;
+  }
+}
+
+static void keepTopNResults(SQueryRuntimeEnv *pRuntimeEnv) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+
+  int32_t numOfRows = (int32_t)pQuery->rec.rows;
+  int32_t n = (int32_t)pQuery->prjInfo.vgroupLimit;
+  if (numOfRows <= n) {
+    return;
+  }
+
+  int32_t orderCols[2] = {0};
+  int32_t numOfCols = getTopNOrderColumns(pQuery, orderCols);
+  assert(numOfCols > 0);
+
+  int32_t *pHeap = malloc(sizeof(int32_t) * n);
+  bool    *kept = calloc(n, sizeof(bool));
+  if (pHeap == NULL || kept == NULL) {
+    tfree(pHeap);
+    tfree(kept);
+    longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+  }
+
+  for (int32_t i = 0; i < n; ++i) {
+    pHeap[i] = i;
+  }
+
+  for (int32_t i = n / 2 - 1; i >= 0; --i) {
+    topNHeapSiftDown(pQuery, orderCols, numOfCols, pHeap, n, i);
+  }
+
+  for (int32_t i = n; i < numOfRows; ++i) {
+    if (compareOutputRows(pQuery, orderCols, numOfCols, i, pHeap[0]) < 0) {
+      pHeap[0] = i;
+      topNHeapSiftDown(pQuery, orderCols, numOfCols, pHeap, n, 0);
+    }
+  }
+
+  // move the kept rows beyond the first n rows into the slots of the evicted ones
+  for (int32_t i = 0; i < n; ++i) {
+    if (pHeap[i] < n) {
+      kept[pHeap[i]] = true;
+    }
+  }
+
+  int32_t slot = 0;
+  for (int32_t i = 0; i < n; ++i) {
+    if (pHeap[i] < n) {
+      continue;
+    }
+
+    while (kept[slot]) {
+      slot += 1;
+    }
+
+    for (int32_t j = 0; j < pQuery->numOfOutput; ++j) {
+      int32_t bytes = pQuery->pExpr1[j].bytes;
+      memcpy(pQuery->sdata[j]->data + slot * bytes, pQuery->sdata[j]->data + pHeap[i] * bytes, bytes);
+    }
+
+    kept[slot] = true;
+  }
+
+  tfree(pHeap);
+  tfree(kept);
+
+  for (int32_t j = 0; j < pQuery->numOfOutput; ++j) {
+    pRuntimeEnv->pCtx[j].aOutputBuf = pQuery->sdata[j]->data + n * pQuery->pExpr1[j].bytes;
+
+    SResultRowCellInfo *pResInfo = GET_RES_INFO(&pRuntimeEnv->pCtx[j]);
+    if (pResInfo->numOfRes > n) {
+      pResInfo->numOfRes = n;
+    }
+  }
+
+  qDebug("QInfo:%p keep top %d rows out of %d rows", GET_QINFO_ADDR(pRuntimeEnv), n, numOfRows);
+
+  pQuery->rec.rows = n;
+  CLEAR_QUERY_STATUS(pQuery, QUERY_RESBUF_FULL);
+}
+
 void setQueryStatus(SQuery *pQuery, int8_t status) {
   if (status == QUERY_NOT_COMPLETED) {
     pQuery->status = status;
@@ -3678,7 +3906,7 @@ static void setEnvBeforeReverseScan(SQueryRuntimeEnv *pRuntimeEnv, SQueryStatusI
 
   // clean unused handle
   if (pRuntimeEnv->pSecQueryHandle != NULL) {
-    tsdbCleanupQueryHandle(pRuntimeEnv->pSecQueryHandle);
+    cleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pSecQueryHandle);
   }
 
   pRuntimeEnv->pSecQueryHandle = tsdbQueryTables(pQInfo->tsdb, &cond, &pQInfo->tableGroupInfo, pQInfo, &pQInfo->memRef);
@@ -3814,7 +4042,7 @@ void scanOneTableDataBlocks(SQueryRuntimeEnv *pRuntimeEnv, TSKEY start) {
     }
 
     if (pRuntimeEnv->pSecQueryHandle != NULL) {
-      tsdbCleanupQueryHandle(pRuntimeEnv->pSecQueryHandle);
+      cleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pSecQueryHandle);
     }
 
     STsdbQueryCond cond = createTsdbQueryCond(pQuery, &pQuery->window);
@@ -4258,7 +4486,9 @@ static void stableApplyFunctionsOnBlock(SQueryRuntimeEnv *pRuntimeEnv, SDataBloc
   SResultRowInfo * pResultRowInfo = &pTableQueryInfo->windowResInfo;
   pQuery->pos = QUERY_IS_ASC_QUERY(pQuery)? 0 : pDataBlockInfo->rows - 1;
 
-  if (pQuery->numOfFilterCols > 0 || pRuntimeEnv->pTsBuf != NULL || pRuntimeEnv->groupbyColumn) {
+  if (isBlockwiseFilterQuery(pRuntimeEnv)) {
+    filteredBlockwiseApplyFunctions(pRuntimeEnv, pStatis, pDataBlockInfo, pDataBlock);
+  } else if (pQuery->numOfFilterCols > 0 || pRuntimeEnv->pTsBuf != NULL || pRuntimeEnv->groupbyColumn) {
     rowwiseApplyFunctions(pRuntimeEnv, pStatis, pDataBlockInfo, pResultRowInfo, pDataBlock);
   } else {
     blockwiseApplyFunctions(pRuntimeEnv, pStatis, pDataBlockInfo, pResultRowInfo, searchFn, pDataBlock);
@@ -4426,10 +4656,14 @@ static void queryCostStatis(SQInfo *pQInfo) {
   pSummary->winInfoSize = getResultRowPoolMemSize(p);
   pSummary->numOfTimeWindows = getNumOfAllocatedResultRows(p);
 
+  // blocks skipped in the query handles that are still alive
+  pSummary->skipBlocks += tsdbGetNumOfSkippedBlocks(pRuntimeEnv->pQueryHandle);
+  pSummary->skipBlocks += tsdbGetNumOfSkippedBlocks(pRuntimeEnv->pSecQueryHandle);
+
   qDebug("QInfo:%p :cost summary: elapsed time:%"PRId64" us, first merge:%"PRId64" us, total blocks:%d, "
-         "load block statis:%d, load data block:%d, total rows:%"PRId64 ", check rows:%"PRId64,
+         "load block statis:%d, load data block:%d, skip data block:%d, total rows:%"PRId64 ", check rows:%"PRId64,
          pQInfo, pSummary->elapsedTime, pSummary->firstStageMergeTime, pSummary->totalBlocks, pSummary->loadBlockStatis,
-         pSummary->loadBlocks, pSummary->totalRows, pSummary->totalCheckedRows);
+         pSummary->loadBlocks, pSummary->skipBlocks, pSummary->totalRows, pSummary->totalCheckedRows);
 
   qDebug("QInfo:%p :cost summary: winResPool size:%.2f Kb, numOfWin:%"PRId64", tableInfoSize:%.2f Kb, hashTable:%.2f Kb", pQInfo, pSummary->winInfoSize/1024.0,
       pSummary->numOfTimeWindows, pSummary->tableInfoSize/1024.0, pSummary->hashSize/1024.0);
@@ -4725,7 +4959,50 @@ static bool skipTimeInterval(SQueryRuntimeEnv *pRuntimeEnv, TSKEY* start) {
 
 static void doDestroyTableQueryInfo(STableGroupInfo* pTableqinfoGroupInfo);
 
-static int32_t setupQueryHandle(void* tsdb, SQInfo* pQInfo, bool isSTableQuery) {
+// the last non-null values of the columns may be read from the cache of tsdb instead of the data blocks
+static bool isCachedLastQuery(SQuery *pQuery, bool tsCompQuery) {
+  return onlyLastQuery(pQuery) && !QUERY_IS_INTERVAL_QUERY(pQuery) && !isGroupbyNormalCol(pQuery->pGroupbyExpr) &&
+         pQuery->numOfFilterCols == 0 && !tsCompQuery && !QUERY_IS_ASC_QUERY(pQuery);
+}
+
+/*
+ * The rollups of the time buckets can replace the data blocks of an interval query if each time window is made of
+ * whole time buckets, and all functions can be computed from the block statistics.
+ */
+static bool isRollupQuery(void* tsdb, SQueryRuntimeEnv* pRuntimeEnv, bool tsCompQuery) {
+  SQuery*    pQuery = pRuntimeEnv->pQuery;
+  SInterval* pInterval = &pQuery->interval;
+  int64_t    bucket = tsdbGetRollupInterval(tsdb);
+
+  if (bucket <= 0 || !QUERY_IS_INTERVAL_QUERY(pQuery) || !QUERY_IS_ASC_QUERY(pQuery) || tsCompQuery ||
+      pQuery->numOfFilterCols > 0 || pQuery->limit.offset > 0 || isGroupbyNormalCol(pQuery->pGroupbyExpr) ||
+      pRuntimeEnv->timeWindowInterpo) {
+    return false;
+  }
+
+  if (pInterval->intervalUnit == 'n' || pInterval->intervalUnit == 'y' || pInterval->slidingUnit == 'n' ||
+      pInterval->slidingUnit == 'y' || pInterval->offsetUnit == 'n' || pInterval->offsetUnit == 'y') {
+    return false;
+  }
+
+  if (pInterval->interval % bucket != 0 || pInterval->sliding % bucket != 0 || pInterval->offset % bucket != 0 ||
+      taosTimeTruncate(0, pInterval, pQuery->precision) % bucket != 0) {
+    return false;
+  }
+
+  for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
+    int32_t functionId = pQuery->pExpr1[i].base.functionId;
+    if (functionId != TSDB_FUNC_COUNT && functionId != TSDB_FUNC_SUM && functionId != TSDB_FUNC_AVG &&
+        functionId != TSDB_FUNC_MIN && functionId != TSDB_FUNC_MAX && functionId != TSDB_FUNC_SPREAD &&
+        functionId != TSDB_FUNC_TS && functionId != TSDB_FUNC_TAG && functionId != TSDB_FUNC_TAG_DUMMY) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static int32_t setupQueryHandle(void* tsdb, SQInfo* pQInfo, bool isSTableQuery, bool tsCompQuery) {
   SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
   SQuery *pQuery = pQInfo->runtimeEnv.pQuery;
 
@@ -4775,6 +5052,9 @@ static int32_t setupQueryHandle(void* tsdb, SQInfo* pQInfo, bool isSTableQuery)
     }
   } else if (isPointInterpoQuery(pQuery)) {
     pRuntimeEnv->pQueryHandle = tsdbQueryRowsInExternalWindow(tsdb, &cond, &pQInfo->tableGroupInfo, pQInfo, &pQInfo->memRef);
+  } else if (isCachedLastQuery(pQuery, tsCompQuery)) {
+    qDebug("QInfo:%p last query, try the cached last values of columns", pQInfo);
+    pRuntimeEnv->pQueryHandle = tsdbQueryCacheLast(tsdb, &cond, &pQInfo->tableGroupInfo, pQInfo, &pQInfo->memRef);
   } else {
     pRuntimeEnv->pQueryHandle = tsdbQueryTables(tsdb, &cond, &pQInfo->tableGroupInfo, pQInfo, &pQInfo->memRef);
   }
@@ -4820,7 +5100,12 @@ int32_t doInitQInfo(SQInfo *pQInfo, STSBuf *pTsBuf, void *tsdb, int32_t vgId, bo
 
   setScanLimitationByResultBuffer(pQuery);
 
-  int32_t code = setupQueryHandle(tsdb, pQInfo, isSTableQuery);
+  pQuery->rollup = isRollupQuery(tsdb, pRuntimeEnv, pTsBuf != NULL);
+  if (pQuery->rollup) {
+    qDebug("QInfo:%p interval query, the file groups may be read from the rollups", pQInfo);
+  }
+
+  int32_t code = setupQueryHandle(tsdb, pQInfo, isSTableQuery, pTsBuf != NULL);
   if (code != TSDB_CODE_SUCCESS) {
     return code;
   }
@@ -5051,7 +5336,7 @@ static bool multiTableMultioutputHelper(SQInfo *pQInfo, int32_t index) {
 
   // include only current table
   if (pRuntimeEnv->pQueryHandle != NULL) {
-    tsdbCleanupQueryHandle(pRuntimeEnv->pQueryHandle);
+    cleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pQueryHandle);
     pRuntimeEnv->pQueryHandle = NULL;
   }
 
@@ -5132,6 +5417,7 @@ STsdbQueryCond createTsdbQueryCond(SQuery* pQuery, STimeWindow* win) {
       .order     = pQuery->order.order,
       .numOfCols = pQuery->numOfCols,
       .loadExternalRows = false,
+      .rollup    = pQuery->rollup,
   };
 
   TIME_WINDOW_COPY(cond.twindow, *win);
@@ -5195,7 +5481,7 @@ static void sequentialTableProcess(SQInfo *pQInfo) {
 
       // include only current table
       if (pRuntimeEnv->pQueryHandle != NULL) {
-        tsdbCleanupQueryHandle(pRuntimeEnv->pQueryHandle);
+        cleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pQueryHandle);
         pRuntimeEnv->pQueryHandle = NULL;
       }
 
@@ -5255,7 +5541,7 @@ static void sequentialTableProcess(SQInfo *pQInfo) {
 
       // include only current table
       if (pRuntimeEnv->pQueryHandle != NULL) {
-        tsdbCleanupQueryHandle(pRuntimeEnv->pQueryHandle);
+        cleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pQueryHandle);
         pRuntimeEnv->pQueryHandle = NULL;
       }
 
@@ -5339,6 +5625,17 @@ static void sequentialTableProcess(SQInfo *pQInfo) {
       assert(pQuery->prjInfo.vgroupLimit == -1);
     }
 
+    bool topN = isTopNProjectionQuery(pQuery);
+    if (topN) {
+      qDebug("QInfo:%p ordered by column:%d, keep top %" PRId64 " rows in vgroup", pQInfo, pQuery->order.orderColId,
+             pQuery->prjInfo.vgroupLimit);
+    }
+
+    // the first rows in time are the first rows of the result only if it is ordered by the primary timestamp, a query
+    // ordered by other column without the heap returns all qualified rows of the vgroup
+    bool tsLimit = !topN && pQuery->prjInfo.vgroupLimit > 0 &&
+                   pQuery->order.orderColId == PRIMARYKEY_TIMESTAMP_COL_INDEX;
+
     bool hasMoreBlock = true;
     int32_t step = GET_FORWARD_DIRECTION_FACTOR(pQuery->order.order);
     SQueryCostInfo *summary = &pRuntimeEnv->summary;
@@ -5363,14 +5660,14 @@ static void sequentialTableProcess(SQInfo *pQInfo) {
         setTagVal(pRuntimeEnv, pQuery->current->pTable, pQInfo->tsdb);
       }
 
-      if (pQuery->prjInfo.vgroupLimit > 0 && pQuery->current->windowResInfo.size > pQuery->prjInfo.vgroupLimit) {
+      if (tsLimit && pQuery->current->windowResInfo.size > pQuery->prjInfo.vgroupLimit) {
         pQuery->current->lastKey =
                 QUERY_IS_ASC_QUERY(pQuery) ? blockInfo.window.ekey + step : blockInfo.window.skey + step;
         continue;
       }
 
       // it is a super table ordered projection query, check for the number of output for each vgroup
-      if (pQuery->prjInfo.vgroupLimit > 0 && pQuery->rec.rows >= pQuery->prjInfo.vgroupLimit) {
+      if (tsLimit && pQuery->rec.rows >= pQuery->prjInfo.vgroupLimit) {
         if (QUERY_IS_ASC_QUERY(pQuery) && blockInfo.window.skey >= pQuery->prjInfo.ts) {
           pQuery->current->lastKey =
                   QUERY_IS_ASC_QUERY(pQuery) ? blockInfo.window.ekey + step : blockInfo.window.skey + step;
@@ -5419,7 +5716,9 @@ static void sequentialTableProcess(SQInfo *pQInfo) {
 
       updateTableIdInfo(pQuery, pQInfo->arrTableIdInfo);
 
-      if (pQuery->prjInfo.vgroupLimit >= 0) {
+      if (topN) {
+        keepTopNResults(pRuntimeEnv);
+      } else if (pQuery->prjInfo.vgroupLimit >= 0) {
         if (((pQuery->rec.rows + pQuery->rec.total) < pQuery->prjInfo.vgroupLimit) || ((pQuery->rec.rows + pQuery->rec.total) > pQuery->prjInfo.vgroupLimit && prev < pQuery->prjInfo.vgroupLimit)) {
           if (QUERY_IS_ASC_QUERY(pQuery) && pQuery->prjInfo.ts < blockInfo.window.ekey) {
             pQuery->prjInfo.ts = blockInfo.window.ekey;
@@ -5584,7 +5883,7 @@ static int32_t doSaveContext(SQInfo *pQInfo) {
 
   // clean unused handle
   if (pRuntimeEnv->pSecQueryHandle != NULL) {
-    tsdbCleanupQueryHandle(pRuntimeEnv->pSecQueryHandle);
+    cleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pSecQueryHandle);
   }
 
   setQueryStatus(pQuery, QUERY_NOT_COMPLETED);
@@ -5631,6 +5930,390 @@ static void doCloseAllTimeWindow(SQInfo *pQInfo) {
   }
 }
 
+/*
+ * The tables of a super table aggregation are split into morsels, which are scanned by a number of workers in
+ * parallel. Each worker has its own runtime environment and result rows, and the intermediate results of the same
+ * group are merged into the query when all the morsels are scanned.
+ */
+#define MORSELS_PER_SCAN_WORKER 4
+
+typedef struct SParallelScanCtx {
+  SQInfo*         pQInfo;
+  SArray*         pMorsels;      // STableGroupInfo of the tables in each morsel
+  int32_t         nextMorsel;
+  SQInfo**        pWorkers;
+  int32_t         numOfWorkers;
+  int32_t         nextWorker;
+  int32_t         code;
+  pthread_mutex_t lock;          // protect the morsel index and the reference of the memory snapshot
+} SParallelScanCtx;
+
+static int32_t getNumOfScanWorkers(SQInfo *pQInfo) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
+  SQuery           *pQuery = pRuntimeEnv->pQuery;
+
+  if (tsNumOfScanWorkers <= 1 || pQInfo->tableqinfoGroupInfo.numOfTables <= 1 || QUERY_IS_INTERVAL_QUERY(pQuery) ||
+      pRuntimeEnv->groupbyColumn || pRuntimeEnv->pTsBuf != NULL || needReverseScan(pQuery)) {
+    return 1;
+  }
+
+  for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
+    if (!isIntermediateMergeable(pQuery->pExpr1[i].base.functionId)) {
+      return 1;
+    }
+  }
+
+  return (int32_t)MIN(tsNumOfScanWorkers, pQInfo->tableqinfoGroupInfo.numOfTables);
+}
+
+static void destroyScanMorsels(SArray *pMorsels) {
+  size_t numOfMorsels = taosArrayGetSize(pMorsels);
+  for (int32_t i = 0; i < numOfMorsels; ++i) {
+    STableGroupInfo *pMorsel = taosArrayGet(pMorsels, i);
+    taosArrayDestroy(taosArrayGetP(pMorsel->pGroupList, 0));
+    taosArrayDestroy(pMorsel->pGroupList);
+  }
+
+  taosArrayDestroy(pMorsels);
+}
+
+// the group of a table is kept in its STableQueryInfo, so the tables of one morsel are put into one group
+static SArray *createScanMorsels(SQInfo *pQInfo, int32_t numOfMorsels) {
+  size_t  numOfTables = pQInfo->tableGroupInfo.numOfTables;
+  size_t  tablesPerMorsel = (numOfTables + numOfMorsels - 1) / numOfMorsels;
+  SArray *pMorsels = taosArrayInit(numOfMorsels, sizeof(STableGroupInfo));
+  if (pMorsels == NULL) {
+    return NULL;
+  }
+
+  SArray *pTables = NULL;
+
+  size_t numOfGroups = taosArrayGetSize(pQInfo->tableGroupInfo.pGroupList);
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    SArray *group = taosArrayGetP(pQInfo->tableGroupInfo.pGroupList, i);
+
+    size_t num = taosArrayGetSize(group);
+    for (int32_t j = 0; j < num; ++j) {
+      if (pTables == NULL) {
+        STableGroupInfo morsel = {.numOfTables = 0, .pGroupList = taosArrayInit(1, POINTER_BYTES), .map = NULL};
+        pTables = taosArrayInit(tablesPerMorsel, sizeof(STableKeyInfo));
+        if (morsel.pGroupList == NULL || pTables == NULL || taosArrayPush(pMorsels, &morsel) == NULL) {
+          taosArrayDestroy(morsel.pGroupList);
+          taosArrayDestroy(pTables);
+          destroyScanMorsels(pMorsels);
+          return NULL;
+        }
+
+        taosArrayPush(morsel.pGroupList, &pTables);
+      }
+
+      taosArrayPush(pTables, taosArrayGet(group, j));
+
+      STableGroupInfo *pMorsel = taosArrayGetLast(pMorsels);
+      if (++pMorsel->numOfTables == tablesPerMorsel) {
+        pTables = NULL;
+      }
+    }
+  }
+
+  return pMorsels;
+}
+
+static void destroyScanWorker(SQInfo *pWorker) {
+  if (pWorker == NULL) {
+    return;
+  }
+
+  SQuery *pQuery = pWorker->runtimeEnv.pQuery;
+  teardownQueryRuntimeEnv(&pWorker->runtimeEnv);
+
+  tfree(pQuery->pFilterInfo);
+  tfree(pQuery);
+  tfree(pWorker);
+}
+
+/*
+ * the worker shares the table list and the query expressions of the query, while keeps its own copy of the query
+ * status, the column filters and the runtime environment.
+ */
+static SQInfo *createScanWorker(SQInfo *pQInfo) {
+  SQueryRuntimeEnv *pParentEnv = &pQInfo->runtimeEnv;
+  SQuery           *pParentQuery = pParentEnv->pQuery;
+
+  SQInfo *pWorker = calloc(1, sizeof(SQInfo));
+  SQuery *pQuery = calloc(1, sizeof(SQuery));
+  if (pWorker == NULL || pQuery == NULL) {
+    tfree(pWorker);
+    tfree(pQuery);
+    return NULL;
+  }
+
+  *pQuery = *pParentQuery;
+  pQuery->sdata = NULL;
+  pQuery->current = NULL;
+  pQuery->pFilterInfo = NULL;
+
+  pWorker->signature = pWorker;
+  pWorker->pParent = pQInfo;
+  pWorker->tsdb = pQInfo->tsdb;
+  pWorker->vgId = pQInfo->vgId;
+  pWorker->tableqinfoGroupInfo = pQInfo->tableqinfoGroupInfo;
+
+  SQueryRuntimeEnv *pRuntimeEnv = &pWorker->runtimeEnv;
+  pRuntimeEnv->pQuery = pQuery;
+
+  if (pQuery->numOfFilterCols > 0) {
+    pQuery->pFilterInfo = malloc(sizeof(SSingleColumnFilterInfo) * pQuery->numOfFilterCols);
+    if (pQuery->pFilterInfo == NULL) {
+      goto _error;
+    }
+
+    memcpy(pQuery->pFilterInfo, pParentQuery->pFilterInfo, sizeof(SSingleColumnFilterInfo) * pQuery->numOfFilterCols);
+  }
+
+  pRuntimeEnv->topBotQuery = pParentEnv->topBotQuery;
+  pRuntimeEnv->hasTagResults = pParentEnv->hasTagResults;
+  pRuntimeEnv->timeWindowInterpo = pParentEnv->timeWindowInterpo;
+  pRuntimeEnv->queryWindowIdentical = pParentEnv->queryWindowIdentical;
+  pRuntimeEnv->interBufSize = pParentEnv->interBufSize;
+  pRuntimeEnv->stableQuery = true;
+  pRuntimeEnv->cur.vgroupIndex = -1;
+  pRuntimeEnv->prevGroupId = INT32_MIN;
+
+  int32_t srcSize = 0;
+  for (int32_t i = 0; i < pQuery->numOfCols; ++i) {
+    srcSize += pQuery->colList[i].bytes;
+  }
+
+  _hash_fn_t fn = taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY);
+  pRuntimeEnv->pResultRowHashTable = taosHashInit(GET_NUM_OF_TABLEGROUP(pQInfo), fn, true, HASH_NO_LOCK);
+  pRuntimeEnv->keyBuf = malloc(TSDB_MAX_BYTES_PER_ROW);
+  pRuntimeEnv->pool = initResultRowPool(getResultRowSize(pRuntimeEnv));
+  pRuntimeEnv->prevRow = malloc(POINTER_BYTES * pQuery->numOfCols + srcSize);
+  if (pRuntimeEnv->pResultRowHashTable == NULL || pRuntimeEnv->keyBuf == NULL || pRuntimeEnv->pool == NULL ||
+      pRuntimeEnv->prevRow == NULL) {
+    goto _error;
+  }
+
+  pRuntimeEnv->prevRow[0] = POINTER_BYTES * pQuery->numOfCols + (char *)pRuntimeEnv->prevRow;
+  for (int32_t i = 1; i < pQuery->numOfCols; ++i) {
+    pRuntimeEnv->prevRow[i] = pRuntimeEnv->prevRow[i - 1] + pQuery->colList[i - 1].bytes;
+  }
+
+  int32_t ps = DEFAULT_PAGE_SIZE;
+  int32_t rowsize = 0;
+  getIntermediateBufInfo(pRuntimeEnv, &ps, &rowsize);
+
+  if (createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, rowsize, ps, 1024 * 1024 * 10, pWorker) !=
+          TSDB_CODE_SUCCESS ||
+      initResultRowInfo(&pRuntimeEnv->windowResInfo, 8, TSDB_DATA_TYPE_INT) != TSDB_CODE_SUCCESS ||
+      setupQueryRuntimeEnv(pRuntimeEnv, pQuery->order.order) != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  // the null flag of the query expressions has been consumed by the setup of the query
+  for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
+    pRuntimeEnv->pCtx[i].requireNull = pParentEnv->pCtx[i].requireNull;
+  }
+
+  return pWorker;
+
+_error:
+  destroyScanWorker(pWorker);
+  return NULL;
+}
+
+static void *parallelScanWorkerFn(void *param) {
+  SParallelScanCtx *pCtx = (SParallelScanCtx *)param;
+
+  int32_t           index = atomic_fetch_add_32(&pCtx->nextWorker, 1);
+  SQInfo           *pWorker = pCtx->pWorkers[index];
+  SQueryRuntimeEnv *pRuntimeEnv = &pWorker->runtimeEnv;
+  SQuery           *pQuery = pRuntimeEnv->pQuery;
+  int32_t           numOfMorsels = (int32_t)taosArrayGetSize(pCtx->pMorsels);
+
+  int32_t code = setjmp(pRuntimeEnv->env);
+  if (code != TSDB_CODE_SUCCESS) {
+    pthread_mutex_lock(&pCtx->lock);
+    cleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pQueryHandle);
+    pRuntimeEnv->pQueryHandle = NULL;
+
+    if (pCtx->code == TSDB_CODE_SUCCESS) {
+      pCtx->code = code;
+    }
+    pthread_mutex_unlock(&pCtx->lock);
+
+    qDebug("QInfo:%p scan worker:%p abort, code:%s", pCtx->pQInfo, pWorker, tstrerror(code));
+    return NULL;
+  }
+
+  STsdbQueryCond cond = createTsdbQueryCond(pQuery, &pQuery->window);
+
+  while (1) {
+    // the query handles share the memory snapshot of the query, whose reference is not thread safe
+    pthread_mutex_lock(&pCtx->lock);
+    int32_t morsel = (pCtx->code == TSDB_CODE_SUCCESS) ? pCtx->nextMorsel++ : numOfMorsels;
+    if (morsel < numOfMorsels) {
+      STableGroupInfo *pMorsel = taosArrayGet(pCtx->pMorsels, morsel);
+      pRuntimeEnv->pQueryHandle =
+          isCachedLastQuery(pQuery, false)
+              ? tsdbQueryCacheLast(pWorker->tsdb, &cond, pMorsel, pWorker, &pCtx->pQInfo->memRef)
+              : tsdbQueryTables(pWorker->tsdb, &cond, pMorsel, pWorker, &pCtx->pQInfo->memRef);
+    }
+    pthread_mutex_unlock(&pCtx->lock);
+
+    if (morsel >= numOfMorsels) {
+      break;
+    }
+
+    if (pRuntimeEnv->pQueryHandle == NULL) {
+      longjmp(pRuntimeEnv->env, terrno);
+    }
+
+    int64_t el = scanMultiTableDataBlocks(pWorker);
+    qDebug("QInfo:%p scan worker:%p morsel:%d completed, elapsed time:%" PRId64 "ms", pCtx->pQInfo, pWorker, morsel,
+           el);
+
+    pthread_mutex_lock(&pCtx->lock);
+    cleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pQueryHandle);
+    pRuntimeEnv->pQueryHandle = NULL;
+    pthread_mutex_unlock(&pCtx->lock);
+  }
+
+  return NULL;
+}
+
+static void mergeQueryCostInfo(SQueryCostInfo *pDst, const SQueryCostInfo *pSrc) {
+  pDst->loadStatisTime      += pSrc->loadStatisTime;
+  pDst->loadFileBlockTime   += pSrc->loadFileBlockTime;
+  pDst->loadDataInCacheTime += pSrc->loadDataInCacheTime;
+  pDst->loadStatisSize      += pSrc->loadStatisSize;
+  pDst->loadFileBlockSize   += pSrc->loadFileBlockSize;
+  pDst->loadDataInCacheSize += pSrc->loadDataInCacheSize;
+  pDst->loadDataTime        += pSrc->loadDataTime;
+  pDst->totalRows           += pSrc->totalRows;
+  pDst->totalCheckedRows    += pSrc->totalCheckedRows;
+  pDst->totalBlocks         += pSrc->totalBlocks;
+  pDst->loadBlocks          += pSrc->loadBlocks;
+  pDst->loadBlockStatis     += pSrc->loadBlockStatis;
+  pDst->discardBlocks       += pSrc->discardBlocks;
+  pDst->skipBlocks          += pSrc->skipBlocks;
+}
+
+// merge the result rows of the worker into the query, in the order of the group id
+static void mergeScanWorkerResult(SQInfo *pQInfo, SQInfo *pWorker) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
+  SQueryRuntimeEnv *pWorkerEnv = &pWorker->runtimeEnv;
+  SQuery           *pQuery = pRuntimeEnv->pQuery;
+
+  int32_t numOfGroups = (int32_t)GET_NUM_OF_TABLEGROUP(pQInfo);
+  for (int32_t groupIndex = 0; groupIndex < numOfGroups; ++groupIndex) {
+    SET_RES_WINDOW_KEY(pWorkerEnv->keyBuf, (char *)&groupIndex, sizeof(groupIndex), (uint64_t)0);
+
+    SResultRow **p = (SResultRow **)taosHashGet(pWorkerEnv->pResultRowHashTable, pWorkerEnv->keyBuf,
+                                                GET_RES_WINDOW_KEY_LEN(sizeof(groupIndex)));
+    if (p == NULL) {
+      continue;
+    }
+
+    SResultRow *pResultRow = doPrepareResultRowFromKey(pRuntimeEnv, &pRuntimeEnv->windowResInfo, (char *)&groupIndex,
+                                                       sizeof(groupIndex), true, 0);
+    if (addNewWindowResultBuf(pResultRow, pRuntimeEnv->pResultBuf, groupIndex, pRuntimeEnv->numOfRowsPerPage) !=
+        TSDB_CODE_SUCCESS) {
+      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+    }
+
+    setResultOutputBuf(pRuntimeEnv, pResultRow);
+    initCtxOutputBuf(pRuntimeEnv);
+
+    tFilePage *page = getResBufPage(pWorkerEnv->pResultBuf, (*p)->pageId);
+    for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
+      char *pInput = getPosInResultPage(pWorkerEnv, i, *p, page);
+      mergeIntermediateResult(&pRuntimeEnv->pCtx[i], pInput, getResultCell(pWorkerEnv, *p, i));
+    }
+  }
+
+  pRuntimeEnv->prevGroupId = INT32_MIN;
+  mergeQueryCostInfo(&pRuntimeEnv->summary, &pWorkerEnv->summary);
+}
+
+static int64_t parallelScanMultiTableDataBlocks(SQInfo *pQInfo, int32_t numOfWorkers) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
+
+  int64_t st = taosGetTimestampMs();
+
+  SParallelScanCtx ctx = {.pQInfo = pQInfo, .numOfWorkers = numOfWorkers, .code = TSDB_CODE_SUCCESS};
+  pthread_t       *threads = calloc(numOfWorkers, sizeof(pthread_t));
+
+  ctx.pMorsels = createScanMorsels(pQInfo, numOfWorkers * MORSELS_PER_SCAN_WORKER);
+  ctx.pWorkers = calloc(numOfWorkers, POINTER_BYTES);
+  if (threads == NULL || ctx.pMorsels == NULL || ctx.pWorkers == NULL) {
+    ctx.code = TSDB_CODE_QRY_OUT_OF_MEMORY;
+    goto _end;
+  }
+
+  for (int32_t i = 0; i < numOfWorkers; ++i) {
+    if ((ctx.pWorkers[i] = createScanWorker(pQInfo)) == NULL) {
+      ctx.code = TSDB_CODE_QRY_OUT_OF_MEMORY;
+      goto _end;
+    }
+  }
+
+  qDebug("QInfo:%p scan %" PRIzu " tables in %" PRIzu " morsels by %d workers", pQInfo,
+         pQInfo->tableqinfoGroupInfo.numOfTables, taosArrayGetSize(ctx.pMorsels), numOfWorkers);
+
+  pthread_mutex_init(&ctx.lock, NULL);
+
+  int32_t numOfThreads = 0;
+  for (; numOfThreads < numOfWorkers - 1; ++numOfThreads) {
+    if (pthread_create(threads + numOfThreads, NULL, parallelScanWorkerFn, &ctx) != 0) {
+      qWarn("QInfo:%p failed to create scan worker since %s", pQInfo, strerror(errno));
+      break;
+    }
+  }
+
+  // the query thread works as a worker too
+  parallelScanWorkerFn(&ctx);
+
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  pthread_mutex_destroy(&ctx.lock);
+
+  if (ctx.code == TSDB_CODE_SUCCESS) {
+    // keep the environment of the query, so that the workers are released if the merge fails
+    jmp_buf env;
+    memcpy(env, pRuntimeEnv->env, sizeof(jmp_buf));
+
+    ctx.code = setjmp(pRuntimeEnv->env);
+    if (ctx.code == TSDB_CODE_SUCCESS) {
+      for (int32_t i = 0; i < ctx.nextWorker; ++i) {
+        mergeScanWorkerResult(pQInfo, ctx.pWorkers[i]);
+      }
+
+      updateWindowResNumOfRes(pRuntimeEnv);
+    }
+
+    memcpy(pRuntimeEnv->env, env, sizeof(jmp_buf));
+  }
+
+_end:
+  for (int32_t i = 0; ctx.pWorkers != NULL && i < numOfWorkers; ++i) {
+    destroyScanWorker(ctx.pWorkers[i]);
+  }
+
+  tfree(ctx.pWorkers);
+  tfree(threads);
+  destroyScanMorsels(ctx.pMorsels);
+
+  if (ctx.code != TSDB_CODE_SUCCESS) {
+    longjmp(pRuntimeEnv->env, ctx.code);
+  }
+
+  return taosGetTimestampMs() - st;
+}
+
 static void multiTableQueryProcess(SQInfo *pQInfo) {
   SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
   SQuery           *pQuery = pRuntimeEnv->pQuery;
@@ -5654,7 +6337,9 @@ static void multiTableQueryProcess(SQInfo *pQInfo) {
          pQuery->window.skey, pQuery->window.ekey, pQuery->order.order);
 
   // do check all qualified data blocks
-  int64_t el = scanMultiTableDataBlocks(pQInfo);
+  int32_t numOfWorkers = getNumOfScanWorkers(pQInfo);
+  int64_t el = (numOfWorkers > 1) ? parallelScanMultiTableDataBlocks(pQInfo, numOfWorkers)
+                                  : scanMultiTableDataBlocks(pQInfo);
   qDebug("QInfo:%p master scan completed, elapsed time: %" PRId64 "ms, reverse scan start", pQInfo, el);
 
   // query error occurred or query is killed, abort current execution
@@ -5859,6 +6544,135 @@ static void tableProjectionProcess(SQInfo *pQInfo, STableQueryInfo* pTableInfo)
 }
 
 // handle time interval query on table
+/*
+ * In a sliding window query, the rows are aggregated only once into the non-overlapping panes, the length of which is
+ * the greatest common divisor of the interval and the sliding, and the result of each time window is merged from the
+ * intermediate results of its panes, instead of aggregating the rows of the overlapped time windows repeatedly.
+ */
+#define MAX_PANES_PER_SLIDING 4
+
+static int64_t getSlidingWindowPaneSize(SQueryRuntimeEnv *pRuntimeEnv) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+
+  SInterval *pInterval = &pQuery->interval;
+  if (pInterval->sliding >= pInterval->interval || pInterval->intervalUnit == 'n' || pInterval->intervalUnit == 'y' ||
+      pInterval->offset != 0 || !QUERY_IS_ASC_QUERY(pQuery) || pRuntimeEnv->groupbyColumn ||
+      pRuntimeEnv->pTsBuf != NULL || pRuntimeEnv->timeWindowInterpo || pQuery->limit.offset > 0) {
+    return 0;
+  }
+
+  for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
+    int32_t functionId = pQuery->pExpr1[i].base.functionId;
+    if (functionId != TSDB_FUNC_TS && !isIntermediateMergeable(functionId)) {
+      return 0;
+    }
+  }
+
+  int64_t a = pInterval->interval, b = pInterval->sliding;
+  while (b != 0) {
+    int64_t t = a % b;
+    a = b;
+    b = t;
+  }
+
+  // too small panes cost more in merging than the rows they save
+  return (pInterval->sliding / a > MAX_PANES_PER_SLIDING) ? 0 : a;
+}
+
+static void mergePaneIntoTimeWindow(SQueryRuntimeEnv *pRuntimeEnv, SResultRow *pWindow, SResultRow *pPane) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+
+  tFilePage *page = getResBufPage(pRuntimeEnv->pResultBuf, pPane->pageId);
+  for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
+    if (pQuery->pExpr1[i].base.functionId == TSDB_FUNC_TS) {
+      continue;
+    }
+
+    char *pInput = getPosInResultPage(pRuntimeEnv, i, pPane, page);
+    mergeIntermediateResult(&pRuntimeEnv->pCtx[i], pInput, getResultCell(pRuntimeEnv, pPane, i));
+  }
+
+  if (pPane->pageId != pWindow->pageId) {
+    releaseResBufPage(pRuntimeEnv->pResultBuf, page);
+  }
+}
+
+// replace the result rows of panes with the result rows of the time windows they belong to
+static void mergePanesIntoTimeWindows(SQueryRuntimeEnv *pRuntimeEnv) {
+  SQuery         *pQuery = pRuntimeEnv->pQuery;
+  SResultRowInfo *pWindowResInfo = &pRuntimeEnv->windowResInfo;
+  SInterval      *pInterval = &pQuery->interval;
+
+  int32_t      numOfPanes = pWindowResInfo->size;
+  SResultRow **pPanes = pWindowResInfo->pResult;
+  if (numOfPanes == 0) {
+    return;
+  }
+
+  int64_t groupId = pQuery->current->groupIndex;
+  for (int32_t i = 0; i < numOfPanes; ++i) {
+    SET_RES_WINDOW_KEY(pRuntimeEnv->keyBuf, (char *)&pPanes[i]->win.skey, TSDB_KEYSIZE, groupId);
+    taosHashRemove(pRuntimeEnv->pResultRowHashTable, pRuntimeEnv->keyBuf, GET_RES_WINDOW_KEY_LEN(TSDB_KEYSIZE));
+  }
+
+  pWindowResInfo->pResult = calloc(pWindowResInfo->capacity, POINTER_BYTES);
+  if (pWindowResInfo->pResult == NULL) {
+    pWindowResInfo->pResult = pPanes;
+    longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+  }
+
+  pWindowResInfo->size = 0;
+  pWindowResInfo->curIndex = -1;
+
+  int32_t     first = 0;
+  STimeWindow w = {.skey = taosTimeTruncate(pPanes[0]->win.skey, pInterval, pQuery->precision)};
+  while (first < numOfPanes) {
+    w.ekey = w.skey + pInterval->interval - 1;
+    if (pPanes[first]->win.skey > w.ekey) {
+      // no data in current time window, jump to the earliest one that covers the next pane, as
+      // getNextQualifiedWindow does
+      w.ekey += ((pPanes[first]->win.skey - w.ekey + pInterval->sliding - 1) / pInterval->sliding) * pInterval->sliding;
+      w.skey = w.ekey - pInterval->interval + 1;
+      continue;
+    }
+
+    STimeWindow win = {.skey = w.skey, .ekey = MIN(w.ekey, pQuery->window.ekey)};
+
+    SResultRow *pWindow = NULL;
+    int32_t     ret = setWindowOutputBufByKey(pRuntimeEnv, pWindowResInfo, &win, true, &pWindow, groupId);
+    if (ret != TSDB_CODE_SUCCESS || pWindow == NULL) {
+      free(pPanes);
+      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+    }
+
+    for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
+      SQLFunctionCtx *pCtx = &pRuntimeEnv->pCtx[i];
+      if (pQuery->pExpr1[i].base.functionId == TSDB_FUNC_TS) {
+        pCtx->size = 1;
+        pCtx->nStartQueryTimestamp = win.skey;
+        aAggs[TSDB_FUNC_TS].xFunction(pCtx);
+      }
+    }
+
+    for (int32_t i = first; i < numOfPanes && pPanes[i]->win.skey <= w.ekey; ++i) {
+      mergePaneIntoTimeWindow(pRuntimeEnv, pWindow, pPanes[i]);
+    }
+
+    pWindow->closed = true;
+
+    w.skey += pInterval->sliding;
+    while (first < numOfPanes && pPanes[first]->win.skey < w.skey) {
+      ++first;
+    }
+  }
+
+  qDebug("QInfo:%p %d panes are merged into %d sliding time windows", GET_QINFO_ADDR(pRuntimeEnv), numOfPanes,
+         pWindowResInfo->size);
+
+  free(pPanes);
+  pWindowResInfo->curIndex = pWindowResInfo->size - 1;
+}
+
 static void tableIntervalProcess(SQInfo *pQInfo, STableQueryInfo* pTableInfo) {
   SQueryRuntimeEnv *pRuntimeEnv = &(pQInfo->runtimeEnv);
   SQuery *pQuery = pRuntimeEnv->pQuery;
@@ -5874,7 +6688,21 @@ static void tableIntervalProcess(SQInfo *pQInfo, STableQueryInfo* pTableInfo) {
     }
   }
 
+  // aggregate the rows into panes by a tumbling window query of the pane size, and merge them into time windows
+  SInterval interval = pQuery->interval;
+  int64_t   paneSize = getSlidingWindowPaneSize(pRuntimeEnv);
+  if (paneSize > 0) {
+    pQuery->interval.interval = paneSize;
+    pQuery->interval.sliding = paneSize;
+  }
+
   scanOneTableDataBlocks(pRuntimeEnv, newStartKey);
+
+  if (paneSize > 0) {
+    pQuery->interval = interval;
+    mergePanesIntoTimeWindows(pRuntimeEnv);
+  }
+
   finalizeQueryResult(pRuntimeEnv);
 
   // skip offset result rows
@@ -6664,6 +7492,7 @@ static int32_t createFilterInfo(void *pQInfo, SQuery *pQuery) {
           return TSDB_CODE_QRY_INVALID_MSG;
         }
 
+        pSingleColFilter->blockFp = getBlockFilterOperator(lower, upper);
         pSingleColFilter->bytes = pQuery->colList[i].bytes;
       }
 
@@ -351,7 +351,7 @@ static FORCE_INLINE int32_t primaryKeyComparator(int64_t f1, int64_t f2, int32_t
   }
 }
 
-static FORCE_INLINE int32_t columnValueAscendingComparator(char *f1, char *f2, int32_t type, int32_t bytes) {
+int32_t columnValueAscendingComparator(char *f1, char *f2, int32_t type, int32_t bytes) {
   switch (type) {
     case TSDB_DATA_TYPE_INT: {
       int32_t first  = *(int32_t *) f1;
@@ -362,6 +362,13 @@ static FORCE_INLINE int32_t columnValueAscendingComparator(char *f1, char *f2, i
       return (first < second) ? -1 : 1;
     };
     case TSDB_DATA_TYPE_DOUBLE: {
+      // null is a NaN that is not ordered, put it ahead of all values as the null of integers
+      bool null1 = isNull(f1, TSDB_DATA_TYPE_DOUBLE);
+      bool null2 = isNull(f2, TSDB_DATA_TYPE_DOUBLE);
+      if (null1 || null2) {
+        return (null1 == null2) ? 0 : (null1 ? -1 : 1);
+      }
+
       double first  = GET_DOUBLE_VAL(f1);
       double second = GET_DOUBLE_VAL(f2);
       if (first == second) {
@@ -370,6 +377,12 @@ static FORCE_INLINE int32_t columnValueAscendingComparator(char *f1, char *f2, i
       return (first < second) ? -1 : 1;
     };
     case TSDB_DATA_TYPE_FLOAT: {
+      bool null1 = isNull(f1, TSDB_DATA_TYPE_FLOAT);
+      bool null2 = isNull(f2, TSDB_DATA_TYPE_FLOAT);
+      if (null1 || null2) {
+        return (null1 == null2) ? 0 : (null1 ? -1 : 1);
+      }
+
       float first  = GET_FLOAT_VAL(f1);
       float second = GET_FLOAT_VAL(f2);
       if (first == second) {
@@ -402,6 +415,38 @@ static FORCE_INLINE int32_t columnValueAscendingComparator(char *f1, char *f2, i
       }
       return (first < second) ? -1 : 1;
     };
+    case TSDB_DATA_TYPE_UTINYINT: {
+      uint8_t first = *(uint8_t *)f1;
+      uint8_t second = *(uint8_t *)f2;
+      if (first == second) {
+        return 0;
+      }
+      return (first < second) ? -1 : 1;
+    };
+    case TSDB_DATA_TYPE_USMALLINT: {
+      uint16_t first = *(uint16_t *)f1;
+      uint16_t second = *(uint16_t *)f2;
+      if (first == second) {
+        return 0;
+      }
+      return (first < second) ? -1 : 1;
+    };
+    case TSDB_DATA_TYPE_UINT: {
+      uint32_t first = *(uint32_t *)f1;
+      uint32_t second = *(uint32_t *)f2;
+      if (first == second) {
+        return 0;
+      }
+      return (first < second) ? -1 : 1;
+    };
+    case TSDB_DATA_TYPE_UBIGINT: {
+      uint64_t first = *(uint64_t *)f1;
+      uint64_t second = *(uint64_t *)f2;
+      if (first == second) {
+        return 0;
+      }
+      return (first < second) ? -1 : 1;
+    };
     case TSDB_DATA_TYPE_BINARY: {
       int32_t len1 = varDataLen(f1);
       int32_t len2 = varDataLen(f2);
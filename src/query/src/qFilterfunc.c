@@ -17,17 +17,11 @@
 #include "os.h"
 
 #include "qExecutor.h"
+#include "qUtil.h"
 #include "taosmsg.h"
 #include "tcompare.h"
 #include "ttype.h"
 
-#define FLT_COMPAR_TOL_FACTOR    4
-#define FLT_EQUAL(_x, _y)        (fabs((_x) - (_y)) <= (FLT_COMPAR_TOL_FACTOR * FLT_EPSILON))
-#define FLT_GREATER(_x, _y)      (!FLT_EQUAL((_x), (_y)) && ((_x) > (_y)))
-#define FLT_LESS(_x, _y)         (!FLT_EQUAL((_x), (_y)) && ((_x) < (_y)))
-#define FLT_GREATEREQUAL(_x, _y) (FLT_EQUAL((_x), (_y)) || ((_x) > (_y)))
-#define FLT_LESSEQUAL(_x, _y)    (FLT_EQUAL((_x), (_y)) || ((_x) < (_y)))
-
 bool lessOperator(SColumnFilterElem *pFilter, const char* minval, const char* maxval, int16_t type) {
   SColumnFilterInfo* pFilterInfo = &pFilter->filterInfo;
 
@@ -153,9 +147,9 @@ bool equalOperator(SColumnFilterElem *pFilter, const char *minval, const char *m
 
     if (minv == maxv) {
       return FLT_EQUAL(minv, pFilterInfo->lowerBndd);
-    } else {  // range filter
+    } else {  // range filter, the values next to the range within the tolerance equal the bound too
       assert(minv < maxv);
-      return minv <= pFilterInfo->lowerBndd && pFilterInfo->lowerBndd <= maxv;
+      return FLT_LESSEQUAL(minv, pFilterInfo->lowerBndd) && FLT_GREATEREQUAL(maxv, pFilterInfo->lowerBndd);
     }
   } else if (type == TSDB_DATA_TYPE_BINARY) {
     // query condition string is greater than the max length of string, not qualified data
@@ -377,6 +371,274 @@ bool rangeFilter_ei(SColumnFilterElem *pFilter, const char *minval, const char *
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+// block filter kernels, evaluate one filter on all rows of a column block, null value is checked by the caller
+#define FILTER_BLOCK_BATCH 512
+
+#define FILTER_BLOCK_LOOP(_type, _data, _rows, _p, _cond) \
+  do {                                                    \
+    const _type *_v = (const _type *)(_data);             \
+    for (int32_t _i = 0; _i < (_rows); ++_i) {            \
+      _type x = _v[_i];                                   \
+      (_p)[_i] = (_cond);                                 \
+    }                                                     \
+  } while (0)
+
+#define FILTER_BLOCK_INTEGER_CASES(_data, _rows, _p, _cond)                                         \
+  case TSDB_DATA_TYPE_TINYINT: FILTER_BLOCK_LOOP(int8_t, _data, _rows, _p, _cond); break;           \
+  case TSDB_DATA_TYPE_UTINYINT: FILTER_BLOCK_LOOP(uint8_t, _data, _rows, _p, _cond); break;         \
+  case TSDB_DATA_TYPE_SMALLINT: FILTER_BLOCK_LOOP(int16_t, _data, _rows, _p, _cond); break;         \
+  case TSDB_DATA_TYPE_USMALLINT: FILTER_BLOCK_LOOP(uint16_t, _data, _rows, _p, _cond); break;       \
+  case TSDB_DATA_TYPE_INT: FILTER_BLOCK_LOOP(int32_t, _data, _rows, _p, _cond); break;              \
+  case TSDB_DATA_TYPE_UINT: FILTER_BLOCK_LOOP(uint32_t, _data, _rows, _p, _cond); break;            \
+  case TSDB_DATA_TYPE_TIMESTAMP:                                                                    \
+  case TSDB_DATA_TYPE_BIGINT: FILTER_BLOCK_LOOP(int64_t, _data, _rows, _p, _cond); break;           \
+  case TSDB_DATA_TYPE_UBIGINT: FILTER_BLOCK_LOOP(uint64_t, _data, _rows, _p, _cond); break
+
+// binary, nchar and bool columns fall back to the single row filter
+static void rowFilterBlock(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  for (int32_t i = 0; i < rows; ++i) {
+    const char *pElem = pData + pFilter->bytes * i;
+    p[i] = pFilter->fp(pFilter, pElem, pElem, type);
+  }
+}
+
+static void lessBlockFilter(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  int64_t bndi = pFilter->filterInfo.upperBndi;
+  double  bndd = pFilter->filterInfo.upperBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, x < bndi);
+    case TSDB_DATA_TYPE_FLOAT: FILTER_BLOCK_LOOP(float, pData, rows, p, FLT_LESS(x, bndd)); break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, x < bndd); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+static void greaterBlockFilter(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  int64_t bndi = pFilter->filterInfo.lowerBndi;
+  double  bndd = pFilter->filterInfo.lowerBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, x > bndi);
+    case TSDB_DATA_TYPE_FLOAT: FILTER_BLOCK_LOOP(float, pData, rows, p, FLT_GREATER(x, bndd)); break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, x > bndd); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+static void lessEqualBlockFilter(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  int64_t bndi = pFilter->filterInfo.upperBndi;
+  double  bndd = pFilter->filterInfo.upperBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, x <= bndi);
+    case TSDB_DATA_TYPE_FLOAT: FILTER_BLOCK_LOOP(float, pData, rows, p, FLT_LESSEQUAL(x, bndd)); break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, x <= bndd); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+static void greaterEqualBlockFilter(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type,
+                                    int8_t *p) {
+  int64_t bndi = pFilter->filterInfo.lowerBndi;
+  double  bndd = pFilter->filterInfo.lowerBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, x >= bndi);
+    case TSDB_DATA_TYPE_FLOAT: FILTER_BLOCK_LOOP(float, pData, rows, p, FLT_GREATEREQUAL(x, bndd)); break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, x >= bndd); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+// the integer value is compared in 64 bits, the same as equalOperator
+static void equalBlockFilter(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  uint64_t bndi = (uint64_t)pFilter->filterInfo.lowerBndi;
+  double   bndd = pFilter->filterInfo.lowerBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, (uint64_t)x == bndi);
+    case TSDB_DATA_TYPE_FLOAT: FILTER_BLOCK_LOOP(float, pData, rows, p, FLT_EQUAL(x, bndd)); break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, FLT_EQUAL(x, bndd)); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+static void notEqualBlockFilter(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  uint64_t bndi = (uint64_t)pFilter->filterInfo.lowerBndi;
+  double   bndd = pFilter->filterInfo.lowerBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, (uint64_t)x != bndi);
+    case TSDB_DATA_TYPE_FLOAT: FILTER_BLOCK_LOOP(float, pData, rows, p, !FLT_EQUAL(x, bndd)); break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, !FLT_EQUAL(x, bndd)); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+// null check is done by the caller with the not null mask
+static void nullBlockFilter(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  memset(p, 1, rows);
+}
+
+static void rangeBlockFilter_ii(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  SColumnFilterInfo *pFilterInfo = &pFilter->filterInfo;
+
+  int64_t lower = pFilterInfo->lowerBndi, upper = pFilterInfo->upperBndi;
+  double  lowerd = pFilterInfo->lowerBndd, upperd = pFilterInfo->upperBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, (x <= upper) & (x >= lower));
+    case TSDB_DATA_TYPE_FLOAT:
+      FILTER_BLOCK_LOOP(float, pData, rows, p, FLT_LESSEQUAL(x, upperd) && FLT_GREATEREQUAL(x, lowerd));
+      break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, (x <= upperd) & (x >= lowerd)); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+static void rangeBlockFilter_ee(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  SColumnFilterInfo *pFilterInfo = &pFilter->filterInfo;
+
+  int64_t lower = pFilterInfo->lowerBndi, upper = pFilterInfo->upperBndi;
+  double  lowerd = pFilterInfo->lowerBndd, upperd = pFilterInfo->upperBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, (x < upper) & (x > lower));
+    case TSDB_DATA_TYPE_FLOAT: FILTER_BLOCK_LOOP(float, pData, rows, p, (x < upperd) & (x > lowerd)); break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, (x < upperd) & (x > lowerd)); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+static void rangeBlockFilter_ie(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  SColumnFilterInfo *pFilterInfo = &pFilter->filterInfo;
+
+  int64_t lower = pFilterInfo->lowerBndi, upper = pFilterInfo->upperBndi;
+  double  lowerd = pFilterInfo->lowerBndd, upperd = pFilterInfo->upperBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, (x < upper) & (x >= lower));
+    case TSDB_DATA_TYPE_FLOAT: FILTER_BLOCK_LOOP(float, pData, rows, p, (x < upperd) & (x >= lowerd)); break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, (x < upperd) & (x >= lowerd)); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+static void rangeBlockFilter_ei(SColumnFilterElem *pFilter, const char *pData, int32_t rows, int16_t type, int8_t *p) {
+  SColumnFilterInfo *pFilterInfo = &pFilter->filterInfo;
+
+  int64_t lower = pFilterInfo->lowerBndi, upper = pFilterInfo->upperBndi;
+  double  lowerd = pFilterInfo->lowerBndd, upperd = pFilterInfo->upperBndd;
+
+  switch (type) {
+    FILTER_BLOCK_INTEGER_CASES(pData, rows, p, (x <= upper) & (x > lower));
+    case TSDB_DATA_TYPE_FLOAT:
+      FILTER_BLOCK_LOOP(float, pData, rows, p, FLT_GREATER(x, lowerd) && FLT_LESSEQUAL(x, upperd));
+      break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(double, pData, rows, p, (x <= upperd) & (x > lowerd)); break;
+    default: rowFilterBlock(pFilter, pData, rows, type, p);
+  }
+}
+
+static void setNotNullMask(const char *pData, int32_t rows, int16_t type, int16_t bytes, int8_t *p) {
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL: FILTER_BLOCK_LOOP(uint8_t, pData, rows, p, x != TSDB_DATA_BOOL_NULL); break;
+    case TSDB_DATA_TYPE_TINYINT: FILTER_BLOCK_LOOP(uint8_t, pData, rows, p, x != TSDB_DATA_TINYINT_NULL); break;
+    case TSDB_DATA_TYPE_UTINYINT: FILTER_BLOCK_LOOP(uint8_t, pData, rows, p, x != TSDB_DATA_UTINYINT_NULL); break;
+    case TSDB_DATA_TYPE_SMALLINT: FILTER_BLOCK_LOOP(uint16_t, pData, rows, p, x != TSDB_DATA_SMALLINT_NULL); break;
+    case TSDB_DATA_TYPE_USMALLINT: FILTER_BLOCK_LOOP(uint16_t, pData, rows, p, x != TSDB_DATA_USMALLINT_NULL); break;
+    case TSDB_DATA_TYPE_INT: FILTER_BLOCK_LOOP(uint32_t, pData, rows, p, x != TSDB_DATA_INT_NULL); break;
+    case TSDB_DATA_TYPE_UINT: FILTER_BLOCK_LOOP(uint32_t, pData, rows, p, x != TSDB_DATA_UINT_NULL); break;
+    case TSDB_DATA_TYPE_FLOAT: FILTER_BLOCK_LOOP(uint32_t, pData, rows, p, x != TSDB_DATA_FLOAT_NULL); break;
+    case TSDB_DATA_TYPE_TIMESTAMP:
+    case TSDB_DATA_TYPE_BIGINT: FILTER_BLOCK_LOOP(uint64_t, pData, rows, p, x != TSDB_DATA_BIGINT_NULL); break;
+    case TSDB_DATA_TYPE_UBIGINT: FILTER_BLOCK_LOOP(uint64_t, pData, rows, p, x != TSDB_DATA_UBIGINT_NULL); break;
+    case TSDB_DATA_TYPE_DOUBLE: FILTER_BLOCK_LOOP(uint64_t, pData, rows, p, x != TSDB_DATA_DOUBLE_NULL); break;
+    default:
+      for (int32_t i = 0; i < rows; ++i) {
+        p[i] = !isNull(pData + bytes * i, type);
+      }
+  }
+}
+
+void filterBitmapAnd(int8_t *dst, const int8_t *src, int32_t numOfRows) {
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    dst[i] &= src[i];
+  }
+}
+
+void filterBitmapOr(int8_t *dst, const int8_t *src, int32_t numOfRows) {
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    dst[i] |= src[i];
+  }
+}
+
+static int32_t filterBitmapCount(const int8_t *p, int32_t numOfRows) {
+  int32_t num = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    num += p[i];
+  }
+
+  return num;
+}
+
+/**
+ * Filters of one column are combined by OR, and the different columns are combined by AND, the same as the
+ * single row version. The rows are processed in batches, so the intermediate bitmaps stay in L1 cache.
+ *
+ * @param pFilterInfo     filter info of each column, pData points to the column data of current block
+ * @param numOfFilterCols number of filter columns
+ * @param numOfRows       number of rows in current block
+ * @param p               output row selection, 1 for the qualified row
+ * @return                number of qualified rows
+ */
+int32_t doFilterDataBlock(SSingleColumnFilterInfo *pFilterInfo, int32_t numOfFilterCols, int32_t numOfRows, int8_t *p) {
+  int8_t notNull[FILTER_BLOCK_BATCH];
+  int8_t colRes[FILTER_BLOCK_BATCH];
+  int8_t elemRes[FILTER_BLOCK_BATCH];
+
+  int32_t numOfQualified = 0;
+  for (int32_t start = 0; start < numOfRows; start += FILTER_BLOCK_BATCH) {
+    int32_t rows = MIN(numOfRows - start, FILTER_BLOCK_BATCH);
+    int8_t *res = p + start;
+
+    int32_t num = rows;
+    memset(res, 1, rows);
+
+    for (int32_t k = 0; k < numOfFilterCols && num > 0; ++k) {
+      SSingleColumnFilterInfo *pInfo = &pFilterInfo[k];
+      const char *pData = (const char *)pInfo->pData + pInfo->info.bytes * start;
+
+      setNotNullMask(pData, rows, pInfo->info.type, pInfo->info.bytes, notNull);
+      memset(colRes, 0, rows);
+
+      for (int32_t j = 0; j < pInfo->numOfFilters; ++j) {
+        SColumnFilterElem *pFilterElem = &pInfo->pFilters[j];
+
+        if (pFilterElem->fp == isNullOperator) {
+          for (int32_t i = 0; i < rows; ++i) {
+            elemRes[i] = notNull[i] ^ 1;
+          }
+        } else {
+          pFilterElem->blockFp(pFilterElem, pData, rows, pInfo->info.type, elemRes);
+          filterBitmapAnd(elemRes, notNull, rows);
+        }
+
+        filterBitmapOr(colRes, elemRes, rows);
+      }
+
+      filterBitmapAnd(res, colRes, rows);
+      num = filterBitmapCount(res, rows);
+    }
+
+    numOfQualified += num;
+  }
+
+  return numOfQualified;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 bool (*filterOperators[])(SColumnFilterElem *pFilter, const char* minval, const char* maxval, int16_t type) = {
     NULL,
@@ -399,6 +661,27 @@ bool (*rangeFilterOperators[])(SColumnFilterElem *pFilter, const char* minval, c
     rangeFilter_ii,
 };
 
+static __filter_block_func_t filterBlockOperators[] = {
+    NULL,
+    lessBlockFilter,
+    greaterBlockFilter,
+    equalBlockFilter,
+    lessEqualBlockFilter,
+    greaterEqualBlockFilter,
+    notEqualBlockFilter,
+    rowFilterBlock,
+    nullBlockFilter,
+    nullBlockFilter,
+};
+
+static __filter_block_func_t rangeFilterBlockOperators[] = {
+    NULL,
+    rangeBlockFilter_ee,
+    rangeBlockFilter_ie,
+    rangeBlockFilter_ei,
+    rangeBlockFilter_ii,
+};
+
 __filter_func_t getFilterOperator(int32_t lowerOptr, int32_t upperOptr) {
   __filter_func_t funcFp = NULL;
 
@@ -432,3 +715,20 @@ __filter_func_t getFilterOperator(int32_t lowerOptr, int32_t upperOptr) {
 
   return funcFp;
 }
+
+__filter_block_func_t getBlockFilterOperator(int32_t lowerOptr, int32_t upperOptr) {
+  if ((lowerOptr == TSDB_RELATION_GREATER_EQUAL || lowerOptr == TSDB_RELATION_GREATER) &&
+      (upperOptr == TSDB_RELATION_LESS_EQUAL || upperOptr == TSDB_RELATION_LESS)) {
+    if (lowerOptr == TSDB_RELATION_GREATER_EQUAL) {
+      return (upperOptr == TSDB_RELATION_LESS_EQUAL) ? rangeFilterBlockOperators[4] : rangeFilterBlockOperators[2];
+    } else {
+      return (upperOptr == TSDB_RELATION_LESS_EQUAL) ? rangeFilterBlockOperators[3] : rangeFilterBlockOperators[1];
+    }
+  }
+
+  if (lowerOptr != TSDB_RELATION_INVALID) {
+    return (upperOptr != TSDB_RELATION_INVALID) ? NULL : filterBlockOperators[lowerOptr];
+  } else {
+    return filterBlockOperators[upperOptr];
+  }
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+
+#include "qHyperLogLog.h"
+
+/**
+ * the HyperLogLog cardinality estimation, based on the paper:
+ * Philippe Flajolet, Eric Fusy, Olivier Gandouet, Frederic Meunier. HyperLogLog: the analysis of a near-optimal
+ * cardinality estimation algorithm, AofA 2007.
+ *
+ * The 64 bits hash value is used, so the large range correction of the 32 bits version is not required.
+ */
+static uint64_t hllHash64(const void* key, int32_t len) {
+  const uint64_t m = 0xc6a4a7935bd1e995ULL;
+  const int32_t  r = 47;
+
+  uint64_t h = 0x8445d61a4e774912ULL ^ ((uint64_t)len * m);
+
+  const uint8_t* data = (const uint8_t*)key;
+  const uint8_t* end = data + (len / 8) * 8;
+  while (data != end) {
+    uint64_t k = 0;
+    memcpy(&k, data, sizeof(uint64_t));
+    data += sizeof(uint64_t);
+
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+
+    h ^= k;
+    h *= m;
+  }
+
+  switch (len & 7) {
+    case 7: h ^= (uint64_t)data[6] << 48;  // fall through
+    case 6: h ^= (uint64_t)data[5] << 40;  // fall through
+    case 5: h ^= (uint64_t)data[4] << 32;  // fall through
+    case 4: h ^= (uint64_t)data[3] << 24;  // fall through
+    case 3: h ^= (uint64_t)data[2] << 16;  // fall through
+    case 2: h ^= (uint64_t)data[1] << 8;   // fall through
+    case 1: h ^= (uint64_t)data[0];
+      h *= m;
+  }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+int32_t tHllSketchSize(int32_t precision) {
+  assert(precision >= HLL_MIN_PRECISION && precision <= HLL_MAX_PRECISION);
+  return (int32_t)sizeof(SHLLInfo) + (1 << precision);
+}
+
+void tHllInit(SHLLInfo* pInfo, int32_t precision) {
+  memset(pInfo, 0, tHllSketchSize(precision));
+  pInfo->precision = (int8_t)precision;
+}
+
+void tHllAdd(SHLLInfo* pInfo, const void* pData, int32_t len) {
+  uint64_t hash = hllHash64(pData, len);
+
+  // the leading bits choose the register, and the position of the first 1 bit in the rest is the rank
+  int32_t  index = (int32_t)(hash >> (64 - pInfo->precision));
+  uint64_t bits = (hash << pInfo->precision) | ((uint64_t)1 << (pInfo->precision - 1));
+
+  uint8_t rank = 1;
+  while ((bits & ((uint64_t)1 << 63)) == 0) {
+    bits <<= 1;
+    rank += 1;
+  }
+
+  if (pInfo->registers[index] < rank) {
+    pInfo->registers[index] = rank;
+  }
+}
+
+void tHllMerge(SHLLInfo* pDst, const SHLLInfo* pSrc) {
+  assert(pDst->precision == pSrc->precision);
+
+  int32_t num = 1 << pDst->precision;
+  for (int32_t i = 0; i < num; ++i) {
+    if (pDst->registers[i] < pSrc->registers[i]) {
+      pDst->registers[i] = pSrc->registers[i];
+    }
+  }
+}
+
+uint64_t tHllEstimate(const SHLLInfo* pInfo) {
+  int32_t m = 1 << pInfo->precision;
+
+  double  sum = 0;
+  int32_t numOfZeros = 0;
+  for (int32_t i = 0; i < m; ++i) {
+    sum += ldexp(1.0, -pInfo->registers[i]);
+    numOfZeros += (pInfo->registers[i] == 0);
+  }
+
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  if (m == 16) {
+    alpha = 0.673;
+  } else if (m == 32) {
+    alpha = 0.697;
+  } else if (m == 64) {
+    alpha = 0.709;
+  }
+
+  double estimate = alpha * m * m / sum;
+
+  // small range correction by linear counting
+  if (estimate <= 2.5 * m && numOfZeros > 0) {
+    estimate = m * log((double)m / numOfZeros);
+  }
+
+  return (uint64_t)(estimate + 0.5);
+}
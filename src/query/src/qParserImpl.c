@@ -52,6 +52,16 @@ SSqlInfo qSQLParse(const char *pStr) {
         goto abort_parse;
       }
       
+      case TK_HYPERLOGLOG: {
+        // a function keyword without a terminal in the grammar, it falls back to ID as the function keywords in the
+        // %fallback list of sql.y do, and the token keeps its type to tell the function
+        Parse(pParser, TK_ID, t0, &sqlInfo);
+        if (sqlInfo.valid == false) {
+          goto abort_parse;
+        }
+        break;
+      }
+
       case TK_QUESTION:
       case TK_ILLEGAL: {
         snprintf(sqlInfo.msg, tListLen(sqlInfo.msg), "unrecognized token: \"%s\"", t0.z);
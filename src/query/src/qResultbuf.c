@@ -36,7 +36,7 @@ int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t ro
 
   // init id hash table
   pResBuf->groupSet  = taosHashInit(10, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, false);
-  pResBuf->assistBuf = malloc(pResBuf->pageSize + 2); // EXTRA BYTES
+  pResBuf->assistBuf = malloc(pResBuf->pageSize + 2); // the compressed page may take one more byte than the raw one
   pResBuf->all = taosHashInit(10, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, false);
 
   char path[PATH_MAX] = {0};
@@ -44,6 +44,7 @@ int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t ro
   pResBuf->path = strdup(path);
 
   pResBuf->emptyDummyIdList = taosArrayInit(1, sizeof(int32_t));
+  pResBuf->pFree = taosArrayInit(4, sizeof(SFreeListItem));
 
   qDebug("QInfo:%p create resBuf for output, page size:%d, inmem buf pages:%d, file:%s", handle, pResBuf->pageSize,
          pResBuf->inMemPages, pResBuf->path);
@@ -61,108 +62,149 @@ static int32_t createDiskFile(SDiskbasedResultBuf* pResultBuf) {
   return TSDB_CODE_SUCCESS;
 }
 
-static char* doCompressData(void* data, int32_t srcSize, int32_t *dst, SDiskbasedResultBuf* pResultBuf) { // do nothing
+// Compress the page into the assistant buffer. The page is flushed as it is if it does not become smaller.
+static char* doCompressData(void* data, int32_t srcSize, int32_t *dst, bool* compressed,
+                            SDiskbasedResultBuf* pResultBuf) {
+  *dst = srcSize;
+  *compressed = false;
   if (!pResultBuf->comp) {
-    *dst = srcSize;
     return data;
   }
 
-  *dst = tsCompressString(data, srcSize, 1, pResultBuf->assistBuf, srcSize, ONE_STAGE_COMP, NULL, 0);
+  int32_t len = tsCompressString(data, srcSize, 1, pResultBuf->assistBuf, srcSize + 1, ONE_STAGE_COMP, NULL, 0);
+  if (len <= 0 || len >= srcSize) {
+    return data;
+  }
 
-  memcpy(data, pResultBuf->assistBuf, *dst);
-  return data;
+  *dst = len;
+  *compressed = true;
+  return pResultBuf->assistBuf;
 }
 
-static char* doDecompressData(void* data, int32_t srcSize, int32_t *dst, SDiskbasedResultBuf* pResultBuf) { // do nothing
-  if (!pResultBuf->comp) {
-    *dst = srcSize;
-    return data;
+static int32_t doDecompressData(const char* data, int32_t srcSize, char* dst, SDiskbasedResultBuf* pResultBuf) {
+  return tsDecompressString(data, srcSize, 1, dst, pResultBuf->pageSize, ONE_STAGE_COMP, NULL, 0);
+}
+
+// return the area to the free list, merged with the adjacent free areas
+static void addFreeAreaInFile(SDiskbasedResultBuf* pResultBuf, int64_t offset, int64_t len) {
+  if (len <= 0) {
+    return;
   }
 
-  *dst = tsDecompressString(data, srcSize, 1, pResultBuf->assistBuf, pResultBuf->pageSize, ONE_STAGE_COMP, NULL, 0);
+  SArray* pFree = pResultBuf->pFree;
+  SFreeListItem item = {.offset = offset, .len = len};
 
-  memcpy(data, pResultBuf->assistBuf, *dst);
-  return data;
-}
+  size_t num = taosArrayGetSize(pFree);
+  size_t pos = 0;
+  while (pos < num && ((SFreeListItem*) taosArrayGet(pFree, pos))->offset < offset) {
+    pos += 1;
+  }
 
-static int32_t allocatePositionInFile(SDiskbasedResultBuf* pResultBuf, size_t size) {
-  if (pResultBuf->pFree == NULL) {
-    return pResultBuf->nextPos;
-  } else {
-    int32_t offset = -1;
-
-    size_t num = taosArrayGetSize(pResultBuf->pFree);
-    for(int32_t i = 0; i < num; ++i) {
-      SFreeListItem* pi = taosArrayGet(pResultBuf->pFree, i);
-      if (pi->len >= size) {
-        offset = pi->offset;
-        pi->offset += (int32_t)size;
-        pi->len -= (int32_t)size;
-
-        return offset;
-      }
+  if (pos > 0) {
+    SFreeListItem* prev = taosArrayGet(pFree, pos - 1);
+    if (prev->offset + prev->len == item.offset) {
+      item.offset = prev->offset;
+      item.len += prev->len;
+      taosArrayRemove(pFree, --pos);
+      num -= 1;
+    }
+  }
+
+  if (pos < num) {
+    SFreeListItem* next = taosArrayGet(pFree, pos);
+    if (item.offset + item.len == next->offset) {
+      item.len += next->len;
+      taosArrayRemove(pFree, pos);
     }
+  }
 
-    // no available recycle space, allocate new area in file
-    return pResultBuf->nextPos;
+  // the free area at the end of file is given back to the unused part of file
+  if (item.offset + item.len == pResultBuf->nextPos) {
+    pResultBuf->nextPos = item.offset;
+  } else {
+    taosArrayInsert(pFree, pos, &item);
   }
 }
 
-static char* doFlushPageToDisk(SDiskbasedResultBuf* pResultBuf, SPageInfo* pg) {
-  assert(!pg->used && pg->pData != NULL);
+// find the best fit free area for the flushed page, or allocate new area at the end of file
+static int64_t allocatePositionInFile(SDiskbasedResultBuf* pResultBuf, int32_t size) {
+  int32_t index = -1;
 
-  int32_t size = -1;
-  char* t = doCompressData(GET_DATA_PAYLOAD(pg), pResultBuf->pageSize, &size, pResultBuf);
+  size_t num = taosArrayGetSize(pResultBuf->pFree);
+  for(int32_t i = 0; i < num; ++i) {
+    SFreeListItem* pi = taosArrayGet(pResultBuf->pFree, i);
+    if (pi->len >= size && (index < 0 || pi->len < ((SFreeListItem*) taosArrayGet(pResultBuf->pFree, index))->len)) {
+      index = i;
+    }
+  }
 
-  // this page is flushed to disk for the first time
-  if (pg->info.offset == -1) {
-    pg->info.offset = allocatePositionInFile(pResultBuf, size);
-    pResultBuf->nextPos += size;
+  if (index >= 0) {
+    SFreeListItem* pi = taosArrayGet(pResultBuf->pFree, index);
 
-    int32_t ret = fseek(pResultBuf->file, pg->info.offset, SEEK_SET);
-    assert(ret == 0);
+    int64_t offset = pi->offset;
+    pi->offset += size;
+    pi->len -= size;
+    if (pi->len == 0) {
+      taosArrayRemove(pResultBuf->pFree, index);
+    }
 
-    ret = (int32_t) fwrite(t, 1, size, pResultBuf->file);
-    assert(ret == size);
+    return offset;
+  }
 
-    if (pResultBuf->fileSize < pg->info.offset + pg->info.length) {
-      pResultBuf->fileSize = pg->info.offset + pg->info.length;
-    }
-  } else {
-    // length becomes greater, current space is not enough, allocate new place, otherwise, do nothing
-    if (pg->info.length < size) {
-      // 1. add current space to free list
-      taosArrayPush(pResultBuf->pFree, &pg->info);
-
-      // 2. allocate new position, and update the info
-      pg->info.offset = allocatePositionInFile(pResultBuf, size);
-      pResultBuf->nextPos += size;
-    }
+  int64_t offset = pResultBuf->nextPos;
+  pResultBuf->nextPos += size;
+  return offset;
+}
 
-    //3. write to disk.
-    int32_t ret = fseek(pResultBuf->file, pg->info.offset, SEEK_SET);
-    if (ret != 0) {  // todo handle the error case
+static char* doFlushPageToDisk(SDiskbasedResultBuf* pResultBuf, SPageInfo* pg) {
+  assert(!pg->used && pg->pData != NULL);
 
+  int32_t size = -1;
+  bool    compressed = false;
+  char*   t = doCompressData(GET_DATA_PAYLOAD(pg), pResultBuf->pageSize, &size, &compressed, pResultBuf);
+
+  SPageDiskInfo info = pg->info;
+  if (info.offset == -1 || info.length < size) {
+    // flushed for the first time, or the area of the previous flush is not enough
+    if (info.offset != -1) {
+      addFreeAreaInFile(pResultBuf, info.offset, info.length);
     }
 
-    ret = (int32_t)fwrite(t, size, 1, pResultBuf->file);
-    if (ret != size) {  // todo handle the error case
+    info.offset = allocatePositionInFile(pResultBuf, size);
+  } else {
+    addFreeAreaInFile(pResultBuf, info.offset + size, info.length - size);
+  }
+
+  info.length = size;
 
-    }
+  if (fseek(pResultBuf->file, info.offset, SEEK_SET) != 0 ||
+      fwrite(t, 1, size, pResultBuf->file) != (size_t) size) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    qError("QInfo:%p failed to flush page:%d to tmp file:%s, %s", pResultBuf->handle, pg->pageId, pResultBuf->path,
+           strerror(errno));
 
-    if (pResultBuf->fileSize < pg->info.offset + pg->info.length) {
-      pResultBuf->fileSize = pg->info.offset + pg->info.length;
-    }
+    // the page is kept in memory, and will take new area in file when flushed again. The area it was written to
+    // holds no valid page any more, so give it back.
+    addFreeAreaInFile(pResultBuf, info.offset, info.length);
+    pg->info = PAGE_INFO_INITIALIZER;
+    return NULL;
   }
 
-  char* ret = pg->pData;
-  memset(ret, 0, pResultBuf->pageSize);
+  if (pResultBuf->fileSize < info.offset + info.length) {
+    pResultBuf->fileSize = info.offset + info.length;
+  }
 
-  pg->pData = NULL;
-  pg->info.length = size;
+  pg->info = info;
+  pg->compressed = compressed;
 
-  pResultBuf->statis.flushBytes += pg->info.length;
+  pResultBuf->statis.flushBytes    += size;
+  pResultBuf->statis.rawFlushBytes += pResultBuf->pageSize;
+  pResultBuf->statis.compPages     += (compressed? 1:0);
 
+  char* ret = pg->pData;
+  memset(ret, 0, pResultBuf->pageSize + POINTER_BYTES);
+
+  pg->pData = NULL;
   return ret;
 }
 
@@ -182,17 +224,26 @@ static char* flushPageToDisk(SDiskbasedResultBuf* pResultBuf, SPageInfo* pg) {
 
 // load file block data in disk
 static char* loadPageFromDisk(SDiskbasedResultBuf* pResultBuf, SPageInfo* pg) {
-  int32_t ret = fseek(pResultBuf->file, pg->info.offset, SEEK_SET);
-  ret = (int32_t)fread(GET_DATA_PAYLOAD(pg), 1, pg->info.length, pResultBuf->file);
-  if (ret != pg->info.length) {
-    terrno = errno;
+  char* buf = pg->compressed? pResultBuf->assistBuf : GET_DATA_PAYLOAD(pg);
+
+  if (fseek(pResultBuf->file, pg->info.offset, SEEK_SET) != 0 ||
+      fread(buf, 1, pg->info.length, pResultBuf->file) != (size_t) pg->info.length) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    qError("QInfo:%p failed to load page:%d from tmp file:%s, %s", pResultBuf->handle, pg->pageId, pResultBuf->path,
+           strerror(errno));
     return NULL;
   }
 
   pResultBuf->statis.loadBytes += pg->info.length;
+  pResultBuf->statis.loadPages += 1;
 
-  int32_t fullSize = 0;
-  doDecompressData(GET_DATA_PAYLOAD(pg), pg->info.length, &fullSize, pResultBuf);
+  if (pg->compressed &&
+      doDecompressData(buf, pg->info.length, GET_DATA_PAYLOAD(pg), pResultBuf) != pResultBuf->pageSize) {
+    terrno = TSDB_CODE_QRY_APP_ERROR;
+    qError("QInfo:%p failed to decompress page:%d loaded from tmp file:%s", pResultBuf->handle, pg->pageId,
+           pResultBuf->path);
+    return NULL;
+  }
 
   return (char*)GET_DATA_PAYLOAD(pg);
 }
@@ -226,6 +277,7 @@ static SPageInfo* registerPage(SDiskbasedResultBuf* pResultBuf, int32_t groupId,
   ppi->info   = PAGE_INFO_INITIALIZER;
   ppi->used   = true;
   ppi->pn     = NULL;
+  ppi->compressed = false;
 
   return *(SPageInfo**) taosArrayPush(list, &ppi);
 }
@@ -249,6 +301,17 @@ static SListNode* getEldestUnrefedPage(SDiskbasedResultBuf* pResultBuf) {
   return pn;
 }
 
+static void lruListPushFront(SList *pList, SPageInfo* pi) {
+  tdListPrepend(pList, &pi);
+  SListNode* front = tdListGetHead(pList);
+  pi->pn = front;
+}
+
+static void lruListMoveToFront(SList *pList, SPageInfo* pi) {
+  tdListPopNode(pList, pi->pn);
+  tdListPrependNode(pList, pi->pn);
+}
+
 static char* evicOneDataPage(SDiskbasedResultBuf* pResultBuf) {
   char* bufPage = NULL;
   SListNode* pn = getEldestUnrefedPage(pResultBuf);
@@ -273,22 +336,15 @@ static char* evicOneDataPage(SDiskbasedResultBuf* pResultBuf) {
     tfree(pn);
 
     bufPage = flushPageToDisk(pResultBuf, d);
+    if (bufPage == NULL) {  // failed to flush, keep the page in memory and allow one more in memory page instead
+      lruListPushFront(pResultBuf->lruList, d);
+      pResultBuf->inMemPages += 1;
+    }
   }
 
   return bufPage;
 }
 
-static void lruListPushFront(SList *pList, SPageInfo* pi) {
-  tdListPrepend(pList, &pi);
-  SListNode* front = tdListGetHead(pList);
-  pi->pn = front;
-}
-
-static void lruListMoveToFront(SList *pList, SPageInfo* pi) {
-  tdListPopNode(pList, pi->pn);
-  tdListPrependNode(pList, pi->pn);
-}
-
 tFilePage* getNewDataBuf(SDiskbasedResultBuf* pResultBuf, int32_t groupId, int32_t* pageId) {
   pResultBuf->statis.getPages += 1;
 
@@ -313,7 +369,7 @@ tFilePage* getNewDataBuf(SDiskbasedResultBuf* pResultBuf, int32_t groupId, int32
 
   // allocate buf
   if (availablePage == NULL) {
-    pi->pData = calloc(1, pResultBuf->pageSize + POINTER_BYTES + 2);  // add extract bytes in case of zipped buffer increased.
+    pi->pData = calloc(1, pResultBuf->pageSize + POINTER_BYTES);
   } else {
     pi->pData = availablePage;
   }
@@ -410,9 +466,14 @@ void destroyResultBuf(SDiskbasedResultBuf* pResultBuf) {
   }
 
   if (pResultBuf->file != NULL) {
+    SResultBufStatis* ps = &pResultBuf->statis;
     qDebug("QInfo:%p res output buffer closed, total:%.2f Kb, inmem size:%.2f Kb, file size:%.2f Kb",
         pResultBuf->handle, pResultBuf->totalBufSize/1024.0, listNEles(pResultBuf->lruList) * pResultBuf->pageSize / 1024.0,
         pResultBuf->fileSize/1024.0);
+    qDebug("QInfo:%p res output buffer flushed pages:%d, compressed:%d, flushed:%.2f Kb, comp ratio:%.2f%%, "
+           "loaded pages:%d, loaded:%.2f Kb", pResultBuf->handle, ps->flushPages, ps->compPages, ps->flushBytes/1024.0,
+           (ps->rawFlushBytes > 0)? ps->flushBytes * 100.0 / ps->rawFlushBytes : 0, ps->loadPages,
+           ps->loadBytes/1024.0);
 
     fclose(pResultBuf->file);
   } else {
@@ -438,6 +499,7 @@ void destroyResultBuf(SDiskbasedResultBuf* pResultBuf) {
 
   tdListFree(pResultBuf->lruList);
   taosArrayDestroy(pResultBuf->emptyDummyIdList);
+  taosArrayDestroy(pResultBuf->pFree);
   taosHashCleanup(pResultBuf->groupSet);
   taosHashCleanup(pResultBuf->all);
 
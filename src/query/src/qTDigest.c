@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+
+#include "qTDigest.h"
+
+/**
+ * the merging t-digest, based on the paper:
+ * Ted Dunning, Otmar Ertl. Computing Extremely Accurate Quantiles Using t-Digests, 2019.
+ *
+ * The k2 scale function k(q) = delta / Z(n) * log(q / (1 - q)), Z(n) = 4 * log(n / delta) + 24 is used, so the
+ * centroids shrink to single points at both tails, and the extreme quantiles, e.g., p99 and p999, are much more
+ * accurate than the median ones. The number of centroids is bounded by delta.
+ */
+static FORCE_INLINE double scaleNormalizer(int64_t total) {
+  double n = MAX(total, TDIGEST_COMPRESSION);
+  return TDIGEST_COMPRESSION / (4 * log(n / TDIGEST_COMPRESSION) + 24);
+}
+
+static FORCE_INLINE double scaleK(double q, double normalizer) { return normalizer * log(q / (1 - q)); }
+
+static FORCE_INLINE double scaleQ(double k, double normalizer) { return 1 / (1 + exp(-k / normalizer)); }
+
+// the maximum accumulated weight of the centroid that starts after the weight of weightSoFar
+static FORCE_INLINE double weightLimit(int64_t weightSoFar, int64_t total, double normalizer) {
+  if (weightSoFar <= 0) {
+    return 0;
+  }
+
+  return total * scaleQ(scaleK((double)weightSoFar / total, normalizer) + 1, normalizer);
+}
+
+static int32_t centroidCompare(const void* p1, const void* p2) {
+  double m1 = ((const SCentroid*)p1)->mean;
+  double m2 = ((const SCentroid*)p2)->mean;
+
+  if (m1 == m2) {
+    return 0;
+  }
+
+  return (m1 < m2) ? -1 : 1;
+}
+
+void tDigestInit(STDigest* pDigest) {
+  pDigest->totalWeight = 0;
+  pDigest->min = DBL_MAX;
+  pDigest->max = -DBL_MAX;
+  pDigest->numOfCentroids = 0;
+  pDigest->numOfBuffered = 0;
+}
+
+void tDigestCompress(STDigest* pDigest) {
+  if (pDigest->numOfBuffered == 0) {
+    return;
+  }
+
+  SCentroid list[TDIGEST_MAX_CENTROIDS + TDIGEST_BUFFER_SIZE];
+
+  int32_t num = pDigest->numOfCentroids + pDigest->numOfBuffered;
+  memcpy(list, pDigest->centroids, pDigest->numOfCentroids * sizeof(SCentroid));
+  memcpy(list + pDigest->numOfCentroids, pDigest->buffered, pDigest->numOfBuffered * sizeof(SCentroid));
+  qsort(list, num, sizeof(SCentroid), centroidCompare);
+
+  int64_t total = 0;
+  for (int32_t i = 0; i < num; ++i) {
+    total += list[i].weight;
+  }
+
+  // merge the adjacent centroids as long as the merged one does not span more than one unit of k
+  SCentroid* pCur = &pDigest->centroids[0];
+  *pCur = list[0];
+
+  int32_t numOfCentroids = 1;
+  int64_t weightSoFar = 0;
+  double  normalizer = scaleNormalizer(total);
+  double  limit = weightLimit(weightSoFar, total, normalizer);
+
+  for (int32_t i = 1; i < num; ++i) {
+    if ((weightSoFar + pCur->weight + list[i].weight <= limit) || numOfCentroids >= TDIGEST_MAX_CENTROIDS) {
+      pCur->weight += list[i].weight;
+      pCur->mean += (list[i].mean - pCur->mean) * list[i].weight / pCur->weight;
+    } else {
+      weightSoFar += pCur->weight;
+      limit = weightLimit(weightSoFar, total, normalizer);
+
+      pCur = &pDigest->centroids[numOfCentroids++];
+      *pCur = list[i];
+    }
+  }
+
+  pDigest->numOfCentroids = numOfCentroids;
+  pDigest->numOfBuffered = 0;
+  pDigest->totalWeight = total;
+}
+
+void tDigestAdd(STDigest* pDigest, double val, int64_t weight) {
+  if (pDigest->numOfBuffered >= TDIGEST_BUFFER_SIZE) {
+    tDigestCompress(pDigest);
+  }
+
+  SCentroid* pPoint = &pDigest->buffered[pDigest->numOfBuffered++];
+  pPoint->mean = val;
+  pPoint->weight = weight;
+
+  if (val < pDigest->min) {
+    pDigest->min = val;
+  }
+
+  if (val > pDigest->max) {
+    pDigest->max = val;
+  }
+}
+
+void tDigestMerge(STDigest* pDst, const STDigest* pSrc) {
+  for (int32_t i = 0; i < pSrc->numOfCentroids; ++i) {
+    tDigestAdd(pDst, pSrc->centroids[i].mean, pSrc->centroids[i].weight);
+  }
+
+  for (int32_t i = 0; i < pSrc->numOfBuffered; ++i) {
+    tDigestAdd(pDst, pSrc->buffered[i].mean, pSrc->buffered[i].weight);
+  }
+
+  // the mean value of centroid is not the extreme value of source digest
+  if (pSrc->min < pDst->min) {
+    pDst->min = pSrc->min;
+  }
+
+  if (pSrc->max > pDst->max) {
+    pDst->max = pSrc->max;
+  }
+}
+
+/*
+ * each centroid is regarded as half of its weight on both sides of the mean value, and the quantile is linearly
+ * interpolated between the mean values of adjacent centroids, and the min/max values at both ends.
+ */
+double tDigestQuantile(STDigest* pDigest, double q) {
+  tDigestCompress(pDigest);
+
+  if (pDigest->numOfCentroids == 0) {
+    return NAN;
+  }
+
+  SCentroid* c = pDigest->centroids;
+  int32_t    num = pDigest->numOfCentroids;
+
+  if (num == 1 || q <= 0) {
+    return (num == 1) ? c[0].mean : pDigest->min;
+  }
+
+  if (q >= 1) {
+    return pDigest->max;
+  }
+
+  double index = q * pDigest->totalWeight;
+
+  // the left tail, between min value and the first centroid
+  if (index < c[0].weight / 2.0) {
+    return pDigest->min + (c[0].mean - pDigest->min) * index / (c[0].weight / 2.0);
+  }
+
+  double weightSoFar = c[0].weight / 2.0;
+  for (int32_t i = 0; i < num - 1; ++i) {
+    double dw = (c[i].weight + c[i + 1].weight) / 2.0;
+    if (weightSoFar + dw > index) {
+      double z1 = index - weightSoFar;
+      double z2 = weightSoFar + dw - index;
+      return (c[i].mean * z2 + c[i + 1].mean * z1) / dw;
+    }
+
+    weightSoFar += dw;
+  }
+
+  // the right tail, between the last centroid and max value
+  double w = c[num - 1].weight / 2.0;
+  double z = MIN(index - weightSoFar, w);
+  return c[num - 1].mean + (pDigest->max - c[num - 1].mean) * z / w;
+}
@@ -0,0 +1,196 @@
+#include "os.h"
+#include <gtest/gtest.h>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "qAggKernel.h"
+#include "taos.h"
+#include "taosdef.h"
+#include "ttype.h"
+#include "tutil.h"
+
+namespace {
+const int32_t numOfRows = 4096;
+
+// the row by row version that the kernels replace
+template <typename T>
+int32_t refAggregate(const char* pData, int16_t type, int32_t rows, const int8_t* sel, double avg, double* sum,
+                     double* sq, T* minVal, int32_t* minIndex, T* maxVal, int32_t* maxIndex) {
+  int32_t num = 0;
+  *sum = 0;
+  *sq = 0;
+  *minIndex = -1;
+  *maxIndex = -1;
+
+  for (int32_t i = 0; i < rows; ++i) {
+    const char* p = pData + i * sizeof(T);
+    if ((sel != NULL && sel[i] == 0) || isNull(p, type)) {
+      continue;
+    }
+
+    T v = *(const T*)p;
+    *sum += (double)v;
+    *sq += ((double)v - avg) * ((double)v - avg);
+
+    if (*minIndex < 0 || v <= *minVal) {
+      *minVal = v;
+      *minIndex = i;
+    }
+
+    if (*maxIndex < 0 || v > *maxVal) {
+      *maxVal = v;
+      *maxIndex = i;
+    }
+
+    num += 1;
+  }
+
+  return num;
+}
+
+template <typename T>
+void fillData(char* pData, int16_t type, int32_t rows, int32_t nullRatio) {
+  T* p = (T*)pData;
+  for (int32_t i = 0; i < rows; ++i) {
+    if (nullRatio > 0 && rand() % nullRatio == 0) {
+      setNull((char*)&p[i], type, sizeof(T));
+    } else if (type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) {
+      p[i] = (T)((rand() % 2000000) / 100.0 - 10000);
+    } else {
+      // a narrow range so that there are ties for the min/max position
+      p[i] = (T)(rand() % 120);
+    }
+  }
+}
+
+bool sameDouble(double a, double b) { return fabs(a - b) <= 1e-9 * MAX(fabs(a), 1.0); }
+
+template <typename T>
+void kernelTest(int16_t type, int32_t rows, int32_t nullRatio, bool withSel) {
+  char*   pData = (char*)malloc(rows * sizeof(T) + 1);
+  int8_t* sel = (int8_t*)malloc(rows + 1);
+
+  fillData<T>(pData, type, rows, nullRatio);
+  for (int32_t i = 0; i < rows; ++i) {
+    sel[i] = (rand() % 3 != 0);
+  }
+
+  const int8_t* pSel = withSel ? sel : NULL;
+  bool          hasNull = (nullRatio > 0);
+
+  double  avg = 17.5;
+  double  refSum = 0, refSq = 0;
+  T       refMin = 0, refMax = 0;
+  int32_t refMinIndex = -1, refMaxIndex = -1;
+  int32_t num = refAggregate<T>(pData, type, rows, pSel, avg, &refSum, &refSq, &refMin, &refMinIndex, &refMax,
+                                &refMaxIndex);
+
+  int64_t sum = 0;
+  ASSERT_EQ(aggSumBlock(pData, type, rows, hasNull, pSel, &sum), num);
+  if (type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) {
+    ASSERT_TRUE(sameDouble(*(double*)&sum, refSum));
+  } else if (type == TSDB_DATA_TYPE_UTINYINT || type == TSDB_DATA_TYPE_USMALLINT || type == TSDB_DATA_TYPE_UINT ||
+             type == TSDB_DATA_TYPE_UBIGINT) {
+    ASSERT_EQ(*(uint64_t*)&sum, (uint64_t)refSum);
+  } else {
+    ASSERT_EQ(sum, (int64_t)refSum);
+  }
+
+  double dsum = 0;
+  ASSERT_EQ(aggSumDoubleBlock(pData, type, rows, hasNull, pSel, &dsum), num);
+  ASSERT_TRUE(sameDouble(dsum, refSum));
+
+  double sq = 0;
+  ASSERT_EQ(aggSquareDiffBlock(pData, type, rows, hasNull, pSel, avg, &sq), num);
+  ASSERT_TRUE(sameDouble(sq, refSq));
+
+  int64_t val = 0;
+  int32_t index = -1;
+  ASSERT_EQ(aggMinMaxBlock(pData, type, rows, hasNull, pSel, true, &val, &index), num);
+  if (num > 0) {
+    ASSERT_EQ(*(T*)&val, refMin);
+    ASSERT_EQ(index, refMinIndex);
+  }
+
+  ASSERT_EQ(aggMinMaxBlock(pData, type, rows, hasNull, pSel, false, &val, NULL), num);
+  if (num > 0) {
+    ASSERT_EQ(*(T*)&val, refMax);
+  }
+
+  ASSERT_EQ(aggMinMaxBlock(pData, type, rows, hasNull, pSel, false, &val, &index), num);
+  if (num > 0) {
+    ASSERT_EQ(index, refMaxIndex);
+  }
+
+  free(pData);
+  free(sel);
+}
+
+template <typename T>
+void typeTest(int16_t type) {
+  const int32_t sizes[] = {0, 1, 7, 8, 9, 33, 1000, numOfRows};
+
+  for (size_t i = 0; i < tListLen(sizes); ++i) {
+    kernelTest<T>(type, sizes[i], 0, false);
+    kernelTest<T>(type, sizes[i], 0, true);
+    kernelTest<T>(type, sizes[i], 5, false);
+    kernelTest<T>(type, sizes[i], 5, true);
+    kernelTest<T>(type, sizes[i], 1, false);  // all null
+  }
+}
+
+template <typename T>
+void throughputTest(int16_t type, int32_t nullRatio, const char* name) {
+  const int32_t loops = 2000;
+
+  char* pData = (char*)malloc(numOfRows * sizeof(T));
+  fillData<T>(pData, type, numOfRows, nullRatio);
+
+  double  d = 0;
+  int64_t val = 0;
+  bool    hasNull = (nullRatio > 0);
+
+  int64_t s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) aggSumDoubleBlock(pData, type, numOfRows, hasNull, NULL, &d);
+  int64_t sumTime = taosGetTimestampUs() - s;
+
+  s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) aggMinMaxBlock(pData, type, numOfRows, hasNull, NULL, false, &val, NULL);
+  int64_t maxTime = taosGetTimestampUs() - s;
+
+  s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) aggSquareDiffBlock(pData, type, numOfRows, hasNull, NULL, 1.0, &d);
+  int64_t sqTime = taosGetTimestampUs() - s;
+
+  double rows = (double)numOfRows * loops;
+  printf("%-18s sum:%8.2f max:%8.2f stddev:%8.2f Mrows/s\n", name, rows / MAX(sumTime, 1), rows / MAX(maxTime, 1),
+         rows / MAX(sqTime, 1));
+
+  free(pData);
+}
+
+}  // namespace
+
+TEST(testCase, aggKernelTest) {
+  srand(20200101);
+
+  typeTest<int8_t>(TSDB_DATA_TYPE_TINYINT);
+  typeTest<uint8_t>(TSDB_DATA_TYPE_UTINYINT);
+  typeTest<int16_t>(TSDB_DATA_TYPE_SMALLINT);
+  typeTest<uint16_t>(TSDB_DATA_TYPE_USMALLINT);
+  typeTest<int32_t>(TSDB_DATA_TYPE_INT);
+  typeTest<uint32_t>(TSDB_DATA_TYPE_UINT);
+  typeTest<int64_t>(TSDB_DATA_TYPE_BIGINT);
+  typeTest<uint64_t>(TSDB_DATA_TYPE_UBIGINT);
+  typeTest<float>(TSDB_DATA_TYPE_FLOAT);
+  typeTest<double>(TSDB_DATA_TYPE_DOUBLE);
+}
+
+TEST(testCase, aggKernelThroughputTest) {
+  throughputTest<int32_t>(TSDB_DATA_TYPE_INT, 0, "int");
+  throughputTest<int32_t>(TSDB_DATA_TYPE_INT, 10, "int with nulls");
+  throughputTest<int64_t>(TSDB_DATA_TYPE_BIGINT, 0, "bigint");
+  throughputTest<double>(TSDB_DATA_TYPE_DOUBLE, 0, "double");
+  throughputTest<double>(TSDB_DATA_TYPE_DOUBLE, 10, "double with nulls");
+}
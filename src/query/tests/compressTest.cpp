@@ -0,0 +1,564 @@
+#include "os.h"
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "tscompression.h"
+#include "ttype.h"
+#include "tutil.h"
+
+namespace {
+#define REF_SIMPLE8B_MAX_INT64 ((uint64_t)1152921504606846976L)
+#define REF_SAFE_INT64_ADD(a, b) (((a >= 0) && (b <= INT64_MAX - a)) || ((a < 0) && (b >= INT64_MIN - a)))
+#define REF_ZIGZAG_ENCODE(T, v) ((u##T)((v) >> (sizeof(T) * 8 - 1))) ^ (((u##T)(v)) << 1)
+#define REF_ZIGZAG_DECODE(T, v) ((v) >> 1) ^ -((T)((v)&1))
+
+const int32_t numOfRows = 4096;
+
+int32_t wordLength(char type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      return CHAR_BYTES;
+    case TSDB_DATA_TYPE_SMALLINT:
+      return SHORT_BYTES;
+    case TSDB_DATA_TYPE_INT:
+      return INT_BYTES;
+    default:
+      return LONG_BYTES;
+  }
+}
+
+int64_t valueAt(const char* input, int32_t i, char type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      return *((int8_t*)input + i);
+    case TSDB_DATA_TYPE_SMALLINT:
+      return *((int16_t*)input + i);
+    case TSDB_DATA_TYPE_INT:
+      return *((int32_t*)input + i);
+    default:
+      return *((int64_t*)input + i);
+  }
+}
+
+void setValueAt(char* output, int32_t i, char type, int64_t v) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      *((int8_t*)output + i) = (int8_t)v;
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      *((int16_t*)output + i) = (int16_t)v;
+      break;
+    case TSDB_DATA_TYPE_INT:
+      *((int32_t*)output + i) = (int32_t)v;
+      break;
+    default:
+      *((int64_t*)output + i) = v;
+      break;
+  }
+}
+
+/*
+ * The simple8b encoder and the integer/timestamp decoders as they were before the SIMD kernels, kept as the
+ * reference for the on-disk format and as the baseline of the throughput comparison. The only change is the limit of
+ * the zigzag value, which used to let 61-bit values index past bit_to_selector.
+ */
+int32_t refCompressINT(const char* input, int32_t nelements, char* output, char type) {
+  char bit_per_integer[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
+  int  selector_to_elems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+  char bit_to_selector[] = {0,  2,  3,  4,  5,  6,  7,  8,  9,  10, 10, 11, 11, 12, 12, 12, 13, 13, 13, 13, 13,
+                            14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+                            15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15};
+
+  int     byte_limit = nelements * wordLength(type) + 1;
+  int     opos = 1;
+  int64_t prev_value = 0;
+  bool    copy = false;
+
+  for (int i = 0; i < nelements && !copy;) {
+    char    selector = 0;
+    char    bit = 0;
+    int     elems = 0;
+    int64_t prev_value_tmp = prev_value;
+
+    for (int j = i; j < nelements; j++) {
+      int64_t curr_value = valueAt(input, j, type);
+      if (!REF_SAFE_INT64_ADD(curr_value, -prev_value)) {
+        copy = true;
+        break;
+      }
+
+      int64_t  diff = curr_value - prev_value_tmp;
+      uint64_t zigzag_value = REF_ZIGZAG_ENCODE(int64_t, diff);
+      if (zigzag_value >= REF_SIMPLE8B_MAX_INT64) {
+        copy = true;
+        break;
+      }
+
+      int64_t tmp_bit = (zigzag_value == 0) ? 0 : (LONG_BYTES * BITS_PER_BYTE) - BUILDIN_CLZL(zigzag_value);
+      if (elems + 1 <= selector_to_elems[(int)selector] &&
+          elems + 1 <= selector_to_elems[(int)(bit_to_selector[(int)tmp_bit])]) {
+        selector = selector > bit_to_selector[(int)tmp_bit] ? selector : bit_to_selector[(int)tmp_bit];
+        elems++;
+        bit = bit_per_integer[(int)selector];
+      } else {
+        while (elems < selector_to_elems[(int)selector]) selector++;
+        elems = selector_to_elems[(int)selector];
+        bit = bit_per_integer[(int)selector];
+        break;
+      }
+      prev_value_tmp = curr_value;
+    }
+    if (copy) break;
+
+    uint64_t buffer = (uint64_t)selector;
+    for (int k = 0; k < elems; k++) {
+      int64_t  curr_value = valueAt(input, i, type);
+      int64_t  diff = curr_value - prev_value;
+      uint64_t zigzag_value = REF_ZIGZAG_ENCODE(int64_t, diff);
+      buffer |= ((zigzag_value & INT64MASK(bit)) << (bit * k + 4));
+      i++;
+      prev_value = curr_value;
+    }
+
+    if (opos + sizeof(buffer) <= (size_t)byte_limit) {
+      memcpy(output + opos, &buffer, sizeof(buffer));
+      opos += sizeof(buffer);
+    } else {
+      copy = true;
+    }
+  }
+
+  if (copy) {
+    output[0] = 1;
+    memcpy(output + 1, input, byte_limit - 1);
+    return byte_limit;
+  }
+
+  output[0] = 0;
+  return opos;
+}
+
+int32_t refDecompressINT(const char* input, int32_t nelements, char* output, char type) {
+  if (input[0] == 1) {
+    memcpy(output, input + 1, nelements * wordLength(type));
+    return nelements * wordLength(type);
+  }
+
+  char bit_per_integer[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
+  int  selector_to_elems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+
+  const char* ip = input + 1;
+  int         count = 0;
+  int64_t     prev_value = 0;
+
+  while (count < nelements) {
+    uint64_t w = 0;
+    memcpy(&w, ip, LONG_BYTES);
+
+    char selector = (char)(w & INT64MASK(4));
+    char bit = bit_per_integer[(int)selector];
+    int  elems = selector_to_elems[(int)selector];
+
+    for (int i = 0; i < elems; i++) {
+      uint64_t zigzag_value = (selector == 0 || selector == 1) ? 0 : ((w >> (4 + bit * i)) & INT64MASK(bit));
+      int64_t  diff = REF_ZIGZAG_DECODE(int64_t, zigzag_value);
+      prev_value = diff + prev_value;
+      setValueAt(output, count, type, prev_value);
+      if (++count == nelements) break;
+    }
+    ip += LONG_BYTES;
+  }
+
+  return nelements * wordLength(type);
+}
+
+int32_t refDecompressTimestamp(const char* input, int32_t nelements, char* output) {
+  if (input[0] == 0) {
+    memcpy(output, input + 1, nelements * LONG_BYTES);
+    return nelements * LONG_BYTES;
+  }
+
+  int64_t* ostream = (int64_t*)output;
+  int      ipos = 1, opos = 0;
+  int64_t  prev_value = 0;
+  int64_t  prev_delta = 0;
+
+  while (1) {
+    uint8_t flags = input[ipos++];
+    for (int k = 0; k < 2; ++k) {
+      int8_t   nbytes = (flags >> (4 * k)) & INT8MASK(4);
+      uint64_t dd = 0;
+      int64_t  delta_of_delta = 0;
+      if (nbytes != 0) {
+        memcpy(&dd, input + ipos, nbytes);
+        delta_of_delta = REF_ZIGZAG_DECODE(int64_t, dd);
+      }
+      ipos += nbytes;
+
+      if (opos == 0) {
+        prev_value = delta_of_delta;
+        prev_delta = 0;
+      } else {
+        prev_delta = delta_of_delta + prev_delta;
+        prev_value = prev_value + prev_delta;
+      }
+      ostream[opos++] = prev_value;
+      if (opos == nelements) return nelements * LONG_BYTES;
+    }
+  }
+}
+
+void fillIntData(char* data, int32_t num, char type, int32_t pattern) {
+  int64_t v = 0;
+  for (int32_t i = 0; i < num; ++i) {
+    switch (pattern) {
+      case 0:  // constant
+        v = 12345;
+        break;
+      case 1:  // small random walk
+        v += rand() % 21 - 10;
+        break;
+      case 2:  // mostly small steps with occasional jumps
+        v += (i % 97 == 0) ? (rand() % 100000) : (rand() % 3);
+        break;
+      default:  // random values
+        v = ((int64_t)rand() << 32) | rand();
+        break;
+    }
+    setValueAt(data, i, type, v);
+  }
+}
+
+void fillTsData(int64_t* data, int32_t num, int32_t pattern) {
+  int64_t ts = 1500000000000L;
+  for (int32_t i = 0; i < num; ++i) {
+    switch (pattern) {
+      case 0:  // regular interval
+        ts += 1000;
+        break;
+      case 1:  // regular interval with gaps
+        ts += (i % 500 == 0) ? 3600000 : 1000;
+        break;
+      default:  // jittered
+        ts += 1000 + rand() % 10;
+        break;
+    }
+    data[i] = ts;
+  }
+}
+
+void fillDoubleData(double* data, int32_t num, int32_t pattern) {
+  for (int32_t i = 0; i < num; ++i) {
+    switch (pattern) {
+      case 0:  // constant
+        data[i] = 36.6;
+        break;
+      case 1:  // slowly changing sensor readings with two decimals
+        data[i] = (int64_t)((20.0 + 5 * sin(i / 200.0) + (rand() % 100) / 1000.0) * 100) / 100.0;
+        break;
+      case 2:  // nulls mixed in
+        if (i % 5 == 0) {
+          SET_DOUBLE_NULL(data + i);
+        } else {
+          data[i] = 100.0 + (i % 13);
+        }
+        break;
+      default:  // random bits
+        uint64_t v = ((uint64_t)rand() << 33) ^ ((uint64_t)rand() << 11) ^ rand();
+        memcpy(data + i, &v, sizeof(v));
+        break;
+    }
+  }
+}
+
+void intRoundTripTest() {
+  const char types[] = {TSDB_DATA_TYPE_TINYINT, TSDB_DATA_TYPE_SMALLINT, TSDB_DATA_TYPE_INT, TSDB_DATA_TYPE_BIGINT};
+  const int32_t sizes[] = {1, 2, 3, 7, 239, 240, 241, 481, 1000, numOfRows};
+
+  char* data = (char*)malloc(numOfRows * LONG_BYTES);
+  char* comp = (char*)malloc(numOfRows * LONG_BYTES + COMP_OVERFLOW_BYTES);
+  char* refComp = (char*)malloc(numOfRows * LONG_BYTES + COMP_OVERFLOW_BYTES);
+  char* out = (char*)malloc(numOfRows * LONG_BYTES);
+
+  for (char type : types) {
+    for (int32_t pattern = 0; pattern < 4; ++pattern) {
+      for (int32_t num : sizes) {
+        fillIntData(data, num, type, pattern);
+
+        int32_t len = tsCompressINTImp(data, num, comp, type);
+        int32_t refLen = refCompressINT(data, num, refComp, type);
+        ASSERT_EQ(len, refLen);
+        ASSERT_EQ(memcmp(comp, refComp, len), 0);
+
+        memset(out, 0, numOfRows * LONG_BYTES);
+        ASSERT_EQ(tsDecompressINTImp(comp, num, out, type), num * wordLength(type));
+        ASSERT_EQ(memcmp(out, data, num * wordLength(type)), 0);
+      }
+    }
+  }
+
+  free(data);
+  free(comp);
+  free(refComp);
+  free(out);
+}
+
+void tsRoundTripTest() {
+  const int32_t sizes[] = {1, 2, 3, 31, 32, 33, 100, 1000, numOfRows};
+
+  int64_t* data = (int64_t*)malloc(numOfRows * LONG_BYTES);
+  char*    comp = (char*)malloc(numOfRows * LONG_BYTES + COMP_OVERFLOW_BYTES);
+  int64_t* out = (int64_t*)malloc(numOfRows * LONG_BYTES);
+  int64_t* refOut = (int64_t*)malloc(numOfRows * LONG_BYTES);
+
+  for (int32_t pattern = 0; pattern < 3; ++pattern) {
+    for (int32_t num : sizes) {
+      fillTsData(data, num, pattern);
+
+      tsCompressTimestampImp((char*)data, num, comp);
+      ASSERT_EQ(tsDecompressTimestampImp(comp, num, (char*)out), num * LONG_BYTES);
+      ASSERT_EQ(refDecompressTimestamp(comp, num, (char*)refOut), num * LONG_BYTES);
+      ASSERT_EQ(memcmp(out, data, num * LONG_BYTES), 0);
+      ASSERT_EQ(memcmp(refOut, data, num * LONG_BYTES), 0);
+    }
+  }
+
+  free(data);
+  free(comp);
+  free(out);
+  free(refOut);
+}
+
+void intThroughputTest(char type, int32_t pattern, const char* name) {
+  const int32_t loops = 500;
+
+  char* data = (char*)malloc(numOfRows * LONG_BYTES);
+  char* comp = (char*)malloc(numOfRows * LONG_BYTES + COMP_OVERFLOW_BYTES);
+  char* out = (char*)malloc(numOfRows * LONG_BYTES);
+
+  fillIntData(data, numOfRows, type, pattern);
+
+  int64_t s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) refCompressINT(data, numOfRows, comp, type);
+  int64_t refCompTime = taosGetTimestampUs() - s;
+
+  s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) tsCompressINTImp(data, numOfRows, comp, type);
+  int64_t compTime = taosGetTimestampUs() - s;
+
+  s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) refDecompressINT(comp, numOfRows, out, type);
+  int64_t refDecompTime = taosGetTimestampUs() - s;
+
+  s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) tsDecompressINTImp(comp, numOfRows, out, type);
+  int64_t decompTime = taosGetTimestampUs() - s;
+
+  double rows = (double)numOfRows * loops;
+  printf("%-18s compress old:%7.2f new:%7.2f Mrows/s, decompress old:%7.2f new:%7.2f Mrows/s\n", name,
+         rows / MAX(refCompTime, 1), rows / MAX(compTime, 1), rows / MAX(refDecompTime, 1),
+         rows / MAX(decompTime, 1));
+
+  free(data);
+  free(comp);
+  free(out);
+}
+
+void tsThroughputTest(int32_t pattern, const char* name) {
+  const int32_t loops = 500;
+
+  int64_t* data = (int64_t*)malloc(numOfRows * LONG_BYTES);
+  char*    comp = (char*)malloc(numOfRows * LONG_BYTES + COMP_OVERFLOW_BYTES);
+  int64_t* out = (int64_t*)malloc(numOfRows * LONG_BYTES);
+
+  fillTsData(data, numOfRows, pattern);
+  tsCompressTimestampImp((char*)data, numOfRows, comp);
+
+  int64_t s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) refDecompressTimestamp(comp, numOfRows, (char*)out);
+  int64_t refDecompTime = taosGetTimestampUs() - s;
+
+  s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) tsDecompressTimestampImp(comp, numOfRows, (char*)out);
+  int64_t decompTime = taosGetTimestampUs() - s;
+
+  double rows = (double)numOfRows * loops;
+  printf("%-18s decompress old:%7.2f new:%7.2f Mrows/s\n", name, rows / MAX(refDecompTime, 1),
+         rows / MAX(decompTime, 1));
+
+  free(data);
+  free(comp);
+  free(out);
+}
+
+void gorillaRoundTripTest() {
+  const int32_t sizes[] = {1, 2, 16, 17, 18, 33, 100, 1000, numOfRows};
+  const char    algorithms[] = {ONE_STAGE_GORILLA_COMP, TWO_STAGE_GORILLA_COMP};
+
+  int32_t size = numOfRows * LONG_BYTES + COMP_OVERFLOW_BYTES;
+  double* data = (double*)malloc(numOfRows * DOUBLE_BYTES);
+  float*  fdata = (float*)malloc(numOfRows * FLOAT_BYTES);
+  char*   comp = (char*)malloc(size);
+  char*   buffer = (char*)malloc(size);
+  char*   out = (char*)malloc(numOfRows * DOUBLE_BYTES);
+
+  for (char algorithm : algorithms) {
+    for (int32_t pattern = 0; pattern < 4; ++pattern) {
+      for (int32_t num : sizes) {
+        fillDoubleData(data, num, pattern);
+        for (int32_t i = 0; i < num; ++i) fdata[i] = (float)data[i];
+
+        // the compressed data is copied out so that reads past its end are caught by a memory checker
+        int32_t len = tsCompressDouble((char*)data, num * DOUBLE_BYTES, num, comp, size, algorithm, buffer, size);
+        ASSERT_GT(len, 0);
+        char* exact = (char*)malloc(len);
+        memcpy(exact, comp, len);
+        ASSERT_EQ(tsDecompressDouble(exact, len, num, out, numOfRows * DOUBLE_BYTES, algorithm, buffer, size),
+                  num * DOUBLE_BYTES);
+        ASSERT_EQ(memcmp(out, data, num * DOUBLE_BYTES), 0);
+        free(exact);
+
+        len = tsCompressFloat((char*)fdata, num * FLOAT_BYTES, num, comp, size, algorithm, buffer, size);
+        ASSERT_GT(len, 0);
+        exact = (char*)malloc(len);
+        memcpy(exact, comp, len);
+        ASSERT_EQ(tsDecompressFloat(exact, len, num, out, numOfRows * FLOAT_BYTES, algorithm, buffer, size),
+                  num * FLOAT_BYTES);
+        ASSERT_EQ(memcmp(out, fdata, num * FLOAT_BYTES), 0);
+        free(exact);
+      }
+    }
+  }
+
+  free(data);
+  free(fdata);
+  free(comp);
+  free(buffer);
+  free(out);
+}
+
+void gorillaThroughputTest(int32_t pattern, const char* name) {
+  const int32_t loops = 500;
+
+  double* data = (double*)malloc(numOfRows * DOUBLE_BYTES);
+  char*   comp = (char*)malloc(numOfRows * DOUBLE_BYTES + COMP_OVERFLOW_BYTES);
+  char*   out = (char*)malloc(numOfRows * DOUBLE_BYTES);
+
+  fillDoubleData(data, numOfRows, pattern);
+
+  int32_t len = tsCompressDoubleImp((char*)data, numOfRows, comp);
+  int64_t s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) tsDecompressDoubleImp(comp, numOfRows, out);
+  int64_t decompTime = taosGetTimestampUs() - s;
+
+  int32_t gorillaLen = tsCompressDoubleGorillaImp((char*)data, numOfRows, comp);
+  s = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) tsDecompressDoubleGorillaImp(comp, gorillaLen, numOfRows, out);
+  int64_t gorillaDecompTime = taosGetTimestampUs() - s;
+
+  double rows = (double)numOfRows * loops;
+  printf("%-18s size xor:%6d gorilla:%6d bytes, decompress xor:%7.2f gorilla:%7.2f Mrows/s\n", name, len, gorillaLen,
+         rows / MAX(decompTime, 1), rows / MAX(gorillaDecompTime, 1));
+
+  free(data);
+  free(comp);
+  free(out);
+}
+
+// Every level must round trip through each second stage backend, the backend being recorded in the algorithm byte
+void backendRoundTripTest() {
+  const char levels[] = {TWO_STAGE_COMP, TWO_STAGE_GORILLA_COMP};
+  const char backends[] = {COMP_BACKEND_LZ4, COMP_BACKEND_ZLIB};
+
+  int32_t  size = numOfRows * LONG_BYTES + COMP_OVERFLOW_BYTES;
+  int64_t* ts = (int64_t*)malloc(numOfRows * LONG_BYTES);
+  char*    ints = (char*)malloc(numOfRows * LONG_BYTES);
+  double*  data = (double*)malloc(numOfRows * DOUBLE_BYTES);
+  char*    comp = (char*)malloc(size);
+  char*    buffer = (char*)malloc(size);
+  char*    out = (char*)malloc(size);
+
+  fillTsData(ts, numOfRows, 2);
+  fillIntData(ints, numOfRows, TSDB_DATA_TYPE_BIGINT, 1);
+  fillDoubleData(data, numOfRows, 1);
+
+  for (char level : levels) {
+    for (char backend : backends) {
+      char    algorithm = (char)COMP_ALGORITHM(level, backend);
+      int32_t bytes = numOfRows * LONG_BYTES;
+
+      int32_t tsLen = tsCompressTimestamp((char*)ts, bytes, numOfRows, comp, size, algorithm, buffer, size);
+      ASSERT_GT(tsLen, 0);
+      ASSERT_EQ(tsDecompressTimestamp(comp, tsLen, numOfRows, out, size, algorithm, buffer, size), bytes);
+      ASSERT_EQ(memcmp(out, ts, bytes), 0);
+
+      int32_t intLen = tsCompressBigint(ints, bytes, numOfRows, comp, size, algorithm, buffer, size);
+      ASSERT_GT(intLen, 0);
+      ASSERT_EQ(tsDecompressBigint(comp, intLen, numOfRows, out, size, algorithm, buffer, size), bytes);
+      ASSERT_EQ(memcmp(out, ints, bytes), 0);
+
+      int32_t dblLen = tsCompressDouble((char*)data, bytes, numOfRows, comp, size, algorithm, buffer, size);
+      ASSERT_GT(dblLen, 0);
+      ASSERT_EQ(tsDecompressDouble(comp, dblLen, numOfRows, out, size, algorithm, buffer, size), bytes);
+      ASSERT_EQ(memcmp(out, data, bytes), 0);
+
+      // incompressible input is stored raw behind the indicator byte
+      int32_t strLen = tsCompressString((char*)data, 7, 7, comp, size, algorithm, buffer, size);
+      ASSERT_EQ(tsDecompressString(comp, strLen, 7, out, size, algorithm, buffer, size), 7);
+      ASSERT_EQ(memcmp(out, data, 7), 0);
+
+      printf("level %d backend %d size ts:%6d bigint:%6d double:%6d bytes\n", level, backend, tsLen, intLen, dblLen);
+    }
+  }
+
+  char invalid = (char)COMP_ALGORITHM(TWO_STAGE_COMP, COMP_MAX_BACKEND);
+  ASSERT_LT(tsCompressGeneralImp((char*)data, 100, comp, size, invalid), 0);
+
+  free(ts);
+  free(ints);
+  free(data);
+  free(comp);
+  free(buffer);
+  free(out);
+}
+
+}  // namespace
+
+TEST(codecTest, compressTest) {
+  srand(20200101);
+
+  // the portable kernels first, then the ones picked for this CPU
+  intRoundTripTest();
+  tsRoundTripTest();
+
+  taosResolveCompression();
+  intRoundTripTest();
+  tsRoundTripTest();
+}
+
+TEST(codecTest, compressThroughputTest) {
+  taosResolveCompression();
+
+  intThroughputTest(TSDB_DATA_TYPE_BIGINT, 1, "bigint walk");
+  intThroughputTest(TSDB_DATA_TYPE_BIGINT, 2, "bigint jumps");
+  intThroughputTest(TSDB_DATA_TYPE_INT, 1, "int walk");
+  intThroughputTest(TSDB_DATA_TYPE_SMALLINT, 0, "smallint constant");
+  tsThroughputTest(0, "ts regular");
+  tsThroughputTest(1, "ts gaps");
+  tsThroughputTest(2, "ts jittered");
+}
+
+TEST(codecTest, gorillaCompressTest) {
+  srand(20200101);
+  gorillaRoundTripTest();
+
+  gorillaThroughputTest(1, "double sensor");
+  gorillaThroughputTest(2, "double with nulls");
+  gorillaThroughputTest(3, "double random");
+}
+
+TEST(codecTest, compressBackendTest) {
+  srand(20200101);
+  backendRoundTripTest();
+}
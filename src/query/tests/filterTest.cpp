@@ -0,0 +1,228 @@
+#include "os.h"
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "qExecutor.h"
+#include "qUtil.h"
+#include "taos.h"
+#include "tsdb.h"
+
+namespace {
+const int32_t numOfRows = 1500;
+
+void initFilterElem(SColumnFilterElem* pElem, int16_t bytes, int32_t lower, int32_t upper) {
+  pElem->bytes = bytes;
+  pElem->filterInfo.lowerRelOptr = lower;
+  pElem->filterInfo.upperRelOptr = upper;
+  pElem->fp = getFilterOperator(lower, upper);
+  pElem->blockFp = getBlockFilterOperator(lower, upper);
+}
+
+// the single row version that the block filter replaces
+bool rowFilter(SSingleColumnFilterInfo* pFilterInfo, int32_t numOfCols, int32_t pos) {
+  for (int32_t k = 0; k < numOfCols; ++k) {
+    SSingleColumnFilterInfo* pInfo = &pFilterInfo[k];
+    char* pElem = (char*)pInfo->pData + pInfo->info.bytes * pos;
+
+    bool qualified = false;
+    for (int32_t j = 0; j < pInfo->numOfFilters && !qualified; ++j) {
+      SColumnFilterElem* pFilterElem = &pInfo->pFilters[j];
+
+      if (isNull(pElem, pInfo->info.type)) {
+        qualified = (pFilterElem->fp == isNullOperator);
+      } else if (pFilterElem->fp == notNullOperator) {
+        qualified = true;
+      } else if (pFilterElem->fp != isNullOperator) {
+        qualified = pFilterElem->fp(pFilterElem, pElem, pElem, pInfo->info.type);
+      }
+    }
+
+    if (!qualified) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void checkBlockFilter(SSingleColumnFilterInfo* pFilterInfo, int32_t numOfCols) {
+  int8_t* p = (int8_t*)malloc(numOfRows);
+
+  int32_t numOfQualified = doFilterDataBlock(pFilterInfo, numOfCols, numOfRows, p);
+
+  int32_t num = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    bool qualified = rowFilter(pFilterInfo, numOfCols, i);
+    ASSERT_EQ(p[i], qualified ? 1 : 0) << "row:" << i;
+    num += qualified;
+  }
+
+  ASSERT_EQ(numOfQualified, num);
+  free(p);
+}
+
+template <typename T>
+T* createColumnData(int16_t type, T nullVal, int32_t range) {
+  T* pData = (T*)malloc(sizeof(T) * numOfRows);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (i % 17 == 0) {
+      pData[i] = nullVal;
+    } else {
+      pData[i] = (T)((i * 7) % range);
+    }
+  }
+
+  return pData;
+}
+
+template <typename T>
+void integerFilterTest(int16_t type, T nullVal) {
+  SColumnFilterElem elem[2] = {{0}};
+
+  SSingleColumnFilterInfo info = {0};
+  info.info.type = type;
+  info.info.bytes = sizeof(T);
+  info.pFilters = elem;
+  info.pData = createColumnData<T>(type, nullVal, 100);
+
+  int32_t optrs[] = {TSDB_RELATION_LESS,          TSDB_RELATION_GREATER,   TSDB_RELATION_EQUAL,
+                     TSDB_RELATION_LESS_EQUAL,    TSDB_RELATION_GREATER_EQUAL, TSDB_RELATION_NOT_EQUAL,
+                     TSDB_RELATION_ISNULL,        TSDB_RELATION_NOTNULL};
+
+  for (size_t i = 0; i < tListLen(optrs); ++i) {
+    int32_t optr = optrs[i];
+    bool    upper = (optr == TSDB_RELATION_LESS || optr == TSDB_RELATION_LESS_EQUAL);
+
+    initFilterElem(&elem[0], sizeof(T), upper ? TSDB_RELATION_INVALID : optr, upper ? optr : TSDB_RELATION_INVALID);
+    elem[0].filterInfo.lowerBndi = 42;
+    elem[0].filterInfo.upperBndi = 42;
+
+    info.numOfFilters = 1;
+    checkBlockFilter(&info, 1);
+  }
+
+  // range filters
+  int32_t lowers[] = {TSDB_RELATION_GREATER, TSDB_RELATION_GREATER_EQUAL};
+  int32_t uppers[] = {TSDB_RELATION_LESS, TSDB_RELATION_LESS_EQUAL};
+  for (int32_t i = 0; i < 2; ++i) {
+    for (int32_t j = 0; j < 2; ++j) {
+      initFilterElem(&elem[0], sizeof(T), lowers[i], uppers[j]);
+      elem[0].filterInfo.lowerBndi = 14;
+      elem[0].filterInfo.upperBndi = 70;
+
+      info.numOfFilters = 1;
+      checkBlockFilter(&info, 1);
+    }
+  }
+
+  // v < 10 or v is null
+  initFilterElem(&elem[0], sizeof(T), TSDB_RELATION_INVALID, TSDB_RELATION_LESS);
+  elem[0].filterInfo.upperBndi = 10;
+  initFilterElem(&elem[1], sizeof(T), TSDB_RELATION_ISNULL, TSDB_RELATION_INVALID);
+
+  info.numOfFilters = 2;
+  checkBlockFilter(&info, 1);
+
+  free(info.pData);
+}
+
+template <typename T>
+void floatFilterTest(int16_t type, T nullVal) {
+  SColumnFilterElem elem[1] = {{0}};
+
+  SSingleColumnFilterInfo info = {0};
+  info.info.type = type;
+  info.info.bytes = sizeof(T);
+  info.pFilters = elem;
+  info.numOfFilters = 1;
+  info.pData = createColumnData<T>(type, nullVal, 100);
+
+  int32_t optrs[] = {TSDB_RELATION_LESS, TSDB_RELATION_GREATER, TSDB_RELATION_EQUAL, TSDB_RELATION_NOT_EQUAL};
+  for (size_t i = 0; i < tListLen(optrs); ++i) {
+    int32_t optr = optrs[i];
+    bool    upper = (optr == TSDB_RELATION_LESS);
+
+    initFilterElem(&elem[0], sizeof(T), upper ? TSDB_RELATION_INVALID : optr, upper ? optr : TSDB_RELATION_INVALID);
+    elem[0].filterInfo.lowerBndd = 42;
+    elem[0].filterInfo.upperBndd = 42;
+    checkBlockFilter(&info, 1);
+  }
+
+  initFilterElem(&elem[0], sizeof(T), TSDB_RELATION_GREATER_EQUAL, TSDB_RELATION_LESS_EQUAL);
+  elem[0].filterInfo.lowerBndd = 14;
+  elem[0].filterInfo.upperBndd = 70;
+  checkBlockFilter(&info, 1);
+
+  initFilterElem(&elem[0], sizeof(T), TSDB_RELATION_GREATER, TSDB_RELATION_LESS_EQUAL);
+  checkBlockFilter(&info, 1);
+
+  free(info.pData);
+}
+}  // namespace
+
+TEST(testCase, blockFilterTest) {
+  integerFilterTest<int8_t>(TSDB_DATA_TYPE_TINYINT, (int8_t)TSDB_DATA_TINYINT_NULL);
+  integerFilterTest<uint8_t>(TSDB_DATA_TYPE_UTINYINT, (uint8_t)TSDB_DATA_UTINYINT_NULL);
+  integerFilterTest<int16_t>(TSDB_DATA_TYPE_SMALLINT, (int16_t)TSDB_DATA_SMALLINT_NULL);
+  integerFilterTest<uint16_t>(TSDB_DATA_TYPE_USMALLINT, (uint16_t)TSDB_DATA_USMALLINT_NULL);
+  integerFilterTest<int32_t>(TSDB_DATA_TYPE_INT, (int32_t)TSDB_DATA_INT_NULL);
+  integerFilterTest<uint32_t>(TSDB_DATA_TYPE_UINT, (uint32_t)TSDB_DATA_UINT_NULL);
+  integerFilterTest<int64_t>(TSDB_DATA_TYPE_BIGINT, (int64_t)TSDB_DATA_BIGINT_NULL);
+  integerFilterTest<uint64_t>(TSDB_DATA_TYPE_UBIGINT, (uint64_t)TSDB_DATA_UBIGINT_NULL);
+
+  uint32_t fnull = TSDB_DATA_FLOAT_NULL;
+  uint64_t dnull = TSDB_DATA_DOUBLE_NULL;
+  floatFilterTest<float>(TSDB_DATA_TYPE_FLOAT, *(float*)&fnull);
+  floatFilterTest<double>(TSDB_DATA_TYPE_DOUBLE, *(double*)&dnull);
+}
+
+// a > 10 and (b < 30 or b is null)
+TEST(testCase, blockFilterMultiColumnTest) {
+  SColumnFilterElem elemA[1] = {{0}};
+  SColumnFilterElem elemB[2] = {{0}};
+
+  SSingleColumnFilterInfo info[2] = {{0}};
+  info[0].info.type = TSDB_DATA_TYPE_INT;
+  info[0].info.bytes = sizeof(int32_t);
+  info[0].pFilters = elemA;
+  info[0].numOfFilters = 1;
+  info[0].pData = createColumnData<int32_t>(TSDB_DATA_TYPE_INT, (int32_t)TSDB_DATA_INT_NULL, 50);
+
+  info[1].info.type = TSDB_DATA_TYPE_BIGINT;
+  info[1].info.bytes = sizeof(int64_t);
+  info[1].pFilters = elemB;
+  info[1].numOfFilters = 2;
+  info[1].pData = createColumnData<int64_t>(TSDB_DATA_TYPE_BIGINT, (int64_t)TSDB_DATA_BIGINT_NULL, 91);
+
+  initFilterElem(&elemA[0], sizeof(int32_t), TSDB_RELATION_GREATER, TSDB_RELATION_INVALID);
+  elemA[0].filterInfo.lowerBndi = 10;
+  initFilterElem(&elemB[0], sizeof(int64_t), TSDB_RELATION_INVALID, TSDB_RELATION_LESS);
+  elemB[0].filterInfo.upperBndi = 30;
+  initFilterElem(&elemB[1], sizeof(int64_t), TSDB_RELATION_ISNULL, TSDB_RELATION_INVALID);
+
+  checkBlockFilter(info, 2);
+
+  // no row qualified for the first column
+  elemA[0].filterInfo.lowerBndi = 100;
+  checkBlockFilter(info, 2);
+
+  free(info[0].pData);
+  free(info[1].pData);
+}
+
+TEST(testCase, filterBitmapTest) {
+  int8_t a[] = {1, 1, 0, 0, 1};
+  int8_t b[] = {1, 0, 1, 0, 0};
+
+  int8_t r[5] = {0};
+  memcpy(r, a, sizeof(a));
+  filterBitmapAnd(r, b, 5);
+  int8_t andRes[] = {1, 0, 0, 0, 0};
+  ASSERT_EQ(memcmp(r, andRes, sizeof(r)), 0);
+
+  memcpy(r, a, sizeof(a));
+  filterBitmapOr(r, b, 5);
+  int8_t orRes[] = {1, 1, 1, 0, 1};
+  ASSERT_EQ(memcmp(r, orRes, sizeof(r)), 0);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "taos.h"
+#include "qHyperLogLog.h"
+
+namespace {
+SHLLInfo* createSketch(int32_t precision) {
+  SHLLInfo* pInfo = (SHLLInfo*)malloc(tHllSketchSize(precision));
+  tHllInit(pInfo, precision);
+  return pInfo;
+}
+
+double relativeError(uint64_t estimate, int64_t actual) {
+  return fabs((double)estimate - (double)actual) / (double)actual;
+}
+}  // namespace
+
+TEST(testCase, hllEmptyTest) {
+  SHLLInfo* pInfo = createSketch(HLL_DEFAULT_PRECISION);
+  EXPECT_EQ(tHllEstimate(pInfo), 0);
+  free(pInfo);
+}
+
+TEST(testCase, hllDuplicateTest) {
+  SHLLInfo* pInfo = createSketch(HLL_DEFAULT_PRECISION);
+  for (int32_t i = 0; i < 100000; ++i) {
+    int64_t v = i % 10;
+    tHllAdd(pInfo, &v, sizeof(v));
+  }
+
+  EXPECT_EQ(tHllEstimate(pInfo), 10);
+  free(pInfo);
+}
+
+TEST(testCase, hllAccuracyTest) {
+  const int64_t num[] = {100, 1000, 10000, 100000, 1000000};
+
+  for (int32_t p = HLL_MIN_PRECISION + 6; p <= HLL_MAX_PRECISION; ++p) {
+    double stdErr = 1.04 / sqrt((double)(1 << p));
+
+    for (int32_t j = 0; j < sizeof(num) / sizeof(num[0]); ++j) {
+      SHLLInfo* pInfo = createSketch(p);
+      for (int64_t i = 0; i < num[j]; ++i) {
+        tHllAdd(pInfo, &i, sizeof(i));
+      }
+
+      EXPECT_LT(relativeError(tHllEstimate(pInfo), num[j]), stdErr * 4);
+      free(pInfo);
+    }
+  }
+}
+
+TEST(testCase, hllStringTest) {
+  SHLLInfo* pInfo = createSketch(HLL_DEFAULT_PRECISION);
+
+  char buf[64] = {0};
+  for (int32_t i = 0; i < 50000; ++i) {
+    int32_t len = snprintf(buf, sizeof(buf), "device_%d", i % 20000);
+    tHllAdd(pInfo, buf, len);
+  }
+
+  EXPECT_LT(relativeError(tHllEstimate(pInfo), 20000), 0.05);
+  free(pInfo);
+}
+
+TEST(testCase, hllMergeTest) {
+  SHLLInfo* pTotal = createSketch(HLL_DEFAULT_PRECISION);
+  SHLLInfo* pMerged = createSketch(HLL_DEFAULT_PRECISION);
+
+  // four overlapping partial sketches, like the results of different vnodes
+  for (int32_t k = 0; k < 4; ++k) {
+    SHLLInfo* pPart = createSketch(HLL_DEFAULT_PRECISION);
+    for (int64_t i = k * 30000; i < k * 30000 + 50000; ++i) {
+      tHllAdd(pPart, &i, sizeof(i));
+      tHllAdd(pTotal, &i, sizeof(i));
+    }
+
+    tHllMerge(pMerged, pPart);
+    free(pPart);
+  }
+
+  // the merged sketch is identical to the one built from all values
+  EXPECT_EQ(memcmp(pMerged, pTotal, tHllSketchSize(HLL_DEFAULT_PRECISION)), 0);
+  EXPECT_LT(relativeError(tHllEstimate(pMerged), 140000), 0.05);
+
+  free(pTotal);
+  free(pMerged);
+}
@@ -149,6 +149,115 @@ void recyclePageTest() {
 
   destroyResultBuf(pResultBuf);
 }
+void fillPage(tFilePage* pPage, int32_t pageId, int32_t size, bool random) {
+  pPage->num = pageId;
+  int32_t* p = (int32_t*) pPage->data;
+  for (int32_t i = 0; i < size / sizeof(int32_t); ++i) {
+    p[i] = random? rand() : pageId;
+  }
+}
+
+void checkPage(tFilePage* pPage, int32_t pageId, int32_t size) {
+  ASSERT_EQ(pPage->num, (uint64_t)pageId);
+  if (pageId % 4 != 0) {
+    int32_t* p = (int32_t*) pPage->data;
+    for (int32_t i = 0; i < size / sizeof(int32_t); ++i) {
+      ASSERT_EQ(p[i], pageId);
+    }
+  }
+}
+
+void compressedPageTest() {
+  SDiskbasedResultBuf* pResultBuf = NULL;
+  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 64, 1024, 4*1024, NULL);
+  ASSERT_EQ(ret, TSDB_CODE_SUCCESS);
+
+  const int32_t numOfPages = 64;
+  const int32_t dataSize = 1024 - sizeof(tFilePage);
+
+  // every 4th page is filled with random data which is not compressible
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    int32_t pageId = 0;
+    tFilePage* pPage = getNewDataBuf(pResultBuf, 0, &pageId);
+    ASSERT_EQ(pageId, i);
+    fillPage(pPage, pageId, (pageId % 8 == 1)? dataSize / 8 : dataSize, pageId % 4 == 0);
+    releaseResBufPage(pResultBuf, pPage);
+  }
+
+  // grow the content of some flushed pages, so they have to move to larger areas when flushed again
+  for (int32_t i = 1; i < numOfPages; i += 8) {
+    tFilePage* pPage = getResBufPage(pResultBuf, i);
+    checkPage(pPage, i, dataSize / 8);
+    fillPage(pPage, i, dataSize, false);
+    releaseResBufPage(pResultBuf, pPage);
+  }
+
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePage* pPage = getResBufPage(pResultBuf, i);
+    checkPage(pPage, i, dataSize);
+    releaseResBufPage(pResultBuf, pPage);
+  }
+
+  SResultBufStatis* ps = &pResultBuf->statis;
+  ASSERT_GT(ps->compPages, 0);
+  ASSERT_LT(ps->compPages, ps->flushPages);
+  ASSERT_LT(ps->flushBytes, ps->rawFlushBytes);
+  ASSERT_LT(pResultBuf->fileSize, (int64_t)numOfPages * 1024);
+
+  destroyResultBuf(pResultBuf);
+}
+
+void failedFlushTest() {
+  SDiskbasedResultBuf* pResultBuf = NULL;
+  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 64, 1024, 4*1024, NULL);
+  ASSERT_EQ(ret, TSDB_CODE_SUCCESS);
+
+  const int32_t dataSize = 1024 - sizeof(tFilePage);
+
+  // the fifth page flushes the first one and creates the file
+  for (int32_t i = 0; i < 5; ++i) {
+    int32_t pageId = 0;
+    tFilePage* pPage = getNewDataBuf(pResultBuf, 0, &pageId);
+    fillPage(pPage, pageId, dataSize, false);
+    releaseResBufPage(pResultBuf, pPage);
+  }
+
+  ASSERT_TRUE(pResultBuf->file != NULL);
+  int64_t nextPos = pResultBuf->nextPos;
+
+  // writes to a read only stream fail, the pages stay in memory and the areas taken for them are given back
+  FILE* file = pResultBuf->file;
+  pResultBuf->file = fopen(pResultBuf->path, "rb");
+  ASSERT_TRUE(pResultBuf->file != NULL);
+
+  for (int32_t i = 5; i < 8; ++i) {
+    int32_t pageId = 0;
+    tFilePage* pPage = getNewDataBuf(pResultBuf, 0, &pageId);
+    fillPage(pPage, pageId, dataSize, false);
+    releaseResBufPage(pResultBuf, pPage);
+  }
+
+  ASSERT_EQ(pResultBuf->nextPos, nextPos);
+  ASSERT_EQ(taosArrayGetSize(pResultBuf->pFree), 0);
+
+  fclose(pResultBuf->file);
+  pResultBuf->file = file;
+
+  for (int32_t i = 8; i < 16; ++i) {
+    int32_t pageId = 0;
+    tFilePage* pPage = getNewDataBuf(pResultBuf, 0, &pageId);
+    fillPage(pPage, pageId, dataSize, false);
+    releaseResBufPage(pResultBuf, pPage);
+  }
+
+  for (int32_t i = 0; i < 16; ++i) {
+    tFilePage* pPage = getResBufPage(pResultBuf, i);
+    checkPage(pPage, i, dataSize);
+    releaseResBufPage(pResultBuf, pPage);
+  }
+
+  destroyResultBuf(pResultBuf);
+}
 } // namespace
 
 
@@ -157,4 +266,6 @@ TEST(testCase, resultBufferTest) {
   simpleTest();
   writeDownTest();
   recyclePageTest();
+  compressedPageTest();
+  failedFlushTest();
 }
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "taos.h"
+#include "tutil.h"
+#include "qHistogram.h"
+#include "qTDigest.h"
+
+namespace {
+const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+// latency like data, most of the values are small and the tail is long
+std::vector<double> genLatencyData(int32_t num, uint64_t seed) {
+  std::mt19937_64                  gen(seed);
+  std::lognormal_distribution<double> dist(3.0, 1.0);
+
+  std::vector<double> data(num);
+  for (int32_t i = 0; i < num; ++i) {
+    data[i] = dist(gen);
+  }
+
+  return data;
+}
+
+double exactQuantile(std::vector<double> sorted, double q) {
+  std::sort(sorted.begin(), sorted.end());
+  int64_t index = (int64_t)ceil(q * sorted.size()) - 1;
+  return sorted[std::max<int64_t>(index, 0)];
+}
+
+double relativeError(double v, double exact) { return fabs(v - exact) / exact; }
+
+STDigest* createDigest() {
+  STDigest* pDigest = (STDigest*)malloc(sizeof(STDigest));
+  tDigestInit(pDigest);
+  return pDigest;
+}
+
+double histogramQuantile(SHistogramInfo* pHisto, double q) {
+  double  ratio = q * 100;
+  double* res = tHistogramUniform(pHisto, &ratio, 1);
+  double  v = res[0];
+  free(res);
+  return v;
+}
+}  // namespace
+
+TEST(testCase, tdigestSmallTest) {
+  STDigest* pDigest = createDigest();
+  EXPECT_TRUE(std::isnan(tDigestQuantile(pDigest, 0.5)));
+
+  tDigestAdd(pDigest, 10, 1);
+  EXPECT_DOUBLE_EQ(tDigestQuantile(pDigest, 0.5), 10);
+
+  for (int32_t i = 1; i <= 100; ++i) {
+    tDigestAdd(pDigest, i, 1);
+  }
+
+  EXPECT_DOUBLE_EQ(tDigestQuantile(pDigest, 0), 1);
+  EXPECT_DOUBLE_EQ(tDigestQuantile(pDigest, 1), 100);
+  EXPECT_NEAR(tDigestQuantile(pDigest, 0.5), 50, 1);
+  free(pDigest);
+}
+
+TEST(testCase, tdigestMergeTest) {
+  const int32_t       numOfParts = 16;
+  std::vector<double> all;
+
+  STDigest* pMerged = createDigest();
+  for (int32_t k = 0; k < numOfParts; ++k) {
+    std::vector<double> data = genLatencyData(20000, k + 1);
+    all.insert(all.end(), data.begin(), data.end());
+
+    STDigest* pPart = createDigest();
+    for (size_t i = 0; i < data.size(); ++i) {
+      tDigestAdd(pPart, data[i], 1);
+    }
+
+    tDigestMerge(pMerged, pPart);
+    free(pPart);
+  }
+
+  EXPECT_LE(pMerged->numOfCentroids, TDIGEST_MAX_CENTROIDS);
+  for (int32_t i = 0; i < tListLen(quantiles); ++i) {
+    EXPECT_LT(relativeError(tDigestQuantile(pMerged, quantiles[i]), exactQuantile(all, quantiles[i])), 0.02);
+  }
+
+  EXPECT_EQ(pMerged->totalWeight, (int64_t)all.size());
+  free(pMerged);
+}
+
+/*
+ * compare the t-digest with the streaming histogram, which is the default algorithm of apercentile, both for the
+ * speed of adding and merging values, and for the accuracy of the tail quantiles.
+ */
+TEST(testCase, tdigestBenchmarkTest) {
+  const int32_t numOfRows = 200000;
+  const int32_t numOfParts = 10;
+
+  std::vector<double> data = genLatencyData(numOfRows, 2019);
+
+  int64_t s = taosGetTimestampUs();
+  SHistogramInfo* pHisto = tHistogramCreate(MAX_HISTOGRAM_BIN);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    tHistogramAdd(&pHisto, data[i]);
+  }
+  int64_t histoAddTime = taosGetTimestampUs() - s;
+
+  s = taosGetTimestampUs();
+  STDigest* pDigest = createDigest();
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    tDigestAdd(pDigest, data[i], 1);
+  }
+  int64_t digestAddTime = taosGetTimestampUs() - s;
+
+  // merge the partial results, like the secondary merge at the client side
+  int32_t                      rowsPerPart = numOfRows / numOfParts;
+  std::vector<SHistogramInfo*> histos;
+  std::vector<STDigest*>       digests;
+  for (int32_t k = 0; k < numOfParts; ++k) {
+    SHistogramInfo* h = tHistogramCreate(MAX_HISTOGRAM_BIN);
+    STDigest*       d = createDigest();
+    for (int32_t i = k * rowsPerPart; i < (k + 1) * rowsPerPart; ++i) {
+      tHistogramAdd(&h, data[i]);
+      tDigestAdd(d, data[i], 1);
+    }
+
+    histos.push_back(h);
+    digests.push_back(d);
+  }
+
+  s = taosGetTimestampUs();
+  SHistogramInfo* pMergedHisto = tHistogramCreate(MAX_HISTOGRAM_BIN);
+  for (int32_t k = 0; k < numOfParts; ++k) {
+    SHistogramInfo* pRes = tHistogramMerge(pMergedHisto, histos[k], MAX_HISTOGRAM_BIN);
+    tHistogramDestroy(&pMergedHisto);
+    pMergedHisto = pRes;
+  }
+  int64_t histoMergeTime = taosGetTimestampUs() - s;
+
+  s = taosGetTimestampUs();
+  STDigest* pMergedDigest = createDigest();
+  for (int32_t k = 0; k < numOfParts; ++k) {
+    tDigestMerge(pMergedDigest, digests[k]);
+  }
+  int64_t digestMergeTime = taosGetTimestampUs() - s;
+
+  const char* fmt = "%-10s add:%8.2f Mrows/s merge %d parts:%8" PRId64 " us\n";
+  printf(fmt, "histogram", numOfRows / (double)MAX(histoAddTime, 1), numOfParts, histoMergeTime);
+  printf(fmt, "t-digest", numOfRows / (double)MAX(digestAddTime, 1), numOfParts, digestMergeTime);
+
+  for (int32_t i = 0; i < tListLen(quantiles); ++i) {
+    double exact = exactQuantile(data, quantiles[i]);
+
+    double histoErr = relativeError(histogramQuantile(pHisto, quantiles[i]), exact);
+    double histoMergeErr = relativeError(histogramQuantile(pMergedHisto, quantiles[i]), exact);
+    double digestErr = relativeError(tDigestQuantile(pDigest, quantiles[i]), exact);
+    double digestMergeErr = relativeError(tDigestQuantile(pMergedDigest, quantiles[i]), exact);
+
+    printf("p%-5g exact:%10.3f histogram err:%7.3f%% (merged %7.3f%%) t-digest err:%7.3f%% (merged %7.3f%%)\n",
+           quantiles[i] * 100, exact, histoErr * 100, histoMergeErr * 100, digestErr * 100, digestMergeErr * 100);
+
+    EXPECT_LT(digestErr, 0.01);
+    EXPECT_LT(digestMergeErr, 0.01);
+  }
+
+  for (int32_t k = 0; k < numOfParts; ++k) {
+    tHistogramDestroy(&histos[k]);
+    free(digests[k]);
+  }
+
+  tHistogramDestroy(&pHisto);
+  tHistogramDestroy(&pMergedHisto);
+  free(pDigest);
+  free(pMergedDigest);
+}
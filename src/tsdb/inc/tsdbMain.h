@@ -17,6 +17,7 @@
 
 #include "os.h"
 #include "hash.h"
+#include "tchecksum.h"
 #include "tcoding.h"
 #include "tglobal.h"
 #include "tkvstore.h"
@@ -53,6 +54,13 @@ extern int32_t tsdbDebugFlag;
 
 // Definitions
 // ------------------ tsdbMeta.c
+typedef struct {
+  int16_t colId;
+  int16_t bytes;  // size of the buffer pointed by pData
+  TSKEY   ts;     // key of the row holding the value, TSKEY_INITIAL_VAL if no non-null value is known
+  void*   pData;
+} SLastCol;
+
 typedef struct STable {
   STableId       tableId;
   ETableType     type;
@@ -64,10 +72,14 @@ typedef struct STable {
   STSchema*      tagSchema;
   SKVRow         tagVal;
   SSkipList*     pIndex;         // For TSDB_SUPER_TABLE, it is the skiplist index
+  SArray*        pTagIndex;      // For TSDB_SUPER_TABLE, STagIndex of the other indexed tag columns
   void*          eventHandler;   // TODO
   void*          streamHandler;  // TODO
   TSKEY          lastKey;
   SDataRow       lastRow;
+  SLastCol*      lastCols;          // last non-null value of each column, in ascending order of colId
+  int16_t        numOfLastCols;
+  bool           lastColsRestored;  // values committed before the repo is opened are loaded from data files
   char*          sql;
   void*          cqhandle;
   SRWLatch       latch;  // TODO: implementa latch functions
@@ -105,19 +117,30 @@ typedef struct {
 } STsdbBufPool;
 
 // ------------------ tsdbMemTable.c
+typedef struct SMemColChunk {
+  struct SMemColChunk* next;
+  int32_t              numOfRows;  // rows visible to readers, pCols->numOfRows is only touched by the writer
+  SDataCols*           pCols;
+} SMemColChunk;
+
+typedef struct {
+  uint64_t      uid;
+  TSKEY         keyFirst;
+  TSKEY         keyLast;
+  int64_t       numOfRows;
+  SSkipList*    pData;
+  int8_t        colActive;  // all rows in pData are also in the column chunks, in the same order
+  int16_t       sversion;   // schema version of the column chunks
+  SMemColChunk* pColHead;
+  SMemColChunk* pColTail;
+} STableData;
+
 typedef struct {
   STable *           pTable;
+  STableData *       pTableData;
   SSkipListIterator *pIter;
 } SCommitIter;
 
-typedef struct {
-  uint64_t   uid;
-  TSKEY      keyFirst;
-  TSKEY      keyLast;
-  int64_t    numOfRows;
-  SSkipList* pData;
-} STableData;
-
 typedef struct {
   T_REF_DECLARE()
   SRWLatch     latch;
@@ -161,7 +184,15 @@ typedef enum {
   TSDB_FILE_TYPE_NHEAD,
   TSDB_FILE_TYPE_NDATA,
   TSDB_FILE_TYPE_NLAST,
-  TSDB_FILE_TYPE_NSTAT
+  TSDB_FILE_TYPE_NSTAT,
+  TSDB_FILE_TYPE_SMA,   // optional rollup records of the time buckets, not a member of SFileGroup
+  TSDB_FILE_TYPE_NSMA,
+  TSDB_FILE_TYPE_CHEAD,  // files rewritten by compaction, see tsdbCompact.c
+  TSDB_FILE_TYPE_CDATA,
+  TSDB_FILE_TYPE_CLAST,
+  TSDB_FILE_TYPE_OHEAD,  // files replaced by compaction, kept aside until all of them are replaced
+  TSDB_FILE_TYPE_ODATA,
+  TSDB_FILE_TYPE_OLAST
 } TSDB_FILE_TYPE;
 
 #ifndef TDINTERNAL
@@ -178,11 +209,13 @@ typedef struct {
   uint32_t offset;
   uint64_t size;      // total size of the file
   uint64_t tombSize;  // unused file size
+  uint32_t backend;   // second stage backend the file is compressed with, see COMP_BACKEND
 } STsdbFileInfo;
 
 typedef struct {
-  char  fname[TSDB_FILENAME_LEN];
-  int   fd;
+  char     fname[TSDB_FILENAME_LEN];
+  int      fd;
+  uint32_t version;  // changes whenever the file is replaced, so the block cache never serves stale content
 
   STsdbFileInfo info;
 } SFile;
@@ -199,6 +232,7 @@ typedef struct {
   int         maxFGroups;
   int         nFGroups;
   SFileGroup* pFGroup;
+  uint32_t    fversion;  // last version assigned to a file
 } STsdbFileH;
 
 typedef struct {
@@ -221,6 +255,115 @@ typedef struct {
   void *  pMsg;
 } SSubmitMsgIter;
 
+// ------------------ tsdbCompact.c
+typedef struct {
+  pthread_mutex_t mutex;           // guards fid and dirty, which commits check against the file groups they write
+  int8_t          dirty;           // a commit wrote to the file group under compaction, its rewrite is dropped
+  int32_t         fid;             // file group under compaction, -1 if idle
+  int32_t         nTables;         // number of tables in the file group under compaction
+  int32_t         tablesDone;      // number of tables already rewritten
+  int64_t         nCompacted;      // number of file groups compacted since repo open
+  int64_t         bytesReclaimed;  // total disk space reclaimed since repo open
+} STsdbCompactInfo;
+
+enum { TSDB_COMPACT_IDLE = 0, TSDB_COMPACT_SCHEDULED };
+
+// ------------------ tsdbBlockCache.c
+typedef struct {
+  int32_t  fid;
+  uint32_t version;  // version of the file the content is loaded from
+  int64_t  offset;   // offset of the SCompIdx/SCompInfo part or the data block in the file
+  int32_t  tid;
+  int16_t  colId;    // TSDB_BLOCK_CACHE_HEAD for the parts other than the column data
+  int8_t   type;     // TSDB_FILE_TYPE_HEAD/DATA/LAST
+  int8_t   reserved;
+} SBlockCacheKey;
+
+#define TSDB_BLOCK_CACHE_HEAD -1
+
+typedef struct SBlockCacheNode SBlockCacheNode;
+
+// LRU cache of the decoded SCompIdx/SCompInfo/SCompData parts and the decompressed columns loaded by queries
+typedef struct {
+  pthread_mutex_t  lock;
+  SHashObj*        pHash;  // SBlockCacheKey -> SBlockCacheNode*
+  SBlockCacheNode* pHead;  // most recently used
+  SBlockCacheNode* pTail;
+  int64_t          capacity;
+  int64_t          size;
+  int64_t          hits;
+  int64_t          misses;
+  int64_t          evicts;
+} STsdbBlockCache;
+
+// ------------------ tsdbTagIndex.c
+// Inverted index on a tag column of a super table. The child tables are grouped into posting lists by tag value, which
+// are found by hash for equality and IN conditions and in value order by skiplist for range conditions.
+typedef struct {
+  int16_t    colId;
+  int8_t     type;
+  SHashObj*  pHash;     // tag value -> STagPosting*
+  SSkipList* pOrdered;  // STagPosting ordered by tag value
+  SArray*    pMissing;  // STable* of the child tables without a value of the tag column
+} STagIndex;
+
+// ------------------ tsdbRollup.c
+// Rollup records of a file group, one per table and time bucket of rollupInterval with data. They are built from the
+// file group the head file of which has the checksum headMagic, and are ignored once the head file is replaced.
+#define TSDB_ROLLUP_MAGIC 0x50554C52
+
+typedef struct {
+  uint32_t magic;
+  uint32_t headMagic;    // magic of the head file the rollups are built from
+  int64_t  interval;     // length of the time buckets in the precision of the repo
+  uint32_t idxOffset;    // offset of the SRollupIdx array
+  int32_t  numOfTables;
+  TSCKSUM  checksum;
+} SRollupHead;
+
+typedef struct {
+  int32_t  tid;
+  uint32_t len;
+  uint32_t offset;
+  int32_t  reserved;
+  uint64_t uid;
+} SRollupIdx;
+
+typedef struct {
+  int32_t numOfNull;
+  int32_t reserved;
+  int64_t sum;  // sum, min and max are kept like SDataStatis
+  int64_t min;
+  int64_t max;
+} SRollupCol;
+
+typedef struct {
+  TSKEY      keyFirst;
+  TSKEY      keyLast;
+  int32_t    numOfRows;
+  int32_t    reserved;
+  SRollupCol cols[];
+} SRollupRecord;
+
+// SRollupRecord of the time buckets in key order follow the column ids, then the checksum of the whole part
+typedef struct {
+  int32_t numOfRollups;
+  int32_t numOfCols;
+  int16_t colIds[];
+} SRollupInfo;
+
+#define TSDB_ROLLUP_RECORD_SIZE(nCols) (sizeof(SRollupRecord) + sizeof(SRollupCol) * (nCols))
+#define TSDB_ROLLUP_INFO_HEAD_SIZE(nCols) (sizeof(SRollupInfo) + ((sizeof(int16_t) * (nCols) + 7) & ~7))
+#define TSDB_ROLLUP_AT(pInfo, i)                                                          \
+  ((SRollupRecord*)POINTER_SHIFT((pInfo), TSDB_ROLLUP_INFO_HEAD_SIZE((pInfo)->numOfCols) + \
+                                              TSDB_ROLLUP_RECORD_SIZE((pInfo)->numOfCols) * (i)))
+
+typedef struct {
+  int         fd;
+  SRollupHead head;
+  SRollupIdx* pIdx;
+} SRollupFile;
+
 typedef struct {
   int8_t state;
 
@@ -237,6 +380,11 @@ typedef struct {
   pthread_mutex_t mutex;
   bool            repoLocked;
   int32_t         code; // Commit code
+  int8_t          compactState;
+  int8_t          compactStop;
+  STsdbCompactInfo compactInfo;
+  STsdbBlockCache* pBlockCache;
+  int64_t          rollupInterval;  // length of the rollup time buckets in the precision of the repo, 0 if disabled
 } STsdbRepo;
 
 // ------------------ tsdbRWHelper.c
@@ -331,6 +479,8 @@ typedef struct {
   SDataCols* pDataCols[2];
   void*      pBuffer;     // Buffer to hold the whole data block
   void*      compBuffer;  // Buffer for temperary compress/decompress purpose
+  // Cache of the parts loaded from files, NULL if not cached
+  STsdbBlockCache* pCache;
 } SRWHelper;
 
 typedef struct {
@@ -379,6 +529,9 @@ int        tsdbUnlockRepoMeta(STsdbRepo* pRepo);
 void       tsdbRefTable(STable* pTable);
 void       tsdbUnRefTable(STable* pTable);
 void       tsdbUpdateTableSchema(STsdbRepo* pRepo, STable* pTable, STSchema* pSchema, bool insertAct);
+int        tsdbAllocLastColumns(STable* pTable, STSchema* pSchema);
+SLastCol*  tsdbGetLastColumn(STable* pTable, int16_t colId);
+int        tsdbSetLastColumnValue(SLastCol* pLastCol, STColumn* pCol, TSKEY key, const void* value);
 
 static FORCE_INLINE int tsdbCompareSchemaVersion(const void *key1, const void *key2) {
   if (*(int16_t *)key1 < schemaVersion(*(STSchema **)key2)) {
@@ -460,6 +613,10 @@ void* tsdbAllocBytes(STsdbRepo* pRepo, int bytes);
 int   tsdbAsyncCommit(STsdbRepo* pRepo);
 int   tsdbLoadDataFromCache(STable* pTable, SSkipListIterator* pIter, TSKEY maxKey, int maxRowsToRead, SDataCols* pCols,
                             TKEY* filterKeys, int nFilterKeys, bool keepDup, SMergeInfo* pMergeInfo);
+int   tsdbLoadColDataFromCache(SCommitIter* pCommitIter, TSKEY maxKey, int maxRowsToRead, SDataCols* pCols,
+                               SMergeInfo* pMergeInfo);
+SMemColChunk* tsdbSearchColChunk(STableData* pTableData, TSKEY key, int* pos);
+int   tsdbColChunkUpperBound(SMemColChunk* pChunk, int start, int numOfRows, TSKEY maxKey);
 void* tsdbCommitData(STsdbRepo* pRepo);
 
 static FORCE_INLINE SDataRow tsdbNextIterRow(SSkipListIterator* pIter) {
@@ -478,6 +635,15 @@ static FORCE_INLINE TSKEY tsdbNextIterKey(SSkipListIterator* pIter) {
   return dataRowKey(row);
 }
 
+// move an ascending iterator to the first row with key larger than the given key
+static FORCE_INLINE void tsdbMoveIterAfterKey(SSkipListIterator* pIter, TSKEY key) {
+  SDataRow row = tsdbNextIterRow(pIter);
+  while (row != NULL && dataRowKey(row) <= key) {
+    tSkipListIterNext(pIter);
+    row = tsdbNextIterRow(pIter);
+  }
+}
+
 static FORCE_INLINE TKEY tsdbNextIterTKey(SSkipListIterator* pIter) {
   SDataRow row = tsdbNextIterRow(pIter);
   if (row == NULL) return TKEY_NULL;
@@ -519,11 +685,14 @@ int         tsdbOpenFile(SFile* pFile, int oflag);
 void        tsdbCloseFile(SFile* pFile);
 int         tsdbCreateFile(SFile* pFile, STsdbRepo* pRepo, int fid, int type);
 SFileGroup* tsdbSearchFGroup(STsdbFileH* pFileH, int fid, int flags);
+bool        tsdbIsColdFGroup(STsdbRepo* pRepo, int fid);
+int8_t      tsdbGetFGroupCompression(STsdbRepo* pRepo, int fid);
 void        tsdbFitRetention(STsdbRepo* pRepo);
 int         tsdbUpdateFileHeader(SFile* pFile);
 int         tsdbEncodeSFileInfo(void** buf, const STsdbFileInfo* pInfo);
 void*       tsdbDecodeSFileInfo(void* buf, STsdbFileInfo* pInfo);
 void        tsdbRemoveFileGroup(STsdbRepo* pRepo, SFileGroup* pFGroup);
+void        tsdbUpdateFileVersion(STsdbRepo* pRepo, SFileGroup* pGroup, int type);
 int         tsdbLoadFileHeader(SFile* pFile, uint32_t* version);
 void        tsdbGetFileInfoImpl(char* fname, uint32_t* magic, int64_t* size);
 void        tsdbGetFidKeyRange(int daysPerFile, int8_t precision, int fileId, TSKEY *minKey, TSKEY *maxKey);
@@ -573,6 +742,9 @@ void tsdbGetDataStatis(SRWHelper* pHelper, SDataStatis* pStatis, int numOfCols);
 int  tsdbLoadBlockDataCols(SRWHelper* pHelper, SCompBlock* pCompBlock, SCompInfo* pCompInfo, int16_t* colIds,
                            int numOfColIds);
 int  tsdbLoadBlockData(SRWHelper* pHelper, SCompBlock* pCompBlock, SCompInfo* pCompInfo);
+int  tsdbWriteBlockToFile(SRWHelper* pHelper, SFile* pFile, SDataCols* pDataCols, SCompBlock* pCompBlock, bool isLast,
+                          bool isSuperBlock);
+int  tsdbInsertSuperBlock(SRWHelper* pHelper, SCompBlock* pCompBlock, int blkIdx);
 
 static FORCE_INLINE int compTSKEY(const void* key1, const void* key2) {
   if (*(TSKEY*)key1 > *(TSKEY*)key2) {
@@ -584,8 +756,37 @@ static FORCE_INLINE int compTSKEY(const void* key1, const void* key2) {
   }
 }
 
+// ------------------ tsdbBlockCache.c
+STsdbBlockCache* tsdbNewBlockCache(int64_t capacity);
+void             tsdbFreeBlockCache(STsdbBlockCache* pCache);
+void    tsdbInitBlockCacheKey(SBlockCacheKey* pKey, SFileGroup* pGroup, int type, int32_t tid, int64_t offset,
+                              int16_t colId);
+int32_t tsdbGetBlockCache(STsdbBlockCache* pCache, const SBlockCacheKey* pKey, void* target, int32_t size);
+void    tsdbPutBlockCache(STsdbBlockCache* pCache, const SBlockCacheKey* pKey, const void* data, int32_t len);
+void    tsdbPurgeBlockCache(STsdbBlockCache* pCache, int fid, int type);
+void    tsdbGetBlockCacheStat(STsdbBlockCache* pCache, int64_t* hits, int64_t* misses, int64_t* size);
+
+// ------------------ tsdbTagIndex.c
+int        tsdbInitTagIndex(STable* pSTable);
+void       tsdbFreeTagIndex(STable* pSTable);
+int        tsdbAddTableIntoTagIndex(STable* pSTable, STable* pTable);
+void       tsdbRemoveTableFromTagIndex(STable* pSTable, STable* pTable);
+STagIndex* tsdbGetTagIndex(STable* pSTable, int16_t colId);
+int        tsdbQueryTagIndex(STagIndex* pIndex, int32_t optr, const void* q, SArray* pTables);
+
+// ------------------ tsdbRollup.c
+int64_t tsdbGetRollupIntervalImpl(STsdbCfg* pCfg);
+void    tsdbCommitRollups(STsdbRepo* pRepo, SFileGroup* pGroup, SCommitIter* iters, int nIters, TSKEY* dirtyKeys,
+                          uint32_t oldHeadMagic);
+void    tsdbRestampRollups(STsdbRepo* pRepo, SFileGroup* pGroup, uint32_t oldHeadMagic);
+int     tsdbOpenRollupFile(STsdbRepo* pRepo, SFileGroup* pGroup, uint32_t headMagic, SRollupFile* pRFile);
+int     tsdbLoadRollupInfo(SRollupFile* pRFile, int32_t tid, uint64_t uid, SRollupInfo** ppInfo);
+void    tsdbCloseRollupFile(SRollupFile* pRFile);
+
 // ------------------ tsdbMain.c
 #define REPO_ID(r) (r)->config.tsdbId
+#define CACHE_LAST_ROW(c) (((c)->cacheLastRow & 1) > 0)
+#define CACHE_LAST_NULL_COLUMN(c) ((((c)->cacheLastRow & 2) > 0) && !(c)->update)
 #define IS_REPO_LOCKED(r) (r)->repoLocked
 #define TSDB_SUBMIT_MSG_HEAD_SIZE sizeof(SSubmitMsg)
 
@@ -598,6 +799,7 @@ int         tsdbGetNextMaxTables(int tid);
 STsdbMeta*  tsdbGetMeta(TSDB_REPO_T* pRepo);
 STsdbFileH* tsdbGetFile(TSDB_REPO_T* pRepo);
 int         tsdbCheckCommit(STsdbRepo* pRepo);
+int         tsdbRestoreLastColumns(STsdbRepo* pRepo, STable* pTable);
 
 // ------------------ tsdbScan.c
 int              tsdbScanFGroup(STsdbScanHandle* pScanHandle, char* rootDir, int fid);
@@ -611,6 +813,14 @@ void             tsdbFreeScanHandle(STsdbScanHandle* pScanHandle);
 
 // ------------------ tsdbCommitQueue.c
 int tsdbScheduleCommit(STsdbRepo *pRepo);
+int tsdbScheduleCompact(STsdbRepo *pRepo);
+
+// ------------------ tsdbCompact.c
+bool  tsdbPrepareCompact(STsdbRepo *pRepo);
+void  tsdbStartCompact(STsdbRepo *pRepo);
+void* tsdbCompactData(STsdbRepo *pRepo);
+void  tsdbStopCompact(STsdbRepo *pRepo);
+void  tsdbMarkCompactFGroup(STsdbRepo *pRepo, int fid);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "tsdbMain.h"
+
+// A block cache entry never takes more than this share of the whole cache
+#define TSDB_BLOCK_CACHE_MAX_ENTRY_RATIO 8
+
+struct SBlockCacheNode {
+  SBlockCacheKey          key;
+  struct SBlockCacheNode *prev;
+  struct SBlockCacheNode *next;
+  int32_t                 len;
+  char                    data[];
+};
+
+static void tsdbUnlinkBlockCacheNode(STsdbBlockCache *pCache, SBlockCacheNode *pNode);
+static void tsdbLinkBlockCacheNode(STsdbBlockCache *pCache, SBlockCacheNode *pNode);
+static void tsdbRemoveBlockCacheNode(STsdbBlockCache *pCache, SBlockCacheNode *pNode);
+
+// ---------------- INTERNAL FUNCTIONS ----------------
+STsdbBlockCache *tsdbNewBlockCache(int64_t capacity) {
+  if (capacity <= 0) return NULL;
+
+  STsdbBlockCache *pCache = (STsdbBlockCache *)calloc(1, sizeof(*pCache));
+  if (pCache == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pCache->capacity = capacity;
+  pCache->pHash = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  if (pCache->pHash == NULL) {
+    free(pCache);
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pthread_mutex_init(&(pCache->lock), NULL);
+
+  return pCache;
+}
+
+void tsdbFreeBlockCache(STsdbBlockCache *pCache) {
+  if (pCache == NULL) return;
+
+  while (pCache->pHead != NULL) {
+    SBlockCacheNode *pNode = pCache->pHead;
+    tsdbUnlinkBlockCacheNode(pCache, pNode);
+    free(pNode);
+  }
+
+  taosHashCleanup(pCache->pHash);
+  pthread_mutex_destroy(&(pCache->lock));
+  free(pCache);
+}
+
+void tsdbInitBlockCacheKey(SBlockCacheKey *pKey, SFileGroup *pGroup, int type, int32_t tid, int64_t offset,
+                           int16_t colId) {
+  memset((void *)pKey, 0, sizeof(*pKey));
+  pKey->fid = pGroup->fileId;
+  pKey->version = pGroup->files[type].version;
+  pKey->offset = offset;
+  pKey->tid = tid;
+  pKey->colId = colId;
+  pKey->type = (int8_t)type;
+}
+
+// Copy the cached content to target and move the entry to the head of the LRU list. Return the length of the content,
+// or -1 if it is not in the cache.
+int32_t tsdbGetBlockCache(STsdbBlockCache *pCache, const SBlockCacheKey *pKey, void *target, int32_t size) {
+  int32_t len = -1;
+
+  pthread_mutex_lock(&(pCache->lock));
+
+  SBlockCacheNode **ppNode = (SBlockCacheNode **)taosHashGet(pCache->pHash, pKey, sizeof(*pKey));
+  if (ppNode != NULL && (*ppNode)->len <= size) {
+    SBlockCacheNode *pNode = *ppNode;
+    memcpy(target, pNode->data, pNode->len);
+    len = pNode->len;
+
+    tsdbUnlinkBlockCacheNode(pCache, pNode);
+    tsdbLinkBlockCacheNode(pCache, pNode);
+    pCache->hits++;
+  } else {
+    pCache->misses++;
+  }
+
+  pthread_mutex_unlock(&(pCache->lock));
+
+  return len;
+}
+
+void tsdbPutBlockCache(STsdbBlockCache *pCache, const SBlockCacheKey *pKey, const void *data, int32_t len) {
+  int64_t nodeSize = sizeof(SBlockCacheNode) + len;
+  if (nodeSize > pCache->capacity / TSDB_BLOCK_CACHE_MAX_ENTRY_RATIO) return;
+
+  SBlockCacheNode *pNode = (SBlockCacheNode *)malloc(nodeSize);
+  if (pNode == NULL) return;
+
+  pNode->key = *pKey;
+  pNode->len = len;
+  memcpy(pNode->data, data, len);
+
+  pthread_mutex_lock(&(pCache->lock));
+
+  // loaded by another reader at the same time
+  if (taosHashGet(pCache->pHash, pKey, sizeof(*pKey)) != NULL) {
+    pthread_mutex_unlock(&(pCache->lock));
+    free(pNode);
+    return;
+  }
+
+  while (pCache->size + nodeSize > pCache->capacity && pCache->pTail != NULL) {
+    tsdbRemoveBlockCacheNode(pCache, pCache->pTail);
+    pCache->evicts++;
+  }
+
+  if (taosHashPut(pCache->pHash, pKey, sizeof(*pKey), (void *)(&pNode), sizeof(pNode)) != 0) {
+    pthread_mutex_unlock(&(pCache->lock));
+    free(pNode);
+    return;
+  }
+
+  tsdbLinkBlockCacheNode(pCache, pNode);
+  pCache->size += nodeSize;
+
+  pthread_mutex_unlock(&(pCache->lock));
+}
+
+// Drop the cached content of a file which is replaced or removed. Type -1 means all files of the file group.
+void tsdbPurgeBlockCache(STsdbBlockCache *pCache, int fid, int type) {
+  if (pCache == NULL) return;
+
+  pthread_mutex_lock(&(pCache->lock));
+
+  SBlockCacheNode *pNode = pCache->pHead;
+  while (pNode != NULL) {
+    SBlockCacheNode *pNext = pNode->next;
+    if (pNode->key.fid == fid && (type < 0 || pNode->key.type == type)) {
+      tsdbRemoveBlockCacheNode(pCache, pNode);
+    }
+    pNode = pNext;
+  }
+
+  pthread_mutex_unlock(&(pCache->lock));
+}
+
+void tsdbGetBlockCacheStat(STsdbBlockCache *pCache, int64_t *hits, int64_t *misses, int64_t *size) {
+  *hits = 0;
+  *misses = 0;
+  *size = 0;
+  if (pCache == NULL) return;
+
+  pthread_mutex_lock(&(pCache->lock));
+  *hits = pCache->hits;
+  *misses = pCache->misses;
+  *size = pCache->size;
+  pthread_mutex_unlock(&(pCache->lock));
+}
+
+// ---------------- LOCAL FUNCTIONS ----------------
+static void tsdbUnlinkBlockCacheNode(STsdbBlockCache *pCache, SBlockCacheNode *pNode) {
+  if (pNode->prev != NULL) {
+    pNode->prev->next = pNode->next;
+  } else {
+    pCache->pHead = pNode->next;
+  }
+
+  if (pNode->next != NULL) {
+    pNode->next->prev = pNode->prev;
+  } else {
+    pCache->pTail = pNode->prev;
+  }
+
+  pNode->prev = NULL;
+  pNode->next = NULL;
+}
+
+static void tsdbLinkBlockCacheNode(STsdbBlockCache *pCache, SBlockCacheNode *pNode) {
+  pNode->prev = NULL;
+  pNode->next = pCache->pHead;
+  if (pCache->pHead != NULL) pCache->pHead->prev = pNode;
+  pCache->pHead = pNode;
+  if (pCache->pTail == NULL) pCache->pTail = pNode;
+}
+
+static void tsdbRemoveBlockCacheNode(STsdbBlockCache *pCache, SBlockCacheNode *pNode) {
+  tsdbUnlinkBlockCacheNode(pCache, pNode);
+  taosHashRemove(pCache->pHash, &(pNode->key), sizeof(pNode->key));
+  pCache->size -= (sizeof(SBlockCacheNode) + pNode->len);
+  free(pNode);
+}
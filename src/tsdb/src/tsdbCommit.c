@@ -12,8 +12,19 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
+#include "os.h"
+#include "tglobal.h"
 #include "tsdbMain.h"
 
+typedef struct {
+  STsdbRepo *  pRepo;
+  SCommitIter *iters;  // table references shared by all commit workers
+  int *        fids;   // file groups with data to commit
+  int          nFids;
+  int32_t      nextIdx;
+  int32_t      code;
+} SCommitCtx;
+
 static int  tsdbCommitTSData(STsdbRepo *pRepo);
 static int  tsdbCommitMeta(STsdbRepo *pRepo);
 static void tsdbEndCommit(STsdbRepo *pRepo, int eno);
@@ -21,6 +32,8 @@ static int  tsdbHasDataToCommit(SCommitIter *iters, int nIters, TSKEY minKey, TS
 static int  tsdbCommitToFile(STsdbRepo *pRepo, int fid, SCommitIter *iters, SRWHelper *pHelper, SDataCols *pDataCols);
 static SCommitIter *tsdbCreateCommitIters(STsdbRepo *pRepo);
 static void         tsdbDestroyCommitIters(SCommitIter *iters, int maxTables);
+static int          tsdbSeekCommitIters(SMemTable *pMem, SCommitIter *iters, TSKEY key);
+static void *       tsdbCommitWorker(void *arg);
 
 void *tsdbCommitData(STsdbRepo *pRepo) {
   SMemTable *  pMem = pRepo->imem;
@@ -45,6 +58,12 @@ void *tsdbCommitData(STsdbRepo *pRepo) {
   tsdbFitRetention(pRepo);
 
   tsdbInfo("vgId:%d commit over, succeed", REPO_ID(pRepo));
+  if (pRepo->pBlockCache != NULL) {
+    int64_t hits = 0, misses = 0, size = 0;
+    tsdbGetBlockCacheStat(pRepo->pBlockCache, &hits, &misses, &size);
+    tsdbDebug("vgId:%d block cache hits %" PRId64 " misses %" PRId64 " size %" PRId64, REPO_ID(pRepo), hits, misses,
+              size);
+  }
   tsdbEndCommit(pRepo, TSDB_CODE_SUCCESS);
 
   return NULL;
@@ -60,11 +79,11 @@ _err:
 
 static int tsdbCommitTSData(STsdbRepo *pRepo) {
   SMemTable *  pMem = pRepo->imem;
-  SDataCols *  pDataCols = NULL;
-  STsdbMeta *  pMeta = pRepo->tsdbMeta;
-  SCommitIter *iters = NULL;
-  SRWHelper    whelper = {0};
   STsdbCfg *   pCfg = &(pRepo->config);
+  SCommitIter *iters = NULL;
+  char *       dataDir = NULL;
+  pthread_t *  workers = NULL;
+  SCommitCtx   ctx = {0};
 
   if (pMem->numOfRows <= 0) return 0;
 
@@ -74,39 +93,85 @@ static int tsdbCommitTSData(STsdbRepo *pRepo) {
     goto _err;
   }
 
-  if (tsdbInitWriteHelper(&whelper, pRepo) < 0) {
-    tsdbError("vgId:%d failed to init write helper since %s", REPO_ID(pRepo), tstrerror(terrno));
+  int sfid = (int)(TSDB_KEY_FILEID(pMem->keyFirst, pCfg->daysPerFile, pCfg->precision));
+  int efid = (int)(TSDB_KEY_FILEID(pMem->keyLast, pCfg->daysPerFile, pCfg->precision));
+
+  ctx.pRepo = pRepo;
+  ctx.iters = iters;
+  ctx.fids = (int *)calloc(efid - sfid + 1, sizeof(int));
+  if (ctx.fids == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
     goto _err;
   }
 
-  if ((pDataCols = tdNewDataCols(pMeta->maxRowBytes, pMeta->maxCols, pCfg->maxRowsPerFileBlock)) == NULL) {
+  dataDir = tsdbGetDataDirName(pRepo->rootDir);
+  if (dataDir == NULL) {
     terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
-    tsdbError("vgId:%d failed to init data cols with maxRowBytes %d maxCols %d maxRowsPerFileBlock %d since %s",
-              REPO_ID(pRepo), pMeta->maxCols, pMeta->maxRowBytes, pCfg->maxRowsPerFileBlock, tstrerror(terrno));
     goto _err;
   }
 
-  int sfid = (int)(TSDB_KEY_FILEID(pMem->keyFirst, pCfg->daysPerFile, pCfg->precision));
-  int efid = (int)(TSDB_KEY_FILEID(pMem->keyLast, pCfg->daysPerFile, pCfg->precision));
-
-  // Loop to commit to each file
+  // Create all the file groups to commit to ahead, so the file group array does not change while committing
   for (int fid = sfid; fid <= efid; fid++) {
-    if (tsdbCommitToFile(pRepo, fid, iters, &whelper, pDataCols) < 0) {
-      tsdbError("vgId:%d failed to commit to file %d since %s", REPO_ID(pRepo), fid, tstrerror(terrno));
+    TSKEY minKey = 0, maxKey = 0;
+    tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, fid, &minKey, &maxKey);
+
+    if (tsdbSeekCommitIters(pMem, iters, minKey) < 0) goto _err;
+    if (!tsdbHasDataToCommit(iters, pMem->maxTables, minKey, maxKey)) {
+      tsdbDebug("vgId:%d no data to commit to file %d", REPO_ID(pRepo), fid);
+      continue;
+    }
+
+    if (tsdbCreateFGroupIfNeed(pRepo, dataDir, fid) == NULL) {
+      tsdbError("vgId:%d failed to create file group %d since %s", REPO_ID(pRepo), fid, tstrerror(terrno));
       goto _err;
     }
+    ctx.fids[ctx.nFids++] = fid;
   }
 
-  tdFreeDataCols(pDataCols);
+  // Loop to commit to each file, file groups are independent and committed by a pool of workers in parallel
+  int nWorkers = MIN(tsNumOfCommitWorkers, ctx.nFids);
+  if (nWorkers <= 1) {
+    tsdbCommitWorker(&ctx);
+  } else {
+    workers = (pthread_t *)calloc(nWorkers, sizeof(pthread_t));
+    if (workers == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      goto _err;
+    }
+
+    int nCreated = 0;
+    for (; nCreated < nWorkers - 1; nCreated++) {
+      if (pthread_create(workers + nCreated, NULL, tsdbCommitWorker, (void *)(&ctx)) != 0) {
+        tsdbWarn("vgId:%d failed to create commit worker since %s", REPO_ID(pRepo), strerror(errno));
+        break;
+      }
+    }
+
+    // The commit thread itself works as a worker too
+    tsdbCommitWorker(&ctx);
+
+    for (int i = 0; i < nCreated; i++) {
+      pthread_join(workers[i], NULL);
+    }
+  }
+
+  if (ctx.code != TSDB_CODE_SUCCESS) {
+    terrno = ctx.code;
+    goto _err;
+  }
+
+  tfree(workers);
+  tfree(dataDir);
+  tfree(ctx.fids);
   tsdbDestroyCommitIters(iters, pMem->maxTables);
-  tsdbDestroyHelper(&whelper);
 
   return 0;
 
 _err:
-  tdFreeDataCols(pDataCols);
+  tfree(workers);
+  tfree(dataDir);
+  tfree(ctx.fids);
   tsdbDestroyCommitIters(iters, pMem->maxTables);
-  tsdbDestroyHelper(&whelper);
 
   return -1;
 }
@@ -166,7 +231,11 @@ static void tsdbEndCommit(STsdbRepo *pRepo, int eno) {
   pRepo->imem = NULL;
   tsdbUnlockRepo(pRepo);
   tsdbUnRefMemTable(pRepo, pIMem);
+  // Claim compaction before releasing the commit slot so tsdbCloseRepo keeps waiting for it. The memtable is already
+  // released, so the compaction finds no commit running.
+  bool compact = (eno == TSDB_CODE_SUCCESS) && tsdbPrepareCompact(pRepo);
   tsem_post(&(pRepo->readyToCommit));
+  if (compact) tsdbStartCompact(pRepo);
 }
 
 static int tsdbHasDataToCommit(SCommitIter *iters, int nIters, TSKEY minKey, TSKEY maxKey) {
@@ -178,12 +247,13 @@ static int tsdbHasDataToCommit(SCommitIter *iters, int nIters, TSKEY minKey, TSK
 }
 
 static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SCommitIter *iters, SRWHelper *pHelper, SDataCols *pDataCols) {
-  char *      dataDir = NULL;
   STsdbCfg *  pCfg = &pRepo->config;
   STsdbFileH *pFileH = pRepo->tsdbFileH;
   SFileGroup *pGroup = NULL;
   SMemTable * pMem = pRepo->imem;
   bool        newLast = false;
+  TSKEY *     dirtyKeys = NULL;
+  uint32_t    oldHeadMagic = 0;
 
   TSKEY minKey = 0, maxKey = 0;
   tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, fid, &minKey, &maxKey);
@@ -195,16 +265,23 @@ static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SCommitIter *iters, SRWHe
     return 0;
   }
 
-  // Create and open files for commit
-  dataDir = tsdbGetDataDirName(pRepo->rootDir);
-  if (dataDir == NULL) {
-    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
-    return -1;
-  }
+  tsdbMarkCompactFGroup(pRepo, fid);
 
-  if ((pGroup = tsdbCreateFGroupIfNeed(pRepo, dataDir, fid)) == NULL) {
-    tsdbError("vgId:%d failed to create file group %d since %s", REPO_ID(pRepo), fid, tstrerror(terrno));
-    goto _err;
+  // The file group is created by tsdbCommitTSData ahead
+  pthread_rwlock_rdlock(&(pFileH->fhlock));
+  pGroup = tsdbSearchFGroup(pFileH, fid, TD_EQ);
+  if (pGroup != NULL) oldHeadMagic = pGroup->files[TSDB_FILE_TYPE_HEAD].info.magic;
+  pthread_rwlock_unlock(&(pFileH->fhlock));
+  ASSERT(pGroup != NULL);
+
+  // the first key committed to each table, the rollups of the earlier time buckets are kept
+  if (pRepo->rollupInterval > 0) {
+    dirtyKeys = (TSKEY *)malloc(sizeof(TSKEY) * pMem->maxTables);
+    if (dirtyKeys == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      goto _err;
+    }
+    for (int tid = 0; tid < pMem->maxTables; tid++) dirtyKeys[tid] = TSKEY_INITIAL_VAL;
   }
 
   // Open files for write/read
@@ -230,6 +307,11 @@ static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SCommitIter *iters, SRWHe
     if (tsdbSetHelperTable(pHelper, pIter->pTable, pRepo) < 0) goto _err;
 
     if (pIter->pIter != NULL) {
+      if (dirtyKeys != NULL) {
+        TSKEY nextKey = tsdbNextIterKey(pIter->pIter);
+        if (nextKey != TSDB_DATA_TIMESTAMP_NULL && nextKey <= maxKey) dirtyKeys[tid] = nextKey;
+      }
+
       if (tdInitDataCols(pDataCols, tsdbGetTableSchemaImpl(pIter->pTable, false, false, -1)) < 0) {
         terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
         goto _err;
@@ -264,17 +346,19 @@ static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SCommitIter *iters, SRWHe
     goto _err;
   }
 
-  tfree(dataDir);
   tsdbCloseHelperFile(pHelper, 0, pGroup);
 
   pthread_rwlock_wrlock(&(pFileH->fhlock));
 
   (void)taosRename(helperNewHeadF(pHelper)->fname, helperHeadF(pHelper)->fname);
   pGroup->files[TSDB_FILE_TYPE_HEAD].info = helperNewHeadF(pHelper)->info;
+  tsdbUpdateFileVersion(pRepo, pGroup, TSDB_FILE_TYPE_HEAD);
 
+  // the data file and an appended last file only grow, the blocks already in them do not change
   if (newLast) {
     (void)taosRename(helperNewLastF(pHelper)->fname, helperLastF(pHelper)->fname);
     pGroup->files[TSDB_FILE_TYPE_LAST].info = helperNewLastF(pHelper)->info;
+    tsdbUpdateFileVersion(pRepo, pGroup, TSDB_FILE_TYPE_LAST);
   } else {
     pGroup->files[TSDB_FILE_TYPE_LAST].info = helperLastF(pHelper)->info;
   }
@@ -283,11 +367,16 @@ static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SCommitIter *iters, SRWHe
 
   pthread_rwlock_unlock(&(pFileH->fhlock));
 
+  if (dirtyKeys != NULL) {
+    tsdbCommitRollups(pRepo, pGroup, iters, pMem->maxTables, dirtyKeys, oldHeadMagic);
+    free(dirtyKeys);
+  }
+
   return 0;
 
 _err:
-  tfree(dataDir);
   tsdbCloseHelperFile(pHelper, 1, pGroup);
+  tfree(dirtyKeys);
   return -1;
 }
 
@@ -313,17 +402,7 @@ static SCommitIter *tsdbCreateCommitIters(STsdbRepo *pRepo) {
 
   if (tsdbUnlockRepoMeta(pRepo) < 0) goto _err;
 
-  for (int i = 0; i < pMem->maxTables; i++) {
-    if ((iters[i].pTable != NULL) && (pMem->tData[i] != NULL) && (TABLE_UID(iters[i].pTable) == pMem->tData[i]->uid)) {
-      if ((iters[i].pIter = tSkipListCreateIter(pMem->tData[i]->pData)) == NULL) {
-        terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
-        goto _err;
-      }
-
-      tSkipListIterNext(iters[i].pIter);
-    }
-  }
-
+  // The skiplist iterators are positioned per file group by tsdbSeekCommitIters
   return iters;
 
 _err:
@@ -343,3 +422,95 @@ static void tsdbDestroyCommitIters(SCommitIter *iters, int maxTables) {
 
   free(iters);
 }
+
+static int tsdbSeekCommitIters(SMemTable *pMem, SCommitIter *iters, TSKEY key) {
+  for (int i = 0; i < pMem->maxTables; i++) {
+    SCommitIter *pIter = iters + i;
+    if (pIter->pTable == NULL || pMem->tData[i] == NULL || TABLE_UID(pIter->pTable) != pMem->tData[i]->uid) continue;
+
+    tSkipListDestroyIter(pIter->pIter);
+    pIter->pTableData = pMem->tData[i];
+    pIter->pIter = tSkipListCreateIterFromVal(pMem->tData[i]->pData, (const char *)(&key), TSDB_DATA_TYPE_TIMESTAMP,
+                                              TSDB_ORDER_ASC);
+    if (pIter->pIter == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+
+    tSkipListIterNext(pIter->pIter);
+  }
+
+  return 0;
+}
+
+// Each worker owns its iterators, helper and data cols and takes the next file group until all are committed or
+// any of the workers fails.
+static void *tsdbCommitWorker(void *arg) {
+  SCommitCtx * pCtx = (SCommitCtx *)arg;
+  STsdbRepo *  pRepo = pCtx->pRepo;
+  SMemTable *  pMem = pRepo->imem;
+  STsdbMeta *  pMeta = pRepo->tsdbMeta;
+  STsdbCfg *   pCfg = &(pRepo->config);
+  SCommitIter *iters = NULL;
+  SDataCols *  pDataCols = NULL;
+  SRWHelper    whelper = {0};
+
+  iters = (SCommitIter *)calloc(pMem->maxTables, sizeof(SCommitIter));
+  if (iters == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+  for (int i = 0; i < pMem->maxTables; i++) {
+    iters[i].pTable = pCtx->iters[i].pTable;
+  }
+
+  if (tsdbInitWriteHelper(&whelper, pRepo) < 0) {
+    tsdbError("vgId:%d failed to init write helper since %s", REPO_ID(pRepo), tstrerror(terrno));
+    goto _err;
+  }
+
+  if ((pDataCols = tdNewDataCols(pMeta->maxRowBytes, pMeta->maxCols, pCfg->maxRowsPerFileBlock)) == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    tsdbError("vgId:%d failed to init data cols with maxRowBytes %d maxCols %d maxRowsPerFileBlock %d since %s",
+              REPO_ID(pRepo), pMeta->maxCols, pMeta->maxRowBytes, pCfg->maxRowsPerFileBlock, tstrerror(terrno));
+    goto _err;
+  }
+
+  while (atomic_load_32(&(pCtx->code)) == TSDB_CODE_SUCCESS) {
+    int idx = atomic_fetch_add_32(&(pCtx->nextIdx), 1);
+    if (idx >= pCtx->nFids) break;
+
+    int   fid = pCtx->fids[idx];
+    TSKEY minKey = 0, maxKey = 0;
+    tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, fid, &minKey, &maxKey);
+
+    if (tsdbSeekCommitIters(pMem, iters, minKey) < 0) goto _err;
+
+    if (tsdbCommitToFile(pRepo, fid, iters, &whelper, pDataCols) < 0) {
+      tsdbError("vgId:%d failed to commit to file %d since %s", REPO_ID(pRepo), fid, tstrerror(terrno));
+      goto _err;
+    }
+  }
+
+  tdFreeDataCols(pDataCols);
+  tsdbDestroyHelper(&whelper);
+  for (int i = 0; i < pMem->maxTables; i++) {
+    tSkipListDestroyIter(iters[i].pIter);
+  }
+  free(iters);
+
+  return NULL;
+
+_err:
+  atomic_val_compare_exchange_32(&(pCtx->code), TSDB_CODE_SUCCESS, terrno);
+  tdFreeDataCols(pDataCols);
+  tsdbDestroyHelper(&whelper);
+  if (iters != NULL) {
+    for (int i = 0; i < pMem->maxTables; i++) {
+      tSkipListDestroyIter(iters[i].pIter);
+    }
+    free(iters);
+  }
+
+  return NULL;
+}
@@ -29,20 +29,46 @@ typedef struct {
   pthread_t *     threads;
 } SCommitQueue;
 
+enum { COMMIT_REQ = 0, COMPACT_REQ };
+
 typedef struct {
+  int        req;
   STsdbRepo *pRepo;
 } SCommitReq;
 
 static void *tsdbLoopCommit(void *arg);
+static int   tsdbScheduleReq(SCommitQueue *pQueue, STsdbRepo *pRepo, int req);
+static int   tsdbInitQueue(SCommitQueue *pQueue, int nthreads);
+static void  tsdbDestroyQueue(SCommitQueue *pQueue);
 
 SCommitQueue tsCommitQueue = {0};
+// Compaction has a thread of its own, so a throttled rewrite never holds back the commits queued behind it
+SCommitQueue tsCompactQueue = {0};
 
 int tsdbInitCommitQueue() {
   int nthreads = tsNumOfCommitThreads;
-  SCommitQueue *pQueue = &tsCommitQueue;
 
   if (nthreads < 1) nthreads = 1;
 
+  if (tsdbInitQueue(&tsCommitQueue, nthreads) < 0) return -1;
+  if (tsdbInitQueue(&tsCompactQueue, 1) < 0) {
+    tsdbDestroyQueue(&tsCommitQueue);
+    return -1;
+  }
+
+  return 0;
+}
+
+void tsdbDestroyCommitQueue() {
+  tsdbDestroyQueue(&tsCommitQueue);
+  tsdbDestroyQueue(&tsCompactQueue);
+}
+
+int tsdbScheduleCommit(STsdbRepo *pRepo) { return tsdbScheduleReq(&tsCommitQueue, pRepo, COMMIT_REQ); }
+
+int tsdbScheduleCompact(STsdbRepo *pRepo) { return tsdbScheduleReq(&tsCompactQueue, pRepo, COMPACT_REQ); }
+
+static int tsdbInitQueue(SCommitQueue *pQueue, int nthreads) {
   pQueue->stop = false;
   pQueue->nthreads = nthreads;
 
@@ -63,15 +89,13 @@ int tsdbInitCommitQueue() {
   pthread_cond_init(&(pQueue->queueNotEmpty), NULL);
 
   for (int i = 0; i < nthreads; i++) {
-    pthread_create(pQueue->threads + i, NULL, tsdbLoopCommit, NULL);
+    pthread_create(pQueue->threads + i, NULL, tsdbLoopCommit, pQueue);
   }
 
   return 0;
 }
 
-void tsdbDestroyCommitQueue() {
-  SCommitQueue *pQueue = &tsCommitQueue;
-
+static void tsdbDestroyQueue(SCommitQueue *pQueue) {
   pthread_mutex_lock(&(pQueue->lock));
 
   if (pQueue->stop) {
@@ -94,15 +118,14 @@ void tsdbDestroyCommitQueue() {
   pthread_mutex_destroy(&(pQueue->lock));
 }
 
-int tsdbScheduleCommit(STsdbRepo *pRepo) {
-  SCommitQueue *pQueue = &tsCommitQueue;
-
+static int tsdbScheduleReq(SCommitQueue *pQueue, STsdbRepo *pRepo, int req) {
   SListNode *pNode = (SListNode *)calloc(1, sizeof(SListNode) + sizeof(SCommitReq));
   if (pNode == NULL) {
     terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
     return -1;
   }
 
+  ((SCommitReq *)pNode->data)->req = req;
   ((SCommitReq *)pNode->data)->pRepo = pRepo;
 
   pthread_mutex_lock(&(pQueue->lock));
@@ -117,7 +140,7 @@ int tsdbScheduleCommit(STsdbRepo *pRepo) {
 }
 
 static void *tsdbLoopCommit(void *arg) {
-  SCommitQueue *pQueue = &tsCommitQueue;
+  SCommitQueue *pQueue = (SCommitQueue *)arg;
   SListNode *   pNode = NULL;
   STsdbRepo *   pRepo = NULL;
 
@@ -142,7 +165,11 @@ static void *tsdbLoopCommit(void *arg) {
 
     pRepo = ((SCommitReq *)pNode->data)->pRepo;
 
-    tsdbCommitData(pRepo);
+    if (((SCommitReq *)pNode->data)->req == COMPACT_REQ) {
+      tsdbCompactData(pRepo);
+    } else {
+      tsdbCommitData(pRepo);
+    }
     listNodeFree(pNode);
   }
 
@@ -11,4 +11,497 @@
  *
  * You should have received a copy of the GNU Affero General Public License
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
- */
\ No newline at end of file
+ */
+#include "os.h"
+#include "tglobal.h"
+#include "tscompression.h"
+#include "tsdbMain.h"
+
+#define TSDB_COMPACT_WAIT_MS 10
+
+static bool tsdbPickCompactFGroup(STsdbRepo *pRepo, int *fid);
+static int  tsdbCompactFGroup(STsdbRepo *pRepo, int fid);
+static void tsdbClearCompactFGroup(STsdbCompactInfo *pInfo);
+static int  tsdbCompactTable(SRWHelper *pReadH, SRWHelper *pWriteH, SDataCols *pDataCols, STable *pTable,
+                             int64_t *bytes, int64_t stime);
+static int  tsdbFlushCompactCols(SRWHelper *pWriteH, SDataCols *pDataCols, int64_t *bytes);
+static void tsdbAppendDataColsRows(SDataCols *target, SDataCols *source, int offset, int nRows);
+static int  tsdbCreateCompactFiles(SRWHelper *pWriteH, SFileGroup *pGroup);
+static void tsdbCloseCompactFiles(SRWHelper *pWriteH, bool hasError);
+static int  tsdbSwapCompactFiles(SRWHelper *pWriteH, SFileGroup *pGroup);
+static void tsdbThrottleCompact(int64_t bytes, int64_t stime);
+static void tsdbEndCompact(STsdbRepo *pRepo, bool reschedule);
+
+bool tsdbPrepareCompact(STsdbRepo *pRepo) {
+  int fid = 0;
+
+  if (!tsEnableCompact || atomic_load_8(&(pRepo->compactStop))) return false;
+  if (!tsdbPickCompactFGroup(pRepo, &fid)) return false;
+
+  // Only one compaction task of a repository can be in the compaction queue
+  if (atomic_val_compare_exchange_8(&(pRepo->compactState), TSDB_COMPACT_IDLE, TSDB_COMPACT_SCHEDULED) !=
+      TSDB_COMPACT_IDLE) {
+    return false;
+  }
+
+  tsdbDebug("vgId:%d compaction of file %d is scheduled", REPO_ID(pRepo), fid);
+  return true;
+}
+
+void tsdbStartCompact(STsdbRepo *pRepo) {
+  if (tsdbScheduleCompact(pRepo) < 0) {
+    tsdbError("vgId:%d failed to schedule compaction since %s", REPO_ID(pRepo), tstrerror(terrno));
+    atomic_store_8(&(pRepo->compactState), TSDB_COMPACT_IDLE);
+  }
+}
+
+void *tsdbCompactData(STsdbRepo *pRepo) {
+  STsdbCompactInfo *pInfo = &(pRepo->compactInfo);
+  int               fid = 0;
+  bool              found = false;
+
+  if (atomic_load_8(&(pRepo->compactStop)) || !tsEnableCompact) {
+    tsdbEndCompact(pRepo, false);
+    return NULL;
+  }
+
+  // Compaction runs beside commits and only coordinates with them per file group, see tsdbMarkCompactFGroup. It never
+  // starts while a commit runs, as that commit may have begun to write the file group picked here. The commit
+  // schedules compaction again once it ends.
+  pthread_mutex_lock(&(pInfo->mutex));
+  if (pRepo->imem == NULL) {
+    found = tsdbPickCompactFGroup(pRepo, &fid);
+    if (found) {
+      pInfo->fid = fid;
+      pInfo->dirty = 0;
+    }
+  } else {
+    pthread_mutex_unlock(&(pInfo->mutex));
+    tsdbDebug("vgId:%d compaction is deferred to the end of the running commit", REPO_ID(pRepo));
+    tsdbEndCompact(pRepo, false);
+    return NULL;
+  }
+  pthread_mutex_unlock(&(pInfo->mutex));
+
+  if (found && tsdbCompactFGroup(pRepo, fid) < 0) {
+    tsdbError("vgId:%d failed to compact file %d since %s", REPO_ID(pRepo), fid, tstrerror(terrno));
+    tsdbEndCompact(pRepo, false);
+    return NULL;
+  }
+
+  tsdbEndCompact(pRepo, true);
+
+  return NULL;
+}
+
+void tsdbStopCompact(STsdbRepo *pRepo) {
+  atomic_store_8(&(pRepo->compactStop), 1);
+  while (atomic_load_8(&(pRepo->compactState)) != TSDB_COMPACT_IDLE) {
+    taosMsleep(TSDB_COMPACT_WAIT_MS);
+  }
+}
+
+// Called by a commit before it writes to a file group. The files of the group under compaction are swapped while the
+// mutex is held, so either the commit writes to the swapped files or the rewrite misses the committed data and is
+// dropped.
+void tsdbMarkCompactFGroup(STsdbRepo *pRepo, int fid) {
+  STsdbCompactInfo *pInfo = &(pRepo->compactInfo);
+
+  pthread_mutex_lock(&(pInfo->mutex));
+  if (pInfo->fid == fid) pInfo->dirty = 1;
+  pthread_mutex_unlock(&(pInfo->mutex));
+}
+
+// ---------------- INTERNAL FUNCTIONS ----------------
+static void tsdbEndCompact(STsdbRepo *pRepo, bool reschedule) {
+  int fid = 0;
+
+  // Chain the next compaction without passing through IDLE: tsdbStopCompact returns once the state is IDLE, and the
+  // repository may be freed right after that.
+  if (reschedule && tsEnableCompact && !atomic_load_8(&(pRepo->compactStop)) && tsdbPickCompactFGroup(pRepo, &fid)) {
+    if (tsdbScheduleCompact(pRepo) == 0) {
+      tsdbDebug("vgId:%d compaction of file %d is scheduled", REPO_ID(pRepo), fid);
+      return;
+    }
+    tsdbError("vgId:%d failed to schedule compaction of file %d since %s", REPO_ID(pRepo), fid, tstrerror(terrno));
+  }
+
+  atomic_store_8(&(pRepo->compactState), TSDB_COMPACT_IDLE);
+}
+
+// Pick the most fragmented file group which is no longer written by the current time window. A file group qualifies
+// once either its sub-block ratio or its tomb ratio reaches the configured threshold, or once it turns cold and is
+// still compressed with the hot backend.
+static bool tsdbPickCompactFGroup(STsdbRepo *pRepo, int *fid) {
+  STsdbCfg *  pCfg = &(pRepo->config);
+  STsdbFileH *pFileH = pRepo->tsdbFileH;
+  double      maxScore = 0;
+  bool        found = false;
+
+  int cfid = (int)(TSDB_KEY_FILEID(taosGetTimestamp(pCfg->precision), pCfg->daysPerFile, pCfg->precision));
+
+  pthread_rwlock_rdlock(&(pFileH->fhlock));
+
+  for (int i = 0; i < pFileH->nFGroups; i++) {
+    SFileGroup *pGroup = pFileH->pFGroup + i;
+    if (pGroup->fileId >= cfid) break;
+
+    STsdbFileInfo *pDInfo = &(pGroup->files[TSDB_FILE_TYPE_DATA].info);
+    STsdbFileInfo *pLInfo = &(pGroup->files[TSDB_FILE_TYPE_LAST].info);
+
+    double score = 0;
+    double nBlocks = (double)pDInfo->totalBlocks + pLInfo->totalBlocks;
+    double nSubBlocks = (double)pDInfo->totalSubBlocks + pLInfo->totalSubBlocks;
+    double size = (double)pDInfo->size + pLInfo->size;
+    double tombSize = (double)pDInfo->tombSize + pLInfo->tombSize;
+
+    if (tsCompactSubBlockRatio > 0 && nBlocks > 0) {
+      score = MAX(score, nSubBlocks / nBlocks / tsCompactSubBlockRatio);
+    }
+    if (tsCompactTombRatio > 0 && size > 0) {
+      score = MAX(score, tombSize / size / tsCompactTombRatio);
+    }
+    if (COMP_BACKEND(tsdbGetFGroupCompression(pRepo, pGroup->fileId)) != pDInfo->backend) {
+      score = MAX(score, 1);
+    }
+
+    if (score >= 1 && score > maxScore) {
+      maxScore = score;
+      *fid = pGroup->fileId;
+      found = true;
+    }
+  }
+
+  pthread_rwlock_unlock(&(pFileH->fhlock));
+
+  return found;
+}
+
+static int tsdbCompactFGroup(STsdbRepo *pRepo, int fid) {
+  STsdbCfg *        pCfg = &(pRepo->config);
+  STsdbMeta *       pMeta = pRepo->tsdbMeta;
+  STsdbFileH *      pFileH = pRepo->tsdbFileH;
+  STsdbCompactInfo *pInfo = &(pRepo->compactInfo);
+  SRWHelper         rhelper = {0};
+  SRWHelper         whelper = {0};
+  SDataCols *       pDataCols = NULL;
+  SFileGroup        fGroup = {0};
+  SFileGroup *      pGroup = NULL;
+  int64_t           bytes = 0;
+  int64_t           stime = taosGetTimestampMs();
+  int8_t            compression = tsdbGetFGroupCompression(pRepo, fid);
+
+  pthread_rwlock_rdlock(&(pFileH->fhlock));
+  pGroup = tsdbSearchFGroup(pFileH, fid, TD_EQ);
+  if (pGroup != NULL) fGroup = *pGroup;
+  pthread_rwlock_unlock(&(pFileH->fhlock));
+  if (pGroup == NULL) {
+    tsdbClearCompactFGroup(pInfo);
+    return 0;
+  }
+
+  int64_t osize = 0;
+  for (int type = 0; type < TSDB_FILE_TYPE_MAX; type++) osize += fGroup.files[type].info.size;
+
+  tsdbInfo("vgId:%d start to compact file %d, data blocks %u sub-blocks %u tomb size %" PRIu64 " size %" PRId64
+           " backend %u -> %d",
+           REPO_ID(pRepo), fid, fGroup.files[TSDB_FILE_TYPE_DATA].info.totalBlocks,
+           fGroup.files[TSDB_FILE_TYPE_DATA].info.totalSubBlocks,
+           fGroup.files[TSDB_FILE_TYPE_DATA].info.tombSize + fGroup.files[TSDB_FILE_TYPE_LAST].info.tombSize, osize,
+           fGroup.files[TSDB_FILE_TYPE_DATA].info.backend, COMP_BACKEND(compression));
+
+  if (tsdbInitReadHelper(&rhelper, pRepo) < 0 || tsdbInitWriteHelper(&whelper, pRepo) < 0) goto _err;
+
+  if ((pDataCols = tdNewDataCols(pMeta->maxRowBytes, pMeta->maxCols, pCfg->maxRowsPerFileBlock)) == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  if (tsdbSetAndOpenHelperFile(&rhelper, &fGroup) < 0) goto _err;
+  if (tsdbLoadCompIdx(&rhelper, NULL) < 0) goto _err;
+  if (tsdbCreateCompactFiles(&whelper, &fGroup) < 0) goto _err;
+
+  pInfo->nTables = rhelper.idxH.numOfIdx;
+  pInfo->tablesDone = 0;
+
+  for (int i = 0; i < rhelper.idxH.numOfIdx; i++) {
+    SCompIdx *pIdx = rhelper.idxH.pIdxArray + i;
+    STable *  pTable = NULL;
+
+    if (atomic_load_8(&(pRepo->compactStop))) {
+      terrno = TSDB_CODE_TDB_COMPACT_CANCELLED;
+      goto _err;
+    }
+
+    if (tsdbRLockRepoMeta(pRepo) < 0) goto _err;
+    if (pIdx->tid < pMeta->maxTables) {
+      pTable = pMeta->tables[pIdx->tid];
+      if (pTable != NULL && TABLE_UID(pTable) == pIdx->uid) {
+        tsdbRefTable(pTable);
+      } else {
+        pTable = NULL;
+      }
+    }
+    if (tsdbUnlockRepoMeta(pRepo) < 0) {
+      if (pTable) tsdbUnRefTable(pTable);
+      goto _err;
+    }
+
+    // Data of dropped tables is left behind and reclaimed
+    if (pTable != NULL) {
+      int code = tsdbCompactTable(&rhelper, &whelper, pDataCols, pTable, &bytes, stime);
+      tsdbUnRefTable(pTable);
+      if (code < 0) goto _err;
+    }
+
+    pInfo->tablesDone++;
+    tsdbDebug("vgId:%d compact file %d, %d/%d tables done, %" PRId64 " bytes written", REPO_ID(pRepo), fid,
+              pInfo->tablesDone, pInfo->nTables, bytes);
+  }
+
+  if (tsdbWriteCompIdx(&whelper) < 0) goto _err;
+  helperDataF(&whelper)->info.backend = COMP_BACKEND(compression);
+  tsdbCloseCompactFiles(&whelper, false);
+
+  // Swap in the new files unless a commit wrote to the file group meanwhile, or the retention removed it
+  int64_t nsize = 0;
+  pthread_mutex_lock(&(pInfo->mutex));
+  pthread_rwlock_wrlock(&(pFileH->fhlock));
+
+  pGroup = tsdbSearchFGroup(pFileH, fid, TD_EQ);
+  if (pInfo->dirty || pGroup == NULL) {
+    pthread_rwlock_unlock(&(pFileH->fhlock));
+    pthread_mutex_unlock(&(pInfo->mutex));
+    tsdbInfo("vgId:%d file %d is changed during compaction, the rewrite is dropped", REPO_ID(pRepo), fid);
+    tsdbCloseCompactFiles(&whelper, true);
+    goto _over;
+  }
+
+  if (tsdbSwapCompactFiles(&whelper, pGroup) < 0) {
+    pthread_rwlock_unlock(&(pFileH->fhlock));
+    pthread_mutex_unlock(&(pInfo->mutex));
+    tsdbError("vgId:%d failed to swap in the compacted files of file %d since %s", REPO_ID(pRepo), fid,
+              tstrerror(terrno));
+    goto _err;
+  }
+
+  pGroup->files[TSDB_FILE_TYPE_DATA].info = helperDataF(&whelper)->info;
+  pGroup->files[TSDB_FILE_TYPE_HEAD].info = helperNewHeadF(&whelper)->info;
+  pGroup->files[TSDB_FILE_TYPE_LAST].info = helperNewLastF(&whelper)->info;
+
+  for (int type = 0; type < TSDB_FILE_TYPE_MAX; type++) {
+    tsdbUpdateFileVersion(pRepo, pGroup, type);
+    nsize += pGroup->files[type].info.size;
+  }
+
+  pInfo->fid = -1;
+
+  pthread_rwlock_unlock(&(pFileH->fhlock));
+  pthread_mutex_unlock(&(pInfo->mutex));
+
+  tsdbRestampRollups(pRepo, pGroup, fGroup.files[TSDB_FILE_TYPE_HEAD].info.magic);
+
+  pInfo->nCompacted++;
+  if (osize > nsize) pInfo->bytesReclaimed += (osize - nsize);
+
+  tsdbInfo("vgId:%d file %d is compacted, %d tables size %" PRId64 " -> %" PRId64 " in %" PRId64
+           " ms, %" PRId64 " files compacted and %" PRId64 " bytes reclaimed in total",
+           REPO_ID(pRepo), fid, pInfo->nTables, osize, nsize, taosGetTimestampMs() - stime, pInfo->nCompacted,
+           pInfo->bytesReclaimed);
+
+_over:
+  tsdbClearCompactFGroup(pInfo);
+  tdFreeDataCols(pDataCols);
+  tsdbDestroyHelper(&rhelper);
+  tsdbDestroyHelper(&whelper);
+  return 0;
+
+_err:
+  tsdbClearCompactFGroup(pInfo);
+  tsdbCloseCompactFiles(&whelper, true);
+  tdFreeDataCols(pDataCols);
+  tsdbDestroyHelper(&rhelper);
+  tsdbDestroyHelper(&whelper);
+  return -1;
+}
+
+static void tsdbClearCompactFGroup(STsdbCompactInfo *pInfo) {
+  pthread_mutex_lock(&(pInfo->mutex));
+  pInfo->fid = -1;
+  pthread_mutex_unlock(&(pInfo->mutex));
+}
+
+// Rewrite all blocks of a table into the new files, merging sub-blocks and re-cutting the rows into blocks of
+// maxRowsPerFileBlock rows. The tail goes to the new .last file if it is too small for the .data file.
+static int tsdbCompactTable(SRWHelper *pReadH, SRWHelper *pWriteH, SDataCols *pDataCols, STable *pTable,
+                            int64_t *bytes, int64_t stime) {
+  STsdbRepo *pRepo = helperRepo(pReadH);
+  STsdbCfg * pCfg = &(pRepo->config);
+  int        code = 0;
+
+  TSDB_RLOCK_TABLE(pTable);
+
+  if (tsdbSetHelperTable(pReadH, pTable, pRepo) < 0 || tsdbSetHelperTable(pWriteH, pTable, pRepo) < 0) goto _err;
+  helperSetState(pWriteH, TSDB_HELPER_INFO_LOAD);
+
+  if (pReadH->curCompIdx.len <= 0) goto _over;
+  if (tsdbLoadCompInfo(pReadH, NULL) < 0) goto _err;
+
+  if (tdInitDataCols(pDataCols, tsdbGetTableSchemaImpl(pTable, false, false, -1)) < 0) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  for (int i = 0; i < (int)pReadH->curCompIdx.numOfBlocks; i++) {
+    SCompBlock *pCompBlock = blockAtIdx(pReadH, i);
+    if (tsdbLoadBlockData(pReadH, pCompBlock, NULL) < 0) goto _err;
+
+    SDataCols *pSrc = pReadH->pDataCols[0];
+    int        offset = 0;
+    while (offset < pSrc->numOfRows) {
+      int rows = MIN(pSrc->numOfRows - offset, pDataCols->maxPoints - pDataCols->numOfRows);
+      tsdbAppendDataColsRows(pDataCols, pSrc, offset, rows);
+      offset += rows;
+
+      if (pDataCols->numOfRows >= pCfg->maxRowsPerFileBlock) {
+        if (tsdbFlushCompactCols(pWriteH, pDataCols, bytes) < 0) goto _err;
+        tsdbThrottleCompact(*bytes, stime);
+      }
+    }
+  }
+
+  if (pDataCols->numOfRows > 0 && tsdbFlushCompactCols(pWriteH, pDataCols, bytes) < 0) goto _err;
+
+  if (tsdbWriteCompInfo(pWriteH) < 0) goto _err;
+
+_over:
+  TSDB_RUNLOCK_TABLE(pTable);
+  return code;
+
+_err:
+  code = -1;
+  goto _over;
+}
+
+static int tsdbFlushCompactCols(SRWHelper *pWriteH, SDataCols *pDataCols, int64_t *bytes) {
+  STsdbCfg * pCfg = &(helperRepo(pWriteH)->config);
+  SCompBlock compBlock = {0};
+  bool       isLast = (pDataCols->numOfRows < pCfg->minRowsPerFileBlock);
+  SFile *    pFile = isLast ? helperNewLastF(pWriteH) : helperDataF(pWriteH);
+
+  if (tsdbWriteBlockToFile(pWriteH, pFile, pDataCols, &compBlock, isLast, true) < 0) return -1;
+  if (tsdbInsertSuperBlock(pWriteH, &compBlock, pWriteH->curCompIdx.numOfBlocks) < 0) return -1;
+
+  *bytes += compBlock.len;
+  tdResetDataCols(pDataCols);
+
+  return 0;
+}
+
+static void tsdbAppendDataColsRows(SDataCols *target, SDataCols *source, int offset, int nRows) {
+  ASSERT(target->numOfCols == source->numOfCols && target->numOfRows + nRows <= target->maxPoints);
+
+  for (int i = offset; i < offset + nRows; i++) {
+    for (int j = 0; j < source->numOfCols; j++) {
+      if (source->cols[j].len > 0) {
+        dataColAppendVal(target->cols + j, tdGetColDataOfRow(source->cols + j, i), target->numOfRows,
+                         target->maxPoints);
+      }
+    }
+    target->numOfRows++;
+  }
+}
+
+// The write helper writes to fresh .cd/.ch/.cl files only and never touches the files being compacted, nor the .h/.l
+// files a commit to the same file group writes
+static int tsdbCreateCompactFiles(SRWHelper *pWriteH, SFileGroup *pGroup) {
+  STsdbRepo *pRepo = helperRepo(pWriteH);
+  SFile *    files[] = {helperDataF(pWriteH), helperNewHeadF(pWriteH), helperNewLastF(pWriteH)};
+  int        types[] = {TSDB_FILE_TYPE_CDATA, TSDB_FILE_TYPE_CHEAD, TSDB_FILE_TYPE_CLAST};
+
+  tsdbResetHelper(pWriteH);
+  pWriteH->files.fGroup.fileId = pGroup->fileId;
+
+  for (int i = 0; i < (int)tListLen(files); i++) {
+    SFile *pFile = files[i];
+
+    memset((void *)&(pFile->info), 0, sizeof(pFile->info));
+    tsdbGetDataFileName(pRepo->rootDir, REPO_ID(pRepo), pGroup->fileId, types[i], pFile->fname);
+    if (tsdbOpenFile(pFile, O_WRONLY | O_CREAT | O_TRUNC) < 0) return -1;
+    pFile->info.size = TSDB_FILE_HEAD_SIZE;
+    pFile->info.magic = TSDB_FILE_INIT_MAGIC;
+    if (tsdbUpdateFileHeader(pFile) < 0) return -1;
+  }
+
+  helperSetState(pWriteH, TSDB_HELPER_FILE_SET_AND_OPEN | TSDB_HELPER_IDX_LOAD);
+
+  return 0;
+}
+
+static void tsdbCloseCompactFiles(SRWHelper *pWriteH, bool hasError) {
+  SFile *files[] = {helperDataF(pWriteH), helperNewHeadF(pWriteH), helperNewLastF(pWriteH)};
+
+  for (int i = 0; i < (int)tListLen(files); i++) {
+    SFile *pFile = files[i];
+
+    if (TSDB_IS_FILE_OPENED(pFile)) {
+      if (!hasError) {
+        tsdbUpdateFileHeader(pFile);
+        fsync(pFile->fd);
+      }
+      tsdbCloseFile(pFile);
+    }
+    if (hasError && pFile->fname[0] != '\0') (void)remove(pFile->fname);
+  }
+}
+
+// Replace the files of the group by the compacted ones, with the .head file last. Each replaced file is moved aside
+// first, so if a rename fails the files already replaced are put back and the group keeps its old files. A crash in
+// between is rolled back the same way when the file groups are restored, see tsdbOpenFileH.
+static int tsdbSwapCompactFiles(SRWHelper *pWriteH, SFileGroup *pGroup) {
+  STsdbRepo *pRepo = helperRepo(pWriteH);
+  SFile *    files[] = {helperDataF(pWriteH), helperNewLastF(pWriteH), helperNewHeadF(pWriteH)};
+  int        types[] = {TSDB_FILE_TYPE_DATA, TSDB_FILE_TYPE_LAST, TSDB_FILE_TYPE_HEAD};
+  int        otypes[] = {TSDB_FILE_TYPE_ODATA, TSDB_FILE_TYPE_OLAST, TSDB_FILE_TYPE_OHEAD};
+  char       oname[TSDB_FILENAME_LEN] = "\0";
+  int        i = 0;
+
+  for (i = 0; i < (int)tListLen(files); i++) {
+    char *fname = pGroup->files[types[i]].fname;
+
+    tsdbGetDataFileName(pRepo->rootDir, REPO_ID(pRepo), pGroup->fileId, otypes[i], oname);
+    if (taosRename(fname, oname) < 0) goto _err;
+    if (taosRename(files[i]->fname, fname) < 0) {
+      int code = errno;
+      (void)taosRename(oname, fname);
+      errno = code;
+      goto _err;
+    }
+  }
+
+  for (i = 0; i < (int)tListLen(files); i++) {
+    tsdbGetDataFileName(pRepo->rootDir, REPO_ID(pRepo), pGroup->fileId, otypes[i], oname);
+    (void)remove(oname);
+  }
+
+  return 0;
+
+_err:
+  terrno = TAOS_SYSTEM_ERROR(errno);
+  while (--i >= 0) {
+    char *fname = pGroup->files[types[i]].fname;
+
+    tsdbGetDataFileName(pRepo->rootDir, REPO_ID(pRepo), pGroup->fileId, otypes[i], oname);
+    (void)taosRename(fname, files[i]->fname);
+    (void)taosRename(oname, fname);
+  }
+  return -1;
+}
+
+static void tsdbThrottleCompact(int64_t bytes, int64_t stime) {
+  if (tsCompactMBPerSec <= 0) return;
+
+  int64_t expected = bytes * 1000 / ((int64_t)tsCompactMBPerSec * 1024 * 1024);
+  int64_t elapsed = taosGetTimestampMs() - stime;
+  if (expected > elapsed) taosMsleep((int32_t)(expected - elapsed));
+}
@@ -18,11 +18,13 @@
 #include "os.h"
 #include "talgo.h"
 #include "tchecksum.h"
+#include "tscompression.h"
 #include "tsdbMain.h"
 #include "tutil.h"
 
 
-const char *tsdbFileSuffix[] = {".head", ".data", ".last", ".stat", ".h", ".d", ".l", ".s"};
+const char *tsdbFileSuffix[] = {".head", ".data", ".last", ".stat", ".h",  ".d",  ".l",  ".s",
+                                ".sma",  ".m",    ".ch",   ".cd",   ".cl", ".oh", ".od", ".ol"};
 
 static int   tsdbInitFile(SFile *pFile, STsdbRepo *pRepo, int fid, int type);
 static void  tsdbDestroyFile(SFile *pFile);
@@ -77,9 +79,10 @@ int tsdbOpenFileH(STsdbRepo *pRepo) {
   DIR *   dir = NULL;
   int     fid = 0;
   int     vid = 0;
-  regex_t regex1 = {0}, regex2 = {0};
+  regex_t regex1 = {0}, regex2 = {0}, regex3 = {0}, regex4 = {0};
   int     code = 0;
   char    fname[TSDB_FILENAME_LEN] = "\0";
+  char    oname[TSDB_FILENAME_LEN] = "\0";
 
   SFileGroup  fileGroup = {0};
   STsdbFileH *pFileH = pRepo->tsdbFileH;
@@ -128,9 +131,49 @@ int tsdbOpenFileH(STsdbRepo *pRepo) {
     goto _err;
   }
 
+  code = regcomp(&regex3, "^v[0-9]+f[0-9]+\\.(sma|m)$", REG_EXTENDED);
+  if (code != 0) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  code = regcomp(&regex4, "^v[0-9]+f[0-9]+\\.(ch|cd|cl|oh|od|ol)$", REG_EXTENDED);
+  if (code != 0) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+
   int mfid = tsdbGetCurrMinFid(pCfg->precision, pCfg->keep, pCfg->daysPerFile);
 
+  // A compaction interrupted before its swap leaves the rewritten files behind, and one interrupted during its swap the
+  // replaced files as well. The replaced files are put back before the file groups are restored.
   struct dirent *dp = NULL;
+  while ((dp = readdir(dir)) != NULL) {
+    if (regexec(&regex4, dp->d_name, 0, NULL, 0) != 0) continue;
+
+    sscanf(dp->d_name, "v%df%d", &vid, &fid);
+    if (vid != REPO_ID(pRepo)) continue;
+
+    for (int type = TSDB_FILE_TYPE_CHEAD; type <= TSDB_FILE_TYPE_OLAST; type++) {
+      if (strcmp(strchr(dp->d_name, '.'), tsdbFileSuffix[type]) != 0) continue;
+
+      tsdbGetDataFileName(pRepo->rootDir, pCfg->tsdbId, fid, type, oname);
+      if (type >= TSDB_FILE_TYPE_OHEAD) {
+        int ftype = type - TSDB_FILE_TYPE_OHEAD + TSDB_FILE_TYPE_HEAD;
+
+        tsdbGetDataFileName(pRepo->rootDir, pCfg->tsdbId, fid, ftype, fname);
+        tsdbInfo("vgId:%d file %s is restored from an interrupted compaction", REPO_ID(pRepo), fname);
+        if (taosRename(oname, fname) < 0) {
+          terrno = TAOS_SYSTEM_ERROR(errno);
+          goto _err;
+        }
+      } else {
+        (void)remove(oname);
+      }
+    }
+  }
+  rewinddir(dir);
+
   while ((dp = readdir(dir)) != NULL) {
     if (strcmp(dp->d_name, ".") == 0 || strcmp(dp->d_name, "..") == 0) continue;
 
@@ -183,6 +226,19 @@ int tsdbOpenFileH(STsdbRepo *pRepo) {
         free(fname2);
         continue;
       } else if (code == REG_NOMATCH) {
+        code = regexec(&regex3, dp->d_name, 0, NULL, 0);
+        if (code == 0) {
+          // rollup files are validated by queries and rebuilt by commits, only the useless ones are removed here
+          sscanf(dp->d_name, "v%df%d", &vid, &fid);
+          bool temp = (strcmp(strchr(dp->d_name, '.'), tsdbFileSuffix[TSDB_FILE_TYPE_NSMA]) == 0);
+          if (vid == REPO_ID(pRepo) && (temp || fid < mfid)) {
+            tsdbGetDataFileName(pRepo->rootDir, pCfg->tsdbId, fid, temp ? TSDB_FILE_TYPE_NSMA : TSDB_FILE_TYPE_SMA,
+                                fname);
+            (void)remove(fname);
+          }
+          continue;
+        }
+
         tsdbError("vgId:%d invalid file %s exists, ignore it", REPO_ID(pRepo), dp->d_name);
         continue;
       } else {
@@ -192,6 +248,7 @@ int tsdbOpenFileH(STsdbRepo *pRepo) {
       goto _err;
     }
 
+    for (int type = 0; type < TSDB_FILE_TYPE_MAX; type++) tsdbUpdateFileVersion(pRepo, &fileGroup, type);
     pFileH->pFGroup[pFileH->nFGroups++] = fileGroup;
     qsort((void *)(pFileH->pFGroup), pFileH->nFGroups, sizeof(SFileGroup), compFGroup);
     tsdbDebug("vgId:%d file group %d is restored, nFGroups %d", REPO_ID(pRepo), fileGroup.fileId, pFileH->nFGroups);
@@ -199,6 +256,8 @@ int tsdbOpenFileH(STsdbRepo *pRepo) {
 
   regfree(&regex1);
   regfree(&regex2);
+  regfree(&regex3);
+  regfree(&regex4);
   tfree(tDataDir);
   closedir(dir);
   return 0;
@@ -208,6 +267,8 @@ _err:
 
   regfree(&regex1);
   regfree(&regex2);
+  regfree(&regex3);
+  regfree(&regex4);
 
   tfree(tDataDir);
   if (dir != NULL) closedir(dir);
@@ -255,6 +316,7 @@ SFileGroup *tsdbCreateFGroupIfNeed(STsdbRepo *pRepo, char *dataDir, int fid) {
 
         return NULL;
       }
+      tsdbUpdateFileVersion(pRepo, pFGroup, type);
     }
 
     pthread_rwlock_wrlock(&pFileH->fhlock);
@@ -377,6 +439,7 @@ int tsdbCreateFile(SFile *pFile, STsdbRepo *pRepo, int fid, int type) {
 
   pFile->info.size = TSDB_FILE_HEAD_SIZE;
   pFile->info.magic = TSDB_FILE_INIT_MAGIC;
+  if (type == TSDB_FILE_TYPE_DATA) pFile->info.backend = COMP_BACKEND(tsdbGetFGroupCompression(pRepo, fid));
 
   if (tsdbUpdateFileHeader(pFile) < 0) {
     tsdbCloseFile(pFile);
@@ -398,6 +461,22 @@ SFileGroup *tsdbSearchFGroup(STsdbFileH *pFileH, int fid, int flags) {
   return (SFileGroup *)ptr;
 }
 
+bool tsdbIsColdFGroup(STsdbRepo *pRepo, int fid) {
+  STsdbCfg *pCfg = &(pRepo->config);
+
+  if (tsColdCompDays <= 0) return false;
+  return fid < tsdbGetCurrMinFid(pCfg->precision, tsColdCompDays, pCfg->daysPerFile);
+}
+
+int8_t tsdbGetFGroupCompression(STsdbRepo *pRepo, int fid) {
+  int8_t compression = pRepo->config.compression;
+
+  if (compression == NO_COMPRESSION || !tsdbIsColdFGroup(pRepo, fid)) return compression;
+
+  int8_t level = COMP_IS_GORILLA(compression) ? TWO_STAGE_GORILLA_COMP : TWO_STAGE_COMP;
+  return (int8_t)COMP_ALGORITHM(level, COMP_BACKEND_ZLIB);
+}
+
 void tsdbFitRetention(STsdbRepo *pRepo) {
   STsdbCfg *pCfg = &(pRepo->config);
   STsdbFileH *pFileH = pRepo->tsdbFileH;
@@ -446,6 +525,7 @@ int tsdbEncodeSFileInfo(void **buf, const STsdbFileInfo *pInfo) {
   tlen += taosEncodeFixedU32(buf, pInfo->offset);
   tlen += taosEncodeFixedU64(buf, pInfo->size);
   tlen += taosEncodeFixedU64(buf, pInfo->tombSize);
+  tlen += taosEncodeFixedU32(buf, pInfo->backend);
 
   return tlen;
 }
@@ -458,6 +538,7 @@ void *tsdbDecodeSFileInfo(void *buf, STsdbFileInfo *pInfo) {
   buf = taosDecodeFixedU32(buf, &(pInfo->offset));
   buf = taosDecodeFixedU64(buf, &(pInfo->size));
   buf = taosDecodeFixedU64(buf, &(pInfo->tombSize));
+  buf = taosDecodeFixedU32(buf, &(pInfo->backend));
 
   return buf;
 }
@@ -482,6 +563,18 @@ void tsdbRemoveFileGroup(STsdbRepo *pRepo, SFileGroup *pFGroup) {
     }
     tsdbDestroyFile(&fileGroup.files[type]);
   }
+
+  char fname[TSDB_FILENAME_LEN] = "\0";
+  tsdbGetDataFileName(pRepo->rootDir, REPO_ID(pRepo), fileGroup.fileId, TSDB_FILE_TYPE_SMA, fname);
+  (void)remove(fname);
+
+  tsdbPurgeBlockCache(pRepo->pBlockCache, fileGroup.fileId, -1);
+}
+
+// Called whenever a file of the group is created or replaced, before readers can open it
+void tsdbUpdateFileVersion(STsdbRepo *pRepo, SFileGroup *pGroup, int type) {
+  pGroup->files[type].version = atomic_add_fetch_32(&(pRepo->tsdbFileH->fversion), 1);
+  tsdbPurgeBlockCache(pRepo->pBlockCache, pGroup->fileId, type);
 }
 
 int tsdbLoadFileHeader(SFile *pFile, uint32_t *version) {
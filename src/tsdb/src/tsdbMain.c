@@ -30,7 +30,7 @@
 #define IS_VALID_PRECISION(precision) \
   (((precision) >= TSDB_TIME_PRECISION_MILLI) && ((precision) <= TSDB_TIME_PRECISION_NANO))
 #define TSDB_DEFAULT_COMPRESSION TWO_STAGE_COMP
-#define IS_VALID_COMPRESSION(compression) (((compression) >= NO_COMPRESSION) && ((compression) <= TWO_STAGE_COMP))
+#define IS_VALID_COMPRESSION(compression) (((compression) >= NO_COMPRESSION) && ((compression) <= TWO_STAGE_GORILLA_COMP))
 
 static int32_t     tsdbCheckAndSetDefaultCfg(STsdbCfg *pCfg);
 static int32_t     tsdbSetRepoEnv(char *rootDir, STsdbCfg *pCfg);
@@ -143,6 +143,7 @@ int tsdbCloseRepo(TSDB_REPO_T *repo, int toCommit) {
   terrno = TSDB_CODE_SUCCESS;
 
   tsdbStopStream(pRepo);
+  tsdbStopCompact(pRepo);
 
   if (toCommit) {
     tsdbAsyncCommit(pRepo);
@@ -479,8 +480,10 @@ static int32_t tsdbCheckAndSetDefaultCfg(STsdbCfg *pCfg) {
   // update check
   if (pCfg->update != 0) pCfg->update = 1;
 
-  // update cacheLastRow
-  if (pCfg->cacheLastRow != 0) pCfg->cacheLastRow = 1;
+  // update cacheLastRow, bit 1 caches the last row and bit 2 the last non-null value of each column
+  if (pCfg->cacheLastRow < TSDB_MIN_DB_CACHE_LAST_ROW || pCfg->cacheLastRow > TSDB_MAX_DB_CACHE_LAST_ROW) {
+    pCfg->cacheLastRow = 1;
+  }
 
   return 0;
 
@@ -643,6 +646,12 @@ static STsdbRepo *tsdbNewRepo(char *rootDir, STsdbAppH *pAppH, STsdbCfg *pCfg) {
     goto _err;
   }
 
+  code = pthread_mutex_init(&(pRepo->compactInfo.mutex), NULL);
+  if (code != 0) {
+    terrno = TAOS_SYSTEM_ERROR(code);
+    goto _err;
+  }
+
   code = tsem_init(&(pRepo->readyToCommit), 0, 1);
   if (code != 0) {
     code = errno;
@@ -651,6 +660,9 @@ static STsdbRepo *tsdbNewRepo(char *rootDir, STsdbAppH *pAppH, STsdbCfg *pCfg) {
   }
 
   pRepo->repoLocked = false;
+  pRepo->compactState = TSDB_COMPACT_IDLE;
+  pRepo->compactStop = 0;
+  pRepo->compactInfo.fid = -1;
 
   pRepo->rootDir = strdup(rootDir);
   if (pRepo->rootDir == NULL) {
@@ -679,6 +691,16 @@ static STsdbRepo *tsdbNewRepo(char *rootDir, STsdbAppH *pAppH, STsdbCfg *pCfg) {
     goto _err;
   }
 
+  pRepo->rollupInterval = tsdbGetRollupIntervalImpl(pCfg);
+
+  if (tsReadCacheSize > 0) {
+    pRepo->pBlockCache = tsdbNewBlockCache((int64_t)tsReadCacheSize * 1024 * 1024);
+    if (pRepo->pBlockCache == NULL) {
+      tsdbError("vgId:%d failed to create block cache since %s", REPO_ID(pRepo), tstrerror(terrno));
+      goto _err;
+    }
+  }
+
   return pRepo;
 
 _err:
@@ -688,6 +710,7 @@ _err:
 
 static void tsdbFreeRepo(STsdbRepo *pRepo) {
   if (pRepo) {
+    tsdbFreeBlockCache(pRepo->pBlockCache);
     tsdbFreeFileH(pRepo->tsdbFileH);
     tsdbFreeBufPool(pRepo->pPool);
     tsdbFreeMeta(pRepo->tsdbMeta);
@@ -695,6 +718,7 @@ static void tsdbFreeRepo(STsdbRepo *pRepo) {
     // tsdbFreeMemTable(pRepo->imem);
     tfree(pRepo->rootDir);
     tsem_destroy(&(pRepo->readyToCommit));
+    pthread_mutex_destroy(&(pRepo->compactInfo.mutex));
     pthread_mutex_destroy(&pRepo->mutex);
     free(pRepo);
   }
@@ -726,7 +750,7 @@ static int tsdbRestoreInfo(STsdbRepo *pRepo) { // TODO
       TSKEY lastKey = tsdbGetTableLastKeyImpl(pTable);
       if (pIdx->offset > 0 && lastKey < pIdx->maxKey) {
         pTable->lastKey = pIdx->maxKey;
-        if (pCfg->cacheLastRow) { // load the block of data
+        if (CACHE_LAST_ROW(pCfg)) { // load the block of data
           if (tsdbLoadCompInfo(&rhelper, NULL) < 0) goto _err;
 
           pBlock = rhelper.pCompInfo->blocks + pIdx->numOfBlocks - 1;
@@ -760,6 +784,132 @@ _err:
   return -1;
 }
 
+/*
+ * Load the last non-null value of each column from data files, which is done on the first query of the table after the
+ * repository is opened. Rows written since then have updated the cache already, so a value from files only replaces a
+ * cached one with an earlier key.
+ */
+int tsdbRestoreLastColumns(STsdbRepo *pRepo, STable *pTable) {
+  STsdbFileH *   pFileH = pRepo->tsdbFileH;
+  SFileGroup *   pFGroup = NULL;
+  SFileGroupIter iter;
+  SRWHelper      rhelper = {0};
+  int16_t        colIds[TSDB_MAX_COLUMNS] = {0};
+  bool           settled[TSDB_MAX_COLUMNS] = {0};
+
+  // Two queries may restore the same table at the same time, which does no harm as a value from files never replaces
+  // a later one. The flag is only set once all values are in place.
+  TSDB_RLOCK_TABLE(pTable);
+  bool restored = pTable->lastColsRestored;
+  TSDB_RUNLOCK_TABLE(pTable);
+  if (restored) return 0;
+
+  STSchema *pSchema = tsdbGetTableSchema(pTable);
+  int       numOfCols = schemaNCols(pSchema);
+  int       numOfSettled = 1;
+
+  TSDB_WLOCK_TABLE(pTable);
+  int code = tsdbAllocLastColumns(pTable, pSchema);
+  TSDB_WUNLOCK_TABLE(pTable);
+  if (code < 0) return -1;
+
+  if (tsdbInitReadHelper(&rhelper, pRepo) < 0) return -1;
+
+  pthread_rwlock_rdlock(&(pFileH->fhlock));
+  tsdbInitFileGroupIter(pFileH, &iter, TSDB_ORDER_DESC);
+  pthread_rwlock_unlock(&(pFileH->fhlock));
+
+  while (numOfSettled < numOfCols) {
+    pthread_rwlock_rdlock(&(pFileH->fhlock));
+    pFGroup = tsdbGetFileGroupNext(&iter);
+    if (pFGroup == NULL) {
+      pthread_rwlock_unlock(&(pFileH->fhlock));
+      break;
+    }
+
+    if (pFGroup->state) {
+      pthread_rwlock_unlock(&(pFileH->fhlock));
+      continue;
+    }
+
+    if (tsdbSetAndOpenHelperFile(&rhelper, pFGroup) < 0) {
+      pthread_rwlock_unlock(&(pFileH->fhlock));
+      goto _err;
+    }
+    pthread_rwlock_unlock(&(pFileH->fhlock));
+
+    if (tsdbLoadCompIdx(&rhelper, NULL) < 0) goto _err;
+    if (tsdbSetHelperTable(&rhelper, pTable, pRepo) < 0) goto _err;
+
+    SCompIdx *pIdx = &(rhelper.curCompIdx);
+    if (pIdx->offset <= 0 || pIdx->numOfBlocks <= 0) continue;
+    if (tsdbLoadCompInfo(&rhelper, NULL) < 0) goto _err;
+
+    for (int iblock = pIdx->numOfBlocks - 1; iblock >= 0 && numOfSettled < numOfCols; iblock--) {
+      SCompBlock *pBlock = rhelper.pCompInfo->blocks + iblock;
+
+      // only the columns not settled yet are loaded
+      int numOfColIds = 0;
+      colIds[numOfColIds++] = PRIMARYKEY_TIMESTAMP_COL_INDEX;
+      for (int j = 1; j < numOfCols; j++) {
+        if (!settled[j]) colIds[numOfColIds++] = schemaColAt(pSchema, j)->colId;
+      }
+
+      if (tsdbLoadBlockDataCols(&rhelper, pBlock, NULL, colIds, numOfColIds) < 0) goto _err;
+      SDataCols *pDataCols = rhelper.pDataCols[0];
+
+      for (int j = 1; j < numOfCols; j++) {
+        if (settled[j]) continue;
+
+        STColumn *pCol = schemaColAt(pSchema, j);
+        SDataCol *pDataCol = NULL;
+        for (int k = 0; k < pDataCols->numOfCols; k++) {
+          if (pDataCols->cols[k].colId == pCol->colId) {
+            pDataCol = pDataCols->cols + k;
+            break;
+          }
+        }
+
+        if (pDataCol == NULL || pDataCol->len <= 0) continue;
+
+        TSDB_WLOCK_TABLE(pTable);
+        SLastCol *pLastCol = tsdbGetLastColumn(pTable, pCol->colId);
+        for (int row = pDataCols->numOfRows - 1; row >= 0; row--) {
+          TSKEY key = dataColsKeyAt(pDataCols, row);
+          if (key <= pLastCol->ts) {
+            settled[j] = true;
+            break;
+          }
+
+          void *value = tdGetColDataOfRow(pDataCol, row);
+          if (isNull(value, pCol->type)) continue;
+
+          code = tsdbSetLastColumnValue(pLastCol, pCol, key, value);
+          settled[j] = true;
+          break;
+        }
+        TSDB_WUNLOCK_TABLE(pTable);
+
+        if (code < 0) goto _err;
+        if (settled[j]) numOfSettled++;
+      }
+    }
+  }
+
+  TSDB_WLOCK_TABLE(pTable);
+  pTable->lastColsRestored = true;
+  TSDB_WUNLOCK_TABLE(pTable);
+
+  tsdbDestroyHelper(&rhelper);
+  tsdbDebug("vgId:%d last values of %d columns of table %s are restored from files", REPO_ID(pRepo), numOfSettled,
+            TABLE_CHAR_NAME(pTable));
+  return 0;
+
+_err:
+  tsdbDestroyHelper(&rhelper);
+  return -1;
+}
+
 static void tsdbAlterCompression(STsdbRepo *pRepo, int8_t compression) {
   int8_t ocompression = pRepo->config.compression;
   pRepo->config.compression = compression;
@@ -18,6 +18,7 @@
 
 #define TSDB_DATA_SKIPLIST_LEVEL 5
 #define TSDB_MAX_INSERT_BATCH 512
+#define TSDB_MIN_COL_CHUNK_ROWS 64
 
 static SMemTable * tsdbNewMemTable(STsdbRepo *pRepo);
 static void        tsdbFreeMemTable(SMemTable *pMemTable);
@@ -36,7 +37,14 @@ static int          tsdbGetSubmitMsgNext(SSubmitMsgIter *pIter, SSubmitBlk **pPB
 static int          tsdbCheckTableSchema(STsdbRepo *pRepo, SSubmitBlk *pBlock, STable *pTable);
 static int          tsdbInsertDataToTableImpl(STsdbRepo *pRepo, STable *pTable, void **rows, int rowCounter);
 static void         tsdbFreeRows(STsdbRepo *pRepo, void **rows, int rowCounter);
-static int          tsdbUpdateTableLatestInfo(STsdbRepo *pRepo, STable *pTable, SDataRow row);
+static SMemColChunk *tsdbNewColChunk(STSchema *pSchema, int maxRows);
+static void          tsdbFreeColChunks(SMemColChunk *pChunk);
+static void          tsdbAppendRowsToColChunks(STsdbRepo *pRepo, STable *pTable, STableData *pTableData, void **rows,
+                                               int rowCounter);
+static bool          tsdbIsSameColsLayout(SDataCols *pCols1, SDataCols *pCols2);
+static void          tsdbAppendColChunkToCols(SDataCols *pSrc, int start, int nRows, SDataCols *pCols);
+static int          tsdbUpdateTableLatestInfo(STsdbRepo *pRepo, STable *pTable, void **rows, int rowCounter);
+static int          tsdbUpdateLastColumns(STable *pTable, void **rows, int rowCounter);
 
 static FORCE_INLINE int tsdbCheckRowRange(STsdbRepo *pRepo, STable *pTable, SDataRow row, TSKEY minKey, TSKEY maxKey,
                                           TSKEY now);
@@ -361,6 +369,93 @@ int tsdbLoadDataFromCache(STable *pTable, SSkipListIterator *pIter, TSKEY maxKey
   return 0;
 }
 
+/**
+ * Same as tsdbLoadDataFromCache without filter keys, but copies the rows column by column from the column chunks of
+ * the table instead of converting them row by row. Return -1 if the rows at the iterator are not served by the
+ * column chunks, and the caller should go on with tsdbLoadDataFromCache.
+ */
+int tsdbLoadColDataFromCache(SCommitIter *pCommitIter, TSKEY maxKey, int maxRowsToRead, SDataCols *pCols,
+                             SMergeInfo *pMergeInfo) {
+  STableData *pTableData = pCommitIter->pTableData;
+  int         pos = 0;
+
+  if (pCols == NULL || pTableData == NULL || !atomic_load_8(&(pTableData->colActive))) return -1;
+
+  TSKEY key = tsdbNextIterKey(pCommitIter->pIter);
+  if (key == TSDB_DATA_TIMESTAMP_NULL || key > maxKey) return -1;
+
+  SMemColChunk *pChunk = tsdbSearchColChunk(pTableData, key, &pos);
+  if (pChunk == NULL || !tsdbIsSameColsLayout(pChunk->pCols, pCols)) return -1;
+
+  memset(pMergeInfo, 0, sizeof(*pMergeInfo));
+  tdResetDataCols(pCols);
+
+  int maxRows = MIN(maxRowsToRead, pCols->maxPoints);
+  while (pChunk != NULL && pCols->numOfRows < maxRows) {
+    int numOfRows = atomic_load_32(&(pChunk->numOfRows));
+    int end = tsdbColChunkUpperBound(pChunk, pos, numOfRows, maxKey);
+    int nRows = MIN(end - pos, maxRows - pCols->numOfRows);
+    if (nRows <= 0) break;
+
+    tsdbAppendColChunkToCols(pChunk->pCols, pos, nRows, pCols);
+    if (pos + nRows < numOfRows) break;
+
+    pChunk = atomic_load_ptr(&(pChunk->next));
+    pos = 0;
+  }
+
+  pMergeInfo->rowsInserted = pCols->numOfRows;
+  pMergeInfo->nOperations = pCols->numOfRows;
+  pMergeInfo->keyFirst = dataColsKeyFirst(pCols);
+  pMergeInfo->keyLast = dataColsKeyLast(pCols);
+
+  tsdbMoveIterAfterKey(pCommitIter->pIter, pMergeInfo->keyLast);
+  return 0;
+}
+
+// Return the column chunk and the position in it of the row with the given key, or NULL if the row is not there.
+SMemColChunk *tsdbSearchColChunk(STableData *pTableData, TSKEY key, int *pos) {
+  SMemColChunk *pChunk = atomic_load_ptr(&(pTableData->pColHead));
+
+  for (; pChunk != NULL; pChunk = atomic_load_ptr(&(pChunk->next))) {
+    int numOfRows = atomic_load_32(&(pChunk->numOfRows));
+    if (numOfRows <= 0 || dataColsKeyAt(pChunk->pCols, numOfRows - 1) < key) continue;
+
+    int lo = 0, hi = numOfRows - 1;
+    while (lo <= hi) {
+      int   mid = (lo + hi) / 2;
+      TSKEY mkey = dataColsKeyAt(pChunk->pCols, mid);
+      if (mkey == key) {
+        *pos = mid;
+        return pChunk;
+      } else if (mkey < key) {
+        lo = mid + 1;
+      } else {
+        hi = mid - 1;
+      }
+    }
+
+    return NULL;
+  }
+
+  return NULL;
+}
+
+// Return the position of the first row in [start, numOfRows) of the chunk with key larger than maxKey
+int tsdbColChunkUpperBound(SMemColChunk *pChunk, int start, int numOfRows, TSKEY maxKey) {
+  int lo = start, hi = numOfRows;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (dataColsKeyAt(pChunk->pCols, mid) <= maxKey) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
 // ---------------- LOCAL FUNCTIONS ----------------
 static SMemTable* tsdbNewMemTable(STsdbRepo *pRepo) {
   STsdbMeta *pMeta = pRepo->tsdbMeta;
@@ -427,10 +522,13 @@ static STableData *tsdbNewTableData(STsdbCfg *pCfg, STable *pTable) {
   pTableData->keyFirst = INT64_MAX;
   pTableData->keyLast = 0;
   pTableData->numOfRows = 0;
+  pTableData->colActive = tsColumnarCache;
+  pTableData->sversion = -1;
 
   pTableData->pData =
       tSkipListCreate(TSDB_DATA_SKIPLIST_LEVEL, TSDB_DATA_TYPE_TIMESTAMP, TYPE_BYTES[TSDB_DATA_TYPE_TIMESTAMP],
-                      tkeyComparFn, pCfg->update ? SL_UPDATE_DUP_KEY : SL_DISCARD_DUP_KEY, tsdbGetTsTupleKey);
+                      tkeyComparFn, (pCfg->update ? SL_UPDATE_DUP_KEY : SL_DISCARD_DUP_KEY) | SL_ARENA_NODE,
+                      tsdbGetTsTupleKey);
   if (pTableData->pData == NULL) {
     terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
     goto _err;
@@ -446,6 +544,7 @@ _err:
 static void tsdbFreeTableData(STableData *pTableData) {
   if (pTableData) {
     tSkipListDestroy(pTableData->pData);
+    tsdbFreeColChunks(pTableData->pColHead);
     free(pTableData);
   }
 }
@@ -848,8 +947,10 @@ static int tsdbInsertDataToTableImpl(STsdbRepo *pRepo, STable *pTable, void **ro
   if (pTableData->keyLast < dataRowKey(rows[rowCounter - 1])) pTableData->keyLast = dataRowKey(rows[rowCounter - 1]);
   pTableData->numOfRows += dsize;
 
+  if (pTableData->colActive) tsdbAppendRowsToColChunks(pRepo, pTable, pTableData, rows, rowCounter);
+
   // update table latest info
-  if (tsdbUpdateTableLatestInfo(pRepo, pTable, rows[rowCounter - 1]) < 0) {
+  if (tsdbUpdateTableLatestInfo(pRepo, pTable, rows, rowCounter) < 0) {
     return -1;
   }
 
@@ -895,11 +996,16 @@ static void tsdbFreeRows(STsdbRepo *pRepo, void **rows, int rowCounter) {
   }
 }
 
-static int tsdbUpdateTableLatestInfo(STsdbRepo *pRepo, STable *pTable, SDataRow row) {
+static int tsdbUpdateTableLatestInfo(STsdbRepo *pRepo, STable *pTable, void **rows, int rowCounter) {
   STsdbCfg *pCfg = &pRepo->config;
+  SDataRow  row = rows[rowCounter - 1];
+
+  if (CACHE_LAST_NULL_COLUMN(pCfg) && tsdbUpdateLastColumns(pTable, rows, rowCounter) < 0) {
+    return -1;
+  }
 
   if (tsdbGetTableLastKeyImpl(pTable) < dataRowKey(row)) {
-    if (pCfg->cacheLastRow || pTable->lastRow != NULL) {
+    if (CACHE_LAST_ROW(pCfg) || pTable->lastRow != NULL) {
       SDataRow nrow = pTable->lastRow;
       if (taosTSizeof(nrow) < dataRowLen(row)) {
         SDataRow orow = nrow;
@@ -928,3 +1034,158 @@ static int tsdbUpdateTableLatestInfo(STsdbRepo *pRepo, STable *pTable, SDataRow
 
   return 0;
 }
+
+// The rows are in ascending order of key, so each column is settled by the latest row with a non-null value of it,
+// or by the first row that is not later than the cached value.
+static int tsdbUpdateLastColumns(STable *pTable, void **rows, int rowCounter) {
+  STSchema *pSchema = tsdbGetTableSchemaByVersion(pTable, dataRowVersion(rows[rowCounter - 1]));
+  int       numOfCols = schemaNCols(pSchema);
+  int       numOfSettled = 1;  // the primary timestamp column is tracked by lastKey
+  bool      settled[TSDB_MAX_COLUMNS] = {0};
+  int       code = 0;
+
+  TSDB_WLOCK_TABLE(pTable);
+  if (tsdbAllocLastColumns(pTable, pSchema) < 0) {
+    TSDB_WUNLOCK_TABLE(pTable);
+    return -1;
+  }
+
+  for (int i = rowCounter - 1; i >= 0 && numOfSettled < numOfCols && code == 0; i--) {
+    SDataRow row = rows[i];
+    TSKEY    key = dataRowKey(row);
+
+    for (int j = 1; j < numOfCols; j++) {
+      if (settled[j]) continue;
+
+      STColumn *pCol = schemaColAt(pSchema, j);
+      SLastCol *pLastCol = tsdbGetLastColumn(pTable, pCol->colId);
+      if (key <= pLastCol->ts) {
+        settled[j] = true;
+        numOfSettled++;
+        continue;
+      }
+
+      void *value = tdGetRowDataOfCol(row, pCol->type, TD_DATA_ROW_HEAD_SIZE + pCol->offset);
+      if (isNull(value, pCol->type)) continue;
+
+      if ((code = tsdbSetLastColumnValue(pLastCol, pCol, key, value)) < 0) break;
+      settled[j] = true;
+      numOfSettled++;
+    }
+  }
+  TSDB_WUNLOCK_TABLE(pTable);
+
+  return code;
+}
+
+static SMemColChunk *tsdbNewColChunk(STSchema *pSchema, int maxRows) {
+  SMemColChunk *pChunk = (SMemColChunk *)calloc(1, sizeof(*pChunk));
+  if (pChunk == NULL) return NULL;
+
+  pChunk->pCols = tdNewDataCols(schemaTLen(pSchema), schemaNCols(pSchema), maxRows);
+  if (pChunk->pCols == NULL || tdInitDataCols(pChunk->pCols, pSchema) < 0) {
+    tdFreeDataCols(pChunk->pCols);
+    free(pChunk);
+    return NULL;
+  }
+  pChunk->pCols->sversion = schemaVersion(pSchema);
+
+  return pChunk;
+}
+
+static void tsdbFreeColChunks(SMemColChunk *pChunk) {
+  while (pChunk) {
+    SMemColChunk *pNext = pChunk->next;
+    tdFreeDataCols(pChunk->pCols);
+    free(pChunk);
+    pChunk = pNext;
+  }
+}
+
+/**
+ * Append the rows just inserted into the skiplist to the column chunks of the table. The chunks only hold rows of a
+ * single schema version in strictly increasing key order, so they have exactly the same rows as the skiplist. Once a
+ * row breaks this, the table stops using the chunks until the memtable is committed. The chunks are kept alive until
+ * the table data is freed, as readers may still be copying from them.
+ */
+static void tsdbAppendRowsToColChunks(STsdbRepo *pRepo, STable *pTable, STableData *pTableData, void **rows,
+                                      int rowCounter) {
+  STsdbCfg *    pCfg = &(pRepo->config);
+  STSchema *    pSchema = NULL;
+  SMemColChunk *pChunk = pTableData->pColTail;
+  TSKEY         lastKey = (pChunk == NULL) ? TSKEY_INITIAL_VAL : dataColsKeyLast(pChunk->pCols);
+
+  for (int i = 0; i < rowCounter; i++) {
+    SDataRow row = (SDataRow)rows[i];
+
+    if (dataRowDeleted(row) || dataRowKey(row) <= lastKey ||
+        (pTableData->sversion >= 0 && dataRowVersion(row) != pTableData->sversion)) {
+      goto _fallback;
+    }
+
+    if (pSchema == NULL) {
+      pSchema = tsdbGetTableSchemaImpl(pTable, false, false, dataRowVersion(row));
+      if (pSchema == NULL) goto _fallback;
+      pTableData->sversion = dataRowVersion(row);
+    }
+
+    if (pChunk == NULL || pChunk->pCols->numOfRows >= pChunk->pCols->maxPoints) {
+      int maxRows = (pChunk == NULL) ? TSDB_MIN_COL_CHUNK_ROWS : pChunk->pCols->maxPoints * 2;
+      maxRows = MIN(maxRows, pCfg->maxRowsPerFileBlock);
+
+      SMemColChunk *pNew = tsdbNewColChunk(pSchema, maxRows);
+      if (pNew == NULL) goto _fallback;
+
+      if (pChunk == NULL) {
+        atomic_store_ptr(&(pTableData->pColHead), pNew);
+      } else {
+        atomic_store_ptr(&(pChunk->next), pNew);
+      }
+      pTableData->pColTail = pChunk = pNew;
+    }
+
+    tdAppendDataRowToDataCol(row, pSchema, pChunk->pCols);
+    atomic_store_32(&(pChunk->numOfRows), pChunk->pCols->numOfRows);
+    lastKey = dataRowKey(row);
+  }
+
+  return;
+
+_fallback:
+  atomic_store_8(&(pTableData->colActive), 0);
+  tsdbDebug("vgId:%d table %s tid %d stops keeping rows in column chunks, %" PRId64 " rows in skiplist", REPO_ID(pRepo),
+            TABLE_CHAR_NAME(pTable), TABLE_TID(pTable), pTableData->numOfRows);
+}
+
+static bool tsdbIsSameColsLayout(SDataCols *pCols1, SDataCols *pCols2) {
+  if (pCols1->numOfCols != pCols2->numOfCols) return false;
+
+  for (int i = 0; i < pCols1->numOfCols; i++) {
+    SDataCol *pCol1 = pCols1->cols + i;
+    SDataCol *pCol2 = pCols2->cols + i;
+    if (pCol1->colId != pCol2->colId || pCol1->type != pCol2->type || pCol1->bytes != pCol2->bytes) return false;
+  }
+
+  return true;
+}
+
+static void tsdbAppendColChunkToCols(SDataCols *pSrc, int start, int nRows, SDataCols *pCols) {
+  ASSERT(pCols->numOfRows + nRows <= pCols->maxPoints);
+
+  for (int i = 0; i < pCols->numOfCols; i++) {
+    SDataCol *pSrcCol = pSrc->cols + i;
+    SDataCol *pDstCol = pCols->cols + i;
+
+    if (IS_VAR_DATA_TYPE(pDstCol->type)) {
+      for (int j = 0; j < nRows; j++) {
+        dataColAppendVal(pDstCol, tdGetColDataOfRow(pSrcCol, start + j), pCols->numOfRows + j, pCols->maxPoints);
+      }
+    } else {
+      memcpy(POINTER_SHIFT(pDstCol->pData, pDstCol->len), POINTER_SHIFT(pSrcCol->pData, pSrcCol->bytes * start),
+             pSrcCol->bytes * nRows);
+      pDstCol->len += pSrcCol->bytes * nRows;
+    }
+  }
+
+  pCols->numOfRows += nRows;
+}
@@ -51,6 +51,7 @@ static void *  tsdbInsertTableAct(STsdbRepo *pRepo, int8_t act, void *buf, STabl
 static int     tsdbRemoveTableFromStore(STsdbRepo *pRepo, STable *pTable);
 static int     tsdbRmTableFromMeta(STsdbRepo *pRepo, STable *pTable);
 static int     tsdbAdjustMetaTables(STsdbRepo *pRepo, int tid);
+static void    tsdbSetSuperTagSchema(STsdbRepo *pRepo, STable *pSuper, STSchema *pNewSchema);
 
 // ------------------ OUTER FUNCTIONS ------------------
 int tsdbCreateTable(TSDB_REPO_T *repo, STableCfg *pCfg) {
@@ -59,6 +60,7 @@ int tsdbCreateTable(TSDB_REPO_T *repo, STableCfg *pCfg) {
   STable *   super = NULL;
   STable *   table = NULL;
   int        newSuper = 0;
+  int        updateSuper = 0;
   int        tid = pCfg->tableId.tid;
   STable *   pTable = NULL;
 
@@ -101,6 +103,19 @@ int tsdbCreateTable(TSDB_REPO_T *repo, STableCfg *pCfg) {
         terrno = TSDB_CODE_TDB_IVD_CREATE_TABLE_INFO;
         goto _err;
       }
+
+      // tags added to the super table reach the vnode with the next child table created
+      if (pCfg->tagSchema != NULL && schemaVersion(pCfg->tagSchema) > schemaVersion(super->tagSchema)) {
+        STSchema *pNewSchema = tdDupSchema(pCfg->tagSchema);
+        if (pNewSchema == NULL) {
+          terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+          return -1;
+        }
+        tsdbDebug("vgId:%d update tag schema of super table %s from version %d to %d", REPO_ID(pRepo),
+                  TABLE_CHAR_NAME(super), schemaVersion(super->tagSchema), schemaVersion(pNewSchema));
+        tsdbSetSuperTagSchema(pRepo, super, pNewSchema);
+        updateSuper = 1;
+      }
     }
   }
 
@@ -125,7 +140,7 @@ int tsdbCreateTable(TSDB_REPO_T *repo, STableCfg *pCfg) {
   // TODO: refactor duplicate codes
   int   tlen = 0;
   void *pBuf = NULL;
-  if (newSuper) {
+  if (newSuper || updateSuper) {
     tlen = tsdbGetTableEncodeSize(TSDB_UPDATE_META, super);
     pBuf = tsdbAllocBytes(pRepo, tlen);
     if (pBuf == NULL) goto _err;
@@ -377,14 +392,11 @@ int tsdbUpdateTableTagValue(TSDB_REPO_T *repo, SUpdateTableTagValMsg *pMsg) {
 
   // Chage in memory
   if (pNewSchema != NULL) { // change super table tag schema
-    TSDB_WLOCK_TABLE(pTable->pSuper);
-    STSchema *pOldSchema = pTable->pSuper->tagSchema;
-    pTable->pSuper->tagSchema = pNewSchema;
-    tdFreeSchema(pOldSchema);
-    TSDB_WUNLOCK_TABLE(pTable->pSuper);
+    tsdbSetSuperTagSchema(pRepo, pTable->pSuper, pNewSchema);
   }
 
-  bool      isChangeIndexCol = (pMsg->colId == colColId(schemaColAt(pTable->pSuper->tagSchema, 0)));
+  bool isChangeIndexCol = (pMsg->colId == colColId(schemaColAt(pTable->pSuper->tagSchema, 0))) ||
+                          (tsdbGetTagIndex(pTable->pSuper, pMsg->colId) != NULL);
   // STColumn *pCol = bsearch(&(pMsg->colId), pMsg->data, pMsg->numOfTags, sizeof(STColumn), colIdCompar);
   // ASSERT(pCol != NULL);
 
@@ -609,6 +621,83 @@ void tsdbUpdateTableSchema(STsdbRepo *pRepo, STable *pTable, STSchema *pSchema,
   }
 }
 
+// Make sure each normal column of the schema has an entry in lastCols. The table should be write locked.
+int tsdbAllocLastColumns(STable *pTable, STSchema *pSchema) {
+  int numOfCols = schemaNCols(pSchema);
+  int numOfNew = 0;
+
+  for (int i = 1; i < numOfCols; i++) {
+    if (tsdbGetLastColumn(pTable, schemaColAt(pSchema, i)->colId) == NULL) numOfNew++;
+  }
+
+  if (numOfNew == 0) return 0;
+
+  SLastCol *lastCols = (SLastCol *)calloc(pTable->numOfLastCols + numOfNew, sizeof(SLastCol));
+  if (lastCols == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  // both the existing entries and the schema columns are in ascending order of colId
+  int i = 0, j = 1, n = 0;
+  while (i < pTable->numOfLastCols || j < numOfCols) {
+    if (j >= numOfCols || (i < pTable->numOfLastCols && pTable->lastCols[i].colId <= schemaColAt(pSchema, j)->colId)) {
+      if (j < numOfCols && pTable->lastCols[i].colId == schemaColAt(pSchema, j)->colId) j++;
+      lastCols[n++] = pTable->lastCols[i++];
+    } else {
+      lastCols[n].colId = schemaColAt(pSchema, j++)->colId;
+      lastCols[n].ts = TSKEY_INITIAL_VAL;
+      n++;
+    }
+  }
+
+  ASSERT(n == pTable->numOfLastCols + numOfNew);
+  tfree(pTable->lastCols);
+  pTable->lastCols = lastCols;
+  pTable->numOfLastCols = (int16_t)n;
+
+  return 0;
+}
+
+SLastCol *tsdbGetLastColumn(STable *pTable, int16_t colId) {
+  int s = 0, e = pTable->numOfLastCols - 1;
+
+  while (s <= e) {
+    int m = (s + e) / 2;
+    if (pTable->lastCols[m].colId == colId) {
+      return pTable->lastCols + m;
+    } else if (pTable->lastCols[m].colId < colId) {
+      s = m + 1;
+    } else {
+      e = m - 1;
+    }
+  }
+
+  return NULL;
+}
+
+int tsdbSetLastColumnValue(SLastCol *pLastCol, STColumn *pCol, TSKEY key, const void *value) {
+  if (pLastCol->bytes < pCol->bytes) {
+    void *pData = realloc(pLastCol->pData, pCol->bytes);
+    if (pData == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+
+    pLastCol->pData = pData;
+    pLastCol->bytes = pCol->bytes;
+  }
+
+  if (IS_VAR_DATA_TYPE(pCol->type)) {
+    memcpy(pLastCol->pData, value, varDataTLen(value));
+  } else {
+    memcpy(pLastCol->pData, value, pCol->bytes);
+  }
+
+  pLastCol->ts = key;
+  return 0;
+}
+
 // ------------------ LOCAL FUNCTIONS ------------------
 static int tsdbRestoreTable(void *pHandle, void *cont, int contLen) {
   STsdbRepo *pRepo = (STsdbRepo *)pHandle;
@@ -706,6 +795,7 @@ static STable *tsdbCreateTableFromCfg(STableCfg *pCfg, bool isSuper) {
       terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
       goto _err;
     }
+    if (tsdbInitTagIndex(pTable) < 0) goto _err;
   } else {
     pTable->type = pCfg->type;
     tsize = strnlen(pCfg->name, TSDB_TABLE_NAME_LEN - 1);
@@ -769,6 +859,7 @@ static void tsdbFreeTable(STable *pTable) {
 
       if (TABLE_TYPE(pTable) == TSDB_SUPER_TABLE) {
         tdFreeSchema(pTable->tagSchema);
+        tsdbFreeTagIndex(pTable);
       }
     }
 
@@ -776,6 +867,10 @@ static void tsdbFreeTable(STable *pTable) {
 
     tSkipListDestroy(pTable->pIndex);
     taosTZfree(pTable->lastRow);
+    for (int i = 0; i < pTable->numOfLastCols; i++) {
+      tfree(pTable->lastCols[i].pData);
+    }
+    tfree(pTable->lastCols);
     tfree(pTable->sql);
     free(pTable);
   }
@@ -903,6 +998,10 @@ static int tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper
   pTable->pSuper = pSTable;
 
   tSkipListPut(pSTable->pIndex, (void *)pTable);
+  if (tsdbAddTableIntoTagIndex(pSTable, pTable) < 0) {
+    tsdbRemoveTableFromIndex(pMeta, pTable);
+    return -1;
+  }
 
   if (refSuper) T_REF_INC(pSTable);
   return 0;
@@ -933,6 +1032,8 @@ static int tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable) {
   }
 
   taosArrayDestroy(res);
+
+  tsdbRemoveTableFromTagIndex(pSTable, pTable);
   return 0;
 }
 
@@ -1159,7 +1260,7 @@ static void *tsdbDecodeTable(void *buf, STable **pRTable) {
       STColumn *pCol = schemaColAt(pTable->tagSchema, DEFAULT_TAG_INDEX_COLUMN);
       pTable->pIndex = tSkipListCreate(TSDB_SUPER_TABLE_SL_LEVEL, colType(pCol), (uint8_t)(colBytes(pCol)), NULL,
                                        SL_ALLOW_DUP_KEY, getTagIndexKey);
-      if (pTable->pIndex == NULL) {
+      if (pTable->pIndex == NULL || tsdbInitTagIndex(pTable) < 0) {
         terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
         tsdbFreeTable(pTable);
         return NULL;
@@ -1296,3 +1397,19 @@ static int tsdbAdjustMetaTables(STsdbRepo *pRepo, int tid) {
 
   return 0;
 }
+
+static void tsdbSetSuperTagSchema(STsdbRepo *pRepo, STable *pSuper, STSchema *pNewSchema) {
+  TSDB_WLOCK_TABLE(pSuper);
+  STSchema *pOldSchema = pSuper->tagSchema;
+  pSuper->tagSchema = pNewSchema;
+  tdFreeSchema(pOldSchema);
+  TSDB_WUNLOCK_TABLE(pSuper);
+
+  // the indexed tag columns change with the tag schema
+  tsdbWLockRepoMeta(pRepo);
+  if (tsdbInitTagIndex(pSuper) < 0) {
+    tsdbWarn("vgId:%d failed to rebuild tag index of super table %s since %s, tag filter will scan all tables",
+             REPO_ID(pRepo), TABLE_CHAR_NAME(pSuper), tstrerror(terrno));
+  }
+  tsdbUnlockRepoMeta(pRepo);
+}
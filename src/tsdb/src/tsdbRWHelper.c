@@ -28,11 +28,9 @@
 #define TSDB_IS_LAST_BLOCK(pb) ((pb)->last)
 
 static bool tsdbShouldCreateNewLast(SRWHelper *pHelper);
-static int  tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDataCols, SCompBlock *pCompBlock,
-                                 bool isLast, bool isSuperBlock);
 static int  compareKeyBlock(const void *arg1, const void *arg2);
 static int  tsdbAdjustInfoSizeIfNeeded(SRWHelper *pHelper, size_t esize);
-static int  tsdbInsertSuperBlock(SRWHelper *pHelper, SCompBlock *pCompBlock, int blkIdx);
+static void tsdbAddTombBlock(SRWHelper *pHelper, SCompBlock *pSCompBlock);
 static int  tsdbAddSubBlock(SRWHelper *pHelper, SCompBlock *pCompBlock, int blkIdx, SMergeInfo *pMergeInfo);
 static int  tsdbUpdateSuperBlock(SRWHelper *pHelper, SCompBlock *pCompBlock, int blkIdx);
 static void tsdbResetHelperFileImpl(SRWHelper *pHelper);
@@ -51,6 +49,7 @@ static int  tsdbCheckAndDecodeColumnData(SDataCol *pDataCol, char *content, int3
 static int  tsdbLoadBlockDataColsImpl(SRWHelper *pHelper, SCompBlock *pCompBlock, SDataCols *pDataCols, int16_t *colIds,
                                       int numOfColIds);
 static int  tsdbLoadBlockDataImpl(SRWHelper *pHelper, SCompBlock *pCompBlock, SDataCols *pDataCols);
+static int  tsdbLoadCompInfoFromCache(SRWHelper *pHelper, SCompIdx *pIdx);
 static int  tsdbEncodeSCompIdx(void **buf, SCompIdx *pIdx);
 static void *tsdbDecodeSCompIdx(void *buf, SCompIdx *pIdx);
 static int   tsdbProcessAppendCommit(SRWHelper *pHelper, SCommitIter *pCommitIter, SDataCols *pDataCols, TSKEY maxKey);
@@ -64,6 +63,8 @@ static void  tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitI
                                        TSKEY maxKey, int maxRows, int8_t update);
 static bool  tsdbCheckAddSubBlockCond(SRWHelper *pHelper, SCompBlock *pCompBlock, SMergeInfo *pMergeInfo, int maxOps);
 static int   tsdbDeleteSuperBlock(SRWHelper *pHelper, int blkIdx);
+static void  tsdbLoadCommitDataFromCache(SCommitIter *pCommitIter, TSKEY maxKey, int maxRowsToRead, SDataCols *pCols,
+                                         bool keepDup, SMergeInfo *pMergeInfo);
 
 // ---------------------- INTERNAL FUNCTIONS ----------------------
 int tsdbInitReadHelper(SRWHelper *pHelper, STsdbRepo *pRepo) {
@@ -515,8 +516,15 @@ int tsdbLoadCompIdx(SRWHelper *pHelper, void *target) {
       }
 
       // Load SCompIdx binary from file
-      if (tsdbLoadCompIdxImpl(pFile, pFile->info.offset, pFile->info.len, (void *)(pHelper->pBuffer)) < 0) {
-        return -1;
+      SBlockCacheKey key;
+      tsdbInitBlockCacheKey(&key, &(pHelper->files.fGroup), TSDB_FILE_TYPE_HEAD, -1, pFile->info.offset,
+                            TSDB_BLOCK_CACHE_HEAD);
+      if (pHelper->pCache == NULL ||
+          tsdbGetBlockCache(pHelper->pCache, &key, pHelper->pBuffer, pFile->info.len) != pFile->info.len) {
+        if (tsdbLoadCompIdxImpl(pFile, pFile->info.offset, pFile->info.len, (void *)(pHelper->pBuffer)) < 0) {
+          return -1;
+        }
+        if (pHelper->pCache) tsdbPutBlockCache(pHelper->pCache, &key, pHelper->pBuffer, pFile->info.len);
       }
 
       // Decode the SCompIdx part
@@ -573,13 +581,11 @@ int tsdbLoadCompInfo(SRWHelper *pHelper, void *target) {
 
   SCompIdx *pIdx = &(pHelper->curCompIdx);
 
-  SFile *pFile = helperHeadF(pHelper);
-
   if (!helperHasState(pHelper, TSDB_HELPER_INFO_LOAD)) {
     if (pIdx->offset > 0) {
       ASSERT(pIdx->uid == pHelper->tableInfo.uid);
 
-      if (tsdbLoadCompInfoImpl(pFile, pIdx, &(pHelper->pCompInfo)) < 0) return -1;
+      if (tsdbLoadCompInfoFromCache(pHelper, pIdx) < 0) return -1;
 
       ASSERT(pIdx->uid == pHelper->pCompInfo->uid && pIdx->tid == pHelper->pCompInfo->tid);
     }
@@ -594,13 +600,8 @@ int tsdbLoadCompInfo(SRWHelper *pHelper, void *target) {
 
 int tsdbLoadCompData(SRWHelper *pHelper, SCompBlock *pCompBlock, void *target) {
   ASSERT(pCompBlock->numOfSubBlocks <= 1);
-  SFile *pFile = (pCompBlock->last) ? helperLastF(pHelper) : helperDataF(pHelper);
-
-  if (lseek(pFile->fd, (off_t)pCompBlock->offset, SEEK_SET) < 0) {
-    tsdbError("vgId:%d failed to lseek file %s since %s", REPO_ID(pHelper->pRepo), pFile->fname, strerror(errno));
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    return -1;
-  }
+  int    type = (pCompBlock->last) ? TSDB_FILE_TYPE_LAST : TSDB_FILE_TYPE_DATA;
+  SFile *pFile = &(pHelper->files.fGroup.files[type]);
 
   size_t tsize = TSDB_GET_COMPCOL_LEN(pCompBlock->numOfCols);
   pHelper->pCompData = taosTRealloc((void *)pHelper->pCompData, tsize);
@@ -609,6 +610,21 @@ int tsdbLoadCompData(SRWHelper *pHelper, SCompBlock *pCompBlock, void *target) {
     return -1;
   }
 
+  SBlockCacheKey key;
+  tsdbInitBlockCacheKey(&key, &(pHelper->files.fGroup), type, pHelper->tableInfo.tid, pCompBlock->offset,
+                        TSDB_BLOCK_CACHE_HEAD);
+  if (pHelper->pCache != NULL &&
+      tsdbGetBlockCache(pHelper->pCache, &key, pHelper->pCompData, (int32_t)tsize) == (int32_t)tsize) {
+    if (target) memcpy(target, pHelper->pCompData, tsize);
+    return 0;
+  }
+
+  if (lseek(pFile->fd, (off_t)pCompBlock->offset, SEEK_SET) < 0) {
+    tsdbError("vgId:%d failed to lseek file %s since %s", REPO_ID(pHelper->pRepo), pFile->fname, strerror(errno));
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
   if (taosRead(pFile->fd, (void *)pHelper->pCompData, tsize) < tsize) {
     tsdbError("vgId:%d failed to read %" PRIzu " bytes from file %s since %s", REPO_ID(pHelper->pRepo), tsize, pFile->fname,
               strerror(errno));
@@ -625,6 +641,7 @@ int tsdbLoadCompData(SRWHelper *pHelper, SCompBlock *pCompBlock, void *target) {
 
   ASSERT(pCompBlock->numOfCols == pHelper->pCompData->numOfCols);
 
+  if (pHelper->pCache) tsdbPutBlockCache(pHelper->pCache, &key, pHelper->pCompData, (int32_t)tsize);
   if (target) memcpy(target, pHelper->pCompData, tsize);
 
   return 0;
@@ -720,12 +737,13 @@ static bool tsdbShouldCreateNewLast(SRWHelper *pHelper) {
   return false;
 }
 
-static int tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDataCols, SCompBlock *pCompBlock,
-                                bool isLast, bool isSuperBlock) {
+int tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDataCols, SCompBlock *pCompBlock, bool isLast,
+                         bool isSuperBlock) {
   STsdbCfg * pCfg = &(pHelper->pRepo->config);
   SCompData *pCompData = (SCompData *)(pHelper->pBuffer);
   int64_t    offset = 0;
   int        rowsToWrite = pDataCols->numOfRows;
+  int8_t     compression = tsdbGetFGroupCompression(pHelper->pRepo, pHelper->files.fGroup.fileId);
 
   ASSERT(rowsToWrite > 0 && rowsToWrite <= pCfg->maxRowsPerFileBlock);
   ASSERT(isLast ? rowsToWrite < pCfg->minRowsPerFileBlock : true);
@@ -779,8 +797,8 @@ static int tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDa
     int32_t flen = 0;  // final length
     int32_t tlen = dataColGetNEleLen(pDataCol, rowsToWrite);
 
-    if (pCfg->compression) {
-      if (pCfg->compression == TWO_STAGE_COMP) {
+    if (compression) {
+      if (COMP_STAGE(compression) == TWO_STAGE_COMP) {
         pHelper->compBuffer = taosTRealloc(pHelper->compBuffer, tlen + COMP_OVERFLOW_BYTES);
         if (pHelper->compBuffer == NULL) {
           terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
@@ -789,7 +807,7 @@ static int tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDa
       }
 
       flen = (*(tDataTypes[pDataCol->type].compFunc))((char *)pDataCol->pData, tlen, rowsToWrite, tptr,
-                                                         (int32_t)taosTSizeof(pHelper->pBuffer) - lsize, pCfg->compression,
+                                                         (int32_t)taosTSizeof(pHelper->pBuffer) - lsize, compression,
                                                          pHelper->compBuffer, (int32_t)taosTSizeof(pHelper->compBuffer));
     } else {
       flen = tlen;
@@ -834,7 +852,7 @@ static int tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDa
   // Update pCompBlock membership vairables
   pCompBlock->last = isLast;
   pCompBlock->offset = offset;
-  pCompBlock->algorithm = pCfg->compression;
+  pCompBlock->algorithm = compression;
   pCompBlock->numOfRows = rowsToWrite;
   pCompBlock->len = lsize;
   pCompBlock->keyLen = keyLen;
@@ -850,6 +868,11 @@ static int tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDa
             pCompBlock->keyLast);
 
   pFile->info.size += pCompBlock->len;
+  if (isSuperBlock) {
+    pFile->info.totalBlocks++;
+  } else {
+    pFile->info.totalSubBlocks++;
+  }
   // ASSERT(pFile->info.size == lseek(pFile->fd, 0, SEEK_CUR));
 
   return 0;
@@ -881,7 +904,7 @@ static int tsdbAdjustInfoSizeIfNeeded(SRWHelper *pHelper, size_t esize) {
   return 0;
 }
 
-static int tsdbInsertSuperBlock(SRWHelper *pHelper, SCompBlock *pCompBlock, int blkIdx) {
+int tsdbInsertSuperBlock(SRWHelper *pHelper, SCompBlock *pCompBlock, int blkIdx) {
   SCompIdx *pIdx = &(pHelper->curCompIdx);
 
   ASSERT(blkIdx >= 0 && blkIdx <= (int)pIdx->numOfBlocks);
@@ -1023,6 +1046,8 @@ static int tsdbUpdateSuperBlock(SRWHelper *pHelper, SCompBlock *pCompBlock, int
 
   ASSERT(pSCompBlock->numOfSubBlocks >= 1);
 
+  tsdbAddTombBlock(pHelper, pSCompBlock);
+
   // Delete the sub blocks it has
   if (pSCompBlock->numOfSubBlocks > 1) {
     size_t tsize = (size_t)(pIdx->len - (pSCompBlock->offset + pSCompBlock->len));
@@ -1061,6 +1086,8 @@ static int tsdbDeleteSuperBlock(SRWHelper *pHelper, int blkIdx) {
   SCompBlock  compBlock = *pCompBlock;
   ASSERT(pCompBlock->numOfSubBlocks > 0 && pCompBlock->numOfSubBlocks <= TSDB_MAX_SUBBLOCKS);
 
+  tsdbAddTombBlock(pHelper, pCompBlock);
+
   if (pCompIdx->numOfBlocks == 1) {
     memset(pCompIdx, 0, sizeof(*pCompIdx));
   } else {
@@ -1091,6 +1118,31 @@ static int tsdbDeleteSuperBlock(SRWHelper *pHelper, int blkIdx) {
   return 0;
 }
 
+// Account the file space taken by a super block (and its sub-blocks) which is about to be replaced as unused, so the
+// compaction engine can tell how fragmented a file group is.
+static void tsdbAddTombBlock(SRWHelper *pHelper, SCompBlock *pSCompBlock) {
+  SCompBlock *pBlock = pSCompBlock;
+  int         nBlocks = 1;
+
+  if (pSCompBlock->numOfSubBlocks > 1) {
+    pBlock = (SCompBlock *)POINTER_SHIFT(pHelper->pCompInfo, pSCompBlock->offset);
+    nBlocks = pSCompBlock->numOfSubBlocks;
+  }
+
+  for (int i = 0; i < nBlocks; i++, pBlock++) {
+    // The old .last file is dropped as a whole if a new one is created
+    if (pBlock->last && TSDB_NLAST_FILE_OPENED(pHelper)) continue;
+
+    SFile *pFile = pBlock->last ? helperLastF(pHelper) : helperDataF(pHelper);
+    pFile->info.tombSize += pBlock->len;
+    if (i == 0) {
+      if (pFile->info.totalBlocks > 0) pFile->info.totalBlocks--;
+    } else {
+      if (pFile->info.totalSubBlocks > 0) pFile->info.totalSubBlocks--;
+    }
+  }
+}
+
 static void tsdbResetHelperFileImpl(SRWHelper *pHelper) {
   pHelper->idxH.numOfIdx = 0;
   pHelper->idxH.curIdx = 0;
@@ -1234,6 +1286,21 @@ static int tsdbCheckAndDecodeColumnData(SDataCol *pDataCol, char *content, int32
 static int tsdbLoadColData(SRWHelper *pHelper, SFile *pFile, SCompBlock *pCompBlock, SCompCol *pCompCol,
                            SDataCol *pDataCol) {
   ASSERT(pDataCol->colId == pCompCol->colId);
+
+  SBlockCacheKey key;
+  tsdbInitBlockCacheKey(&key, &(pHelper->files.fGroup), (pCompBlock->last) ? TSDB_FILE_TYPE_LAST : TSDB_FILE_TYPE_DATA,
+                        pHelper->tableInfo.tid, pCompBlock->offset, pCompCol->colId);
+  if (pHelper->pCache != NULL) {
+    int32_t len = tsdbGetBlockCache(pHelper->pCache, &key, pDataCol->pData, pDataCol->spaceSize);
+    if (len >= 0) {
+      pDataCol->len = len;
+      if (pDataCol->type == TSDB_DATA_TYPE_BINARY || pDataCol->type == TSDB_DATA_TYPE_NCHAR) {
+        dataColSetOffset(pDataCol, pCompBlock->numOfRows);
+      }
+      return 0;
+    }
+  }
+
   int tsize = pDataCol->bytes * pCompBlock->numOfRows + COMP_OVERFLOW_BYTES;
   pHelper->pBuffer = taosTRealloc(pHelper->pBuffer, pCompCol->len);
   if (pHelper->pBuffer == NULL) {
@@ -1269,6 +1336,28 @@ static int tsdbLoadColData(SRWHelper *pHelper, SFile *pFile, SCompBlock *pCompBl
     return -1;
   }
 
+  if (pHelper->pCache) tsdbPutBlockCache(pHelper->pCache, &key, pDataCol->pData, pDataCol->len);
+
+  return 0;
+}
+
+static int tsdbLoadCompInfoFromCache(SRWHelper *pHelper, SCompIdx *pIdx) {
+  if (pHelper->pCache == NULL) return tsdbLoadCompInfoImpl(helperHeadF(pHelper), pIdx, &(pHelper->pCompInfo));
+
+  pHelper->pCompInfo = taosTRealloc((void *)pHelper->pCompInfo, pIdx->len);
+  if (pHelper->pCompInfo == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  SBlockCacheKey key;
+  tsdbInitBlockCacheKey(&key, &(pHelper->files.fGroup), TSDB_FILE_TYPE_HEAD, pIdx->tid, pIdx->offset,
+                        TSDB_BLOCK_CACHE_HEAD);
+  if (tsdbGetBlockCache(pHelper->pCache, &key, pHelper->pCompInfo, pIdx->len) == pIdx->len) return 0;
+
+  if (tsdbLoadCompInfoImpl(helperHeadF(pHelper), pIdx, &(pHelper->pCompInfo)) < 0) return -1;
+  tsdbPutBlockCache(pHelper->pCache, &key, pHelper->pCompInfo, pIdx->len);
+
   return 0;
 }
 
@@ -1413,7 +1502,7 @@ static int tsdbLoadBlockDataImpl(SRWHelper *pHelper, SCompBlock *pCompBlock, SDa
     }
 
     if (tcolId == pDataCol->colId) {
-      if (pCompBlock->algorithm == TWO_STAGE_COMP) {
+      if (COMP_STAGE(pCompBlock->algorithm) == TWO_STAGE_COMP) {
         int zsize = pDataCol->bytes * pCompBlock->numOfRows + COMP_OVERFLOW_BYTES;
         if (pDataCol->type == TSDB_DATA_TYPE_BINARY || pDataCol->type == TSDB_DATA_TYPE_NCHAR) {
           zsize += (sizeof(VarDataLenT) * pCompBlock->numOfRows);
@@ -1482,9 +1571,15 @@ static void *tsdbDecodeSCompIdx(void *buf, SCompIdx *pIdx) {
   return buf;
 }
 
+static void tsdbLoadCommitDataFromCache(SCommitIter *pCommitIter, TSKEY maxKey, int maxRowsToRead, SDataCols *pCols,
+                                        bool keepDup, SMergeInfo *pMergeInfo) {
+  if (tsdbLoadColDataFromCache(pCommitIter, maxKey, maxRowsToRead, pCols, pMergeInfo) == 0) return;
+  tsdbLoadDataFromCache(pCommitIter->pTable, pCommitIter->pIter, maxKey, maxRowsToRead, pCols, NULL, 0, keepDup,
+                        pMergeInfo);
+}
+
 static int tsdbProcessAppendCommit(SRWHelper *pHelper, SCommitIter *pCommitIter, SDataCols *pDataCols, TSKEY maxKey) {
   STsdbCfg *  pCfg = &(pHelper->pRepo->config);
-  STable *    pTable = pCommitIter->pTable;
   SCompIdx *  pIdx = &(pHelper->curCompIdx);
   TSKEY       keyFirst = tsdbNextIterKey(pCommitIter->pIter);
   int         defaultRowsInBlock = pCfg->maxRowsPerFileBlock * 4 / 5;
@@ -1497,8 +1592,8 @@ static int tsdbProcessAppendCommit(SRWHelper *pHelper, SCommitIter *pCommitIter,
     ASSERT(pIdx->len > 0);
     SCompBlock *pCompBlock = blockAtIdx(pHelper, pIdx->numOfBlocks - 1);
     ASSERT(pCompBlock->last && pCompBlock->numOfRows < pCfg->minRowsPerFileBlock);
-    tsdbLoadDataFromCache(pTable, pCommitIter->pIter, maxKey, defaultRowsInBlock - pCompBlock->numOfRows, pDataCols,
-                          NULL, 0, pCfg->update, pMergeInfo);
+    tsdbLoadCommitDataFromCache(pCommitIter, maxKey, defaultRowsInBlock - pCompBlock->numOfRows, pDataCols,
+                                pCfg->update, pMergeInfo);
 
     ASSERT(pMergeInfo->rowsInserted == pMergeInfo->nOperations && pMergeInfo->nOperations == pDataCols->numOfRows);
 
@@ -1526,7 +1621,7 @@ static int tsdbProcessAppendCommit(SRWHelper *pHelper, SCommitIter *pCommitIter,
     }
   } else {
     ASSERT(!pHelper->hasOldLastBlock);
-    tsdbLoadDataFromCache(pTable, pCommitIter->pIter, maxKey, defaultRowsInBlock, pDataCols, NULL, 0, pCfg->update, pMergeInfo);
+    tsdbLoadCommitDataFromCache(pCommitIter, maxKey, defaultRowsInBlock, pDataCols, pCfg->update, pMergeInfo);
     ASSERT(pMergeInfo->rowsInserted == pMergeInfo->nOperations && pMergeInfo->nOperations == pDataCols->numOfRows);
 
     if (pDataCols->numOfRows > 0) {
@@ -1571,8 +1666,8 @@ static int tsdbProcessMergeCommit(SRWHelper *pHelper, SCommitIter *pCommitIter,
 
   if ((!TSDB_IS_LAST_BLOCK(&oBlock)) && keyFirst < pCompBlock->keyFirst) {
     while (true) {
-      tsdbLoadDataFromCache(pTable, pCommitIter->pIter, oBlock.keyFirst-1, defaultRowsInBlock, pDataCols, NULL, 0,
-                            pCfg->update, pMergeInfo);
+      tsdbLoadCommitDataFromCache(pCommitIter, oBlock.keyFirst - 1, defaultRowsInBlock, pDataCols, pCfg->update,
+                                  pMergeInfo);
       ASSERT(pMergeInfo->rowsInserted == pMergeInfo->nOperations && pMergeInfo->nOperations == pDataCols->numOfRows);
       if (pDataCols->numOfRows == 0) break;
 
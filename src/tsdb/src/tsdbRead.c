@@ -76,6 +76,8 @@ typedef struct STableCheckInfo {
   bool          initBuf;        // whether to initialize the in-memory skip list iterator or not
   SSkipListIterator* iter;      // mem buffer skip list iterator
   SSkipListIterator* iiter;     // imem buffer skip list iterator
+  STableData*        pMemData;  // table data in mem buffer
+  STableData*        pIMemData; // table data in imem buffer
 } STableCheckInfo;
 
 typedef struct STableBlockInfo {
@@ -83,6 +85,13 @@ typedef struct STableBlockInfo {
   STableCheckInfo*   pTableCheckInfo;
 } STableBlockInfo;
 
+// a rollup record of a time bucket, returned as a data block with statistics only
+typedef struct SRollupBlockInfo {
+  STableCheckInfo* pTableCheckInfo;
+  SRollupInfo*     pRollupInfo;
+  SRollupRecord*   pRecord;
+} SRollupBlockInfo;
+
 typedef struct SBlockOrderSupporter {
   int32_t             numOfTables;
   STableBlockInfo**   pDataBlockInfo;
@@ -94,6 +103,7 @@ typedef struct SIOCostSummary {
   int64_t blockLoadTime;
   int64_t statisInfoLoadTime;
   int64_t checkForNextTime;
+  int32_t skipBlocks;  // file blocks skipped by the column filters without being loaded
 } SIOCostSummary;
 
 typedef struct STsdbQueryHandle {
@@ -111,13 +121,20 @@ typedef struct STsdbQueryHandle {
   int32_t        activeIndex;
   bool           checkFiles;       // check file stage
   bool           cachelastrow;     // check if last row cached
+  bool           cachelastcols;    // the last non-null value of each column is read from the table cache
   bool           loadExternalRow;  // load time window external data rows
+  bool           filterBlocks;     // skip the file blocks whose statistics can not satisfy the column filters
+  bool           rollup;           // the file groups inside the query window may be read from their rollups
+  bool           rollupBlocks;     // the blocks of current file group are the rollup records
   void*          qinfo;            // query info handle, for debug purpose
   int32_t        type;             // query type: retrieve all data blocks, 2. retrieve only last row, 3. retrieve direct prev|next rows
   SFileGroup*    pFileGroup;
   SFileGroupIter fileIter;
   SRWHelper      rhelper;
   STableBlockInfo* pDataBlockInfo;
+  SRollupBlockInfo* pRollupBlocks;  // rollup records of current file group in key order
+  SRollupInfo**  pRollupInfo;      // rollups of each table in current file group, NULL if the table has none
+  SLastCol*      pLastCols;        // cached last values of each table taken by the check, the last key leads each table
 
   SDataCols     *pDataCols;        // in order to hold current file data block
   int32_t        allocSize;        // allocated data block size
@@ -140,11 +157,14 @@ typedef struct STableGroupSupporter {
 static STimeWindow updateLastrowForEachGroup(STableGroupInfo *groupList);
 static int32_t checkForCachedLastRow(STsdbQueryHandle* pQueryHandle, STableGroupInfo *groupList);
 static int32_t tsdbGetCachedLastRow(STable* pTable, SDataRow* pRes, TSKEY* lastKey);
+static int32_t checkForCachedLastColumns(STsdbQueryHandle* pQueryHandle);
+static bool    loadCachedLastColumns(STsdbQueryHandle* pQueryHandle);
 
 static void    changeQueryHandleForInterpQuery(TsdbQueryHandleT pHandle);
 static void    doMergeTwoLevelData(STsdbQueryHandle* pQueryHandle, STableCheckInfo* pCheckInfo, SCompBlock* pBlock);
 static int32_t binarySearchForKey(char* pValue, int num, TSKEY key, int order);
 static int32_t tsdbReadRowsFromCache(STableCheckInfo* pCheckInfo, TSKEY maxKey, int maxRowsToRead, STimeWindow* win, STsdbQueryHandle* pQueryHandle);
+static int32_t tsdbReadColRowsFromCache(STableCheckInfo* pCheckInfo, TSKEY maxKey, int maxRowsToRead, STimeWindow* win, STsdbQueryHandle* pQueryHandle);
 static int32_t tsdbCheckInfoCompar(const void* key1, const void* key2);
 static int32_t doGetExternalRow(STsdbQueryHandle* pQueryHandle, int16_t type, SMemRef* pMemRef);
 static void*   doFreeColumnInfoData(SArray* pColumnInfoData);
@@ -328,11 +348,14 @@ static STsdbQueryHandle* tsdbQueryTablesImpl(TSDB_REPO_T* tsdb, STsdbQueryCond*
   pQueryHandle->locateStart = false;
   pQueryHandle->pMemRef     = pMemRef;
   pQueryHandle->loadExternalRow = pCond->loadExternalRows;
+  pQueryHandle->rollup      = pCond->rollup && ASCENDING_TRAVERSE(pCond->order);
 
   if (tsdbInitReadHelper(&pQueryHandle->rhelper, (STsdbRepo*) tsdb) != 0) {
     goto out_of_memory;
   }
 
+  pQueryHandle->rhelper.pCache = ((STsdbRepo*) tsdb)->pBlockCache;
+
   tsdbMayTakeMemSnapshot(pQueryHandle);
   assert(pCond != NULL && pCond->numOfCols > 0 && pMemRef != NULL);
 
@@ -363,6 +386,10 @@ static STsdbQueryHandle* tsdbQueryTablesImpl(TSDB_REPO_T* tsdb, STsdbQueryCond*
     }
     taosArrayPush(pQueryHandle->pColumns, &colInfo);
     pQueryHandle->statis[i].colId = colInfo.info.colId;
+
+    if (colInfo.info.numOfFilters > 0) {
+      pQueryHandle->filterBlocks = true;
+    }
   }
 
   pQueryHandle->defaultLoadColumn = getDefaultLoadColumns(pQueryHandle, true);
@@ -426,6 +453,22 @@ TsdbQueryHandleT tsdbQueryLastRow(TSDB_REPO_T *tsdb, STsdbQueryCond *pCond, STab
   return pQueryHandle;
 }
 
+TsdbQueryHandleT tsdbQueryCacheLast(TSDB_REPO_T *tsdb, STsdbQueryCond *pCond, STableGroupInfo *groupList, void* qinfo, SMemRef* pMemRef) {
+  STsdbQueryHandle *pQueryHandle = (STsdbQueryHandle*) tsdbQueryTables(tsdb, pCond, groupList, qinfo, pMemRef);
+  if (pQueryHandle == NULL) {
+    return NULL;
+  }
+
+  int32_t code = checkForCachedLastColumns(pQueryHandle);
+  if (code != TSDB_CODE_SUCCESS) {
+    tsdbCleanupQueryHandle(pQueryHandle);
+    terrno = code;
+    return NULL;
+  }
+
+  return pQueryHandle;
+}
+
 SArray* tsdbGetQueriedTableList(TsdbQueryHandleT *pHandle) {
   assert(pHandle != NULL);
 
@@ -479,6 +522,7 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
   if (pMemT && pCheckInfo->tableId.tid < pMemT->maxTables) {
     pMem = pMemT->tData[pCheckInfo->tableId.tid];
     if (pMem != NULL && pMem->uid == pCheckInfo->tableId.uid) { // check uid
+      pCheckInfo->pMemData = pMem;
       pCheckInfo->iter =
           tSkipListCreateIterFromVal(pMem->pData, (const char*)&pCheckInfo->lastKey, TSDB_DATA_TYPE_TIMESTAMP, order);
     }
@@ -487,6 +531,7 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
   if (pIMemT && pCheckInfo->tableId.tid < pIMemT->maxTables) {
     pIMem = pIMemT->tData[pCheckInfo->tableId.tid];
     if (pIMem != NULL && pIMem->uid == pCheckInfo->tableId.uid) { // check uid
+      pCheckInfo->pIMemData = pIMem;
       pCheckInfo->iiter =
           tSkipListCreateIterFromVal(pIMem->pData, (const char*)&pCheckInfo->lastKey, TSDB_DATA_TYPE_TIMESTAMP, order);
     }
@@ -965,10 +1010,186 @@ static int32_t handleDataMergeIfNeeded(STsdbQueryHandle* pQueryHandle, SCompBloc
   return code;
 }
 
+static int32_t tsdbLoadBlockStatis(STsdbQueryHandle* pHandle, SCompBlock* pBlock) {
+  int64_t stime = taosGetTimestampUs();
+  int32_t code = tsdbLoadCompData(&pHandle->rhelper, pBlock, NULL);
+
+  int16_t* colIds = pHandle->defaultLoadColumn->pData;
+
+  size_t numOfCols = QH_GET_NUM_OF_COLS(pHandle);
+  memset(pHandle->statis, 0, numOfCols * sizeof(SDataStatis));
+  for(int32_t i = 0; i < numOfCols; ++i) {
+    pHandle->statis[i].colId = colIds[i];
+  }
+
+  tsdbGetDataStatis(&pHandle->rhelper, pHandle->statis, (int)numOfCols);
+
+  // always load the first primary timestamp column data
+  SDataStatis* pPrimaryColStatis = &pHandle->statis[0];
+  assert(pPrimaryColStatis->colId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
+
+  pPrimaryColStatis->numOfNull = 0;
+  pPrimaryColStatis->min = pBlock->keyFirst;
+  pPrimaryColStatis->max = pBlock->keyLast;
+
+  //update the number of NULL data rows
+  for(int32_t i = 1; i < numOfCols; ++i) {
+    if (pHandle->statis[i].numOfNull == -1) { // set the column data are all NULL
+      pHandle->statis[i].numOfNull = pBlock->numOfRows;
+    }
+
+    SColumnInfo* pColInfo = taosArrayGet(pHandle->pColumns, i);
+    if (pColInfo->type == TSDB_DATA_TYPE_TIMESTAMP) {
+      pHandle->statis[i].min = pBlock->keyFirst;
+      pHandle->statis[i].max = pBlock->keyLast;
+    }
+  }
+
+  int64_t elapsed = taosGetTimestampUs() - stime;
+  pHandle->cost.statisInfoLoadTime += elapsed;
+
+  return code;
+}
+
+static void loadRollupBlockStatis(STsdbQueryHandle* pHandle, SRollupBlockInfo* pBlock) {
+  SRollupInfo*   pInfo = pBlock->pRollupInfo;
+  SRollupRecord* pRecord = pBlock->pRecord;
+  int16_t*       colIds = pHandle->defaultLoadColumn->pData;
+
+  size_t numOfCols = QH_GET_NUM_OF_COLS(pHandle);
+  memset(pHandle->statis, 0, numOfCols * sizeof(SDataStatis));
+
+  SDataStatis* pPrimaryColStatis = &pHandle->statis[0];
+  assert(colIds[0] == PRIMARYKEY_TIMESTAMP_COL_INDEX);
+
+  pPrimaryColStatis->colId = colIds[0];
+  pPrimaryColStatis->min = pRecord->keyFirst;
+  pPrimaryColStatis->max = pRecord->keyLast;
+
+  for (int32_t i = 1; i < numOfCols; ++i) {
+    SDataStatis* pStatis = &pHandle->statis[i];
+    pStatis->colId = colIds[i];
+    pStatis->numOfNull = pRecord->numOfRows;  // the column added after the rollups are written is all NULL
+
+    for (int32_t j = 0; j < pInfo->numOfCols; ++j) {
+      if (pInfo->colIds[j] == colIds[i]) {
+        pStatis->numOfNull = pRecord->cols[j].numOfNull;
+        pStatis->sum = pRecord->cols[j].sum;
+        pStatis->min = pRecord->cols[j].min;
+        pStatis->max = pRecord->cols[j].max;
+        break;
+      }
+    }
+  }
+}
+
+/*
+ * Check if any row of a block may satisfy one filter of a column, given the statistics of the column in the block.
+ * The check is conservative: float values are compared with the tolerance of the row filters, see FLT_EQUAL, and the
+ * unsupported operators and types always match.
+ */
+static bool tsdbFilterMayMatch(SColumnFilterInfo* pFilter, int16_t type, SDataStatis* pStatis, int32_t numOfRows) {
+  int16_t lower = pFilter->lowerRelOptr;
+  int16_t upper = pFilter->upperRelOptr;
+
+  if (lower == TSDB_RELATION_ISNULL) return pStatis->numOfNull > 0;
+  if (lower == TSDB_RELATION_NOTNULL) return pStatis->numOfNull < numOfRows;
+
+  // NULL values never satisfy a value filter
+  if (pStatis->numOfNull >= numOfRows) return false;
+
+  if (lower != TSDB_RELATION_INVALID && lower != TSDB_RELATION_GREATER && lower != TSDB_RELATION_GREATER_EQUAL &&
+      lower != TSDB_RELATION_EQUAL) {
+    return true;
+  }
+
+  if ((type >= TSDB_DATA_TYPE_TINYINT && type <= TSDB_DATA_TYPE_BIGINT) || type == TSDB_DATA_TYPE_TIMESTAMP) {
+    int64_t minv = pStatis->min, maxv = pStatis->max;
+
+    if (lower == TSDB_RELATION_GREATER && maxv <= pFilter->lowerBndi) return false;
+    if (lower == TSDB_RELATION_GREATER_EQUAL && maxv < pFilter->lowerBndi) return false;
+    if (lower == TSDB_RELATION_EQUAL && (minv > pFilter->lowerBndi || maxv < pFilter->lowerBndi)) return false;
+    if (upper == TSDB_RELATION_LESS && minv >= pFilter->upperBndi) return false;
+    if (upper == TSDB_RELATION_LESS_EQUAL && minv > pFilter->upperBndi) return false;
+  } else if (type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) {
+    double minv = GET_DOUBLE_VAL(&pStatis->min), maxv = GET_DOUBLE_VAL(&pStatis->max);
+    double tol = FLT_COMPAR_TOL_FACTOR * FLT_EPSILON;
+
+    if (lower != TSDB_RELATION_INVALID && maxv < pFilter->lowerBndd - tol) return false;
+    if (lower == TSDB_RELATION_EQUAL && minv > pFilter->lowerBndd + tol) return false;
+    if (upper != TSDB_RELATION_INVALID && minv > pFilter->upperBndd + tol) return false;
+  }
+
+  return true;
+}
+
+/*
+ * A complete file block is skipped without loading its data if for any column with filters, none of the filters may
+ * be satisfied by the block. The filters of a column are ORed and the columns are ANDed, the same as the row filters
+ * of the query. Blocks with sub-blocks have no statistics, and blocks overlapping the rows in cache are merged with
+ * them, so they are always loaded.
+ */
+static bool tsdbSkipFileDataBlock(STsdbQueryHandle* pQueryHandle, SCompBlock* pBlock, STableCheckInfo* pCheckInfo) {
+  if (!pQueryHandle->filterBlocks || pQueryHandle->type != TSDB_QUERY_TYPE_ALL || pQueryHandle->loadExternalRow ||
+      pBlock->numOfSubBlocks > 1) {
+    return false;
+  }
+
+  STsdbCfg* pCfg = &pQueryHandle->pTsdb->config;
+  initTableMemIterator(pQueryHandle, pCheckInfo);
+  SDataRow row = getSDataRowInTableMem(pCheckInfo, pQueryHandle->order, pCfg->update);
+  if (row != NULL) {
+    TSKEY key = dataRowKey(row);
+    if ((ASCENDING_TRAVERSE(pQueryHandle->order) && key <= pBlock->keyLast) ||
+        (!ASCENDING_TRAVERSE(pQueryHandle->order) && key >= pBlock->keyFirst)) {
+      return false;
+    }
+  }
+
+  if (tsdbLoadBlockStatis(pQueryHandle, pBlock) != TSDB_CODE_SUCCESS) {
+    return false;
+  }
+
+  size_t numOfCols = QH_GET_NUM_OF_COLS(pQueryHandle);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfo* pColInfo = taosArrayGet(pQueryHandle->pColumns, i);
+    if (pColInfo->numOfFilters == 0) {
+      continue;
+    }
+
+    bool match = false;
+    for (int32_t j = 0; j < pColInfo->numOfFilters && !match; ++j) {
+      match = tsdbFilterMayMatch(&pColInfo->filters[j], pColInfo->type, &pQueryHandle->statis[i], pBlock->numOfRows);
+    }
+
+    if (!match) {
+      SQueryFilePos* cur = &pQueryHandle->cur;
+
+      pCheckInfo->lastKey = ASCENDING_TRAVERSE(pQueryHandle->order) ? pBlock->keyLast + 1 : pBlock->keyFirst - 1;
+      cur->lastKey = pCheckInfo->lastKey;
+      cur->mixBlock = false;
+      cur->blockCompleted = true;
+      pQueryHandle->realNumOfRows = 0;
+      pQueryHandle->cost.skipBlocks += 1;
+
+      tsdbDebug("%p skip file block by column filters, index:%d, brange:%" PRId64 "-%" PRId64 ", rows:%d, %p",
+                pQueryHandle, cur->slot, pBlock->keyFirst, pBlock->keyLast, pBlock->numOfRows, pQueryHandle->qinfo);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 static int32_t loadFileDataBlock(STsdbQueryHandle* pQueryHandle, SCompBlock* pBlock, STableCheckInfo* pCheckInfo, bool* exists) {
   SQueryFilePos* cur = &pQueryHandle->cur;
   int32_t code = TSDB_CODE_SUCCESS;
 
+  if (tsdbSkipFileDataBlock(pQueryHandle, pBlock, pCheckInfo)) {
+    *exists = false;
+    return code;
+  }
+
   if (ASCENDING_TRAVERSE(pQueryHandle->order)) {
     // query ended in/started from current block
     if (pQueryHandle->window.ekey < pBlock->keyLast || pCheckInfo->lastKey > pBlock->keyFirst) {
@@ -1423,8 +1644,8 @@ static void doMergeTwoLevelData(STsdbQueryHandle* pQueryHandle, STableCheckInfo*
         break;
       }
 
-      if (((pos > endPos || tsArray[pos] > pQueryHandle->window.ekey) && ASCENDING_TRAVERSE(pQueryHandle->order)) ||
-          ((pos < endPos || tsArray[pos] < pQueryHandle->window.ekey) && !ASCENDING_TRAVERSE(pQueryHandle->order))) {
+      if ((ASCENDING_TRAVERSE(pQueryHandle->order) && (pos > endPos || tsArray[pos] > pQueryHandle->window.ekey)) ||
+          (!ASCENDING_TRAVERSE(pQueryHandle->order) && (pos < endPos || tsArray[pos] < pQueryHandle->window.ekey))) {
         break;
       }
 
@@ -1750,6 +1971,157 @@ static int32_t createDataBlocksInfo(STsdbQueryHandle* pQueryHandle, int32_t numO
 
 static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exists);
 
+static void cleanupRollupBlocks(STsdbQueryHandle* pQueryHandle) {
+  if (pQueryHandle->pRollupInfo != NULL) {
+    size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+    for (int32_t i = 0; i < numOfTables; ++i) {
+      tfree(pQueryHandle->pRollupInfo[i]);
+    }
+  }
+
+  tfree(pQueryHandle->pRollupBlocks);
+  pQueryHandle->rollupBlocks = false;
+}
+
+/*
+ * The rollups of a file group can replace its data blocks only if all rows of the file group are in the query time
+ * window, and no table has rows in buffer that precede or fall into the file group.
+ */
+static bool isFileGroupRollupQualified(STsdbQueryHandle* pQueryHandle, STimeWindow* win) {
+  if (!pQueryHandle->rollup || pQueryHandle->type != TSDB_QUERY_TYPE_ALL) {
+    return false;
+  }
+
+  if (win->skey < pQueryHandle->window.skey || win->ekey > pQueryHandle->window.ekey) {
+    return false;
+  }
+
+  SMemTable* pMemT = pQueryHandle->pMemRef->mem;
+  SMemTable* pIMemT = pQueryHandle->pMemRef->imem;
+
+  size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+    if (pCheckInfo->lastKey > win->skey) {
+      return false;
+    }
+
+    int32_t tid = pCheckInfo->tableId.tid;
+    if (pMemT != NULL && tid < pMemT->maxTables) {
+      STableData* pMem = pMemT->tData[tid];
+      if (pMem != NULL && pMem->uid == pCheckInfo->tableId.uid && pMem->keyFirst <= win->ekey) {
+        return false;
+      }
+    }
+
+    if (pIMemT != NULL && tid < pIMemT->maxTables) {
+      STableData* pIMem = pIMemT->tData[tid];
+      if (pIMem != NULL && pIMem->uid == pCheckInfo->tableId.uid && pIMem->keyFirst <= win->ekey) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static int32_t rollupBlockCompar(const void* p1, const void* p2) {
+  const SRollupBlockInfo* pLeft = (const SRollupBlockInfo*)p1;
+  const SRollupBlockInfo* pRight = (const SRollupBlockInfo*)p2;
+
+  if (pLeft->pRecord->keyFirst != pRight->pRecord->keyFirst) {
+    return (pLeft->pRecord->keyFirst > pRight->pRecord->keyFirst) ? 1 : -1;
+  }
+
+  if (pLeft->pTableCheckInfo->tableId.tid == pRight->pTableCheckInfo->tableId.tid) {
+    return 0;
+  }
+
+  return (pLeft->pTableCheckInfo->tableId.tid > pRight->pTableCheckInfo->tableId.tid) ? 1 : -1;
+}
+
+// Load the rollups of all tables in the file group as the data blocks, return false if they can not be used
+static bool loadRollupBlocks(STsdbQueryHandle* pQueryHandle, SRollupFile* pRFile, STimeWindow* win) {
+  size_t  numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+  int32_t numOfBlocks = 0;
+
+  if (pQueryHandle->pRollupInfo == NULL) {
+    pQueryHandle->pRollupInfo = calloc(numOfTables, POINTER_BYTES);
+    if (pQueryHandle->pRollupInfo == NULL) {
+      return false;
+    }
+  }
+
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+    if (tsdbLoadRollupInfo(pRFile, pCheckInfo->tableId.tid, pCheckInfo->tableId.uid, &pQueryHandle->pRollupInfo[i]) <
+        0) {
+      tsdbError("%p failed to load rollups of uid:%" PRIu64 ", tid:%d, fid:%d since %s, %p", pQueryHandle,
+                pCheckInfo->tableId.uid, pCheckInfo->tableId.tid, pQueryHandle->pFileGroup->fileId, tstrerror(terrno),
+                pQueryHandle->qinfo);
+      cleanupRollupBlocks(pQueryHandle);
+      return false;
+    }
+
+    if (pQueryHandle->pRollupInfo[i] != NULL) {
+      numOfBlocks += pQueryHandle->pRollupInfo[i]->numOfRollups;
+    }
+  }
+
+  if (numOfBlocks > 0) {
+    pQueryHandle->pRollupBlocks = malloc(sizeof(SRollupBlockInfo) * numOfBlocks);
+    if (pQueryHandle->pRollupBlocks == NULL) {
+      cleanupRollupBlocks(pQueryHandle);
+      return false;
+    }
+  }
+
+  int32_t k = 0;
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    SRollupInfo* pInfo = pQueryHandle->pRollupInfo[i];
+    if (pInfo == NULL) {
+      continue;
+    }
+
+    for (int32_t j = 0; j < pInfo->numOfRollups; ++j, ++k) {
+      pQueryHandle->pRollupBlocks[k].pTableCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+      pQueryHandle->pRollupBlocks[k].pRollupInfo = pInfo;
+      pQueryHandle->pRollupBlocks[k].pRecord = TSDB_ROLLUP_AT(pInfo, j);
+    }
+  }
+
+  if (numOfBlocks > 1) {
+    qsort(pQueryHandle->pRollupBlocks, numOfBlocks, sizeof(SRollupBlockInfo), rollupBlockCompar);
+  }
+
+  // all rows of the file group are covered by the rollups
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+    pCheckInfo->lastKey = win->ekey + 1;
+  }
+
+  pQueryHandle->rollupBlocks = true;
+  pQueryHandle->numOfBlocks = numOfBlocks;
+
+  tsdbDebug("%p %d rollups found in file for %" PRIzu " table(s), fid:%d, %p", pQueryHandle, numOfBlocks, numOfTables,
+            pQueryHandle->pFileGroup->fileId, pQueryHandle->qinfo);
+  return true;
+}
+
+static void setCurrentRollupBlock(STsdbQueryHandle* pQueryHandle) {
+  SQueryFilePos* cur = &pQueryHandle->cur;
+  SRollupRecord* pRecord = pQueryHandle->pRollupBlocks[cur->slot].pRecord;
+
+  cur->rows = pRecord->numOfRows;
+  cur->win.skey = pRecord->keyFirst;
+  cur->win.ekey = pRecord->keyLast;
+  cur->lastKey = pRecord->keyLast + 1;
+  cur->mixBlock = false;
+  cur->blockCompleted = true;
+
+  pQueryHandle->realNumOfRows = cur->rows;
+}
+
 static int32_t getDataBlockRv(STsdbQueryHandle* pQueryHandle, STableBlockInfo* pNext, bool *exists) {
   int32_t step = ASCENDING_TRAVERSE(pQueryHandle->order)? 1 : -1;
   SQueryFilePos* cur = &pQueryHandle->cur;
@@ -1777,6 +2149,8 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
   pQueryHandle->numOfBlocks = 0;
   SQueryFilePos* cur = &pQueryHandle->cur;
 
+  cleanupRollupBlocks(pQueryHandle);
+
   int32_t code = TSDB_CODE_SUCCESS;
 
   int32_t numOfBlocks = 0;
@@ -1806,6 +2180,28 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
       break;
     }
 
+    SRollupFile rfile = {.fd = -1};
+    if (isFileGroupRollupQualified(pQueryHandle, &win) &&
+        tsdbOpenRollupFile(pQueryHandle->pTsdb, pQueryHandle->pFileGroup,
+                           pQueryHandle->pFileGroup->files[TSDB_FILE_TYPE_HEAD].info.magic, &rfile) == 0) {
+      pthread_rwlock_unlock(&pQueryHandle->pTsdb->tsdbFileH->fhlock);
+
+      bool loaded = loadRollupBlocks(pQueryHandle, &rfile, &win);
+      tsdbCloseRollupFile(&rfile);
+      if (loaded) {
+        if (pQueryHandle->numOfBlocks > 0) {
+          break;
+        }
+
+        // none of the tables has data in this file group, the next one may be read from its data blocks
+        cleanupRollupBlocks(pQueryHandle);
+        continue;
+      }
+
+      // the rollups are not usable, load the data blocks instead
+      pthread_rwlock_rdlock(&pQueryHandle->pTsdb->tsdbFileH->fhlock);
+    }
+
     if (tsdbSetAndOpenHelperFile(&pQueryHandle->rhelper, pQueryHandle->pFileGroup) < 0) {
       pthread_rwlock_unlock(&pQueryHandle->pTsdb->tsdbFileH->fhlock);
       code = terrno;
@@ -1857,6 +2253,12 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
   cur->slot = ASCENDING_TRAVERSE(pQueryHandle->order)? 0:pQueryHandle->numOfBlocks-1;
   cur->fid = pQueryHandle->pFileGroup->fileId;
 
+  if (pQueryHandle->rollupBlocks) {
+    setCurrentRollupBlock(pQueryHandle);
+    *exists = true;
+    return TSDB_CODE_SUCCESS;
+  }
+
   STableBlockInfo* pBlockInfo = &pQueryHandle->pDataBlockInfo[cur->slot];
   return getDataBlockRv(pQueryHandle, pBlockInfo, exists);
 }
@@ -1893,6 +2295,15 @@ static int32_t getDataBlocksInFiles(STsdbQueryHandle* pQueryHandle, bool* exists
     pthread_rwlock_unlock(&pQueryHandle->pTsdb->tsdbFileH->fhlock);
 
     return getFirstFileDataBlock(pQueryHandle, exists);
+  } else if (pQueryHandle->rollupBlocks) {
+    if (cur->slot == pQueryHandle->numOfBlocks - 1) {
+      return getFirstFileDataBlock(pQueryHandle, exists);
+    }
+
+    cur->slot += 1;
+    setCurrentRollupBlock(pQueryHandle);
+    *exists = true;
+    return TSDB_CODE_SUCCESS;
   } else {
     // check if current file block is all consumed
     STableBlockInfo* pBlockInfo = &pQueryHandle->pDataBlockInfo[cur->slot];
@@ -1989,6 +2400,18 @@ static int tsdbReadRowsFromCache(STableCheckInfo* pCheckInfo, TSKEY maxKey, int
   int64_t st = taosGetTimestampUs();
   STable* pTable = pCheckInfo->pTableObj;
 
+  if (ASCENDING_TRAVERSE(pQueryHandle->order)) {
+    numOfRows = tsdbReadColRowsFromCache(pCheckInfo, maxKey, maxRowsToRead, win, pQueryHandle);
+    if (numOfRows > 0) {
+      int64_t elapsedTime = taosGetTimestampUs() - st;
+      tsdbDebug("%p build data block from column cache completed, elapsed time:%"PRId64" us, numOfRows:%d, numOfCols:%d, %p",
+                pQueryHandle, elapsedTime, numOfRows, numOfCols, pQueryHandle->qinfo);
+      return numOfRows;
+    }
+
+    numOfRows = 0;
+  }
+
   do {
     SDataRow row = getSDataRowInTableMem(pCheckInfo, pQueryHandle->order, pCfg->update);
     if (row == NULL) {
@@ -2036,6 +2459,133 @@ static int tsdbReadRowsFromCache(STableCheckInfo* pCheckInfo, TSKEY maxKey, int
   return numOfRows;
 }
 
+static bool isColChunkCompatible(STsdbQueryHandle* pQueryHandle, SDataCols* pCols) {
+  int32_t numOfCols = (int32_t)taosArrayGetSize(pQueryHandle->pColumns);
+
+  for (int32_t i = 0, j = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pQueryHandle->pColumns, i);
+    while (j < pCols->numOfCols && pCols->cols[j].colId < pColInfo->info.colId) {
+      j++;
+    }
+
+    if (j >= pCols->numOfCols || pCols->cols[j].colId != pColInfo->info.colId) {
+      continue;
+    }
+
+    SDataCol* pCol = pCols->cols + j;
+    if (pCol->type != pColInfo->info.type || pCol->bytes > pColInfo->info.bytes) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void copyRowsFromColChunk(STsdbQueryHandle* pQueryHandle, SDataCols* pCols, int32_t start, int32_t nRows,
+                                 int32_t numOfRows) {
+  int32_t numOfCols = (int32_t)taosArrayGetSize(pQueryHandle->pColumns);
+
+  for (int32_t i = 0, j = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pQueryHandle->pColumns, i);
+    char*            pData = (char*)pColInfo->pData + numOfRows * pColInfo->info.bytes;
+    int16_t          bytes = pColInfo->info.bytes;
+
+    while (j < pCols->numOfCols && pCols->cols[j].colId < pColInfo->info.colId) {
+      j++;
+    }
+
+    if (j < pCols->numOfCols && pCols->cols[j].colId == pColInfo->info.colId) {
+      SDataCol* pCol = pCols->cols + j;
+      if (IS_VAR_DATA_TYPE(pCol->type)) {
+        for (int32_t k = 0; k < nRows; ++k) {
+          void* value = tdGetColDataOfRow(pCol, start + k);
+          memcpy(pData + k * bytes, value, varDataTLen(value));
+        }
+      } else {
+        memcpy(pData, (char*)pCol->pData + start * pCol->bytes, nRows * pCol->bytes);
+      }
+    } else if (IS_VAR_DATA_TYPE(pColInfo->info.type)) {
+      for (int32_t k = 0; k < nRows; ++k) {
+        setVardataNull(pData + k * bytes, pColInfo->info.type);
+      }
+    } else {
+      setNullN(pData, pColInfo->info.type, bytes, nRows);
+    }
+  }
+}
+
+/*
+ * Copy rows of the table from the column chunks of the buffer, if the table keeps all its buffered rows there and
+ * only one of mem and imem has rows left. Only ascending order is served. Return 0 if nothing is copied, and the
+ * caller should go on reading the skiplist rows.
+ */
+static int32_t tsdbReadColRowsFromCache(STableCheckInfo* pCheckInfo, TSKEY maxKey, int maxRowsToRead, STimeWindow* win,
+                                        STsdbQueryHandle* pQueryHandle) {
+  SDataRow           rmem = tsdbNextIterRow(pCheckInfo->iter);
+  SDataRow           rimem = tsdbNextIterRow(pCheckInfo->iiter);
+  SSkipListIterator* pIter = NULL;
+  STableData*        pTableData = NULL;
+  int32_t            numOfRows = 0;
+  int                pos = 0;
+
+  if (rmem != NULL && rimem == NULL) {
+    pIter = pCheckInfo->iter;
+    pTableData = pCheckInfo->pMemData;
+    pCheckInfo->chosen = 0;
+  } else if (rmem == NULL && rimem != NULL) {
+    pIter = pCheckInfo->iiter;
+    pTableData = pCheckInfo->pIMemData;
+    pCheckInfo->chosen = 1;
+  } else {
+    return 0;
+  }
+
+  if (pTableData == NULL || !atomic_load_8(&pTableData->colActive)) {
+    return 0;
+  }
+
+  TSKEY key = tsdbNextIterKey(pIter);
+  if (key > maxKey) {
+    return 0;
+  }
+
+  SMemColChunk* pChunk = tsdbSearchColChunk(pTableData, key, &pos);
+  if (pChunk == NULL || !isColChunkCompatible(pQueryHandle, pChunk->pCols)) {
+    return 0;
+  }
+
+  while (pChunk != NULL && numOfRows < maxRowsToRead) {
+    int32_t rows = atomic_load_32(&pChunk->numOfRows);
+    int32_t end = tsdbColChunkUpperBound(pChunk, pos, rows, maxKey);
+    int32_t nRows = MIN(end - pos, maxRowsToRead - numOfRows);
+    if (nRows <= 0) {
+      break;
+    }
+
+    if (numOfRows == 0) {
+      win->skey = dataColsKeyAt(pChunk->pCols, pos);
+    }
+
+    copyRowsFromColChunk(pQueryHandle, pChunk->pCols, pos, nRows, numOfRows);
+    numOfRows += nRows;
+    win->ekey = dataColsKeyAt(pChunk->pCols, pos + nRows - 1);
+
+    if (pos + nRows < rows) {
+      break;
+    }
+
+    // all chunks of a table have the same schema
+    pChunk = atomic_load_ptr(&pChunk->next);
+    pos = 0;
+  }
+
+  if (numOfRows > 0) {
+    tsdbMoveIterAfterKey(pIter, win->ekey);
+  }
+
+  return numOfRows;
+}
+
 static int32_t getAllTableList(STable* pSuperTable, SArray* list) {
   SSkipListIterator* iter = tSkipListCreateIter(pSuperTable->pIndex);
   while (tSkipListIterNext(iter)) {
@@ -2074,6 +2624,10 @@ bool tsdbNextDataBlock(TsdbQueryHandleT* pHandle) {
   size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
   assert(numOfTables > 0);
 
+  if (pQueryHandle->cachelastcols) {
+    return loadCachedLastColumns(pQueryHandle);
+  }
+
   if (pQueryHandle->type == TSDB_QUERY_TYPE_LAST && pQueryHandle->cachelastrow) {
     // the last row is cached in buffer, return it directly.
     // here note that the pQueryHandle->window must be the TS_INITIALIZER
@@ -2148,6 +2702,10 @@ bool tsdbNextDataBlockWithoutMerge(TsdbQueryHandleT* pHandle) {
   size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
   assert(numOfTables > 0);
 
+  if (pQueryHandle->cachelastcols) {
+    return loadCachedLastColumns(pQueryHandle);
+  }
+
   if (pQueryHandle->type == TSDB_QUERY_TYPE_LAST && pQueryHandle->cachelastrow) {
     // the last row is cached in buffer, return it directly.
     // here note that the pQueryHandle->window must be the TS_INITIALIZER
@@ -2368,6 +2926,180 @@ int32_t checkForCachedLastRow(STsdbQueryHandle* pQueryHandle, STableGroupInfo *g
   return code;
 }
 
+/*
+ * The last values of the columns are served by the cache only if none of the tables has data after the query time
+ * window, otherwise the cached values may be later than the last ones in the time window. The values are copied under
+ * the table latch together with the check, so a write after it can not replace them with ones out of the window.
+ */
+int32_t checkForCachedLastColumns(STsdbQueryHandle* pQueryHandle) {
+  STsdbRepo* pRepo = pQueryHandle->pTsdb;
+  TSKEY      ekey = MAX(pQueryHandle->window.skey, pQueryHandle->window.ekey);
+  int32_t    numOfCols = (int32_t)QH_GET_NUM_OF_COLS(pQueryHandle);
+
+  pQueryHandle->cachelastcols = false;
+  if (!CACHE_LAST_NULL_COLUMN(&pRepo->config) || numOfCols >= pQueryHandle->outputCapacity) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+    if (pCheckInfo->pTableObj->lastKey > ekey) {
+      return TSDB_CODE_SUCCESS;
+    }
+  }
+
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+    if (tsdbRestoreLastColumns(pRepo, pCheckInfo->pTableObj) < 0) {
+      return terrno;
+    }
+  }
+
+  int32_t rowBytes = 0;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pQueryHandle->pColumns, i);
+    rowBytes += pColInfo->info.bytes;
+  }
+
+  size_t numOfEntries = numOfTables * (numOfCols + 1);
+  pQueryHandle->pLastCols = malloc(numOfEntries * sizeof(SLastCol) + numOfTables * rowBytes);
+  if (pQueryHandle->pLastCols == NULL) {
+    return TSDB_CODE_TDB_OUT_OF_MEMORY;
+  }
+
+  char* pBuf = (char*)(pQueryHandle->pLastCols + numOfEntries);
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+    STable*          pTable = pCheckInfo->pTableObj;
+    SLastCol*        pLastCols = pQueryHandle->pLastCols + i * (numOfCols + 1);
+
+    TSDB_RLOCK_TABLE(pTable);
+    if (pTable->lastKey > ekey) {
+      TSDB_RUNLOCK_TABLE(pTable);
+      tfree(pQueryHandle->pLastCols);
+      return TSDB_CODE_SUCCESS;
+    }
+
+    pLastCols[0] = (SLastCol){.colId = PRIMARYKEY_TIMESTAMP_COL_INDEX, .ts = pTable->lastKey};
+    for (int32_t j = 0; j < numOfCols; ++j) {
+      SColumnInfoData* pColInfo = taosArrayGet(pQueryHandle->pColumns, j);
+      SLastCol*        pCached = tsdbGetLastColumn(pTable, pColInfo->info.colId);
+      SLastCol*        pLastCol = pLastCols + j + 1;
+
+      *pLastCol = (SLastCol){.colId = pColInfo->info.colId, .bytes = pColInfo->info.bytes, .ts = TSKEY_INITIAL_VAL};
+      if (pColInfo->info.colId != PRIMARYKEY_TIMESTAMP_COL_INDEX && pCached != NULL && pCached->pData != NULL) {
+        pLastCol->ts = pCached->ts;
+        pLastCol->pData = pBuf;
+        if (pColInfo->info.type == TSDB_DATA_TYPE_BINARY || pColInfo->info.type == TSDB_DATA_TYPE_NCHAR) {
+          memcpy(pBuf, pCached->pData, varDataTLen(pCached->pData));
+        } else {
+          memcpy(pBuf, pCached->pData, pColInfo->info.bytes);
+        }
+      }
+      pBuf += pColInfo->info.bytes;
+    }
+    TSDB_RUNLOCK_TABLE(pTable);
+  }
+
+  pQueryHandle->cachelastcols = true;
+  pQueryHandle->checkFiles    = false;
+  pQueryHandle->activeIndex   = -1;  // start from -1
+
+  tsdbDebug("%p last values of %" PRIzu " tables are read from cache, %p", pQueryHandle, numOfTables,
+            pQueryHandle->qinfo);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t tsdbKeyCompar(const void* p1, const void* p2) {
+  TSKEY k1 = *(TSKEY*)p1;
+  TSKEY k2 = *(TSKEY*)p2;
+  return (k1 == k2) ? 0 : ((k1 < k2) ? -1 : 1);
+}
+
+/*
+ * Build a data block of one table out of the last values taken by checkForCachedLastColumns. The rows are the distinct
+ * timestamps of the values, each column has its value in the row of its own timestamp and NULL in the others.
+ */
+bool loadCachedLastColumns(STsdbQueryHandle* pQueryHandle) {
+  SQueryFilePos* cur = &pQueryHandle->cur;
+  size_t         numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+  int32_t        numOfCols = (int32_t)QH_GET_NUM_OF_COLS(pQueryHandle);
+  TSKEY          skey = MIN(pQueryHandle->window.skey, pQueryHandle->window.ekey);
+  TSKEY          ekey = MAX(pQueryHandle->window.skey, pQueryHandle->window.ekey);
+  TSKEY          keys[TSDB_MAX_COLUMNS + 1];
+
+  while (++pQueryHandle->activeIndex < numOfTables) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, pQueryHandle->activeIndex);
+    SLastCol*        pLastCols = pQueryHandle->pLastCols + pQueryHandle->activeIndex * (numOfCols + 1);
+    int32_t          numOfRows = 0;
+
+    // the last key of the table leads its values
+    for (int32_t i = 0; i <= numOfCols; ++i) {
+      TSKEY ts = pLastCols[i].ts;
+      if (ts != TSKEY_INITIAL_VAL && ts >= skey && ts <= ekey && (i == 0 || pLastCols[i].pData != NULL)) {
+        keys[numOfRows++] = ts;
+      }
+    }
+
+    if (numOfRows == 0) {
+      continue;
+    }
+
+    qsort(keys, numOfRows, sizeof(TSKEY), tsdbKeyCompar);
+    int32_t n = 1;
+    for (int32_t i = 1; i < numOfRows; ++i) {
+      if (keys[i] != keys[n - 1]) keys[n++] = keys[i];
+    }
+    numOfRows = n;
+
+    for (int32_t i = 0; i < numOfCols; ++i) {
+      SColumnInfoData* pColInfo = taosArrayGet(pQueryHandle->pColumns, i);
+      if (pColInfo->info.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+        memcpy(pColInfo->pData, keys, numOfRows * sizeof(TSKEY));
+        continue;
+      }
+
+      for (int32_t j = 0; j < numOfRows; ++j) {
+        char* pData = (char*)pColInfo->pData + j * pColInfo->info.bytes;
+        if (pColInfo->info.type == TSDB_DATA_TYPE_BINARY || pColInfo->info.type == TSDB_DATA_TYPE_NCHAR) {
+          setVardataNull(pData, pColInfo->info.type);
+        } else {
+          setNull(pData, pColInfo->info.type, pColInfo->info.bytes);
+        }
+      }
+
+      SLastCol* pLastCol = pLastCols + i + 1;
+      if (pLastCol->pData == NULL || pLastCol->ts < skey || pLastCol->ts > ekey) {
+        continue;
+      }
+
+      int32_t pos = binarySearchForKey((char*)keys, numOfRows, pLastCol->ts, TSDB_ORDER_ASC);
+      char*   pData = (char*)pColInfo->pData + pos * pColInfo->info.bytes;
+      if (pColInfo->info.type == TSDB_DATA_TYPE_BINARY || pColInfo->info.type == TSDB_DATA_TYPE_NCHAR) {
+        memcpy(pData, pLastCol->pData, varDataTLen(pLastCol->pData));
+      } else {
+        memcpy(pData, pLastCol->pData, pColInfo->info.bytes);
+      }
+    }
+
+    int32_t step = ASCENDING_TRAVERSE(pQueryHandle->order) ? 1 : -1;
+
+    cur->fid      = -1;
+    cur->rows     = numOfRows;
+    cur->mixBlock = true;
+    cur->win.skey = keys[0];
+    cur->win.ekey = keys[numOfRows - 1];
+    cur->lastKey  = (ASCENDING_TRAVERSE(pQueryHandle->order) ? keys[numOfRows - 1] : keys[0]) + step;
+
+    pCheckInfo->lastKey = cur->lastKey;
+    pQueryHandle->realNumOfRows = numOfRows;
+    return true;
+  }
+
+  return false;
+}
+
 STimeWindow updateLastrowForEachGroup(STableGroupInfo *groupList) {
   STimeWindow window = {INT64_MAX, INT64_MIN};
 
@@ -2445,7 +3177,9 @@ void tsdbRetrieveDataBlockInfo(TsdbQueryHandleT* pQueryHandle, SDataBlockInfo* p
   STable* pTable = NULL;
 
   // there are data in file
-  if (pHandle->cur.fid >= 0) {
+  if (pHandle->cur.fid >= 0 && pHandle->rollupBlocks) {
+    pTable = pHandle->pRollupBlocks[cur->slot].pTableCheckInfo->pTableObj;
+  } else if (pHandle->cur.fid >= 0) {
     STableBlockInfo* pBlockInfo = &pHandle->pDataBlockInfo[cur->slot];
     pTable = pBlockInfo->pTableCheckInfo->pTableObj;
   } else {
@@ -2472,6 +3206,12 @@ int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT* pQueryHandle, SDataSta
     return TSDB_CODE_SUCCESS;
   }
 
+  if (pHandle->rollupBlocks) {
+    loadRollupBlockStatis(pHandle, &pHandle->pRollupBlocks[c->slot]);
+    *pBlockStatis = pHandle->statis;
+    return TSDB_CODE_SUCCESS;
+  }
+
   STableBlockInfo* pBlockInfo = &pHandle->pDataBlockInfo[c->slot];
   assert((c->slot >= 0 && c->slot < pHandle->numOfBlocks) || ((c->slot == pHandle->numOfBlocks) && (c->slot == 0)));
 
@@ -2481,42 +3221,7 @@ int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT* pQueryHandle, SDataSta
     return TSDB_CODE_SUCCESS;
   }
 
-  int64_t stime = taosGetTimestampUs();
-  tsdbLoadCompData(&pHandle->rhelper, pBlockInfo->compBlock, NULL);
-
-  int16_t* colIds = pHandle->defaultLoadColumn->pData;
-
-  size_t numOfCols = QH_GET_NUM_OF_COLS(pHandle);
-  memset(pHandle->statis, 0, numOfCols * sizeof(SDataStatis));
-  for(int32_t i = 0; i < numOfCols; ++i) {
-    pHandle->statis[i].colId = colIds[i];
-  }
-
-  tsdbGetDataStatis(&pHandle->rhelper, pHandle->statis, (int)numOfCols);
-
-  // always load the first primary timestamp column data
-  SDataStatis* pPrimaryColStatis = &pHandle->statis[0];
-  assert(pPrimaryColStatis->colId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
-
-  pPrimaryColStatis->numOfNull = 0;
-  pPrimaryColStatis->min = pBlockInfo->compBlock->keyFirst;
-  pPrimaryColStatis->max = pBlockInfo->compBlock->keyLast;
-
-  //update the number of NULL data rows
-  for(int32_t i = 1; i < numOfCols; ++i) {
-    if (pHandle->statis[i].numOfNull == -1) { // set the column data are all NULL
-      pHandle->statis[i].numOfNull = pBlockInfo->compBlock->numOfRows;
-    }
-
-    SColumnInfo* pColInfo = taosArrayGet(pHandle->pColumns, i);
-    if (pColInfo->type == TSDB_DATA_TYPE_TIMESTAMP) {
-      pHandle->statis[i].min = pBlockInfo->compBlock->keyFirst;
-      pHandle->statis[i].max = pBlockInfo->compBlock->keyLast;
-    }
-  }
-
-  int64_t elapsed = taosGetTimestampUs() - stime;
-  pHandle->cost.statisInfoLoadTime += elapsed;
+  tsdbLoadBlockStatis(pHandle, pBlockInfo->compBlock);
 
   *pBlockStatis = pHandle->statis;
   return TSDB_CODE_SUCCESS;
@@ -2531,6 +3236,9 @@ SArray* tsdbRetrieveDataBlock(TsdbQueryHandleT* pQueryHandle, SArray* pIdList) {
 
   if (pHandle->cur.fid < 0) {
     return pHandle->pColumns;
+  } else if (pHandle->rollupBlocks) {  // the rows are not kept by the rollups
+    terrno = TSDB_CODE_TDB_INVALID_ACTION;
+    return NULL;
   } else {
     STableBlockInfo* pBlockInfo = &pHandle->pDataBlockInfo[pHandle->cur.slot];
     STableCheckInfo* pCheckInfo = pBlockInfo->pTableCheckInfo;
@@ -2806,6 +3514,157 @@ static bool tableFilterFp(const void* pNode, void* param) {
 }
 
 static void getTableListfromSkipList(tExprNode *pExpr, SSkipList *pSkipList, SArray *result, SExprTraverseSupp *param);
+static void queryIndexedColumn(SSkipList* pSkipList, tQueryInfo* pQueryInfo, SArray* result);
+
+static int32_t tablePtrComparFn(const void* p1, const void* p2) {
+  STable* pTable1 = *(STable**) p1;
+  STable* pTable2 = *(STable**) p2;
+
+  return (pTable1 == pTable2)? 0 : ((pTable1 < pTable2)? -1 : 1);
+}
+
+static int32_t tableTidComparFn(const void* p1, const void* p2) {
+  STable* pTable1 = *(STable**) p1;
+  STable* pTable2 = *(STable**) p2;
+
+  return (TABLE_TID(pTable1) == TABLE_TID(pTable2))? 0 : ((TABLE_TID(pTable1) < TABLE_TID(pTable2))? -1 : 1);
+}
+
+// find the tables satisfying the leaf condition by the index on its tag column, return NULL if there is no such index
+static SArray* queryTagIndexByCond(STable* pSTable, tQueryInfo* pInfo) {
+  int32_t optr = pInfo->optr;
+
+  if (pInfo->indexed) {  // the first tag column, indexed by the skiplist
+    if (optr != TSDB_RELATION_EQUAL && optr != TSDB_RELATION_GREATER && optr != TSDB_RELATION_GREATER_EQUAL &&
+        optr != TSDB_RELATION_LESS && optr != TSDB_RELATION_LESS_EQUAL) {
+      return NULL;
+    }
+
+    SArray* pKeyInfo = taosArrayInit(8, sizeof(STableKeyInfo));
+    SArray* pTables = taosArrayInit(8, POINTER_BYTES);
+    queryIndexedColumn(pSTable->pIndex, pInfo, pKeyInfo);
+
+    for (size_t i = 0; i < taosArrayGetSize(pKeyInfo); ++i) {
+      taosArrayPush(pTables, &((STableKeyInfo*) taosArrayGet(pKeyInfo, i))->pTable);
+    }
+
+    taosArrayDestroy(pKeyInfo);
+    return pTables;
+  }
+
+  STagIndex* pIndex = tsdbGetTagIndex(pSTable, pInfo->sch.colId);
+  if (pIndex == NULL) {
+    return NULL;
+  }
+
+  SArray* pTables = taosArrayInit(8, POINTER_BYTES);
+  if (tsdbQueryTagIndex(pIndex, optr, pInfo->q, pTables) < 0) {
+    taosArrayDestroy(pTables);
+    return NULL;
+  }
+
+  return pTables;
+}
+
+// keep the tables of pRes which are also in pTables, both are sorted by table pointer
+static void intersectTableList(SArray* pRes, SArray* pTables) {
+  size_t num = 0;
+  size_t i = 0, j = 0;
+
+  while (i < taosArrayGetSize(pRes) && j < taosArrayGetSize(pTables)) {
+    int32_t ret = tablePtrComparFn(taosArrayGet(pRes, i), taosArrayGet(pTables, j));
+    if (ret < 0) {
+      i++;
+    } else if (ret > 0) {
+      j++;
+    } else {
+      *(STable**) taosArrayGet(pRes, num++) = *(STable**) taosArrayGet(pRes, i);
+      i++;
+      j++;
+    }
+  }
+
+  while (taosArrayGetSize(pRes) > num) {
+    taosArrayPop(pRes);
+  }
+}
+
+// intersect the tables found by the tag indexes for the conditions connected by AND
+static void queryTagIndexByAndConds(STable* pSTable, tExprNode* pExpr, SArray** pRes, SExprTraverseSupp* param) {
+  tExprNode* pLeft  = pExpr->_node.pLeft;
+  tExprNode* pRight = pExpr->_node.pRight;
+
+  if (pLeft->nodeType == TSQL_NODE_EXPR && pRight->nodeType == TSQL_NODE_EXPR) {
+    if (pExpr->_node.optr == TSDB_RELATION_AND) {
+      queryTagIndexByAndConds(pSTable, pLeft, pRes, param);
+      queryTagIndexByAndConds(pSTable, pRight, pRes, param);
+    }
+
+    return;
+  }
+
+  param->setupInfoFn(pExpr, param->pExtInfo);
+
+  tQueryInfo* pInfo = pExpr->_node.info;
+  if (pInfo->sch.colId == TSDB_TBNAME_COLUMN_INDEX) {
+    return;
+  }
+
+  SArray* pTables = queryTagIndexByCond(pSTable, pInfo);
+  if (pTables == NULL) {
+    return;
+  }
+
+  taosArraySort(pTables, tablePtrComparFn);
+  if (*pRes == NULL) {
+    *pRes = pTables;
+  } else {
+    intersectTableList(*pRes, pTables);
+    taosArrayDestroy(pTables);
+  }
+}
+
+// Find the candidate tables by the tag indexes and apply the whole filter expression to them only. Return false if
+// none of the conditions can be served by the indexes.
+static bool queryTableListByTagIndex(STable* pSTable, tExprNode* pExpr, SArray* pRes, SExprTraverseSupp* param) {
+  tExprNode* pLeft  = pExpr->_node.pLeft;
+  tExprNode* pRight = pExpr->_node.pRight;
+
+  // a single condition on the first tag column is served by the skiplist directly
+  if (pLeft->nodeType != TSQL_NODE_EXPR && pRight->nodeType != TSQL_NODE_EXPR) {
+    param->setupInfoFn(pExpr, param->pExtInfo);
+    if (((tQueryInfo*) pExpr->_node.info)->indexed) {
+      return false;
+    }
+  }
+
+  SArray* pTables = NULL;
+  queryTagIndexByAndConds(pSTable, pExpr, &pTables, param);
+  if (pTables == NULL) {
+    return false;
+  }
+
+  taosArraySort(pTables, tableTidComparFn);
+
+  SSkipListNode node = {0};
+  for (size_t i = 0; i < taosArrayGetSize(pTables); ++i) {
+    node.pData = taosArrayGetP(pTables, i);
+    if (i > 0 && node.pData == taosArrayGetP(pTables, i - 1)) {
+      continue;
+    }
+
+    if (exprTreeApplayFilter(pExpr, &node, param)) {
+      STableKeyInfo info = {.pTable = node.pData, .lastKey = TSKEY_INITIAL_VAL};
+      taosArrayPush(pRes, &info);
+    }
+  }
+
+  tsdbDebug("stable uid:%" PRIu64 " %" PRIzu " candidate tables found by tag index, %" PRIzu " qualified",
+            TABLE_UID(pSTable), taosArrayGetSize(pTables), taosArrayGetSize(pRes));
+
+  taosArrayDestroy(pTables);
+  return true;
+}
 
 static int32_t doQueryTableList(STable* pSTable, SArray* pRes, tExprNode* pExpr) {
   // query according to the expression tree
@@ -2815,7 +3674,10 @@ static int32_t doQueryTableList(STable* pSTable, SArray* pRes, tExprNode* pExpr)
       .pExtInfo = pSTable->tagSchema,
       };
 
-  getTableListfromSkipList(pExpr, pSTable->pIndex, pRes, &supp);
+  if (!queryTableListByTagIndex(pSTable, pExpr, pRes, &supp)) {
+    getTableListfromSkipList(pExpr, pSTable->pIndex, pRes, &supp);
+  }
+
   tExprTreeDestroy(pExpr, destroyHelper);
   return TSDB_CODE_SUCCESS;
 }
@@ -3005,6 +3867,11 @@ static void* doFreeColumnInfoData(SArray* pColumnInfoData) {
   return NULL;
 }
 
+int32_t tsdbGetNumOfSkippedBlocks(TsdbQueryHandleT queryHandle) {
+  STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
+  return (pQueryHandle == NULL) ? 0 : pQueryHandle->cost.skipBlocks;
+}
+
 void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
   if (pQueryHandle == NULL) {
@@ -3012,6 +3879,10 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   }
   
   if (pQueryHandle->pTableCheckInfo != NULL) {
+    cleanupRollupBlocks(pQueryHandle);
+    tfree(pQueryHandle->pRollupInfo);
+    tfree(pQueryHandle->pLastCols);
+
     size_t size = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
     for (int32_t i = 0; i < size; ++i) {
       STableCheckInfo* pTableCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
@@ -3040,8 +3911,9 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   pQueryHandle->next = doFreeColumnInfoData(pQueryHandle->next);
 
   SIOCostSummary* pCost = &pQueryHandle->cost;
-  tsdbDebug("%p :io-cost summary: statis-info:%"PRId64" us, datablock:%" PRId64" us, check data:%"PRId64" us, %p",
-      pQueryHandle, pCost->statisInfoLoadTime, pCost->blockLoadTime, pCost->checkForNextTime, pQueryHandle->qinfo);
+  tsdbDebug("%p :io-cost summary: statis-info:%"PRId64" us, datablock:%" PRId64" us, check data:%"PRId64" us, "
+      "skip blocks:%d, %p", pQueryHandle, pCost->statisInfoLoadTime, pCost->blockLoadTime, pCost->checkForNextTime,
+      pCost->skipBlocks, pQueryHandle->qinfo);
 
   tfree(pQueryHandle);
 }
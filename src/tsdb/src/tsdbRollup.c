@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tchecksum.h"
+#include "tsdbMain.h"
+
+static TSKEY tsdbRollupBucket(TSKEY key, int64_t interval);
+static int   tsdbRollupTable(SRWHelper *pHelper, STable *pTable, SRollupInfo *pOld, TSKEY from, SRollupInfo **ppInfo,
+                             int32_t *pSize);
+static int   tsdbReserveRollups(SRollupInfo **ppInfo, int32_t *pSize, int32_t numOfRollups);
+static void  tsdbRollupRows(SRollupRecord *pRecord, SDataCols *pCols, int start, int end);
+static void  tsdbMergeRollupCol(SRollupCol *pRCol, int8_t type, int64_t sum, int64_t min, int64_t max);
+static int   tsdbWriteRollupPart(int fd, char *fname, void *buf, uint32_t len);
+static int   tsdbLoadRollupHead(int fd, STsdbRepo *pRepo, uint32_t headMagic, SRollupHead *pHead);
+static int   compRollupIdx(const void *key, const void *pIdx);
+
+int64_t tsdbGetRollupIntervalImpl(STsdbCfg *pCfg) {
+  if (tsRollupInterval <= 0) return 0;
+
+  int64_t interval = (int64_t)tsRollupInterval * (int64_t)TSDB_TICK_PER_SECOND(pCfg->precision);
+
+  // a time bucket never spans two file groups
+  if ((pCfg->daysPerFile * tsMsPerDay[pCfg->precision]) % interval != 0) {
+    tsdbWarn("vgId:%d rollup interval %d seconds does not divide the file group span, rollup is disabled",
+             pCfg->tsdbId, tsRollupInterval);
+    return 0;
+  }
+
+  return interval;
+}
+
+int64_t tsdbGetRollupInterval(TSDB_REPO_T *repo) { return ((STsdbRepo *)repo)->rollupInterval; }
+
+/*
+ * Rebuild the rollup file of a file group after data is committed to it. The rollups of the time buckets before the
+ * first key committed to a table are kept, the remaining ones are computed again from the data blocks. Without valid
+ * rollups of the previous head file all tables are rolled up from scratch. The rollups are optional, failures only
+ * leave them out of date, which queries detect.
+ */
+void tsdbCommitRollups(STsdbRepo *pRepo, SFileGroup *pGroup, SCommitIter *iters, int nIters, TSKEY *dirtyKeys,
+                       uint32_t oldHeadMagic) {
+  STsdbFileH *pFileH = pRepo->tsdbFileH;
+  SRollupFile rfile = {.fd = -1};
+  SRWHelper   rhelper = {0};
+  SRollupHead head = {0};
+  SRollupIdx *pIdx = NULL;
+  SRollupInfo *pInfo = NULL, *pOld = NULL;
+  int32_t     size = 0;
+  int         nIdx = 0;
+  int         fd = -1;
+  uint32_t    offset = sizeof(SRollupHead);
+  char        fname[TSDB_FILENAME_LEN] = "\0";
+  char        nfname[TSDB_FILENAME_LEN] = "\0";
+  int64_t     stime = taosGetTimestampMs();
+
+  if (pRepo->rollupInterval <= 0) return;
+
+  bool incremental = (tsdbOpenRollupFile(pRepo, pGroup, oldHeadMagic, &rfile) == 0);
+
+  if (tsdbInitReadHelper(&rhelper, pRepo) < 0) goto _err;
+
+  pthread_rwlock_rdlock(&(pFileH->fhlock));
+  head.headMagic = pGroup->files[TSDB_FILE_TYPE_HEAD].info.magic;
+  int code = tsdbSetAndOpenHelperFile(&rhelper, pGroup);
+  pthread_rwlock_unlock(&(pFileH->fhlock));
+  if (code < 0) goto _err;
+
+  if (tsdbLoadCompIdx(&rhelper, NULL) < 0) goto _err;
+
+  pIdx = (SRollupIdx *)malloc(sizeof(SRollupIdx) * nIters + sizeof(TSCKSUM));
+  if (pIdx == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  tsdbGetDataFileName(pRepo->rootDir, REPO_ID(pRepo), pGroup->fileId, TSDB_FILE_TYPE_NSMA, nfname);
+  fd = open(nfname, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0755);
+  if (fd < 0 || lseek(fd, offset, SEEK_SET) < 0) {
+    tsdbError("vgId:%d failed to open file %s since %s", REPO_ID(pRepo), nfname, strerror(errno));
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  for (int tid = 1; tid < nIters; tid++) {
+    STable *pTable = iters[tid].pTable;
+    TSKEY   from = TSKEY_INITIAL_VAL;
+    void *  buf = NULL;
+    uint32_t len = 0;
+
+    if (pTable == NULL) continue;
+
+    tfree(pOld);
+    if (incremental) {
+      if (tsdbLoadRollupInfo(&rfile, tid, TABLE_UID(pTable), &pOld) < 0) goto _err;
+      if (dirtyKeys[tid] == TSKEY_INITIAL_VAL && pOld == NULL) continue;
+      from = dirtyKeys[tid];
+    }
+
+    if (pOld != NULL && from == TSKEY_INITIAL_VAL) {  // nothing committed to the table, the rollups are unchanged
+      buf = pOld;
+      len = TSDB_ROLLUP_INFO_HEAD_SIZE(pOld->numOfCols) + TSDB_ROLLUP_RECORD_SIZE(pOld->numOfCols) * pOld->numOfRollups;
+    } else {
+      TSDB_RLOCK_TABLE(pTable);
+      code = tsdbSetHelperTable(&rhelper, pTable, pRepo);
+      if (code == 0) code = tsdbRollupTable(&rhelper, pTable, pOld, from, &pInfo, &size);
+      TSDB_RUNLOCK_TABLE(pTable);
+      if (code < 0) goto _err;
+
+      if (pInfo->numOfRollups == 0) continue;
+      buf = pInfo;
+      len = TSDB_ROLLUP_INFO_HEAD_SIZE(pInfo->numOfCols) + TSDB_ROLLUP_RECORD_SIZE(pInfo->numOfCols) * pInfo->numOfRollups;
+    }
+
+    len += sizeof(TSCKSUM);
+    taosCalcChecksumAppend(0, (uint8_t *)buf, len);
+    if (tsdbWriteRollupPart(fd, nfname, buf, len) < 0) goto _err;
+
+    pIdx[nIdx].tid = tid;
+    pIdx[nIdx].len = len;
+    pIdx[nIdx].offset = offset;
+    pIdx[nIdx].reserved = 0;
+    pIdx[nIdx].uid = TABLE_UID(pTable);
+    nIdx++;
+    offset += len;
+  }
+
+  uint32_t len = sizeof(SRollupIdx) * nIdx + sizeof(TSCKSUM);
+  taosCalcChecksumAppend(0, (uint8_t *)pIdx, len);
+  if (tsdbWriteRollupPart(fd, nfname, pIdx, len) < 0) goto _err;
+
+  head.magic = TSDB_ROLLUP_MAGIC;
+  head.interval = pRepo->rollupInterval;
+  head.idxOffset = offset;
+  head.numOfTables = nIdx;
+  taosCalcChecksumAppend(0, (uint8_t *)(&head), sizeof(head));
+  if (lseek(fd, 0, SEEK_SET) < 0 || tsdbWriteRollupPart(fd, nfname, &head, sizeof(head)) < 0) goto _err;
+
+  if (fsync(fd) < 0) {
+    tsdbError("vgId:%d failed to fsync file %s since %s", REPO_ID(pRepo), nfname, strerror(errno));
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+  close(fd);
+  fd = -1;
+
+  // readers validate the rollups by the head file magic, so the file is replaced without the file handle lock. If it
+  // is not replaced, the old rollups stay and are found out of date.
+  tsdbGetDataFileName(pRepo->rootDir, REPO_ID(pRepo), pGroup->fileId, TSDB_FILE_TYPE_SMA, fname);
+  if (taosRename(nfname, fname) < 0) {
+    tsdbError("vgId:%d failed to rename file %s to %s since %s", REPO_ID(pRepo), nfname, fname, strerror(errno));
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    (void)remove(nfname);
+    goto _err;
+  }
+
+  tsdbDebug("vgId:%d rollups of %d tables are written to file %s %s in %" PRId64 " ms", REPO_ID(pRepo), nIdx, fname,
+            incremental ? "incrementally" : "from scratch", taosGetTimestampMs() - stime);
+
+  tfree(pOld);
+  tfree(pInfo);
+  tfree(pIdx);
+  tsdbCloseRollupFile(&rfile);
+  tsdbDestroyHelper(&rhelper);
+  return;
+
+_err:
+  tsdbError("vgId:%d failed to write rollups of file %d since %s", REPO_ID(pRepo), pGroup->fileId, tstrerror(terrno));
+  if (fd >= 0) {
+    close(fd);
+    (void)remove(nfname);
+  }
+  tfree(pOld);
+  tfree(pInfo);
+  tfree(pIdx);
+  tsdbCloseRollupFile(&rfile);
+  tsdbDestroyHelper(&rhelper);
+}
+
+// Compaction rewrites the blocks without changing the data, so the rollups stay valid for the new head file
+void tsdbRestampRollups(STsdbRepo *pRepo, SFileGroup *pGroup, uint32_t oldHeadMagic) {
+  STsdbFileH *pFileH = pRepo->tsdbFileH;
+  SRollupHead head = {0};
+  char        fname[TSDB_FILENAME_LEN] = "\0";
+
+  if (pRepo->rollupInterval <= 0) return;
+
+  tsdbGetDataFileName(pRepo->rootDir, REPO_ID(pRepo), pGroup->fileId, TSDB_FILE_TYPE_SMA, fname);
+  int fd = open(fname, O_RDWR | O_BINARY);
+  if (fd < 0) return;
+
+  if (tsdbLoadRollupHead(fd, pRepo, oldHeadMagic, &head) == 0) {
+    pthread_rwlock_rdlock(&(pFileH->fhlock));
+    head.headMagic = pGroup->files[TSDB_FILE_TYPE_HEAD].info.magic;
+    pthread_rwlock_unlock(&(pFileH->fhlock));
+
+    taosCalcChecksumAppend(0, (uint8_t *)(&head), sizeof(head));
+    if (lseek(fd, 0, SEEK_SET) < 0 || tsdbWriteRollupPart(fd, fname, &head, sizeof(head)) < 0) {
+      tsdbError("vgId:%d failed to update the head of rollup file %s since %s", REPO_ID(pRepo), fname,
+                tstrerror(terrno));
+    } else {
+      fsync(fd);
+    }
+  }
+
+  close(fd);
+}
+
+// Open the rollup file of a file group, which fails if the rollups are missing or not built from the head file
+int tsdbOpenRollupFile(STsdbRepo *pRepo, SFileGroup *pGroup, uint32_t headMagic, SRollupFile *pRFile) {
+  char fname[TSDB_FILENAME_LEN] = "\0";
+
+  memset((void *)pRFile, 0, sizeof(*pRFile));
+  tsdbGetDataFileName(pRepo->rootDir, REPO_ID(pRepo), pGroup->fileId, TSDB_FILE_TYPE_SMA, fname);
+
+  pRFile->fd = open(fname, O_RDONLY | O_BINARY);
+  if (pRFile->fd < 0) return -1;
+
+  if (tsdbLoadRollupHead(pRFile->fd, pRepo, headMagic, &(pRFile->head)) < 0) goto _err;
+
+  uint32_t len = sizeof(SRollupIdx) * pRFile->head.numOfTables + sizeof(TSCKSUM);
+  pRFile->pIdx = (SRollupIdx *)malloc(len);
+  if (pRFile->pIdx == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  if (lseek(pRFile->fd, pRFile->head.idxOffset, SEEK_SET) < 0 || taosRead(pRFile->fd, pRFile->pIdx, len) < len ||
+      !taosCheckChecksumWhole((uint8_t *)(pRFile->pIdx), len)) {
+    tsdbError("vgId:%d rollup file %s is broken, ignore it", REPO_ID(pRepo), fname);
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    goto _err;
+  }
+
+  return 0;
+
+_err:
+  tsdbCloseRollupFile(pRFile);
+  return -1;
+}
+
+// Load the rollups of a table, *ppInfo is set to NULL if the table has no data in the file group
+int tsdbLoadRollupInfo(SRollupFile *pRFile, int32_t tid, uint64_t uid, SRollupInfo **ppInfo) {
+  *ppInfo = NULL;
+
+  SRollupIdx *pIdx = (SRollupIdx *)bsearch((void *)(&tid), (void *)(pRFile->pIdx), pRFile->head.numOfTables,
+                                           sizeof(SRollupIdx), compRollupIdx);
+  if (pIdx == NULL || pIdx->uid != uid) return 0;
+
+  SRollupInfo *pInfo = (SRollupInfo *)malloc(pIdx->len);
+  if (pInfo == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  if (lseek(pRFile->fd, pIdx->offset, SEEK_SET) < 0 || taosRead(pRFile->fd, pInfo, pIdx->len) < pIdx->len ||
+      !taosCheckChecksumWhole((uint8_t *)pInfo, pIdx->len) || pInfo->numOfCols < 0 ||
+      pIdx->len != TSDB_ROLLUP_INFO_HEAD_SIZE(pInfo->numOfCols) +
+                       TSDB_ROLLUP_RECORD_SIZE(pInfo->numOfCols) * pInfo->numOfRollups + sizeof(TSCKSUM)) {
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    free(pInfo);
+    return -1;
+  }
+
+  *ppInfo = pInfo;
+  return 0;
+}
+
+void tsdbCloseRollupFile(SRollupFile *pRFile) {
+  if (pRFile->fd >= 0) {
+    close(pRFile->fd);
+    pRFile->fd = -1;
+  }
+  tfree(pRFile->pIdx);
+}
+
+// ---------------- LOCAL FUNCTIONS ----------------
+static TSKEY tsdbRollupBucket(TSKEY key, int64_t interval) {
+  TSKEY start = key / interval * interval;
+  return (start > key) ? (start - interval) : start;
+}
+
+// Roll up the rows of a table from the time bucket of key from, the earlier buckets are copied from pOld
+static int tsdbRollupTable(SRWHelper *pHelper, STable *pTable, SRollupInfo *pOld, TSKEY from, SRollupInfo **ppInfo,
+                           int32_t *pSize) {
+  int64_t   interval = helperRepo(pHelper)->rollupInterval;
+  STSchema *pSchema = tsdbGetTableSchemaImpl(pTable, false, false, -1);
+  int       numOfCols = schemaNCols(pSchema) - 1;  // the primary timestamp column is not rolled up
+
+  if (pOld != NULL) {
+    bool sameCols = (pOld->numOfCols == numOfCols);
+    for (int i = 0; sameCols && i < numOfCols; i++) {
+      sameCols = (pOld->colIds[i] == schemaColAt(pSchema, i + 1)->colId);
+    }
+    if (!sameCols) from = TSKEY_INITIAL_VAL;
+  }
+
+  if (*ppInfo == NULL || *pSize < (int32_t)TSDB_ROLLUP_INFO_HEAD_SIZE(numOfCols)) {
+    *pSize = 0;
+    tfree(*ppInfo);
+    *ppInfo = (SRollupInfo *)malloc(TSDB_ROLLUP_INFO_HEAD_SIZE(numOfCols));
+    if (*ppInfo == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+    *pSize = TSDB_ROLLUP_INFO_HEAD_SIZE(numOfCols);
+  }
+
+  SRollupInfo *pInfo = *ppInfo;
+  pInfo->numOfRollups = 0;
+  pInfo->numOfCols = numOfCols;
+  for (int i = 0; i < numOfCols; i++) {
+    pInfo->colIds[i] = schemaColAt(pSchema, i + 1)->colId;
+  }
+
+  TSKEY bfrom = (from == TSKEY_INITIAL_VAL) ? INT64_MIN : tsdbRollupBucket(from, interval);
+
+  if (pOld != NULL && bfrom != INT64_MIN) {
+    int nKept = 0;
+    while (nKept < pOld->numOfRollups && TSDB_ROLLUP_AT(pOld, nKept)->keyFirst < bfrom) nKept++;
+
+    if (tsdbReserveRollups(ppInfo, pSize, nKept) < 0) return -1;
+    pInfo = *ppInfo;
+    memcpy((void *)TSDB_ROLLUP_AT(pInfo, 0), (void *)TSDB_ROLLUP_AT(pOld, 0), TSDB_ROLLUP_RECORD_SIZE(numOfCols) * nKept);
+    pInfo->numOfRollups = nKept;
+  }
+
+  if (pHelper->curCompIdx.len <= 0) return 0;
+  if (tsdbLoadCompInfo(pHelper, NULL) < 0) return -1;
+
+  for (int i = 0; i < (int)pHelper->curCompIdx.numOfBlocks; i++) {
+    SCompBlock *pCompBlock = blockAtIdx(pHelper, i);
+    if (pCompBlock->keyLast < bfrom) continue;
+
+    if (tsdbLoadBlockData(pHelper, pCompBlock, NULL) < 0) return -1;
+
+    SDataCols *pCols = pHelper->pDataCols[0];
+    int        start = 0;
+    while (start < pCols->numOfRows && dataColsKeyAt(pCols, start) < bfrom) start++;
+
+    while (start < pCols->numOfRows) {
+      TSKEY bucket = tsdbRollupBucket(dataColsKeyAt(pCols, start), interval);
+      int   end = start + 1;
+      while (end < pCols->numOfRows && dataColsKeyAt(pCols, end) < bucket + interval) end++;
+
+      SRollupRecord *pRecord = NULL;
+      pInfo = *ppInfo;
+      if (pInfo->numOfRollups > 0 &&
+          tsdbRollupBucket(TSDB_ROLLUP_AT(pInfo, pInfo->numOfRollups - 1)->keyFirst, interval) == bucket) {
+        pRecord = TSDB_ROLLUP_AT(pInfo, pInfo->numOfRollups - 1);
+      } else {
+        if (tsdbReserveRollups(ppInfo, pSize, pInfo->numOfRollups + 1) < 0) return -1;
+        pInfo = *ppInfo;
+        pRecord = TSDB_ROLLUP_AT(pInfo, pInfo->numOfRollups);
+        memset((void *)pRecord, 0, TSDB_ROLLUP_RECORD_SIZE(numOfCols));
+        pInfo->numOfRollups++;
+      }
+
+      tsdbRollupRows(pRecord, pCols, start, end);
+      start = end;
+    }
+  }
+
+  return 0;
+}
+
+// Make room for the given number of rollups and the checksum
+static int tsdbReserveRollups(SRollupInfo **ppInfo, int32_t *pSize, int32_t numOfRollups) {
+  int     numOfCols = (*ppInfo)->numOfCols;
+  int32_t tsize = (int32_t)(TSDB_ROLLUP_INFO_HEAD_SIZE(numOfCols) + TSDB_ROLLUP_RECORD_SIZE(numOfCols) * numOfRollups +
+                            sizeof(TSCKSUM));
+  if (tsize <= *pSize) return 0;
+
+  tsize = MAX(tsize, *pSize * 2);
+  void *ptr = realloc(*ppInfo, tsize);
+  if (ptr == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  *ppInfo = (SRollupInfo *)ptr;
+  *pSize = tsize;
+  return 0;
+}
+
+// Add the rows [start, end) of the same time bucket to its rollup record
+static void tsdbRollupRows(SRollupRecord *pRecord, SDataCols *pCols, int start, int end) {
+  int32_t rows = end - start;
+
+  for (int i = 1; i < pCols->numOfCols; i++) {
+    SDataCol *  pCol = pCols->cols + i;
+    SRollupCol *pRCol = pRecord->cols + (i - 1);
+    int32_t     notNull = pRecord->numOfRows - pRCol->numOfNull;
+    int64_t     sum = 0, min = 0, max = 0;
+    int16_t     minIndex = 0, maxIndex = 0, numOfNull = 0;
+
+    if (pCol->len <= 0 || tDataTypes[pCol->type].statisFunc == NULL) {
+      pRCol->numOfNull += rows;
+      continue;
+    }
+
+    (*tDataTypes[pCol->type].statisFunc)(tdGetColDataOfRow(pCol, start), rows, &min, &max, &sum, &minIndex, &maxIndex,
+                                         &numOfNull);
+    pRCol->numOfNull += numOfNull;
+    if (numOfNull == rows || IS_VAR_DATA_TYPE(pCol->type)) continue;
+
+    if (notNull == 0) {
+      pRCol->sum = sum;
+      pRCol->min = min;
+      pRCol->max = max;
+    } else {
+      tsdbMergeRollupCol(pRCol, pCol->type, sum, min, max);
+    }
+  }
+
+  if (pRecord->numOfRows == 0) pRecord->keyFirst = dataColsKeyAt(pCols, start);
+  pRecord->keyLast = dataColsKeyAt(pCols, end - 1);
+  pRecord->numOfRows += rows;
+}
+
+static void tsdbMergeRollupCol(SRollupCol *pRCol, int8_t type, int64_t sum, int64_t min, int64_t max) {
+  if (type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) {
+    double dsum = GET_DOUBLE_VAL((const char *)&(pRCol->sum)) + GET_DOUBLE_VAL((const char *)&sum);
+    SET_DOUBLE_VAL(&(pRCol->sum), dsum);
+    if (GET_DOUBLE_VAL((const char *)&min) < GET_DOUBLE_VAL((const char *)&(pRCol->min))) pRCol->min = min;
+    if (GET_DOUBLE_VAL((const char *)&max) > GET_DOUBLE_VAL((const char *)&(pRCol->max))) pRCol->max = max;
+  } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
+    pRCol->sum = (int64_t)((uint64_t)pRCol->sum + (uint64_t)sum);
+    if ((uint64_t)min < (uint64_t)pRCol->min) pRCol->min = min;
+    if ((uint64_t)max > (uint64_t)pRCol->max) pRCol->max = max;
+  } else {
+    pRCol->sum = (int64_t)((uint64_t)pRCol->sum + (uint64_t)sum);
+    if (min < pRCol->min) pRCol->min = min;
+    if (max > pRCol->max) pRCol->max = max;
+  }
+}
+
+static int tsdbWriteRollupPart(int fd, char *fname, void *buf, uint32_t len) {
+  if (taosWrite(fd, buf, len) < (int)len) {
+    tsdbError("failed to write %u bytes to file %s since %s", len, fname, strerror(errno));
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  return 0;
+}
+
+static int tsdbLoadRollupHead(int fd, STsdbRepo *pRepo, uint32_t headMagic, SRollupHead *pHead) {
+  if (taosRead(fd, (void *)pHead, sizeof(*pHead)) < (int)sizeof(*pHead) ||
+      !taosCheckChecksumWhole((uint8_t *)pHead, sizeof(*pHead)) || pHead->magic != TSDB_ROLLUP_MAGIC) {
+    tsdbDebug("vgId:%d rollup file of invalid head, ignore it", REPO_ID(pRepo));
+    return -1;
+  }
+
+  if (pHead->headMagic != headMagic || pHead->interval != pRepo->rollupInterval) return -1;
+
+  return 0;
+}
+
+static int compRollupIdx(const void *key, const void *pIdx) {
+  int32_t tid = *(int32_t *)key;
+  int32_t tid2 = ((SRollupIdx *)pIdx)->tid;
+
+  if (tid == tid2) return 0;
+  return (tid > tid2) ? 1 : -1;
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "hash.h"
+#include "taosdef.h"
+#include "tglobal.h"
+#include "tsdbMain.h"
+#include "tskiplist.h"
+
+#define TSDB_TAG_INDEX_SL_LEVEL 5
+
+typedef struct {
+  SArray* pTables;  // STable* of the child tables with this tag value
+  char    key[];
+} STagPosting;
+
+static char *tsdbGetTagPostingKey(const void *pData);
+static int   tsdbGetTagKeyLen(int8_t type, const void *key);
+static void  tsdbFreeTagPosting(STagPosting *pPosting);
+static void  tsdbRemoveTagPosting(STagIndex *pIndex, STagPosting *pPosting);
+static void  tsdbRemoveTableFromList(SArray *pTables, STable *pTable);
+static void  tsdbAppendTableList(SArray *pTables, SArray *pList);
+
+// ---------------- INTERNAL FUNCTIONS ----------------
+// (Re)build the indexes on the tag columns following the first one, which is indexed by STable.pIndex
+int tsdbInitTagIndex(STable *pSTable) {
+  ASSERT(TABLE_TYPE(pSTable) == TSDB_SUPER_TABLE);
+
+  tsdbFreeTagIndex(pSTable);
+
+  STSchema *pSchema = pSTable->tagSchema;
+  int       ncols = MIN(schemaNCols(pSchema), tsTagIndexColumns);
+
+  for (int i = 1; i < ncols; i++) {
+    STColumn *pCol = schemaColAt(pSchema, i);
+    // float comparison is not exact, the postings of such values can not be kept apart
+    if (colType(pCol) == TSDB_DATA_TYPE_FLOAT || colType(pCol) == TSDB_DATA_TYPE_DOUBLE) continue;
+
+    if (pSTable->pTagIndex == NULL) {
+      pSTable->pTagIndex = taosArrayInit(ncols, sizeof(STagIndex));
+      if (pSTable->pTagIndex == NULL) goto _err;
+    }
+
+    STagIndex index = {.colId = colColId(pCol), .type = colType(pCol)};
+    index.pHash = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+    index.pOrdered = tSkipListCreate(TSDB_TAG_INDEX_SL_LEVEL, colType(pCol), (uint16_t)colBytes(pCol), NULL,
+                                     SL_ALLOW_DUP_KEY, tsdbGetTagPostingKey);
+    index.pMissing = taosArrayInit(4, POINTER_BYTES);
+    if (index.pHash == NULL || index.pOrdered == NULL || index.pMissing == NULL ||
+        taosArrayPush(pSTable->pTagIndex, &index) == NULL) {
+      taosHashCleanup(index.pHash);
+      tSkipListDestroy(index.pOrdered);
+      taosArrayDestroy(index.pMissing);
+      goto _err;
+    }
+  }
+
+  if (pSTable->pTagIndex == NULL || pSTable->pIndex == NULL) return 0;
+
+  SSkipListIterator *pIter = tSkipListCreateIter(pSTable->pIndex);
+  if (pIter == NULL) goto _err;
+
+  while (tSkipListIterNext(pIter)) {
+    STable *pTable = (STable *)SL_GET_NODE_DATA(tSkipListIterGet(pIter));
+    if (tsdbAddTableIntoTagIndex(pSTable, pTable) < 0) {
+      tSkipListDestroyIter(pIter);
+      goto _err;
+    }
+  }
+
+  tSkipListDestroyIter(pIter);
+  return 0;
+
+_err:
+  tsdbFreeTagIndex(pSTable);
+  terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+  return -1;
+}
+
+void tsdbFreeTagIndex(STable *pSTable) {
+  if (pSTable->pTagIndex == NULL) return;
+
+  for (size_t i = 0; i < taosArrayGetSize(pSTable->pTagIndex); i++) {
+    STagIndex *pIndex = (STagIndex *)taosArrayGet(pSTable->pTagIndex, i);
+
+    SSkipListIterator *pIter = tSkipListCreateIter(pIndex->pOrdered);
+    while (pIter != NULL && tSkipListIterNext(pIter)) {
+      tsdbFreeTagPosting((STagPosting *)SL_GET_NODE_DATA(tSkipListIterGet(pIter)));
+    }
+    tSkipListDestroyIter(pIter);
+
+    taosHashCleanup(pIndex->pHash);
+    tSkipListDestroy(pIndex->pOrdered);
+    taosArrayDestroy(pIndex->pMissing);
+  }
+
+  taosArrayDestroy(pSTable->pTagIndex);
+  pSTable->pTagIndex = NULL;
+}
+
+int tsdbAddTableIntoTagIndex(STable *pSTable, STable *pTable) {
+  if (pSTable->pTagIndex == NULL) return 0;
+
+  for (size_t i = 0; i < taosArrayGetSize(pSTable->pTagIndex); i++) {
+    STagIndex *pIndex = (STagIndex *)taosArrayGet(pSTable->pTagIndex, i);
+
+    void *key = tdGetKVRowValOfCol(pTable->tagVal, pIndex->colId);
+    if (key == NULL) {
+      if (taosArrayPush(pIndex->pMissing, &pTable) == NULL) goto _err;
+      continue;
+    }
+
+    int           len = tsdbGetTagKeyLen(pIndex->type, key);
+    STagPosting **ppPosting = (STagPosting **)taosHashGet(pIndex->pHash, key, len);
+    STagPosting * pPosting = NULL;
+
+    if (ppPosting != NULL) {
+      pPosting = *ppPosting;
+    } else {
+      pPosting = (STagPosting *)malloc(sizeof(*pPosting) + len);
+      if (pPosting == NULL) goto _err;
+      memcpy(pPosting->key, key, len);
+      pPosting->pTables = taosArrayInit(4, POINTER_BYTES);
+      if (pPosting->pTables == NULL) {
+        free(pPosting);
+        goto _err;
+      }
+
+      if (taosHashPut(pIndex->pHash, key, len, (void *)(&pPosting), sizeof(pPosting)) != 0) {
+        tsdbFreeTagPosting(pPosting);
+        goto _err;
+      }
+
+      if (tSkipListPut(pIndex->pOrdered, (void *)pPosting) == NULL) {
+        taosHashRemove(pIndex->pHash, key, len);
+        tsdbFreeTagPosting(pPosting);
+        goto _err;
+      }
+    }
+
+    if (taosArrayPush(pPosting->pTables, &pTable) == NULL) goto _err;
+  }
+
+  return 0;
+
+_err:
+  terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+  return -1;
+}
+
+// NOTE: the tag values of the table must not be changed since it is added into the index
+void tsdbRemoveTableFromTagIndex(STable *pSTable, STable *pTable) {
+  if (pSTable->pTagIndex == NULL) return;
+
+  for (size_t i = 0; i < taosArrayGetSize(pSTable->pTagIndex); i++) {
+    STagIndex *pIndex = (STagIndex *)taosArrayGet(pSTable->pTagIndex, i);
+
+    void *key = tdGetKVRowValOfCol(pTable->tagVal, pIndex->colId);
+    if (key == NULL) {
+      tsdbRemoveTableFromList(pIndex->pMissing, pTable);
+      continue;
+    }
+
+    STagPosting **ppPosting =
+        (STagPosting **)taosHashGet(pIndex->pHash, key, tsdbGetTagKeyLen(pIndex->type, key));
+    if (ppPosting == NULL) continue;
+
+    STagPosting *pPosting = *ppPosting;
+    tsdbRemoveTableFromList(pPosting->pTables, pTable);
+    if (taosArrayGetSize(pPosting->pTables) == 0) tsdbRemoveTagPosting(pIndex, pPosting);
+  }
+}
+
+STagIndex *tsdbGetTagIndex(STable *pSTable, int16_t colId) {
+  if (pSTable->pTagIndex == NULL) return NULL;
+
+  for (size_t i = 0; i < taosArrayGetSize(pSTable->pTagIndex); i++) {
+    STagIndex *pIndex = (STagIndex *)taosArrayGet(pSTable->pTagIndex, i);
+    if (pIndex->colId == colId) return pIndex;
+  }
+
+  return NULL;
+}
+
+// Append the child tables which satisfy the condition on the tag column to pTables. Return -1 if the condition can not
+// be served by the index.
+int tsdbQueryTagIndex(STagIndex *pIndex, int32_t optr, const void *q, SArray *pTables) {
+  SSkipList *pOrdered = pIndex->pOrdered;
+
+  switch (optr) {
+    case TSDB_RELATION_EQUAL: {
+      STagPosting **ppPosting = (STagPosting **)taosHashGet(pIndex->pHash, q, tsdbGetTagKeyLen(pIndex->type, q));
+      if (ppPosting != NULL) tsdbAppendTableList(pTables, (*ppPosting)->pTables);
+      return 0;
+    }
+    case TSDB_RELATION_IN: {
+      // the IN set is a sorted array of binary strings
+      if (pIndex->type != TSDB_DATA_TYPE_BINARY) return -1;
+
+      SArray *pSet = (SArray *)q;
+      for (size_t i = 0; i < taosArrayGetSize(pSet); i++) {
+        char *        key = taosArrayGetP(pSet, i);
+        STagPosting **ppPosting = (STagPosting **)taosHashGet(pIndex->pHash, key, varDataTLen(key));
+        if (ppPosting != NULL) tsdbAppendTableList(pTables, (*ppPosting)->pTables);
+      }
+      return 0;
+    }
+    case TSDB_RELATION_GREATER:
+    case TSDB_RELATION_GREATER_EQUAL:
+    case TSDB_RELATION_LESS:
+    case TSDB_RELATION_LESS_EQUAL: {
+      bool  asc = (optr == TSDB_RELATION_GREATER || optr == TSDB_RELATION_GREATER_EQUAL);
+      bool  inclusive = (optr == TSDB_RELATION_GREATER_EQUAL || optr == TSDB_RELATION_LESS_EQUAL);
+      SSkipListIterator *pIter =
+          tSkipListCreateIterFromVal(pOrdered, q, pOrdered->type, asc ? TSDB_ORDER_ASC : TSDB_ORDER_DESC);
+      if (pIter == NULL) return -1;
+
+      while (tSkipListIterNext(pIter)) {
+        STagPosting *pPosting = (STagPosting *)SL_GET_NODE_DATA(tSkipListIterGet(pIter));
+        if (!inclusive && pOrdered->comparFn(pPosting->key, q) == 0) continue;
+        tsdbAppendTableList(pTables, pPosting->pTables);
+      }
+      tSkipListDestroyIter(pIter);
+
+      // a missing tag value is taken as less than any value by the tag filter
+      if (!asc) tsdbAppendTableList(pTables, pIndex->pMissing);
+      return 0;
+    }
+    default:
+      return -1;
+  }
+}
+
+// ---------------- LOCAL FUNCTIONS ----------------
+static char *tsdbGetTagPostingKey(const void *pData) { return ((STagPosting *)pData)->key; }
+
+static int tsdbGetTagKeyLen(int8_t type, const void *key) {
+  return IS_VAR_DATA_TYPE(type) ? varDataTLen(key) : TYPE_BYTES[type];
+}
+
+static void tsdbFreeTagPosting(STagPosting *pPosting) {
+  taosArrayDestroy(pPosting->pTables);
+  free(pPosting);
+}
+
+static void tsdbRemoveTagPosting(STagIndex *pIndex, STagPosting *pPosting) {
+  taosHashRemove(pIndex->pHash, pPosting->key, tsdbGetTagKeyLen(pIndex->type, pPosting->key));
+
+  SArray *pNodes = tSkipListGet(pIndex->pOrdered, pPosting->key);
+  for (size_t i = 0; i < taosArrayGetSize(pNodes); i++) {
+    SSkipListNode *pNode = taosArrayGetP(pNodes, i);
+    if ((STagPosting *)SL_GET_NODE_DATA(pNode) == pPosting) {
+      tSkipListRemoveNode(pIndex->pOrdered, pNode);
+      break;
+    }
+  }
+  taosArrayDestroy(pNodes);
+
+  tsdbFreeTagPosting(pPosting);
+}
+
+static void tsdbRemoveTableFromList(SArray *pTables, STable *pTable) {
+  size_t size = taosArrayGetSize(pTables);
+  for (size_t i = 0; i < size; i++) {
+    STable **ppTable = (STable **)taosArrayGet(pTables, i);
+    if (*ppTable == pTable) {  // the order of the list does not matter, fill the hole with the last one
+      *ppTable = *(STable **)taosArrayGetLast(pTables);
+      taosArrayPop(pTables);
+      return;
+    }
+  }
+}
+
+static void tsdbAppendTableList(SArray *pTables, SArray *pList) {
+  for (size_t i = 0; i < taosArrayGetSize(pList); i++) {
+    taosArrayPush(pTables, taosArrayGet(pList, i));
+  }
+}
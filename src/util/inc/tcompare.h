@@ -29,6 +29,14 @@ extern "C" {
 
 #define PATTERN_COMPARE_INFO_INITIALIZER { '%', '_' }
 
+// float and double values are compared with this tolerance by the column filters
+#define FLT_COMPAR_TOL_FACTOR    4
+#define FLT_EQUAL(_x, _y)        (fabs((_x) - (_y)) <= (FLT_COMPAR_TOL_FACTOR * FLT_EPSILON))
+#define FLT_GREATER(_x, _y)      (!FLT_EQUAL((_x), (_y)) && ((_x) > (_y)))
+#define FLT_LESS(_x, _y)         (!FLT_EQUAL((_x), (_y)) && ((_x) < (_y)))
+#define FLT_GREATEREQUAL(_x, _y) (FLT_EQUAL((_x), (_y)) || ((_x) > (_y)))
+#define FLT_LESSEQUAL(_x, _y)    (FLT_EQUAL((_x), (_y)) || ((_x) < (_y)))
+
 typedef struct SPatternCompareInfo {
   char matchAll;  // symbol for match all wildcard, default: '%'
   char matchOne;  // symbol for match one wildcard, default: '_'
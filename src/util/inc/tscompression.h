@@ -33,27 +33,52 @@ extern "C" {
 #define NO_COMPRESSION 0
 #define ONE_STAGE_COMP 1
 #define TWO_STAGE_COMP 2
+// Same as ONE_STAGE_COMP/TWO_STAGE_COMP, except that float and double columns are encoded by the Gorilla codec
+#define ONE_STAGE_GORILLA_COMP 3
+#define TWO_STAGE_GORILLA_COMP 4
 
+// General purpose compressors of the second stage (and of strings), kept in the high bits of the algorithm
+#define COMP_BACKEND_LZ4 0
+#define COMP_BACKEND_ZLIB 1
+#define COMP_MAX_BACKEND 2
+
+#define COMP_ALGORITHM(level, backend) ((level) | ((backend) << 4))
+#define COMP_LEVEL(algorithm) ((algorithm)&0x0F)
+#define COMP_BACKEND(algorithm) (((algorithm) >> 4) & 0x07)
+#define COMP_STAGE(algorithm) \
+  ((COMP_LEVEL(algorithm) > TWO_STAGE_COMP) ? (COMP_LEVEL(algorithm) - TWO_STAGE_COMP) : COMP_LEVEL(algorithm))
+#define COMP_IS_GORILLA(algorithm) (COMP_LEVEL(algorithm) > TWO_STAGE_COMP)
+
+// Pick the SIMD kernels of the integer codecs supported by the running CPU.
+extern void taosResolveCompression();
 extern int tsCompressINTImp(const char *const input, const int nelements, char *const output, const char type);
 extern int tsDecompressINTImp(const char *const input, const int nelements, char *const output, const char type);
 extern int tsCompressBoolImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressBoolImp(const char *const input, const int nelements, char *const output);
 extern int tsCompressStringImp(const char *const input, int inputSize, char *const output, int outputSize);
 extern int tsDecompressStringImp(const char *const input, int compressedSize, char *const output, int outputSize);
+extern int tsCompressGeneralImp(const char *const input, int inputSize, char *const output, int outputSize,
+                                char algorithm);
+extern int tsDecompressGeneralImp(const char *const input, int compressedSize, char *const output, int outputSize,
+                                  char algorithm);
 extern int tsCompressTimestampImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressTimestampImp(const char *const input, const int nelements, char *const output);
 extern int tsCompressDoubleImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressDoubleImp(const char *const input, const int nelements, char *const output);
 extern int tsCompressFloatImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressFloatImp(const char *const input, const int nelements, char *const output);
+extern int tsCompressDoubleGorillaImp(const char *const input, const int nelements, char *const output);
+extern int tsDecompressDoubleGorillaImp(const char *const input, int compressedSize, const int nelements, char *const output);
+extern int tsCompressFloatGorillaImp(const char *const input, const int nelements, char *const output);
+extern int tsDecompressFloatGorillaImp(const char *const input, int compressedSize, const int nelements, char *const output);
 
 static FORCE_INLINE int tsCompressTinyint(const char *const input, int inputSize, const int nelements, char *const output, int outputSize, char algorithm,
                       char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsCompressINTImp(input, nelements, output, TSDB_DATA_TYPE_TINYINT);
-  } else if (algorithm == TWO_STAGE_COMP) {
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
     int len = tsCompressINTImp(input, nelements, buffer, TSDB_DATA_TYPE_TINYINT);
-    return tsCompressStringImp(buffer, len, output, outputSize);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
   } else {
     assert(0);
     return -1;
@@ -62,10 +87,10 @@ static FORCE_INLINE int tsCompressTinyint(const char *const input, int inputSize
 
 static FORCE_INLINE int tsDecompressTinyint(const char *const input, int compressedSize, const int nelements, char *const output,
                         int outputSize, char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsDecompressINTImp(input, nelements, output, TSDB_DATA_TYPE_TINYINT);
-  } else if (algorithm == TWO_STAGE_COMP) {
-    if (tsDecompressStringImp(input, compressedSize, buffer, bufferSize) < 0) return -1;
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
+    if (tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm) < 0) return -1;
     return tsDecompressINTImp(buffer, nelements, output, TSDB_DATA_TYPE_TINYINT);
   } else {
     assert(0);
@@ -75,11 +100,11 @@ static FORCE_INLINE int tsDecompressTinyint(const char *const input, int compres
 
 static FORCE_INLINE int tsCompressSmallint(const char *const input, int inputSize, const int nelements, char *const output, int outputSize, char algorithm,
                        char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsCompressINTImp(input, nelements, output, TSDB_DATA_TYPE_SMALLINT);
-  } else if (algorithm == TWO_STAGE_COMP) {
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
     int len = tsCompressINTImp(input, nelements, buffer, TSDB_DATA_TYPE_SMALLINT);
-    return tsCompressStringImp(buffer, len, output, outputSize);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
   } else {
     assert(0);
     return -1;
@@ -88,10 +113,10 @@ static FORCE_INLINE int tsCompressSmallint(const char *const input, int inputSiz
 
 static FORCE_INLINE int tsDecompressSmallint(const char *const input, int compressedSize, const int nelements, char *const output,
                          int outputSize, char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsDecompressINTImp(input, nelements, output, TSDB_DATA_TYPE_SMALLINT);
-  } else if (algorithm == TWO_STAGE_COMP) {
-    if (tsDecompressStringImp(input, compressedSize, buffer, bufferSize) < 0) return -1;
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
+    if (tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm) < 0) return -1;
     return tsDecompressINTImp(buffer, nelements, output, TSDB_DATA_TYPE_SMALLINT);
   } else {
     assert(0);
@@ -101,11 +126,11 @@ static FORCE_INLINE int tsDecompressSmallint(const char *const input, int compre
 
 static FORCE_INLINE int tsCompressInt(const char *const input, int inputSize, const int nelements, char *const output, int outputSize, char algorithm,
                   char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsCompressINTImp(input, nelements, output, TSDB_DATA_TYPE_INT);
-  } else if (algorithm == TWO_STAGE_COMP) {
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
     int len = tsCompressINTImp(input, nelements, buffer, TSDB_DATA_TYPE_INT);
-    return tsCompressStringImp(buffer, len, output, outputSize);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
   } else {
     assert(0);
     return -1;
@@ -114,10 +139,10 @@ static FORCE_INLINE int tsCompressInt(const char *const input, int inputSize, co
 
 static FORCE_INLINE int tsDecompressInt(const char *const input, int compressedSize, const int nelements, char *const output,
                     int outputSize, char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsDecompressINTImp(input, nelements, output, TSDB_DATA_TYPE_INT);
-  } else if (algorithm == TWO_STAGE_COMP) {
-    if (tsDecompressStringImp(input, compressedSize, buffer, bufferSize) < 0) return -1;
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
+    if (tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm) < 0) return -1;
     return tsDecompressINTImp(buffer, nelements, output, TSDB_DATA_TYPE_INT);
   } else {
     assert(0);
@@ -127,11 +152,11 @@ static FORCE_INLINE int tsDecompressInt(const char *const input, int compressedS
 
 static FORCE_INLINE int tsCompressBigint(const char *const input, int inputSize, const int nelements, char *const output, int outputSize,
                      char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsCompressINTImp(input, nelements, output, TSDB_DATA_TYPE_BIGINT);
-  } else if (algorithm == TWO_STAGE_COMP) {
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
     int len = tsCompressINTImp(input, nelements, buffer, TSDB_DATA_TYPE_BIGINT);
-    return tsCompressStringImp(buffer, len, output, outputSize);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
   } else {
     assert(0);
     return -1;
@@ -140,10 +165,10 @@ static FORCE_INLINE int tsCompressBigint(const char *const input, int inputSize,
 
 static FORCE_INLINE int tsDecompressBigint(const char *const input, int compressedSize, const int nelements, char *const output,
                        int outputSize, char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsDecompressINTImp(input, nelements, output, TSDB_DATA_TYPE_BIGINT);
-  } else if (algorithm == TWO_STAGE_COMP) {
-    if (tsDecompressStringImp(input, compressedSize, buffer, bufferSize) < 0) return -1;
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
+    if (tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm) < 0) return -1;
     return tsDecompressINTImp(buffer, nelements, output, TSDB_DATA_TYPE_BIGINT);
   } else {
     assert(0);
@@ -153,11 +178,11 @@ static FORCE_INLINE int tsDecompressBigint(const char *const input, int compress
 
 static FORCE_INLINE int tsCompressBool(const char *const input, int inputSize, const int nelements, char *const output, int outputSize, 
                    char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsCompressBoolImp(input, nelements, output);
-  } else if (algorithm == TWO_STAGE_COMP) {
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
     int len = tsCompressBoolImp(input, nelements, buffer);
-    return tsCompressStringImp(buffer, len, output, outputSize);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
   } else {
     assert(0);
     return -1;
@@ -166,10 +191,10 @@ static FORCE_INLINE int tsCompressBool(const char *const input, int inputSize, c
 
 static FORCE_INLINE int tsDecompressBool(const char *const input, int compressedSize, const int nelements, char *const output,
                      int outputSize, char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsDecompressBoolImp(input, nelements, output);
-  } else if (algorithm == TWO_STAGE_COMP) {
-    if (tsDecompressStringImp(input, compressedSize, buffer, bufferSize) < 0) return -1;
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
+    if (tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm) < 0) return -1;
     return tsDecompressBoolImp(buffer, nelements, output);
   } else {
     assert(0);
@@ -179,21 +204,25 @@ static FORCE_INLINE int tsDecompressBool(const char *const input, int compressed
 
 static FORCE_INLINE int tsCompressString(const char *const input, int inputSize, const int nelements, char *const output, int outputSize,
                      char algorithm, char *const buffer, int bufferSize) {
-  return tsCompressStringImp(input, inputSize, output, outputSize);
+  return tsCompressGeneralImp(input, inputSize, output, outputSize, algorithm);
 }
 
 static FORCE_INLINE int tsDecompressString(const char *const input, int compressedSize, const int nelements, char *const output,
                        int outputSize, char algorithm, char *const buffer, int bufferSize) {
-  return tsDecompressStringImp(input, compressedSize, output, outputSize);
+  return tsDecompressGeneralImp(input, compressedSize, output, outputSize, algorithm);
 }
 
 static FORCE_INLINE int tsCompressFloat(const char *const input, int inputSize, const int nelements, char *const output, int outputSize,
                     char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_IS_GORILLA(algorithm)) {
+    if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) return tsCompressFloatGorillaImp(input, nelements, output);
+    int len = tsCompressFloatGorillaImp(input, nelements, buffer);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
+  } else if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsCompressFloatImp(input, nelements, output);
-  } else if (algorithm == TWO_STAGE_COMP) {
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
     int len = tsCompressFloatImp(input, nelements, buffer);
-    return tsCompressStringImp(buffer, len, output, outputSize);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
   } else {
     assert(0);
     return -1;
@@ -202,10 +231,15 @@ static FORCE_INLINE int tsCompressFloat(const char *const input, int inputSize,
 
 static FORCE_INLINE int tsDecompressFloat(const char *const input, int compressedSize, const int nelements, char *const output,
                       int outputSize, char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_IS_GORILLA(algorithm)) {
+    if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) return tsDecompressFloatGorillaImp(input, compressedSize, nelements, output);
+    int len = tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm);
+    if (len < 0) return -1;
+    return tsDecompressFloatGorillaImp(buffer, len, nelements, output);
+  } else if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsDecompressFloatImp(input, nelements, output);
-  } else if (algorithm == TWO_STAGE_COMP) {
-    if (tsDecompressStringImp(input, compressedSize, buffer, bufferSize) < 0) return -1;
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
+    if (tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm) < 0) return -1;
     return tsDecompressFloatImp(buffer, nelements, output);
   } else {
     assert(0);
@@ -215,11 +249,15 @@ static FORCE_INLINE int tsDecompressFloat(const char *const input, int compresse
 
 static FORCE_INLINE int tsCompressDouble(const char *const input, int inputSize, const int nelements, char *const output, int outputSize,
                      char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_IS_GORILLA(algorithm)) {
+    if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) return tsCompressDoubleGorillaImp(input, nelements, output);
+    int len = tsCompressDoubleGorillaImp(input, nelements, buffer);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
+  } else if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsCompressDoubleImp(input, nelements, output);
-  } else if (algorithm == TWO_STAGE_COMP) {
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
     int len = tsCompressDoubleImp(input, nelements, buffer);
-    return tsCompressStringImp(buffer, len, output, outputSize);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
   } else {
     assert(0);
     return -1;
@@ -228,10 +266,15 @@ static FORCE_INLINE int tsCompressDouble(const char *const input, int inputSize,
 
 static FORCE_INLINE int tsDecompressDouble(const char *const input, int compressedSize, const int nelements, char *const output,
                        int outputSize, char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_IS_GORILLA(algorithm)) {
+    if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) return tsDecompressDoubleGorillaImp(input, compressedSize, nelements, output);
+    int len = tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm);
+    if (len < 0) return -1;
+    return tsDecompressDoubleGorillaImp(buffer, len, nelements, output);
+  } else if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsDecompressDoubleImp(input, nelements, output);
-  } else if (algorithm == TWO_STAGE_COMP) {
-    if (tsDecompressStringImp(input, compressedSize, buffer, bufferSize) < 0) return -1;
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
+    if (tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm) < 0) return -1;
     return tsDecompressDoubleImp(buffer, nelements, output);
   } else {
     assert(0);
@@ -241,11 +284,11 @@ static FORCE_INLINE int tsDecompressDouble(const char *const input, int compress
 
 static FORCE_INLINE int tsCompressTimestamp(const char *const input, int inputSize, const int nelements, char *const output, int outputSize,
                         char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsCompressTimestampImp(input, nelements, output);
-  } else if (algorithm == TWO_STAGE_COMP) {
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
     int len = tsCompressTimestampImp(input, nelements, buffer);
-    return tsCompressStringImp(buffer, len, output, outputSize);
+    return tsCompressGeneralImp(buffer, len, output, outputSize, algorithm);
   } else {
     assert(0);
     return -1;
@@ -254,10 +297,10 @@ static FORCE_INLINE int tsCompressTimestamp(const char *const input, int inputSi
 
 static FORCE_INLINE int tsDecompressTimestamp(const char *const input, int compressedSize, const int nelements, char *const output,
                           int outputSize, char algorithm, char *const buffer, int bufferSize) {
-  if (algorithm == ONE_STAGE_COMP) {
+  if (COMP_STAGE(algorithm) == ONE_STAGE_COMP) {
     return tsDecompressTimestampImp(input, nelements, output);
-  } else if (algorithm == TWO_STAGE_COMP) {
-    if (tsDecompressStringImp(input, compressedSize, buffer, bufferSize) < 0) return -1;
+  } else if (COMP_STAGE(algorithm) == TWO_STAGE_COMP) {
+    if (tsDecompressGeneralImp(input, compressedSize, buffer, bufferSize, algorithm) < 0) return -1;
     return tsDecompressTimestampImp(buffer, nelements, output);
   } else {
     assert(0);
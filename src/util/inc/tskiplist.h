@@ -33,6 +33,9 @@ extern "C" {
 #define SL_UPDATE_DUP_KEY (uint8_t)0x2   // Update duplicate key by remove/insert (for data update=1 case)
 // For thread safety setting
 #define SL_THREAD_SAFE (uint8_t)0x4
+// For node memory setting: nodes are carved from arena chunks owned by the skiplist and only released when the
+// skiplist is destroyed. Such a skiplist supports one writer with readers iterating without lock (memtable usage).
+#define SL_ARENA_NODE (uint8_t)0x8
 
 typedef char *SSkipListKey;
 typedef char *(*__sl_key_fn_t)(const void *);
@@ -95,6 +98,8 @@ typedef struct tSkipListState {
   uint64_t nTotalElapsedTimeForInsert;
 } tSkipListState;
 
+typedef struct SSkipListArena SSkipListArena;
+
 typedef struct SSkipList {
   __compar_fn_t     comparFn;
   __sl_key_fn_t     keyFn;
@@ -105,8 +110,10 @@ typedef struct SSkipList {
   uint8_t           type;  // static info above
   uint8_t           level;
   uint32_t          size;
-  SSkipListNode *   pHead;  // point to the first element
-  SSkipListNode *   pTail;  // point to the last element
+  uint32_t          seed;    // random seed to generate node level
+  SSkipListNode *   pHead;   // point to the first element
+  SSkipListNode *   pTail;   // point to the last element
+  SSkipListArena *  pArena;  // arena chunks of nodes if SL_ARENA_NODE is set
 #if SKIP_LIST_RECORD_PERFORMANCE
   tSkipListState state;  // skiplist state
 #endif
@@ -121,6 +128,7 @@ typedef struct SSkipListIterator {
 } SSkipListIterator;
 
 #define SL_IS_THREAD_SAFE(s) (((s)->flags) & SL_THREAD_SAFE)
+#define SL_IS_ARENA_NODE(s) (((s)->flags) & SL_ARENA_NODE)
 #define SL_DUP_MODE(s) (((s)->flags) & ((((uint8_t)1) << 2) - 1))
 #define SL_GET_NODE_KEY(s, n) ((s)->keyFn((n)->pData))
 #define SL_GET_MIN_KEY(s) SL_GET_NODE_KEY(s, SL_NODE_GET_FORWARD_POINTER((s)->pHead, 0))
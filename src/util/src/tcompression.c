@@ -36,7 +36,8 @@
  *   better when there are a lot of consecutive true values or false values.
  *
  * STRING Compression Algorithm:
- *   We us LZ4 method to compress the string type.
+ *   We us LZ4 method to compress the string type. The same general purpose compressor is the second stage of
+ *   TWO_STAGE_COMP. zlib can be picked instead by the backend bits of the algorithm, which is done for cold data.
  *
  * FLOAT Compression Algorithm:
  *   We use the same method with Akumuli to compress float and double types. The compression
@@ -44,58 +45,70 @@
  *   adjacent values. Then compare the number of leading zeros and trailing zeros. If the number
  *   of leading zeros are larger than the trailing zeros, then record the last serveral bytes
  *   of the XORed value with informations. If not, record the first corresponding bytes.
+ *   With ONE_STAGE_GORILLA_COMP/TWO_STAGE_GORILLA_COMP the XORed values are bit packed in groups instead, see the
+ *   Gorilla Float Compression section.
  *
  */
 
 #include "lz4.h"
 #include "os.h"
 #include "taosdef.h"
+#include "tglobal.h"
 #include "tscompression.h"
 #include "tulog.h"
+#include "zlib.h"
+
+#if defined(__x86_64__) && !defined(WINDOWS)
+#define TD_COMP_X86_SIMD
+#include <immintrin.h>
+#endif
 
 static const int TEST_NUMBER = 1;
 #define is_bigendian() ((*(char *)&TEST_NUMBER) == 0)
-#define SIMPLE8B_MAX_INT64 ((uint64_t)2305843009213693951L)
+// A zigzag value needs to fit in the 60 bits of selector 15, larger ones are stored uncompressed.
+#define SIMPLE8B_MAX_INT64 ((uint64_t)1152921504606846976L)
+#define SIMPLE8B_MAX_ELEMS 240
 
 #define safeInt64Add(a, b) (((a >= 0) && (b <= INT64_MAX - a)) || ((a < 0) && (b >= INT64_MIN - a)))
 #define ZIGZAG_ENCODE(T, v) ((u##T)((v) >> (sizeof(T) * 8 - 1))) ^ (((u##T)(v)) << 1)  // zigzag encode
 #define ZIGZAG_DECODE(T, v) ((v) >> 1) ^ -((T)((v)&1))                                 // zigzag decode
 
+// Selector value:                            0    1   2   3   4   5   6   7   8  9  10  11 12  13  14  15
+static const char bit_per_integer[] =       {0,   0,  1,  2,  3,  4,  5,  6,  7, 8, 10, 12, 15, 20, 30, 60};
+static const int  selector_to_elems[] =     {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6,  5,  4,  3,  2,  1};
+
+// Decode one simple8b word into out (room for SIMPLE8B_MAX_ELEMS values) and return the number of values it holds.
+typedef int (*__simple8b_decode_fn_t)(uint64_t w, int64_t *const prev, int64_t *const out);
+
+static FORCE_INLINE int64_t tsGetIntValue(const char *const input, const int i, const char type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      return (int64_t)(*((int8_t *)input + i));
+    case TSDB_DATA_TYPE_SMALLINT:
+      return (int64_t)(*((int16_t *)input + i));
+    case TSDB_DATA_TYPE_INT:
+      return (int64_t)(*((int32_t *)input + i));
+    default:
+      return (int64_t)(*((int64_t *)input + i));
+  }
+}
+
 /*
  * Compress Integer (Simple8B).
+ *
+ * The body is inlined once per integer type so the value loads are resolved at compile time, and the zigzag values
+ * computed while choosing the selector are kept for packing the word instead of being derived a second time.
  */
-int tsCompressINTImp(const char *const input, const int nelements, char *const output, const char type) {
-  // Selector value:              0    1   2   3   4   5   6   7   8  9  10  11
-  // 12  13  14  15
-  char bit_per_integer[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
-  int  selector_to_elems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+static FORCE_INLINE int tsCompressINTTyped(const char *const input, const int nelements, char *const output,
+                                           const char type, const int word_length) {
   char bit_to_selector[] = {0,  2,  3,  4,  5,  6,  7,  8,  9,  10, 10, 11, 11, 12, 12, 12, 13, 13, 13, 13, 13,
                             14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
                             15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15};
 
-  // get the byte limit.
-  int word_length = 0;
-  switch (type) {
-    case TSDB_DATA_TYPE_BIGINT:
-      word_length = LONG_BYTES;
-      break;
-    case TSDB_DATA_TYPE_INT:
-      word_length = INT_BYTES;
-      break;
-    case TSDB_DATA_TYPE_SMALLINT:
-      word_length = SHORT_BYTES;
-      break;
-    case TSDB_DATA_TYPE_TINYINT:
-      word_length = CHAR_BYTES;
-      break;
-    default:
-      uError("Invalid compress integer type:%d", type);
-      return -1;
-  }
-
-  int     byte_limit = nelements * word_length + 1;
-  int     opos = 1;
-  int64_t prev_value = 0;
+  int      byte_limit = nelements * word_length + 1;
+  int      opos = 1;
+  int64_t  prev_value = 0;
+  uint64_t zigzag_values[SIMPLE8B_MAX_ELEMS];
 
   for (int i = 0; i < nelements;) {
     char    selector = 0;
@@ -105,21 +118,7 @@ int tsCompressINTImp(const char *const input, const int nelements, char *const o
 
     for (int j = i; j < nelements; j++) {
       // Read data from the input stream and convert it to INT64 type.
-      int64_t curr_value = 0;
-      switch (type) {
-        case TSDB_DATA_TYPE_TINYINT:
-          curr_value = (int64_t)(*((int8_t *)input + j));
-          break;
-        case TSDB_DATA_TYPE_SMALLINT:
-          curr_value = (int64_t)(*((int16_t *)input + j));
-          break;
-        case TSDB_DATA_TYPE_INT:
-          curr_value = (int64_t)(*((int32_t *)input + j));
-          break;
-        case TSDB_DATA_TYPE_BIGINT:
-          curr_value = (int64_t)(*((int64_t *)input + j));
-          break;
-      }
+      int64_t curr_value = tsGetIntValue(input, j, type);
       // Get difference.
       if (!safeInt64Add(curr_value, -prev_value)) goto _copy_and_exit;
 
@@ -140,7 +139,7 @@ int tsCompressINTImp(const char *const input, const int nelements, char *const o
       if (elems + 1 <= selector_to_elems[(int)selector] && elems + 1 <= selector_to_elems[(int)(bit_to_selector[(int)tmp_bit])]) {
         // If can hold another one.
         selector = selector > bit_to_selector[(int)tmp_bit] ? selector : bit_to_selector[(int)tmp_bit];
-        elems++;
+        zigzag_values[elems++] = zigzag_value;
         bit = bit_per_integer[(int)selector];
       } else {
         // if cannot hold another one.
@@ -155,27 +154,10 @@ int tsCompressINTImp(const char *const input, const int nelements, char *const o
     uint64_t buffer = 0;
     buffer |= (uint64_t)selector;
     for (int k = 0; k < elems; k++) {
-      int64_t curr_value = 0; /* get current values */
-      switch (type) {
-        case TSDB_DATA_TYPE_TINYINT:
-          curr_value = (int64_t)(*((int8_t *)input + i));
-          break;
-        case TSDB_DATA_TYPE_SMALLINT:
-          curr_value = (int64_t)(*((int16_t *)input + i));
-          break;
-        case TSDB_DATA_TYPE_INT:
-          curr_value = (int64_t)(*((int32_t *)input + i));
-          break;
-        case TSDB_DATA_TYPE_BIGINT:
-          curr_value = (int64_t)(*((int64_t *)input + i));
-          break;
-      }
-      int64_t  diff = curr_value - prev_value;
-      uint64_t zigzag_value = ZIGZAG_ENCODE(int64_t, diff);
-      buffer |= ((zigzag_value & INT64MASK(bit)) << (bit * k + 4));
-      i++;
-      prev_value = curr_value;
+      buffer |= ((zigzag_values[k] & INT64MASK(bit)) << (bit * k + 4));
     }
+    i += elems;
+    prev_value = tsGetIntValue(input, i - 1, type);
 
     // Output the encoded value to the output.
     if (opos + sizeof(buffer) <= byte_limit) {
@@ -194,6 +176,112 @@ int tsCompressINTImp(const char *const input, const int nelements, char *const o
   return opos;
 }
 
+int tsCompressINTImp(const char *const input, const int nelements, char *const output, const char type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_BIGINT:
+      return tsCompressINTTyped(input, nelements, output, TSDB_DATA_TYPE_BIGINT, LONG_BYTES);
+    case TSDB_DATA_TYPE_INT:
+      return tsCompressINTTyped(input, nelements, output, TSDB_DATA_TYPE_INT, INT_BYTES);
+    case TSDB_DATA_TYPE_SMALLINT:
+      return tsCompressINTTyped(input, nelements, output, TSDB_DATA_TYPE_SMALLINT, SHORT_BYTES);
+    case TSDB_DATA_TYPE_TINYINT:
+      return tsCompressINTTyped(input, nelements, output, TSDB_DATA_TYPE_TINYINT, CHAR_BYTES);
+    default:
+      uError("Invalid compress integer type:%d", type);
+      return -1;
+  }
+}
+
+static int tsDecodeSimple8bWord(uint64_t w, int64_t *const prev, int64_t *const out) {
+  int     selector = (int)(w & INT64MASK(4));
+  int     elems = selector_to_elems[selector];
+  int64_t prev_value = *prev;
+
+  if (selector == 0 || selector == 1) {
+    // A run of zero differences.
+    for (int i = 0; i < elems; i++) out[i] = prev_value;
+    return elems;
+  }
+
+  int      bit = bit_per_integer[selector];
+  uint64_t mask = INT64MASK(bit);
+  w >>= 4;
+  for (int i = 0; i < elems; i++) {
+    uint64_t zigzag_value = (w >> (bit * i)) & mask;
+    prev_value += ZIGZAG_DECODE(int64_t, zigzag_value);
+    out[i] = prev_value;
+  }
+
+  *prev = prev_value;
+  return elems;
+}
+
+#ifdef TD_COMP_X86_SIMD
+/*
+ * AVX2 version of tsDecodeSimple8bWord: four values are shifted out of the word at once with per-lane variable
+ * shifts, zigzag decoded and turned into absolute values by an in-register prefix sum.
+ */
+__attribute__((target("avx2"))) static int tsDecodeSimple8bWordAVX2(uint64_t w, int64_t *const prev,
+                                                                     int64_t *const out) {
+  int selector = (int)(w & INT64MASK(4));
+  int elems = selector_to_elems[selector];
+
+  if (selector == 0 || selector == 1) {
+    __m256i vprev = _mm256_set1_epi64x(*prev);
+    for (int i = 0; i < elems; i += 4) _mm256_storeu_si256((__m256i *)(out + i), vprev);
+    return elems;
+  }
+
+  if (elems < 4) return tsDecodeSimple8bWord(w, prev, out);
+
+  int      bit = bit_per_integer[selector];
+  uint64_t mask = INT64MASK(bit);
+  w >>= 4;
+
+  __m256i vword = _mm256_set1_epi64x((int64_t)w);
+  __m256i vmask = _mm256_set1_epi64x((int64_t)mask);
+  __m256i vshift = _mm256_setr_epi64x(0, bit, 2 * bit, 3 * bit);
+  __m256i vstep = _mm256_set1_epi64x(4 * bit);
+  __m256i vone = _mm256_set1_epi64x(1);
+  __m256i vzero = _mm256_setzero_si256();
+  __m256i vprev = _mm256_set1_epi64x(*prev);
+
+  int i = 0;
+  for (; i + 4 <= elems; i += 4) {
+    __m256i v = _mm256_and_si256(_mm256_srlv_epi64(vword, vshift), vmask);
+    v = _mm256_xor_si256(_mm256_srli_epi64(v, 1), _mm256_sub_epi64(vzero, _mm256_and_si256(v, vone)));
+    // [d0, d1, d2, d3] -> [d0, d0+d1, d0+d1+d2, d0+d1+d2+d3]
+    v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0)), vzero, 0x03));
+    v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 0, 0)), vzero, 0x0F));
+    v = _mm256_add_epi64(v, vprev);
+    _mm256_storeu_si256((__m256i *)(out + i), v);
+    vprev = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+    vshift = _mm256_add_epi64(vshift, vstep);
+  }
+
+  int64_t prev_value = out[i - 1];
+  for (; i < elems; i++) {
+    uint64_t zigzag_value = (w >> (bit * i)) & mask;
+    prev_value += ZIGZAG_DECODE(int64_t, zigzag_value);
+    out[i] = prev_value;
+  }
+
+  *prev = prev_value;
+  return elems;
+}
+#endif
+
+static __simple8b_decode_fn_t tsDecodeSimple8bWordFp = tsDecodeSimple8bWord;
+
+void taosResolveCompression() {
+#ifdef TD_COMP_X86_SIMD
+  __builtin_cpu_init();
+  tsDecodeSimple8bWordFp = __builtin_cpu_supports("avx2") ? tsDecodeSimple8bWordAVX2 : tsDecodeSimple8bWord;
+#else
+  tsDecodeSimple8bWordFp = tsDecodeSimple8bWord;
+#endif
+}
+
 int tsDecompressINTImp(const char *const input, const int nelements, char *const output, const char type) {
   int word_length = 0;
   switch (type) {
@@ -220,63 +308,42 @@ int tsDecompressINTImp(const char *const input, const int nelements, char *const
     return nelements * word_length;
   }
 
-  // Selector value:              0    1   2   3   4   5   6   7   8  9  10  11
-  // 12  13  14  15
-  char bit_per_integer[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
-  int  selector_to_elems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+  __simple8b_decode_fn_t decodeFp = tsDecodeSimple8bWordFp;
 
   const char *ip = input + 1;
   int         count = 0;
-  int         _pos = 0;
   int64_t     prev_value = 0;
+  int64_t     values[SIMPLE8B_MAX_ELEMS];
 
-  while (1) {
-    if (count == nelements) break;
-
+  while (count < nelements) {
     uint64_t w = 0;
     memcpy(&w, ip, LONG_BYTES);
+    ip += LONG_BYTES;
 
-    char selector = (char)(w & INT64MASK(4));  // selector = 4
-    char bit = bit_per_integer[(int)selector];      // bit = 3
-    int  elems = selector_to_elems[(int)selector];
+    // Bigint values are decoded in place as long as a whole word still fits in the output.
+    if (type == TSDB_DATA_TYPE_BIGINT && nelements - count >= SIMPLE8B_MAX_ELEMS) {
+      count += (*decodeFp)(w, &prev_value, (int64_t *)output + count);
+      continue;
+    }
 
-    for (int i = 0; i < elems; i++) {
-      uint64_t zigzag_value;
+    int elems = (*decodeFp)(w, &prev_value, values);
+    if (elems > nelements - count) elems = nelements - count;
 
-      if (selector == 0 || selector == 1) {
-        zigzag_value = 0;
-      } else {
-        zigzag_value = ((w >> (4 + bit * i)) & INT64MASK(bit));
-      }
-      int64_t diff = ZIGZAG_DECODE(int64_t, zigzag_value);
-      int64_t curr_value = diff + prev_value;
-      prev_value = curr_value;
-
-      switch (type) {
-        case TSDB_DATA_TYPE_BIGINT:
-          *((int64_t *)output + _pos) = (int64_t)curr_value;
-          _pos++;
-          break;
-        case TSDB_DATA_TYPE_INT:
-          *((int32_t *)output + _pos) = (int32_t)curr_value;
-          _pos++;
-          break;
-        case TSDB_DATA_TYPE_SMALLINT:
-          *((int16_t *)output + _pos) = (int16_t)curr_value;
-          _pos++;
-          break;
-        case TSDB_DATA_TYPE_TINYINT:
-          *((int8_t *)output + _pos) = (int8_t)curr_value;
-          _pos++;
-          break;
-        default:
-          perror("Wrong integer types.\n");
-          return -1;
-      }
-      count++;
-      if (count == nelements) break;
+    switch (type) {
+      case TSDB_DATA_TYPE_BIGINT:
+        memcpy((int64_t *)output + count, values, elems * LONG_BYTES);
+        break;
+      case TSDB_DATA_TYPE_INT:
+        for (int i = 0; i < elems; i++) *((int32_t *)output + count + i) = (int32_t)values[i];
+        break;
+      case TSDB_DATA_TYPE_SMALLINT:
+        for (int i = 0; i < elems; i++) *((int16_t *)output + count + i) = (int16_t)values[i];
+        break;
+      case TSDB_DATA_TYPE_TINYINT:
+        for (int i = 0; i < elems; i++) *((int8_t *)output + count + i) = (int8_t)values[i];
+        break;
     }
-    ip += LONG_BYTES;
+    count += elems;
   }
 
   return nelements * word_length;
@@ -429,6 +496,73 @@ int tsDecompressStringImp(const char *const input, int compressedSize, char *con
   }
 }
 
+// zlib is the compressor of cold data, where the compression ratio matters more than the speed. The level is
+// tsColdCompLevel.
+static int tsCompressZlibImp(const char *const input, int inputSize, char *const output, int outputSize) {
+  uLongf len = (uLongf)(outputSize - 1);
+  int    code = compress2((Bytef *)(output + 1), &len, (const Bytef *)input, (uLong)inputSize, tsColdCompLevel);
+
+  // If cannot compress or after compression, data becomes larger.
+  if (code != Z_OK || len > (uLongf)inputSize) {
+    output[0] = 0;
+    memcpy(output + 1, input, inputSize);
+    return inputSize + 1;
+  }
+
+  output[0] = 1;
+  return (int)len + 1;
+}
+
+static int tsDecompressZlibImp(const char *const input, int compressedSize, char *const output, int outputSize) {
+  if (input[0] == 1) {
+    uLongf len = (uLongf)outputSize;
+    int    code = uncompress((Bytef *)output, &len, (const Bytef *)(input + 1), (uLong)(compressedSize - 1));
+    if (code != Z_OK) {
+      uError("Failed to decompress string with zlib algorithm, code:%d", code);
+      return -1;
+    }
+
+    return (int)len;
+  } else if (input[0] == 0) {
+    memcpy(output, input + 1, compressedSize - 1);
+    return compressedSize - 1;
+  } else {
+    uError("Invalid decompress string indicator:%d", input[0]);
+    return -1;
+  }
+}
+
+typedef struct {
+  int (*compress)(const char *const input, int inputSize, char *const output, int outputSize);
+  int (*decompress)(const char *const input, int compressedSize, char *const output, int outputSize);
+} SCompBackend;
+
+static SCompBackend tsCompBackends[COMP_MAX_BACKEND] = {
+    {tsCompressStringImp, tsDecompressStringImp},  // COMP_BACKEND_LZ4
+    {tsCompressZlibImp, tsDecompressZlibImp},      // COMP_BACKEND_ZLIB
+};
+
+int tsCompressGeneralImp(const char *const input, int inputSize, char *const output, int outputSize, char algorithm) {
+  int backend = COMP_BACKEND(algorithm);
+  if (backend >= COMP_MAX_BACKEND) {
+    uError("Invalid compress backend:%d", backend);
+    return -1;
+  }
+
+  return (*tsCompBackends[backend].compress)(input, inputSize, output, outputSize);
+}
+
+int tsDecompressGeneralImp(const char *const input, int compressedSize, char *const output, int outputSize,
+                           char algorithm) {
+  int backend = COMP_BACKEND(algorithm);
+  if (backend >= COMP_MAX_BACKEND) {
+    uError("Invalid decompress backend:%d", backend);
+    return -1;
+  }
+
+  return (*tsCompBackends[backend].decompress)(input, compressedSize, output, outputSize);
+}
+
 /* --------------------------------------------Timestamp Compression
  * ---------------------------------------------- */
 // TODO: Take care here, we assumes little endian encoding.
@@ -524,6 +658,19 @@ _exit_over:
   return nelements * LONG_BYTES + 1;
 }
 
+// Count the zero bytes at the head of p, looking at n bytes at most.
+static FORCE_INLINE int tsCountZeroBytes(const char *const p, const int n) {
+  int i = 0;
+#ifdef TD_COMP_X86_SIMD
+  for (; i + 16 <= n; i += 16) {
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + i)), _mm_setzero_si128()));
+    if (mask != 0xFFFF) return i + __builtin_ctz(~mask & 0xFFFF);
+  }
+#endif
+  while (i < n && p[i] == 0) i++;
+  return i;
+}
+
 int tsDecompressTimestampImp(const char *const input, const int nelements, char *const output) {
   assert(nelements >= 0);
   if (nelements == 0) return 0;
@@ -541,6 +688,21 @@ int tsDecompressTimestampImp(const char *const input, const int nelements, char
     int64_t delta_of_delta = 0;
 
     while (1) {
+      if (opos > 0 && input[ipos] == 0) {
+        // A run of zero flag bytes keeps the delta unchanged, which is what regularly sampled data looks like. Each
+        // remaining pair still owns at least its flag byte, so the scan never reads past the compressed stream.
+        int npairs = tsCountZeroBytes(input + ipos, (nelements - opos + 1) / 2);
+        int nvalues = MIN(npairs * 2, nelements - opos);
+        for (int i = 0; i < nvalues; i++) {
+          ostream[opos + i] = (int64_t)((uint64_t)prev_value + (uint64_t)prev_delta * (i + 1));
+        }
+        opos += nvalues;
+        ipos += npairs;
+        if (opos == nelements) return nelements * LONG_BYTES;
+        prev_value = ostream[opos - 1];
+        continue;
+      }
+
       uint8_t flags = input[ipos++];
       // Decode dd1
       uint64_t dd1 = 0;
@@ -886,3 +1048,181 @@ int tsDecompressFloatImp(const char *const input, const int nelements, char *con
 
   return nelements * FLOAT_BYTES;
 }
+
+/* ----------------------------------------------Gorilla Float Compression
+ * ---------------------------------------------- */
+/*
+ * Each value is XOR-ed with its predecessor like in Gorilla, but instead of control bits per value, the window of
+ * meaningful bits is shared by a group of GORILLA_GROUP_ELEMS values and written once in the group header:
+ *
+ *   | trailing zeros (1 byte) | meaningful bits (1 byte) | meaningful bits of each XOR-ed value, bit packed |
+ *
+ * so the values of a group are packed and unpacked with the same shift and width, without branching on each value.
+ * The output starts with an indicator byte (1 for encoded, 0 for copied as it is) and the first value as it is.
+ */
+#define GORILLA_GROUP_ELEMS 16
+#define GORILLA_MAX_FAST_WIDTH 56  // widest field that always fits in an unaligned 8-byte window
+#define GORILLA_GROUP_BUF_SIZE (2 + GORILLA_GROUP_ELEMS * LONG_BYTES + LONG_BYTES)
+
+static FORCE_INLINE uint64_t tsGorillaGetValue(const char *const input, const int i, const int wordBytes) {
+  if (wordBytes == FLOAT_BYTES) {
+    uint32_t v;
+    memcpy(&v, input + i * FLOAT_BYTES, FLOAT_BYTES);
+    return v;
+  } else {
+    uint64_t v;
+    memcpy(&v, input + i * LONG_BYTES, LONG_BYTES);
+    return v;
+  }
+}
+
+static FORCE_INLINE void tsGorillaSetValue(char *const output, const int i, const uint64_t v, const int wordBytes) {
+  if (wordBytes == FLOAT_BYTES) {
+    uint32_t t = (uint32_t)v;
+    memcpy(output + i * FLOAT_BYTES, &t, FLOAT_BYTES);
+  } else {
+    memcpy(output + i * LONG_BYTES, &v, LONG_BYTES);
+  }
+}
+
+// Or v at bit offset pos of buf, the 8 bytes at pos / 8 must be addressable and v no wider than 57 bits.
+static FORCE_INLINE void tsGorillaPutBits(char *const buf, const int pos, const uint64_t v) {
+  uint64_t w;
+  memcpy(&w, buf + (pos >> 3), LONG_BYTES);
+  w |= v << (pos & 7);
+  memcpy(buf + (pos >> 3), &w, LONG_BYTES);
+}
+
+static FORCE_INLINE uint64_t tsGorillaGetBits(const char *const buf, const int pos, const uint64_t mask) {
+  uint64_t w;
+  memcpy(&w, buf + (pos >> 3), LONG_BYTES);
+  return (w >> (pos & 7)) & mask;
+}
+
+static FORCE_INLINE int tsCompressGorillaImp(const char *const input, const int nelements, char *const output,
+                                             const int wordBytes) {
+  int      byte_limit = nelements * wordBytes + 1;
+  int      opos = 1 + wordBytes;
+  uint64_t prev_value = tsGorillaGetValue(input, 0, wordBytes);
+  uint64_t xors[GORILLA_GROUP_ELEMS];
+  char     group[GORILLA_GROUP_BUF_SIZE];
+
+  memcpy(output + 1, input, wordBytes);
+
+  for (int i = 1; i < nelements; i += GORILLA_GROUP_ELEMS) {
+    int      nvalues = MIN(GORILLA_GROUP_ELEMS, nelements - i);
+    uint64_t bits = 0;
+
+    for (int k = 0; k < nvalues; k++) {
+      uint64_t curr_value = tsGorillaGetValue(input, i + k, wordBytes);
+      xors[k] = curr_value ^ prev_value;
+      bits |= xors[k];
+      prev_value = curr_value;
+    }
+
+    int trailing = (bits == 0) ? 0 : BUILDIN_CTZL(bits);
+    int width = (bits == 0) ? 0 : (LONG_BYTES * BITS_PER_BYTE - BUILDIN_CLZL(bits) - trailing);
+    int nbytes = 2 + (nvalues * width + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+
+    if (opos + nbytes >= byte_limit) goto _copy_and_exit;
+
+    memset(group, 0, nbytes + LONG_BYTES);
+    group[0] = (char)trailing;
+    group[1] = (char)width;
+    if (width <= GORILLA_MAX_FAST_WIDTH) {
+      for (int k = 0, pos = 16; k < nvalues; k++, pos += width) {
+        tsGorillaPutBits(group, pos, xors[k] >> trailing);
+      }
+    } else {
+      // Too wide for one 8-byte window, write the lower 32 bits and the rest separately.
+      for (int k = 0, pos = 16; k < nvalues; k++, pos += width) {
+        uint64_t v = xors[k] >> trailing;
+        tsGorillaPutBits(group, pos, v & INT64MASK(32));
+        tsGorillaPutBits(group, pos + 32, v >> 32);
+      }
+    }
+
+    memcpy(output + opos, group, nbytes);
+    opos += nbytes;
+  }
+
+  output[0] = 1;
+  return opos;
+
+_copy_and_exit:
+  output[0] = 0;
+  memcpy(output + 1, input, nelements * wordBytes);
+  return byte_limit;
+}
+
+static FORCE_INLINE int tsDecompressGorillaImp(const char *const input, const int compressedSize, const int nelements,
+                                               char *const output, const int wordBytes) {
+  if (input[0] == 0) {
+    memcpy(output, input + 1, nelements * wordBytes);
+    return nelements * wordBytes;
+  } else if (input[0] != 1) {
+    uError("Invalid decompress gorilla indicator:%d", input[0]);
+    return -1;
+  }
+
+  int      ipos = 1 + wordBytes;
+  uint64_t prev_value = tsGorillaGetValue(input + 1, 0, wordBytes);
+  char     group[GORILLA_GROUP_BUF_SIZE];
+
+  tsGorillaSetValue(output, 0, prev_value, wordBytes);
+
+  for (int i = 1; i < nelements; i += GORILLA_GROUP_ELEMS) {
+    int nvalues = MIN(GORILLA_GROUP_ELEMS, nelements - i);
+    if (ipos + 2 > compressedSize) return -1;
+
+    int trailing = (uint8_t)input[ipos];
+    int width = (uint8_t)input[ipos + 1];
+    int nbytes = 2 + (nvalues * width + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+    if (trailing + width > wordBytes * BITS_PER_BYTE || ipos + nbytes > compressedSize) return -1;
+
+    // The unaligned 8-byte reads may run over the end of the input at its last groups, so those are read from a copy.
+    const char *buf = input + ipos;
+    if (ipos + nbytes + LONG_BYTES > compressedSize) {
+      memset(group, 0, sizeof(group));
+      memcpy(group, input + ipos, nbytes);
+      buf = group;
+    }
+
+    if (width <= GORILLA_MAX_FAST_WIDTH) {
+      uint64_t mask = INT64MASK(width);
+      for (int k = 0, pos = 16; k < nvalues; k++, pos += width) {
+        prev_value ^= tsGorillaGetBits(buf, pos, mask) << trailing;
+        tsGorillaSetValue(output, i + k, prev_value, wordBytes);
+      }
+    } else {
+      int      hiWidth = width - 32;
+      uint64_t mask = INT64MASK(hiWidth);
+      for (int k = 0, pos = 16; k < nvalues; k++, pos += width) {
+        uint64_t v = tsGorillaGetBits(buf, pos, INT64MASK(32)) | (tsGorillaGetBits(buf, pos + 32, mask) << 32);
+        prev_value ^= v << trailing;
+        tsGorillaSetValue(output, i + k, prev_value, wordBytes);
+      }
+    }
+
+    ipos += nbytes;
+  }
+
+  return nelements * wordBytes;
+}
+
+int tsCompressDoubleGorillaImp(const char *const input, const int nelements, char *const output) {
+  return tsCompressGorillaImp(input, nelements, output, DOUBLE_BYTES);
+}
+
+int tsDecompressDoubleGorillaImp(const char *const input, int compressedSize, const int nelements,
+                                 char *const output) {
+  return tsDecompressGorillaImp(input, compressedSize, nelements, output, DOUBLE_BYTES);
+}
+
+int tsCompressFloatGorillaImp(const char *const input, const int nelements, char *const output) {
+  return tsCompressGorillaImp(input, nelements, output, FLOAT_BYTES);
+}
+
+int tsDecompressFloatGorillaImp(const char *const input, int compressedSize, const int nelements, char *const output) {
+  return tsDecompressGorillaImp(input, compressedSize, nelements, output, FLOAT_BYTES);
+}
@@ -19,6 +19,16 @@
 #include "tulog.h"
 #include "tutil.h"
 
+#define SL_ARENA_MIN_CHUNK_SIZE 1024
+#define SL_ARENA_MAX_CHUNK_SIZE 65536
+
+struct SSkipListArena {
+  SSkipListArena *next;
+  int32_t         size;
+  int32_t         offset;
+  char            data[];
+};
+
 static int                initForwardBackwardPtr(SSkipList *pSkipList);
 static SSkipListNode *    getPriorNode(SSkipList *pSkipList, const char *val, int32_t order, SSkipListNode **pCur);
 static void               tSkipListRemoveNodeImpl(SSkipList *pSkipList, SSkipListNode *pNode);
@@ -27,6 +37,8 @@ static SSkipListIterator *doCreateSkipListIterator(SSkipList *pSkipList, int32_t
 static void tSkipListDoInsert(SSkipList *pSkipList, SSkipListNode **direction, SSkipListNode *pNode, bool isForward);
 static bool tSkipListGetPosToPut(SSkipList *pSkipList, SSkipListNode **backward, void *pData);
 static SSkipListNode *tSkipListNewNode(uint8_t level);
+static SSkipListNode *tSkipListArenaNewNode(SSkipList *pSkipList, uint8_t level);
+static void           tSkipListArenaDestroy(SSkipList *pSkipList);
 #define tSkipListFreeNode(n) tfree((n))
 static SSkipListNode *tSkipListPutImpl(SSkipList *pSkipList, void *pData, SSkipListNode **direction, bool isForward,
                                        bool hasDup);
@@ -50,6 +62,8 @@ SSkipList *tSkipListCreate(uint8_t maxLevel, uint8_t keyType, uint16_t keyLen, _
   pSkipList->len = keyLen;
   pSkipList->flags = flags;
   pSkipList->keyFn = fn;
+  pSkipList->seed = (uint32_t)taosGetTimestampUs() ^ (uint32_t)((uintptr_t)pSkipList >> 4);
+  if (pSkipList->seed == 0) pSkipList->seed = 1;
   if (comparFn == NULL) {
     pSkipList->comparFn = getKeyComparFunc(keyType);
   } else {
@@ -88,12 +102,16 @@ void tSkipListDestroy(SSkipList *pSkipList) {
 
   tSkipListWLock(pSkipList);
 
-  SSkipListNode *pNode = SL_NODE_GET_FORWARD_POINTER(pSkipList->pHead, 0);
+  if (SL_IS_ARENA_NODE(pSkipList)) {
+    tSkipListArenaDestroy(pSkipList);
+  } else if (pSkipList->pHead != NULL) {
+    SSkipListNode *pNode = SL_NODE_GET_FORWARD_POINTER(pSkipList->pHead, 0);
 
-  while (pNode != pSkipList->pTail) {
-    SSkipListNode *pTemp = pNode;
-    pNode = SL_NODE_GET_FORWARD_POINTER(pNode, 0);
-    tSkipListFreeNode(pTemp);
+    while (pNode != pSkipList->pTail) {
+      SSkipListNode *pTemp = pNode;
+      pNode = SL_NODE_GET_FORWARD_POINTER(pNode, 0);
+      tSkipListFreeNode(pTemp);
+    }
   }
 
   tSkipListUnlock(pSkipList);
@@ -377,25 +395,27 @@ void tSkipListPrint(SSkipList *pSkipList, int16_t nlevel) {
   }
 }
 
+// The new node is fully linked before it is published to its neighbours, from the bottom level up, so a reader
+// iterating without lock either sees the node with valid pointers or does not see it at all.
 static void tSkipListDoInsert(SSkipList *pSkipList, SSkipListNode **direction, SSkipListNode *pNode, bool isForward) {
   for (int32_t i = 0; i < pNode->level; ++i) {
     SSkipListNode *x = direction[i];
     if (isForward) {
-      SL_NODE_GET_BACKWARD_POINTER(pNode, i) = x;
-
       SSkipListNode *next = SL_NODE_GET_FORWARD_POINTER(x, i);
-      SL_NODE_GET_BACKWARD_POINTER(next, i) = pNode;
 
+      SL_NODE_GET_BACKWARD_POINTER(pNode, i) = x;
       SL_NODE_GET_FORWARD_POINTER(pNode, i) = next;
-      SL_NODE_GET_FORWARD_POINTER(x, i) = pNode;
-    } else {
-      SL_NODE_GET_FORWARD_POINTER(pNode, i) = x;
 
+      atomic_store_ptr(&SL_NODE_GET_FORWARD_POINTER(x, i), pNode);
+      atomic_store_ptr(&SL_NODE_GET_BACKWARD_POINTER(next, i), pNode);
+    } else {
       SSkipListNode *prev = SL_NODE_GET_BACKWARD_POINTER(x, i);
-      SL_NODE_GET_FORWARD_POINTER(prev, i) = pNode;
 
+      SL_NODE_GET_FORWARD_POINTER(pNode, i) = x;
       SL_NODE_GET_BACKWARD_POINTER(pNode, i) = prev;
-      SL_NODE_GET_BACKWARD_POINTER(x, i) = pNode;
+
+      atomic_store_ptr(&SL_NODE_GET_FORWARD_POINTER(prev, i), pNode);
+      atomic_store_ptr(&SL_NODE_GET_BACKWARD_POINTER(x, i), pNode);
     }
   }
 
@@ -513,7 +533,8 @@ static void tSkipListRemoveNodeImpl(SSkipList *pSkipList, SSkipListNode *pNode)
     SL_NODE_GET_BACKWARD_POINTER(next, j) = prev;
   }
 
-  tSkipListFreeNode(pNode);
+  // arena nodes are released together with the skiplist
+  if (!SL_IS_ARENA_NODE(pSkipList)) tSkipListFreeNode(pNode);
   pSkipList->size--;
 }
 
@@ -541,12 +562,19 @@ UNUSED_FUNC static FORCE_INLINE void removeNodeEachLevel(SSkipList *pSkipList, i
 #endif
 }
 
+// Each level is kept with probability 1/4, drawn two bits at a time from a per-skiplist xorshift generator, which
+// avoids the global lock of rand() among concurrent writers.
 static FORCE_INLINE int32_t getSkipListNodeRandomHeight(SSkipList *pSkipList) {
-  const uint32_t factor = 4;
+  uint32_t r = pSkipList->seed;
+  r ^= r << 13;
+  r ^= r >> 17;
+  r ^= r << 5;
+  pSkipList->seed = r;
 
   int32_t n = 1;
-  while ((rand() % factor) == 0 && n <= pSkipList->maxLevel) {
+  while ((r & 0x3) == 0 && n <= pSkipList->maxLevel) {
     n++;
+    r >>= 2;
   }
 
   return n;
@@ -651,6 +679,45 @@ static SSkipListNode *tSkipListNewNode(uint8_t level) {
   return pNode;
 }
 
+// Nodes are bump allocated from the latest chunk. Chunk size doubles from a small size, so a table with few rows
+// does not hold a large chunk, while a busy table allocates in big chunks.
+static SSkipListNode *tSkipListArenaNewNode(SSkipList *pSkipList, uint8_t level) {
+  int32_t         tsize = sizeof(SSkipListNode) + sizeof(SSkipListNode *) * level * 2;
+  SSkipListArena *pArena = pSkipList->pArena;
+
+  tsize = (int32_t)ALIGN_NUM(tsize, sizeof(void *));
+  if (pArena == NULL || pArena->offset + tsize > pArena->size) {
+    int32_t size = (pArena == NULL) ? SL_ARENA_MIN_CHUNK_SIZE : MIN(pArena->size * 2, SL_ARENA_MAX_CHUNK_SIZE);
+    if (size < tsize) size = tsize;
+
+    SSkipListArena *pNew = (SSkipListArena *)malloc(sizeof(SSkipListArena) + size);
+    if (pNew == NULL) return NULL;
+
+    pNew->next = pArena;
+    pNew->size = size;
+    pNew->offset = 0;
+    pSkipList->pArena = pArena = pNew;
+  }
+
+  SSkipListNode *pNode = (SSkipListNode *)(pArena->data + pArena->offset);
+  pArena->offset += tsize;
+
+  memset(pNode, 0, tsize);
+  pNode->level = level;
+  return pNode;
+}
+
+static void tSkipListArenaDestroy(SSkipList *pSkipList) {
+  SSkipListArena *pArena = pSkipList->pArena;
+  while (pArena) {
+    SSkipListArena *pNext = pArena->next;
+    free(pArena);
+    pArena = pNext;
+  }
+
+  pSkipList->pArena = NULL;
+}
+
 static SSkipListNode *tSkipListPutImpl(SSkipList *pSkipList, void *pData, SSkipListNode **direction, bool isForward,
                                        bool hasDup) {
   uint8_t        dupMode = SL_DUP_MODE(pSkipList);
@@ -666,7 +733,8 @@ static SSkipListNode *tSkipListPutImpl(SSkipList *pSkipList, void *pData, SSkipL
       atomic_store_ptr(&(pNode->pData), pData);
     }
   } else {
-    pNode = tSkipListNewNode(getSkipListRandLevel(pSkipList));
+    uint8_t level = (uint8_t)getSkipListRandLevel(pSkipList);
+    pNode = SL_IS_ARENA_NODE(pSkipList) ? tSkipListArenaNewNode(pSkipList, level) : tSkipListNewNode(level);
     if (pNode != NULL) {
       pNode->pData = pData;
 
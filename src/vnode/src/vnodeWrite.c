@@ -91,7 +91,8 @@ int32_t vnodeProcessWrite(void *vparam, void *wparam, int32_t qtype, void *rpara
   syncCode = syncForwardToPeer(pVnode->sync, pHead, pWrite, qtype);
   if (syncCode < 0) return syncCode;
 
-  // write into WAL
+  // write into WAL. The record is only buffered, it reaches the file with the rest of the batch in walFsync after the
+  // data is applied below. A failure of that write is not seen here, it fails the responses of the whole batch
   code = walWrite(pVnode->wal, pHead);
   if (code < 0) {
     vError("vgId:%d, hver:%" PRIu64 " vver:%" PRIu64 " code:0x%x", pVnode->vgId, pHead->version, pVnode->version, code);
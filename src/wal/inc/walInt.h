@@ -21,6 +21,7 @@ extern "C" {
 #endif
 
 #include "tlog.h"
+#include "twal.h"
 
 extern int32_t wDebugFlag;
 
@@ -39,6 +40,11 @@ extern int32_t wDebugFlag;
 #define WAL_PATH_LEN   (TSDB_FILENAME_LEN + 12)
 #define WAL_FILE_LEN   (WAL_PATH_LEN + 32)
 #define WAL_FILE_NUM   1 // 3
+#define WAL_MIN_BUF_SIZE (64 * 1024)
+#define WAL_MAX_BUF_SIZE (4 * 1024 * 1024)
+#define WAL_RESTORE_BUF_SIZE    (1024 * 1024)
+#define WAL_RESTORE_QUEUE_SIZE  4
+#define WAL_RESTORE_PROGRESS_MS 5000
 
 typedef struct {
   uint64_t version;
@@ -54,12 +60,19 @@ typedef struct {
   int8_t   reserved[3];
   char     path[WAL_PATH_LEN];
   char     name[WAL_FILE_LEN];
+  char *   buffer;      // records not written into file yet, flushed by one write call per batch
+  int32_t  bufSize;
+  int32_t  bufLen;
+  int32_t  bufNum;
+  int64_t  firstUs;     // time when the first record of current batch is written
+  SWalStat stat;
   pthread_mutex_t mutex;
 } SWal;
 
 int32_t walGetNextFile(SWal *pWal, int64_t *nextFileId);
 int32_t walGetOldFile(SWal *pWal, int64_t curFileId, int32_t minDiff, int64_t *oldFileId);
 int32_t walGetNewFile(SWal *pWal, int64_t *newFileId);
+int32_t walFlush(SWal *pWal);
 
 #ifdef __cplusplus
 }
@@ -125,8 +125,12 @@ void walClose(void *handle) {
 
   SWal *pWal = handle;
   pthread_mutex_lock(&pWal->mutex);
+  walFlush(pWal);
   tfClose(pWal->tfd);
   pthread_mutex_unlock(&pWal->mutex);
+
+  wDebug("vgId:%d, wal:%p is closed, batches:%" PRId64 " records:%" PRId64 " fsyncs:%" PRId64, pWal->vgId, pWal,
+         pWal->stat.numOfBatches, pWal->stat.numOfRecords, pWal->stat.numOfFsyncs);
   taosRemoveRef(tsWal.refId, pWal->rid);
 }
 
@@ -146,6 +150,7 @@ static void walFreeObj(void *wal) {
 
   tfClose(pWal->tfd);
   pthread_mutex_destroy(&pWal->mutex);
+  tfree(pWal->buffer);
   tfree(pWal);
 }
 
@@ -171,6 +176,11 @@ static void walUpdateSeq() {
 static void walFsyncAll() {
   SWal *pWal = taosIterateRef(tsWal.refId, 0);
   while (pWal) {
+    // in case the writer does not call walFsync after a batch
+    pthread_mutex_lock(&pWal->mutex);
+    walFlush(pWal);
+    pthread_mutex_unlock(&pWal->mutex);
+
     if (walNeedFsync(pWal)) {
       wTrace("vgId:%d, do fsync, level:%d seq:%d rseq:%d", pWal->vgId, pWal->level, pWal->fsyncSeq, tsWal.seq);
       int32_t code = tfFsync(pWal->tfd);
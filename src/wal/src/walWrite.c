@@ -38,6 +38,7 @@ int32_t walRenew(void *handle) {
   pthread_mutex_lock(&pWal->mutex);
 
   if (tfValid(pWal->tfd)) {
+    walFlush(pWal);
     tfClose(pWal->tfd);
     wDebug("vgId:%d, file:%s, it is closed", pWal->vgId, pWal->name);
   }
@@ -107,6 +108,79 @@ void walRemoveAllOldFiles(void *handle) {
   pthread_mutex_unlock(&pWal->mutex);
 }
 
+static void walAddToHist(int64_t *hist, int64_t value) {
+  int32_t bucket = 0;
+  while (value > 1 && bucket < WAL_STAT_BUCKETS - 1) {
+    value >>= 1;
+    bucket++;
+  }
+
+  hist[bucket]++;
+}
+
+static int32_t walAppendToBuffer(SWal *pWal, SWalHead *pHead, int32_t contLen) {
+  if (pWal->bufLen + contLen > WAL_MAX_BUF_SIZE) {
+    int32_t code = walFlush(pWal);
+    if (code != TSDB_CODE_SUCCESS) return code;
+  }
+
+  // a record larger than the buffer is written directly
+  if (contLen > WAL_MAX_BUF_SIZE) {
+    if (tfWrite(pWal->tfd, pHead, contLen) != contLen) {
+      return TAOS_SYSTEM_ERROR(errno);
+    }
+
+    pWal->stat.numOfBatches++;
+    pWal->stat.numOfRecords++;
+    walAddToHist(pWal->stat.batchSize, 1);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (pWal->bufLen + contLen > pWal->bufSize) {
+    int32_t size = MAX(pWal->bufSize, WAL_MIN_BUF_SIZE);
+    while (size < pWal->bufLen + contLen) size *= 2;
+    size = MIN(size, WAL_MAX_BUF_SIZE);
+
+    char *buffer = realloc(pWal->buffer, size);
+    if (buffer == NULL) {
+      return TSDB_CODE_WAL_OUT_OF_MEMORY;
+    }
+
+    pWal->buffer = buffer;
+    pWal->bufSize = size;
+  }
+
+  memcpy(pWal->buffer + pWal->bufLen, pHead, contLen);
+  pWal->bufLen += contLen;
+  pWal->bufNum++;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// write the buffered records into file by one write call, mutex shall be locked by the caller
+int32_t walFlush(SWal *pWal) {
+  if (pWal->bufLen == 0) return TSDB_CODE_SUCCESS;
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (tfWrite(pWal->tfd, pWal->buffer, pWal->bufLen) != pWal->bufLen) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    wError("vgId:%d, file:%s, failed to write %d records since %s", pWal->vgId, pWal->name, pWal->bufNum,
+           strerror(errno));
+  } else {
+    wTrace("vgId:%d, fileId:%" PRId64 ", %d records are written, len:%d", pWal->vgId, pWal->fileId, pWal->bufNum,
+           pWal->bufLen);
+  }
+
+  pWal->stat.numOfBatches++;
+  pWal->stat.numOfRecords += pWal->bufNum;
+  walAddToHist(pWal->stat.batchSize, pWal->bufNum);
+
+  pWal->bufLen = 0;
+  pWal->bufNum = 0;
+
+  return code;
+}
+
 int32_t walWrite(void *handle, SWalHead *pHead) {
   if (handle == NULL) return -1;
 
@@ -124,9 +198,12 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
 
   pthread_mutex_lock(&pWal->mutex);
 
-  if (tfWrite(pWal->tfd, pHead, contLen) != contLen) {
-    code = TAOS_SYSTEM_ERROR(errno);
-    wError("vgId:%d, file:%s, failed to write since %s", pWal->vgId, pWal->name, strerror(errno));
+  if (pWal->bufLen == 0 && pWal->firstUs == 0) pWal->firstUs = taosGetTimestampUs();
+
+  // the record is buffered, and written into file with the other records of the batch in walFsync
+  code = walAppendToBuffer(pWal, pHead, contLen);
+  if (code != TSDB_CODE_SUCCESS) {
+    wError("vgId:%d, file:%s, failed to write since %s", pWal->vgId, pWal->name, tstrerror(code));
   } else {
     wTrace("vgId:%d, write wal, fileId:%" PRId64 " tfd:%" PRId64 " hver:%" PRId64 " wver:%" PRIu64 " len:%d", pWal->vgId,
            pWal->fileId, pWal->tfd, pHead->version, pWal->version, pHead->len);
@@ -140,16 +217,46 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
   return code;
 }
 
-void walFsync(void *handle, bool forceFsync) {
+/*
+ * Called once for a batch of write requests: the buffered records are written by one write call and synced by one
+ * fsync, then all the requests of the batch can be responded together.
+ */
+int32_t walFsync(void *handle, bool forceFsync) {
   SWal *pWal = handle;
-  if (pWal == NULL || !tfValid(pWal->tfd)) return;
+  if (pWal == NULL || !tfValid(pWal->tfd)) return 0;
 
-  if (forceFsync || (pWal->level == TAOS_WAL_FSYNC && pWal->fsyncPeriod == 0)) {
+  pthread_mutex_lock(&pWal->mutex);
+  int32_t code = walFlush(pWal);
+  int64_t firstUs = pWal->firstUs;
+  pWal->firstUs = 0;
+  pthread_mutex_unlock(&pWal->mutex);
+
+  bool doFsync = forceFsync || (pWal->level == TAOS_WAL_FSYNC && pWal->fsyncPeriod == 0);
+  if (code == TSDB_CODE_SUCCESS && doFsync) {
     wTrace("vgId:%d, fileId:%" PRId64 ", do fsync", pWal->vgId, pWal->fileId);
     if (tfFsync(pWal->tfd) < 0) {
+      code = TAOS_SYSTEM_ERROR(errno);
       wError("vgId:%d, fileId:%" PRId64 ", fsync failed since %s", pWal->vgId, pWal->fileId, strerror(errno));
     }
   }
+
+  if (firstUs != 0) {
+    pthread_mutex_lock(&pWal->mutex);
+    if (doFsync) pWal->stat.numOfFsyncs++;
+    walAddToHist(pWal->stat.latency, taosGetTimestampUs() - firstUs);
+    pthread_mutex_unlock(&pWal->mutex);
+  }
+
+  return code;
+}
+
+void walGetStat(void *handle, SWalStat *pStat) {
+  SWal *pWal = handle;
+  if (pWal == NULL) return;
+
+  pthread_mutex_lock(&pWal->mutex);
+  *pStat = pWal->stat;
+  pthread_mutex_unlock(&pWal->mutex);
 }
 
 int32_t walRestore(void *handle, void *pVnode, FWalWrite writeFp) {
@@ -206,6 +313,9 @@ int32_t walGetWalFile(void *handle, char *fileName, int64_t *fileId) {
 
   pthread_mutex_lock(&(pWal->mutex));
 
+  // the records shall be in file before it is retrieved by peers
+  walFlush(pWal);
+
   int32_t code = walGetNextFile(pWal, fileId);
   if (code >= 0) {
     sprintf(fileName, "wal/%s%" PRId64, WAL_PREFIX, *fileId);
@@ -223,116 +333,298 @@ static void walFtruncate(SWal *pWal, int64_t tfd, int64_t offset) {
   tfFsync(tfd);
 }
 
-static int32_t walSkipCorruptedRecord(SWal *pWal, SWalHead *pHead, int64_t tfd, int64_t *offset) {
-  int64_t pos = *offset;
-  while (1) {
-    pos++;
+/*
+ * The wal file is restored by a pipeline: the reader thread reads the file in large chunks, checks the head of each
+ * record and packs the complete records into batches, while the calling thread applies the batches in order.
+ */
+typedef struct SWalRestoreBatch {
+  struct SWalRestoreBatch *next;
+  char *   buffer;
+  int32_t  size;
+  int32_t  numOfRecords;
+  int32_t  maxRecords;
+  int32_t *offsets;     // offset of each record in buffer
+  int64_t  endOffset;   // file offset after the last record
+} SWalRestoreBatch;
+
+typedef struct {
+  SWal *            pWal;
+  char *            name;
+  int64_t           tfd;
+  int64_t           truncOffset;  // the file is truncated at this offset if it is not -1
+  int32_t           code;
+  int32_t           numOfBatches;
+  bool              threaded;
+  bool              eof;
+  SWalRestoreBatch *head;
+  SWalRestoreBatch *tail;
+  pthread_mutex_t   mutex;
+  pthread_cond_t    cond;
+} SWalRestore;
+
+static SWalRestoreBatch *walAllocRestoreBatch(int32_t size) {
+  SWalRestoreBatch *pBatch = tcalloc(1, sizeof(SWalRestoreBatch));
+  if (pBatch == NULL) return NULL;
+
+  pBatch->buffer = tmalloc(size);
+  if (pBatch->buffer == NULL) {
+    tfree(pBatch);
+    return NULL;
+  }
 
-    if (tfLseek(tfd, pos, SEEK_SET) < 0) {
-      wError("vgId:%d, failed to seek from corrupted wal file since %s", pWal->vgId, strerror(errno));
-      return TSDB_CODE_WAL_FILE_CORRUPTED;
-    }
+  pBatch->size = size;
+  return pBatch;
+}
 
-    if (tfRead(tfd, pHead, sizeof(SWalHead)) <= 0) {
-      wError("vgId:%d, read to end of corrupted wal file, offset:%" PRId64, pWal->vgId, pos);
-      return TSDB_CODE_WAL_FILE_CORRUPTED;
-    }
+static void walFreeRestoreBatch(SWalRestoreBatch *pBatch) {
+  if (pBatch == NULL) return;
 
-    if (pHead->signature != WAL_SIGNATURE) {
-      continue;
-    }
+  tfree(pBatch->offsets);
+  tfree(pBatch->buffer);
+  tfree(pBatch);
+}
 
-    if (taosCheckChecksumWhole((uint8_t *)pHead, sizeof(SWalHead))) {
-      wInfo("vgId:%d, wal head cksum check passed, offset:%" PRId64, pWal->vgId, pos);
-      *offset = pos;
-      return TSDB_CODE_SUCCESS;
-    }
+static int32_t walAddToRestoreBatch(SWalRestoreBatch *pBatch, int32_t offset) {
+  if (pBatch->numOfRecords >= pBatch->maxRecords) {
+    int32_t  maxRecords = MAX(pBatch->maxRecords * 2, 64);
+    int32_t *offsets = realloc(pBatch->offsets, maxRecords * sizeof(int32_t));
+    if (offsets == NULL) return TSDB_CODE_WAL_OUT_OF_MEMORY;
+
+    pBatch->offsets = offsets;
+    pBatch->maxRecords = maxRecords;
   }
 
-  return TSDB_CODE_WAL_FILE_CORRUPTED;
+  pBatch->offsets[pBatch->numOfRecords++] = offset;
+  return TSDB_CODE_SUCCESS;
 }
 
-static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, char *name, int64_t fileId) {
-  int32_t size = WAL_MAX_SIZE;
-  void *  buffer = tmalloc(size);
-  if (buffer == NULL) {
-    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
-    return TAOS_SYSTEM_ERROR(errno);
+static void walPushRestoreBatch(SWalRestore *pRestore, SWalRestoreBatch *pBatch) {
+  pthread_mutex_lock(&pRestore->mutex);
+
+  // the reader shall not go too far ahead of the applier
+  while (pRestore->threaded && pRestore->numOfBatches >= WAL_RESTORE_QUEUE_SIZE) {
+    pthread_cond_wait(&pRestore->cond, &pRestore->mutex);
   }
 
-  int64_t tfd = tfOpen(name, O_RDWR);
-  if (!tfValid(tfd)) {
-    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
-    tfree(buffer);
-    return TAOS_SYSTEM_ERROR(errno);
+  if (pRestore->tail == NULL) {
+    pRestore->head = pBatch;
+  } else {
+    pRestore->tail->next = pBatch;
   }
 
-  int32_t   code = TSDB_CODE_SUCCESS;
-  int64_t   offset = 0;
-  SWalHead *pHead = buffer;
+  pRestore->tail = pBatch;
+  pRestore->numOfBatches++;
 
-  while (1) {
-    int32_t ret = (int32_t)tfRead(tfd, pHead, sizeof(SWalHead));
-    if (ret == 0) break;
+  pthread_cond_broadcast(&pRestore->cond);
+  pthread_mutex_unlock(&pRestore->mutex);
+}
 
+static SWalRestoreBatch *walPopRestoreBatch(SWalRestore *pRestore) {
+  pthread_mutex_lock(&pRestore->mutex);
+
+  while (pRestore->head == NULL && !pRestore->eof) {
+    pthread_cond_wait(&pRestore->cond, &pRestore->mutex);
+  }
+
+  SWalRestoreBatch *pBatch = pRestore->head;
+  if (pBatch != NULL) {
+    pRestore->head = pBatch->next;
+    if (pRestore->head == NULL) pRestore->tail = NULL;
+    pRestore->numOfBatches--;
+    pthread_cond_broadcast(&pRestore->cond);
+  }
+
+  pthread_mutex_unlock(&pRestore->mutex);
+  return pBatch;
+}
+
+static bool walIsValidHead(SWalHead *pHead) {
+  return pHead->signature == WAL_SIGNATURE && taosCheckChecksumWhole((uint8_t *)pHead, sizeof(SWalHead)) &&
+         pHead->len >= 0 && pHead->len <= WAL_MAX_SIZE - sizeof(SWalHead);
+}
+
+static void *walReadWalFile(void *param) {
+  SWalRestore *pRestore = param;
+  SWal *       pWal = pRestore->pWal;
+  int32_t      len = 0;             // bytes in the buffer of current batch
+  int32_t      pos = 0;             // the first byte not packed into current batch
+  int64_t      offset = 0;          // file offset of the buffer of current batch
+  int64_t      corruptOffset = -1;  // file offset of the corrupted record being skipped
+  bool         eof = false;
+
+  SWalRestoreBatch *pBatch = walAllocRestoreBatch(WAL_RESTORE_BUF_SIZE);
+  if (pBatch == NULL) {
+    pRestore->code = TSDB_CODE_WAL_OUT_OF_MEMORY;
+    goto _end;
+  }
+
+  while (!eof) {
+    int64_t ret = tfRead(pRestore->tfd, pBatch->buffer + len, pBatch->size - len);
     if (ret < 0) {
-      wError("vgId:%d, file:%s, failed to read wal head since %s", pWal->vgId, name, strerror(errno));
-      code = TAOS_SYSTEM_ERROR(errno);
+      wError("vgId:%d, file:%s, failed to read since %s", pWal->vgId, pRestore->name, strerror(errno));
+      pRestore->code = TAOS_SYSTEM_ERROR(errno);
       break;
     }
 
-    if (ret < sizeof(SWalHead)) {
-      wError("vgId:%d, file:%s, failed to read wal head, ret is %d", pWal->vgId, name, ret);
-      walFtruncate(pWal, tfd, offset);
-      break;
-    }
+    eof = (ret == 0);
+    len += (int32_t)ret;
+
+    int32_t needSize = 0;
+    while (pos + (int32_t)sizeof(SWalHead) <= len) {
+      SWalHead *pHead = (SWalHead *)(pBatch->buffer + pos);
+      if (!walIsValidHead(pHead)) {
+        if (corruptOffset < 0) {
+          corruptOffset = offset + pos;
+          wError("vgId:%d, file:%s, wal head is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId,
+                 pRestore->name, pHead->version, pHead->len, corruptOffset);
+        }
+
+        pos++;
+        continue;
+      }
 
-    if (!taosCheckChecksumWhole((uint8_t *)pHead, sizeof(SWalHead))) {
-      wError("vgId:%d, file:%s, wal head cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
-      if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+      if (corruptOffset >= 0) {
+        wInfo("vgId:%d, wal head cksum check passed, offset:%" PRId64, pWal->vgId, offset + pos);
+        corruptOffset = -1;
       }
-    }
 
-    if (pHead->len < 0 || pHead->len > size - sizeof(SWalHead)) {
-      wError("vgId:%d, file:%s, wal head len out of range, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
-      if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
+      int32_t recordLen = (int32_t)sizeof(SWalHead) + pHead->len;
+      if (pos + recordLen > len) {
+        needSize = recordLen;
         break;
       }
+
+      if ((pRestore->code = walAddToRestoreBatch(pBatch, pos)) != TSDB_CODE_SUCCESS) goto _end;
+      pos += recordLen;
     }
 
-    ret = (int32_t)tfRead(tfd, pHead->cont, pHead->len);
-    if (ret < 0) {
-      wError("vgId:%d, file:%s, failed to read wal body since %s", pWal->vgId, name, strerror(errno));
-      code = TAOS_SYSTEM_ERROR(errno);
-      break;
+    if (eof) break;
+
+    // pass the complete records to the applier, and move the remaining bytes into the next batch
+    SWalRestoreBatch *pNext = walAllocRestoreBatch(MAX(WAL_RESTORE_BUF_SIZE, needSize));
+    if (pNext == NULL) {
+      pRestore->code = TSDB_CODE_WAL_OUT_OF_MEMORY;
+      goto _end;
     }
 
-    if (ret < pHead->len) {
-      wError("vgId:%d, file:%s, failed to read wal body, ret:%d len:%d", pWal->vgId, name, ret, pHead->len);
-      offset += sizeof(SWalHead);
-      continue;
+    memcpy(pNext->buffer, pBatch->buffer + pos, len - pos);
+    pBatch->endOffset = offset + pos;
+    if (pBatch->numOfRecords > 0) {
+      walPushRestoreBatch(pRestore, pBatch);
+    } else {
+      walFreeRestoreBatch(pBatch);
     }
 
-    offset = offset + sizeof(SWalHead) + pHead->len;
+    pBatch = pNext;
+    offset += pos;
+    len -= pos;
+    pos = 0;
+  }
 
-    wTrace("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d", pWal->vgId,
-           fileId, pHead->version, pWal->version, pHead->len);
+  if (eof && corruptOffset >= 0) {
+    wError("vgId:%d, read to end of corrupted wal file, offset:%" PRId64, pWal->vgId, offset + pos);
+    pRestore->code = TSDB_CODE_WAL_FILE_CORRUPTED;
+    pRestore->truncOffset = corruptOffset;
+  } else if (eof && pos < len) {
+    if (len - pos < sizeof(SWalHead)) {
+      wError("vgId:%d, file:%s, failed to read wal head, ret is %d", pWal->vgId, pRestore->name, len - pos);
+      pRestore->truncOffset = offset + pos;
+    } else {
+      SWalHead *pHead = (SWalHead *)(pBatch->buffer + pos);
+      wError("vgId:%d, file:%s, failed to read wal body, ret:%d len:%d", pWal->vgId, pRestore->name,
+             len - pos - (int32_t)sizeof(SWalHead), pHead->len);
+    }
+  }
 
-    pWal->version = pHead->version;
-    (*writeFp)(pVnode, pHead, TAOS_QTYPE_WAL, NULL);
+_end:
+  if (pBatch != NULL && pBatch->numOfRecords > 0) {
+    pBatch->endOffset = offset + pos;
+    walPushRestoreBatch(pRestore, pBatch);
+  } else {
+    walFreeRestoreBatch(pBatch);
   }
 
+  pthread_mutex_lock(&pRestore->mutex);
+  pRestore->eof = true;
+  pthread_cond_broadcast(&pRestore->cond);
+  pthread_mutex_unlock(&pRestore->mutex);
+
+  return NULL;
+}
+
+static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, char *name, int64_t fileId) {
+  int64_t tfd = tfOpen(name, O_RDWR);
+  if (!tfValid(tfd)) {
+    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  int64_t fileSize = tfLseek(tfd, 0, SEEK_END);
+  tfLseek(tfd, 0, SEEK_SET);
+
+  SWalRestore restore = {.pWal = pWal, .name = name, .tfd = tfd, .truncOffset = -1, .code = TSDB_CODE_SUCCESS};
+  pthread_mutex_init(&restore.mutex, NULL);
+  pthread_cond_init(&restore.cond, NULL);
+
+  pthread_t      thread;
+  pthread_attr_t thAttr;
+  pthread_attr_init(&thAttr);
+  pthread_attr_setdetachstate(&thAttr, PTHREAD_CREATE_JOINABLE);
+
+  restore.threaded = true;
+  if (pthread_create(&thread, &thAttr, walReadWalFile, &restore) != 0) {
+    wWarn("vgId:%d, file:%s, failed to create read thread since %s, read it directly", pWal->vgId, name,
+          strerror(errno));
+    restore.threaded = false;
+    walReadWalFile(&restore);
+  }
+
+  pthread_attr_destroy(&thAttr);
+
+  int64_t startMs = taosGetTimestampMs();
+  int64_t reportMs = startMs;
+  int64_t numOfRecords = 0;
+
+  SWalRestoreBatch *pBatch = NULL;
+  while ((pBatch = walPopRestoreBatch(&restore)) != NULL) {
+    for (int32_t i = 0; i < pBatch->numOfRecords; ++i) {
+      SWalHead *pHead = (SWalHead *)(pBatch->buffer + pBatch->offsets[i]);
+
+      wTrace("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d", pWal->vgId,
+             fileId, pHead->version, pWal->version, pHead->len);
+
+      pWal->version = pHead->version;
+      (*writeFp)(pVnode, pHead, TAOS_QTYPE_WAL, NULL);
+    }
+
+    numOfRecords += pBatch->numOfRecords;
+
+    int64_t nowMs = taosGetTimestampMs();
+    if (nowMs - reportMs >= WAL_RESTORE_PROGRESS_MS) {
+      wInfo("vgId:%d, file:%s, restore progress:%" PRId64 "%%, records:%" PRId64, pWal->vgId, name,
+            pBatch->endOffset * 100 / MAX(fileSize, 1), numOfRecords);
+      reportMs = nowMs;
+    }
+
+    walFreeRestoreBatch(pBatch);
+  }
+
+  if (restore.threaded) {
+    pthread_join(thread, NULL);
+  }
+
+  if (restore.truncOffset >= 0) {
+    walFtruncate(pWal, tfd, restore.truncOffset);
+  }
+
+  wDebug("vgId:%d, file:%s, %" PRId64 " records are restored in %" PRId64 " ms", pWal->vgId, name, numOfRecords,
+         taosGetTimestampMs() - startMs);
+
+  pthread_cond_destroy(&restore.cond);
+  pthread_mutex_destroy(&restore.mutex);
   tfClose(tfd);
-  tfree(buffer);
 
-  return code;
+  return restore.code;
 }
 
 uint64_t walGetVersion(twalh param) {
@@ -18,6 +18,7 @@
 #include "tutil.h"
 #include "tglobal.h"
 #include "tlog.h"
+#include "tfile.h"
 #include "twal.h"
 
 int64_t  ver = 0;
@@ -42,6 +43,7 @@ int main(int argc, char *argv[]) {
   int  rows = 10000;
   int  size = 128;
   int  keep = 0;
+  int  batch = 0;
 
   for (int i=1; i<argc; ++i) {
     if (strcmp(argv[i], "-p")==0 && i < argc-1) {
@@ -56,6 +58,8 @@ int main(int argc, char *argv[]) {
       total = atoi(argv[++i]);
     } else if (strcmp(argv[i], "-s")==0 && i < argc-1) {
       size = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-b")==0 && i < argc-1) {
+      batch = atoi(argv[++i]);
     } else if (strcmp(argv[i], "-v")==0 && i < argc-1) {
       ver = atoll(argv[++i]);
     } else if (strcmp(argv[i], "-d")==0 && i < argc-1) {
@@ -67,6 +71,7 @@ int main(int argc, char *argv[]) {
       printf("  [-t total]: total wal files, default is:%d\n", total);
       printf("  [-r rows]: rows of records per wal file, default is:%d\n", rows);
       printf("  [-k keep]: keep the wal after closing, default is:%d\n", keep);
+      printf("  [-b batch]: records per group commit, 0 means no walFsync is called, default is:%d\n", batch);
       printf("  [-v version]: initial version, default is:%" PRId64 "\n", ver);
       printf("  [-d debugFlag]: debug flag, default:%d\n", dDebugFlag);
       printf("  [-h help]: print out this help\n\n");
@@ -75,6 +80,8 @@ int main(int argc, char *argv[]) {
   } 
 
   taosInitLog("wal.log", 100000, 10);
+  tfInit();
+  walInit();
 
   SWalCfg walCfg = {0};
   walCfg.walLevel = level;
@@ -92,23 +99,41 @@ int main(int argc, char *argv[]) {
     exit(-1);
   }
 
+  // the same as vnode, a new wal file is created after restoring
+  if (keep == 0) walRenew(pWal);
+
   printf("version starts from:%" PRId64 "\n", ver);
   
   int contLen = sizeof(SWalHead) + size;
   SWalHead *pHead = (SWalHead *) malloc(contLen);
 
+  int64_t st = taosGetTimestampUs();
+
   for (int i=0; i<total; ++i) {
     for (int k=0; k<rows; ++k) {
       pHead->version = ++ver;
       pHead->len = size;
       walWrite(pWal, pHead);
+      if (batch > 0 && (k + 1) % batch == 0) walFsync(pWal, false);
     }
        
+    if (batch > 0) walFsync(pWal, false);
     printf("renew a wal, i:%d\n", i);
     walRenew(pWal);
   }
 
-  printf("%d wal files are written\n", total);
+  int64_t elapsed = taosGetTimestampUs() - st;
+  printf("%d wal files are written, %.0f records/s\n", total, (double)total * rows * 1000000 / MAX(elapsed, 1));
+
+  SWalStat stat = {0};
+  walGetStat(pWal, &stat);
+  printf("batches:%" PRId64 " records:%" PRId64 " fsyncs:%" PRId64 "\n", stat.numOfBatches, stat.numOfRecords,
+         stat.numOfFsyncs);
+  for (int i = 0; i < WAL_STAT_BUCKETS; ++i) {
+    if (stat.batchSize[i] == 0 && stat.latency[i] == 0) continue;
+    printf("  [%d, %d): batch size:%" PRId64 " latency(us):%" PRId64 "\n", 1 << i, 1 << (i + 1), stat.batchSize[i],
+           stat.latency[i]);
+  }
 
   int64_t index = 0;
   char    name[256];
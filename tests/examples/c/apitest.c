@@ -404,6 +404,138 @@ void verify_prepare(TAOS* taos) {
   taos_stmt_close(stmt);
 }
 
+void verify_prepare_batch(TAOS* taos) {
+  TAOS_RES* result = taos_query(taos, "drop database if exists test;");
+  taos_free_result(result);
+  usleep(100000);
+  result = taos_query(taos, "create database test;");
+
+  int code = taos_errno(result);
+  if (code != 0) {
+    printf("\033[31mfailed to create database, reason:%s\033[0m\n", taos_errstr(result));
+    taos_free_result(result);
+    return;
+  }
+  taos_free_result(result);
+
+  usleep(100000);
+  taos_select_db(taos, "test");
+
+  // create a super table and 10 tables, which are spread over the vgroups
+  char sql[256];
+  strcpy(sql, "create table m2 (ts timestamp, v4 int, f8 double, bin binary(40)) tags(t int)");
+  for (int i = 0; i <= 10; ++i) {
+    if (i > 0) {
+      sprintf(sql, "create table m2_%d using m2 tags(%d)", i - 1, i - 1);
+    }
+    result = taos_query(taos, sql);
+    code = taos_errno(result);
+    if (code != 0) {
+      printf("\033[31mfailed to create table, reason:%s\033[0m\n", taos_errstr(result));
+      taos_free_result(result);
+      return;
+    }
+    taos_free_result(result);
+  }
+
+  // 100 records of each table are bound in two batches, f8 is null in every 3rd record
+  int64_t ts[50];
+  int32_t v4[50];
+  double  f8[50];
+  char    bin[50][40];
+  int32_t length[50];
+  char    is_null[50];
+
+  TAOS_MULTI_BIND params[4] = {0};
+  params[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  params[0].buffer = ts;
+  params[1].buffer_type = TSDB_DATA_TYPE_INT;
+  params[1].buffer = v4;
+  params[2].buffer_type = TSDB_DATA_TYPE_DOUBLE;
+  params[2].buffer = f8;
+  params[2].is_null = is_null;
+  params[3].buffer_type = TSDB_DATA_TYPE_BINARY;
+  params[3].buffer = bin;
+  params[3].buffer_length = sizeof(bin[0]);
+  params[3].length = length;
+  for (int i = 0; i < 4; ++i) {
+    params[i].num = 50;
+  }
+
+  TAOS_STMT* stmt = taos_stmt_init(taos);
+  code = taos_stmt_prepare(stmt, "insert into test.m2_0 values(?,?,?,?)", 0);
+  if (code != 0) {
+    printf("\033[31mfailed to execute taos_stmt_prepare. code:0x%x\033[0m\n", code);
+    taos_stmt_close(stmt);
+    return;
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    // the name is resolved in the database of the prepared table if it is not qualified
+    sprintf(sql, (i % 2 == 0) ? "m2_%d" : "test.m2_%d", i);
+    code = taos_stmt_set_tbname(stmt, sql);
+    if (code != 0) {
+      printf("\033[31mfailed to set table name %s. code:0x%x\033[0m\n", sql, code);
+      taos_stmt_close(stmt);
+      return;
+    }
+
+    for (int j = 0; j < 100; j += 50) {
+      for (int k = 0; k < 50; ++k) {
+        ts[k] = 1591060628000 + j + k;
+        v4[k] = i * 100 + j + k;
+        f8[k] = (double)(j + k) / 2;
+        is_null[k] = ((j + k) % 3 == 0);
+        length[k] = sprintf(bin[k], "%d", j + k);
+      }
+      code = taos_stmt_bind_param_batch(stmt, params);
+      if (code != 0) {
+        printf("\033[31mfailed to bind records of table %s. code:0x%x\033[0m\n", sql, code);
+        taos_stmt_close(stmt);
+        return;
+      }
+    }
+  }
+
+  if (taos_stmt_execute(stmt) != 0) {
+    printf("\033[31mfailed to execute insert statement.\033[0m\n");
+    taos_stmt_close(stmt);
+    return;
+  }
+  taos_stmt_close(stmt);
+
+  result = taos_query(taos, "select count(*), count(f8), sum(v4) from m2");
+  TAOS_ROW row = taos_fetch_row(result);
+  if (row == NULL || *(int64_t*)row[0] != 1000 || *(int64_t*)row[1] != 660 || *(int64_t*)row[2] != 499500) {
+    printf("\033[31mthe records are not inserted by the batch statement\033[0m\n");
+  } else {
+    printf("1000 records inserted into 10 tables by the batch statement\n");
+  }
+  taos_free_result(result);
+
+  // the columns left out of the column list are null
+  stmt = taos_stmt_init(taos);
+  code = taos_stmt_prepare(stmt, "insert into m2_0 (ts, v4) values(?,?)", 0);
+  for (int k = 0; k < 50; ++k) {
+    ts[k] = 1591060629000 + k;
+  }
+  if (code != 0 || taos_stmt_bind_param_batch(stmt, params) != 0 || taos_stmt_execute(stmt) != 0) {
+    printf("\033[31mfailed to insert records with a column list\033[0m\n");
+    taos_stmt_close(stmt);
+    return;
+  }
+  taos_stmt_close(stmt);
+
+  result = taos_query(taos, "select count(*), count(f8), count(bin) from m2_0 where ts >= 1591060629000");
+  row = taos_fetch_row(result);
+  if (row == NULL || *(int64_t*)row[0] != 50 || *(int64_t*)row[1] != 0 || *(int64_t*)row[2] != 0) {
+    printf("\033[31mthe columns out of the column list are not null\033[0m\n");
+  } else {
+    printf("50 records inserted with a column list\n");
+  }
+  taos_free_result(result);
+}
+
 void retrieve_callback(void *param, TAOS_RES *tres, int numOfRows)
 {
   if (numOfRows > 0) {
@@ -492,6 +624,9 @@ int main(int argc, char *argv[]) {
   printf("************ verify prepare *************\n");
   verify_prepare(taos);
 
+  printf("********* verify prepare batch **********\n");
+  verify_prepare_batch(taos);
+
   printf("************ verify stream  *************\n");
   verify_stream(taos);
   printf("done\n");
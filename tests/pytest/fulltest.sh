@@ -21,6 +21,8 @@ python3 ./test.py -f insert/alterTableAndInsert.py
 python3 ./test.py -f insert/insertIntoTwoTables.py
 #python3 ./test.py -f insert/before_1970.py
 python3 ./test.py -f insert/metadataUpdate.py
+python3 ./test.py -f insert/influxLineProtocol.py
+python3 ./test.py -f insert/compaction.py
 python3 bug2265.py
 
 #table
@@ -45,6 +47,7 @@ python3 ./test.py -f tag_lite/4.py
 python3 ./test.py -f tag_lite/5.py
 python3 ./test.py -f tag_lite/6.py
 python3 ./test.py -f tag_lite/add.py
+python3 ./test.py -f tag_lite/add-then-create.py
 python3 ./test.py -f tag_lite/bigint.py
 python3 ./test.py -f tag_lite/binary_binary.py
 python3 ./test.py -f tag_lite/binary.py
@@ -152,7 +155,9 @@ python3 ./test.py -f query/queryError.py
 python3 ./test.py -f query/filterAllIntTypes.py
 python3 ./test.py -f query/filterFloatAndDouble.py
 python3 ./test.py -f query/filterOtherTypes.py
+python3 ./test.py -f query/filterBlockStatis.py
 python3 ./test.py -f query/querySort.py
+python3 ./test.py -f query/queryOrderByColumn.py
 python3 ./test.py -f query/queryJoin.py
 python3 ./test.py -f query/select_last_crash.py
 python3 ./test.py -f query/queryNullValueTest.py
@@ -170,6 +175,8 @@ python3 ./test.py -f query/bug2117.py
 python3 ./test.py -f query/bug2118.py
 python3 ./test.py -f query/bug2143.py
 python3 ./test.py -f query/sliding.py
+python3 ./test.py -f query/slidingPane.py
+python3 ./test.py -f query/rollup.py
 python3 ./test.py -f query/unionAllTest.py
 python3 ./test.py -f query/bug2281.py
 python3 ./test.py -f query/bug2119.py
@@ -224,6 +231,7 @@ python3 ./test.py -f functions/function_sum.py -r 1
 python3 ./test.py -f functions/function_top.py -r 1
 python3 ./test.py -f functions/function_twa.py -r 1
 python3 ./test.py -f functions/function_twa_test2.py
+python3 ./test.py -f functions/function_hyperloglog.py
 python3 ./test.py -f functions/all_null_value.py
 python3 queryCount.py
 python3 ./test.py -f query/queryGroupbyWithInterval.py
@@ -232,6 +240,7 @@ python3 ./test.py -f query/queryInterval.py
 python3 ./test.py -f query/queryFillTest.py
 python3 ./test.py -f query/last_row_cache.py
 python3 ./test.py -f query/last_cache.py
+python3 ./test.py -f query/lastColumnCache.py
 
 # tools
 python3 test.py -f tools/taosdemoTest.py
@@ -0,0 +1,71 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import taos
+from util.log import *
+from util.cases import *
+from util.sql import *
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor())
+
+        self.rowNum = 1000
+        self.distinct = 100
+        self.ts = 1537146000000
+
+    def checkEstimate(self, sql, expect):
+        tdSql.query(sql)
+        tdSql.checkRows(1)
+        estimate = tdSql.getData(0, 0)
+        if abs(estimate - expect) > expect * 0.05:
+            tdLog.exit("sql:%s, estimate %s is not close to %d" % (sql, estimate, expect))
+        tdLog.info("sql:%s, estimate %s of %d" % (sql, estimate, expect))
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create table test(ts timestamp, col1 int, col2 binary(20)) tags(loc int)")
+        tdSql.execute("create table test1 using test tags(1)")
+        tdSql.execute("create table test2 using test tags(2)")
+        for i in range(self.rowNum):
+            tdSql.execute("insert into test1 values(%d, %d, 'v%d') test2 values(%d, %d, 'v%d')" %
+                          (self.ts + i, i % self.distinct, i % self.distinct,
+                           self.ts + i, i % self.distinct + self.distinct, i % self.distinct))
+
+        # the function name is a keyword in any case
+        self.checkEstimate("select hyperloglog(col1) from test1", self.distinct)
+        self.checkEstimate("select HyperLogLog(col2) from test1", self.distinct)
+        self.checkEstimate("select HYPERLOGLOG(col1, 13) from test", 2 * self.distinct)
+        self.checkEstimate("select hyperloglog(col2) from test", self.distinct)
+
+        tdSql.query("select hyperloglog(col1) from test group by loc")
+        tdSql.checkRows(2)
+
+        tdSql.error("select hyperloglog(*) from test1")
+        tdSql.error("select hyperloglog() from test1")
+        tdSql.error("select hyperloglog(col1, 14) from test1")
+
+        # like the other function keywords it is not a valid column name
+        tdSql.error("create table test3(ts timestamp, hyperloglog int)")
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
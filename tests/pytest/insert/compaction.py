@@ -0,0 +1,115 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import os
+import re
+import sys
+import time
+import taos
+from util.log import tdLog
+from util.cases import tdCases
+from util.sql import tdSql
+from util.dnodes import tdDnodes
+
+
+class TDTestCase:
+    updatecfgDict = {'compactMBPerSec': 0}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.day = 24 * 3600 * 1000
+        self.ts = (int(time.time() * 1000) // self.day - 10) * self.day
+        self.rows = 0
+        self.sum = 0
+
+    def insertRows(self, table, start, count, step):
+        for i in range(0, count, 1000):
+            sql = "insert into %s values" % table
+            for j in range(i, min(i + 1000, count)):
+                sql += "(%d, %d, %f)" % (start + j * step, j, j * 0.5)
+                self.sum += j
+            tdSql.execute(sql)
+        self.rows += count
+
+    def compactedFids(self):
+        with open(os.path.join(tdDnodes.dnodes[0].logDir, "taosdlog.0"), errors="ignore") as f:
+            return set(int(fid) for fid in re.findall(r"file (-?\d+) is compacted", f.read()))
+
+    def checkRows(self):
+        tdSql.query("select count(*), sum(c1) from cdb.st")
+        tdSql.checkData(0, 0, self.rows)
+        tdSql.checkData(0, 1, self.sum)
+
+        # the rows of each table are still in key order, without duplicates
+        for table in ["t1", "t2"]:
+            tdSql.query("select ts from cdb.%s where ts >= %d and ts < %d" % (table, self.ts, self.ts + 3 * self.day))
+            tdSql.checkRows(3 * 5000)
+            keys = [row[0] for row in tdSql.queryResult]
+            if keys != sorted(set(keys)):
+                tdLog.exit("rows of %s are not in key order after compaction" % table)
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create database cdb days 1 cache 1 blocks 3")
+        tdSql.execute("use cdb")
+        tdSql.execute("create table st(ts timestamp, c1 int, c2 double) tags(t1 int)")
+        tdSql.execute("create table t1 using st tags(1)")
+        tdSql.execute("create table t2 using st tags(2)")
+
+        # three past file groups, committed by the restart. They turn cold with the restart too, and compaction picks
+        # them to recompress them with the cold backend.
+        for table in ["t1", "t2"]:
+            self.insertRows(table, self.ts, 3 * 5000, int(3 * self.day / 15000))
+        tdDnodes.stop(1)
+        tdDnodes.dnodes[0].cfg("coldCompDays", 1)
+        tdDnodes.start(1)
+
+        # the rows of the current time fill the cache, the commits they cause schedule compaction
+        now = int(time.time() * 1000)
+        self.insertRows("t1", now - 200000, 200000, 1)
+
+        pastFids = set(int((self.ts + i * self.day) // self.day) for i in range(3))
+        for i in range(60):
+            if pastFids <= self.compactedFids():
+                break
+            time.sleep(1)
+        compacted = self.compactedFids()
+        if not pastFids <= compacted:
+            tdLog.exit("file groups %s are not compacted, compacted %s" % (pastFids, compacted))
+
+        # the file group written by the current time window is never compacted
+        if now // self.day in compacted:
+            tdLog.exit("the current file group %d is compacted" % (now // self.day))
+
+        self.checkRows()
+
+        # no file of a compaction is left behind, and the compacted files are read again after the restart
+        tdDnodes.stop(1)
+        for root, dirs, files in os.walk(tdDnodes.dnodes[0].dataDir):
+            for name in files:
+                if re.match(r"^v\d+f\d+\.(ch|cd|cl|oh|od|ol)$", name):
+                    tdLog.exit("file %s of a compaction is left in %s" % (name, root))
+        tdDnodes.start(1)
+
+        self.checkRows()
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -0,0 +1,76 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import taos
+from util.log import tdLog
+from util.cases import tdCases
+from util.sql import tdSql
+from util.dnodes import tdDnodes
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1601481600000
+        self.rows = 1000
+        self.maxRows = 200
+        # a commit cuts the rows of a table into blocks of 4/5 maxrows
+        self.blockRows = 160
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create database fdb maxrows %d" % self.maxRows)
+        tdSql.execute("use fdb")
+        tdSql.execute("create table t1(ts timestamp, c1 double, c2 float, c3 int)")
+
+        for i in range(0, self.rows, 100):
+            sql = "insert into t1 values"
+            for j in range(i, i + 100):
+                sql += "(%d, %f, %f, %d)" % (self.ts + j, j * 10.0, j * 10.0, j)
+            tdSql.execute(sql)
+
+        # the rows are read from the file blocks, which are checked against the filters by their statistics
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+
+        last = self.blockRows - 1
+        for col in ["c1", "c2"]:
+            # the values within the tolerance of the row filters equal the first and the last value of a block
+            tdSql.query("select c3 from t1 where %s = %.7f" % (col, last * 10.0 + 1e-7))
+            tdSql.checkRows(1)
+            tdSql.checkData(0, 0, last)
+            tdSql.query("select c3 from t1 where %s = %.7f" % (col, (last + 1) * 10.0 - 1e-7))
+            tdSql.checkRows(1)
+            tdSql.checkData(0, 0, last + 1)
+
+            # a value out of the range of every block
+            tdSql.query("select c3 from t1 where %s = %f" % (col, self.rows * 10.0))
+            tdSql.checkRows(0)
+
+            tdSql.query("select count(*) from t1 where %s >= %f and %s <= %f" % (col, last * 10.0, col, (last + 1) * 10.0))
+            tdSql.checkData(0, 0, 2)
+
+        tdSql.query("select count(*) from t1 where c3 > %d and c3 < %d" % (last - 1, last + 2))
+        tdSql.checkData(0, 0, 2)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -0,0 +1,134 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import taos
+from util.log import tdLog
+from util.cases import tdCases
+from util.sql import tdSql
+from util.dnodes import tdDnodes
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.tables = 4
+        self.rows = 30
+        self.ts = 1601481600000
+        self.column = "c2"
+
+    def insertData(self, db):
+        tdSql.execute("use %s" % db)
+        tdSql.execute("create table st(ts timestamp, c1 int, c2 double, c3 binary(16)) tags(t1 int)")
+
+        # c1 is null in the last 3 rows, c2 in every other row and c3 in the last 5 rows of each table, the tables do
+        # not share timestamps so the last value of the super table is the same whichever table is scanned first
+        for i in range(self.tables):
+            tdSql.execute("create table t%d using st tags(%d)" % (i, i))
+            sql = "insert into t%d values" % i
+            for j in range(self.rows):
+                c1 = "null" if j >= self.rows - 3 else "%d" % (i * 100 + j)
+                c2 = "null" if j % 2 == 1 else "%f" % (j + 0.5)
+                c3 = "null" if j >= self.rows - 5 else "'b%d'" % j
+                sql += "(%d, %s, %s, %s)" % (self.ts + j * 60000 + i * 1000, c1, c2, c3)
+            tdSql.execute(sql)
+
+    def queries(self):
+        mid = self.ts + 10 * 60000
+        sqls = []
+        for tb in ["t0", "t%d" % (self.tables - 1), "st"]:
+            sqls.append("select last(*) from %s" % tb)
+            sqls.append("select last(c1), last(c3) from %s" % tb)
+            # the tables have rows after the end of the window, the query falls back to the normal scan
+            sqls.append("select last(*) from %s where ts <= %d" % (tb, mid))
+            sqls.append("select last(%s) from %s where ts <= %d" % (self.column, tb, mid + 60000))
+        return sqls
+
+    def checkSameResult(self, step):
+        for sql in self.queries():
+            tdSql.execute("use db0")
+            tdSql.query(sql)
+            expect = tdSql.queryResult
+
+            tdSql.execute("use db2")
+            tdSql.query(sql)
+            if tdSql.queryResult != expect:
+                tdLog.exit("%s, sql:%s, cached result %s != scanned result %s" % (step, sql, tdSql.queryResult, expect))
+        tdLog.info("%s, %d queries return the same result with or without the column cache" % (step, len(self.queries())))
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create database db0 cachelast 0")
+        tdSql.execute("create database db2 cachelast 2")
+        for db in ["db0", "db2"]:
+            self.insertData(db)
+
+        # the last non-null value of each column comes from a different row
+        tdSql.execute("use db2")
+        tdSql.query("select last(c1), last(c2), last(c3) from t1")
+        tdSql.checkData(0, 0, 100 + self.rows - 4)
+        tdSql.checkData(0, 1, self.rows - 2 + 0.5)
+        tdSql.checkData(0, 2, "b%d" % (self.rows - 6))
+        self.checkSameResult("insert")
+
+        # the values are restored lazily from the data files on the first query after the restart
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.checkSameResult("restart")
+
+        tdSql.execute("use db2")
+        tdSql.query("select last(c1), last(c2), last(c3) from t1")
+        tdSql.checkData(0, 0, 100 + self.rows - 4)
+        tdSql.checkData(0, 1, self.rows - 2 + 0.5)
+        tdSql.checkData(0, 2, "b%d" % (self.rows - 6))
+
+        # new rows update the restored values, the null ones keep the older values
+        for db in ["db0", "db2"]:
+            tdSql.execute("use %s" % db)
+            tdSql.execute("insert into t1 values(%d, null, 99.5, null)" % (self.ts + self.rows * 60000 + 1000))
+        self.checkSameResult("insert after restart")
+
+        # a column added later is null in the older rows
+        for db in ["db0", "db2"]:
+            tdSql.execute("use %s" % db)
+            tdSql.execute("alter table st add column c4 int")
+            tdSql.execute("insert into t2 values(%d, 1000, null, 'new', 7)" % (self.ts + (self.rows + 1) * 60000 + 2000))
+            tdSql.execute("insert into t2 values(%d, null, null, null, null)" % (self.ts + (self.rows + 2) * 60000 + 2000))
+        self.checkSameResult("add column")
+
+        tdSql.execute("use db2")
+        tdSql.query("select last(c4) from t2")
+        tdSql.checkData(0, 0, 7)
+        tdSql.query("select last(c4) from t0")
+        tdSql.checkRows(0)
+
+        for db in ["db0", "db2"]:
+            tdSql.execute("use %s" % db)
+            tdSql.execute("alter table st drop column c2")
+        self.column = "c3"
+        self.checkSameResult("drop column")
+
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.checkSameResult("restart after schema change")
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -0,0 +1,82 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import taos
+from util.log import tdLog
+from util.cases import tdCases
+from util.sql import tdSql
+import random
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1500000000000
+        self.numOfTables = 2
+        self.rowsPerTable = 12000
+
+    def checkOrderByColumn(self, order, limit, offset):
+        sql = "select ts, c1, c2 from st order by c1 %s limit %d" % (order, limit)
+        if offset > 0:
+            sql += " offset %d" % offset
+        tdSql.query(sql)
+
+        expect = sorted(self.values, reverse=(order == "desc"))[offset:offset + limit]
+        tdSql.checkRows(len(expect))
+
+        result = [row[1] for row in tdSql.queryResult]
+        if result != expect:
+            tdLog.exit("sql:%s, result is not the first %d values in %s order" % (sql, limit, order))
+        tdLog.info("sql:%s, %d rows are in %s order" % (sql, len(result), order))
+
+    def run(self):
+        tdSql.prepare()
+
+        # the wide binary column makes the result threshold of the vnode about 7000 rows
+        tdSql.execute("create table st(ts timestamp, c1 int, c2 binary(200)) tags(t1 int)")
+
+        # each table holds more rows than the limits below, and the rows after the first ones in time can be the top ones
+        self.values = []
+        for i in range(self.numOfTables):
+            tdSql.execute("create table t%d using st tags(%d)" % (i, i))
+            for j in range(0, self.rowsPerTable, 1000):
+                sql = "insert into t%d values" % i
+                for k in range(j, j + 1000):
+                    v = random.randint(-100000, 100000)
+                    self.values.append(v)
+                    sql += "(%d, %d, 'c2')" % (self.ts + (i * self.rowsPerTable + k) * 1000, v)
+                tdSql.execute(sql)
+
+        # the limit is below the result threshold of the vnode, each vgroup keeps a heap of the top rows
+        for order in ["asc", "desc"]:
+            self.checkOrderByColumn(order, 10, 0)
+            self.checkOrderByColumn(order, 10, 5)
+            self.checkOrderByColumn(order, 100, 0)
+
+        # the limit is beyond the result threshold, every qualified row is returned and sorted by the client
+        for order in ["asc", "desc"]:
+            self.checkOrderByColumn(order, 8000, 0)
+            self.checkOrderByColumn(order, 7000, 2000)
+
+        tdSql.error("select ts, c1, c2 from st order by c1 desc, ts asc limit 10")
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -0,0 +1,107 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import taos
+from util.log import tdLog
+from util.cases import tdCases
+from util.sql import tdSql
+from util.dnodes import tdDnodes
+import random
+
+
+class TDTestCase:
+    updatecfgDict = {'rollupInterval': 3600}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1601481600000
+        self.hour = 3600 * 1000
+        self.day = 24 * self.hour
+
+    def insertRows(self, table, start, end, step):
+        keys = list(range(start, end, step))
+        for i in range(0, len(keys), 1000):
+            sql = "insert into %s values" % table
+            for ts in keys[i:i + 1000]:
+                c1 = "null" if random.randint(0, 9) == 0 else "%d" % random.randint(-1000, 1000)
+                sql += "(%d, %s, %f)" % (ts, c1, random.uniform(-100, 100))
+            tdSql.execute(sql)
+
+    def checkSameResult(self, table, where, interval):
+        # first() can not be computed from the rollups, the same windows are aggregated from the data blocks then
+        sql = "select count(*), count(c1), sum(c1), min(c1), max(c1), avg(c2), spread(c2) from %s %s interval(%s)" % (
+            table, where, interval)
+        tdSql.query(sql)
+        rollupResult = tdSql.queryResult
+
+        tdSql.query(sql.replace("spread(c2)", "spread(c2), first(c1)"))
+        blockResult = [row[:8] for row in tdSql.queryResult]
+
+        if len(rollupResult) == 0 or len(rollupResult) != len(blockResult):
+            tdLog.exit("sql:%s, %d windows from rollups, %d windows from blocks" % (
+                sql, len(rollupResult), len(blockResult)))
+
+        for r, b in zip(rollupResult, blockResult):
+            if r[:6] != b[:6] or abs(r[6] - b[6]) > 1e-6 or abs(r[7] - b[7]) > 1e-6:
+                tdLog.exit("sql:%s, rollup result %s != block result %s" % (sql, r, b))
+        tdLog.info("sql:%s, %d windows are the same" % (sql, len(rollupResult)))
+
+    def checkQueries(self):
+        for table in ["st", "t1", "t2"]:
+            self.checkSameResult(table, "", "1h")
+            self.checkSameResult(table, "", "2h")
+            self.checkSameResult(table, "", "1d")
+            # the windows are not made of whole buckets
+            self.checkSameResult(table, "", "90m")
+            # the window covers part of the second file group, which is read from the data blocks
+            self.checkSameResult(table, "where ts <= %d" % (self.ts + self.day + 12 * self.hour), "1h")
+            self.checkSameResult(table, "where ts >= %d" % (self.ts + 12 * self.hour), "1h")
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create database rdb days 1")
+        tdSql.execute("use rdb")
+        tdSql.execute("create table st(ts timestamp, c1 int, c2 double) tags(t1 int)")
+        tdSql.execute("create table t1 using st tags(1)")
+        tdSql.execute("create table t2 using st tags(2)")
+
+        # the first file group only has rows of t2, it has rollups but none of t1
+        self.insertRows("t2", self.ts, self.ts + self.day, 60000)
+        self.insertRows("t1", self.ts + self.day, self.ts + 3 * self.day, 60000)
+        self.insertRows("t2", self.ts + self.day, self.ts + 2 * self.day, 90000)
+
+        # the rollups are written when the rows are committed to the files
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.checkQueries()
+
+        # rows in buffer overlap the second file group, which is read from the data blocks till they are committed
+        self.insertRows("t1", self.ts + self.day + 30000, self.ts + self.day + 6 * self.hour, 600000)
+        self.checkQueries()
+
+        # the rollups of the second file group are built again from the committed rows
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.checkQueries()
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
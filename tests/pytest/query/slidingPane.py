@@ -0,0 +1,72 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import taos
+from util.log import tdLog
+from util.cases import tdCases
+from util.sql import tdSql
+import random
+import datetime
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1500000000000
+
+    def checkSameResult(self, interval, sliding):
+        # count/sum/min/max only are merged from the panes of the sliding windows, first() takes the row by row path
+        tdSql.query("select count(*), sum(v), min(v), max(v) from t1 interval(%s) sliding(%s)" % (interval, sliding))
+        paneResult = tdSql.queryResult
+
+        tdSql.query("select count(*), sum(v), min(v), max(v), first(v) from t1 interval(%s) sliding(%s)" % (interval, sliding))
+        rowResult = [row[:5] for row in tdSql.queryResult]
+
+        if paneResult != rowResult:
+            tdLog.exit("interval(%s) sliding(%s): pane result %s != row result %s" % (interval, sliding, paneResult, rowResult))
+        tdLog.info("interval(%s) sliding(%s): %d windows are the same" % (interval, sliding, len(paneResult)))
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create table t1(ts timestamp, v int)")
+
+        # clusters of rows separated by gaps longer than the interval
+        offsets = [0, 100, 101, 250, 257, 259, 400]
+        for i in range(20):
+            offsets.append(600 + random.randint(0, 300))
+        offsets = sorted(set(offsets))
+
+        sql = "insert into t1 values"
+        for offset in offsets:
+            sql += "(%d, %d)" % (self.ts + offset * 1000, random.randint(1, 100))
+        tdSql.execute(sql)
+
+        # the window [95s, 105s) is the earliest one covering the row at 100s after the gap
+        tdSql.query("select count(*) from t1 interval(10s) sliding(5s)")
+        tdSql.checkData(2, 0, datetime.datetime.fromtimestamp((self.ts + 95 * 1000) / 1000))
+        tdSql.checkData(2, 1, 2)
+
+        for interval, sliding in [("10s", "5s"), ("10s", "4s"), ("15s", "10s"), ("12s", "8s"), ("1m", "20s")]:
+            self.checkSameResult(interval, sliding)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -0,0 +1,74 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+    def checkTags(self):
+        tdSql.query("select t1, t2, t3 from t0")
+        tdSql.checkData(0, 0, 0)
+        tdSql.checkData(0, 1, None)
+        tdSql.checkData(0, 2, None)
+
+        tdSql.query("select t1, t2, t3 from t1")
+        tdSql.checkData(0, 0, 1)
+        tdSql.checkData(0, 1, 11)
+        tdSql.checkData(0, 2, None)
+
+        tdSql.query("select t1, t2, t3 from t2")
+        tdSql.checkData(0, 0, 2)
+        tdSql.checkData(0, 1, 12)
+        tdSql.checkData(0, 2, "b2")
+
+        tdSql.query("select count(*) from st where t2 = 12")
+        tdSql.checkData(0, 0, 1)
+        tdSql.query("select count(*) from st where t3 = 'b2'")
+        tdSql.checkData(0, 0, 1)
+
+    def run(self):
+        tdSql.prepare()
+
+        # the vnode has the super table with its first tag schema once t0 is created
+        tdSql.execute("create table st(ts timestamp, c1 int) tags(t1 int)")
+        tdSql.execute("create table t0 using st tags(0)")
+        tdSql.execute("insert into t0 values(now, 0)")
+
+        # the tags added afterwards reach the vnode with the child tables created next
+        tdSql.execute("alter table st add tag t2 int")
+        tdSql.execute("create table t1 using st tags(1, 11)")
+        tdSql.execute("insert into t1 values(now, 1)")
+
+        tdSql.execute("alter table st add tag t3 binary(8)")
+        tdSql.execute("insert into t2 using st tags(2, 12, 'b2') values(now, 2)")
+        self.checkTags()
+
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.checkTags()
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())